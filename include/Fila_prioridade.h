@@ -16,6 +16,18 @@ typedef enum {
     NOITE
 } Turno;
 
+/* Quotas de vendas por turno */
+#define LIMITE_VENDAS_MANHA 35
+#define LIMITE_VENDAS_TARDE 35
+#define LIMITE_VENDAS_NOITE 30
+
+#define MAX_FILA 200  // Tamanho máximo da fila
+
+/* Desistências: roda temporal com posições de RESOLUCAO_RODA_MS; os prazos
+ * além de uma volta ficam na mesma posição e são revistos a cada volta */
+#define RESOLUCAO_RODA_MS 100
+#define POSICOES_RODA 4096
+
 typedef struct {
     int id_cliente;
     TipoCliente tipo;
@@ -26,28 +38,58 @@ typedef struct {
 typedef struct Node {
     Cliente cliente;
     struct Node* next;
+    struct Node* prev;
+    // Roda de desistências (posicao_roda -1 = sem prazo)
+    struct Node* prox_roda;
+    struct Node* ant_roda;
+    int posicao_roda;
+    long long prazo_desistencia_ns;
 } Node;
 
 typedef struct {
     Node* frente;
     Node* fim;
     int tamanho;
+    Node** roda;                // POSICOES_RODA listas de nós com prazo
+    long long tique_roda;       // Último tique da roda já revisto
+    long long chegadas[2];      // Por TipoCliente
+    long long desistencias[2];
     pthread_mutex_t lock;       // Mutex para exclusão mútua
     sem_t semaforo_clientes;    // Semáforo para controle de clientes disponíveis
     sem_t semaforo_espaco;      // Semáforo para controle de espaço na fila
 } FilaPrioridade;
 
+typedef struct {
+    double paciencia_s[2];      // 0 = espera sem limite
+    long long chegadas[2];
+    long long desistencias[2];
+} EstatisticasDesistencia;
+
+// Aviso de chegada (ex.: acordar agências em fibras que esperam clientes)
+typedef void (*AvisoChegadaFila)(void);
+
 // Protótipos das funções
 FilaPrioridade* inicializar_fila(void);
 void liberar_fila(FilaPrioridade* fila);
 void inserir_cliente(FilaPrioridade* fila, int id_cliente, TipoCliente tipo);
+int tentar_inserir_cliente(FilaPrioridade* fila, int id_cliente, TipoCliente tipo);  // Não bloqueia
 Cliente* obter_proximo_cliente(FilaPrioridade* fila);
 void remover_cliente_processado(FilaPrioridade* fila, int id_cliente);
+int retirar_proximo_cliente(FilaPrioridade* fila, Cliente* destino);  // Não bloqueia
+void devolver_cliente(FilaPrioridade* fila, const Cliente* cliente);
 int processar_vendas_turno(FilaPrioridade* fila, Turno turno_atual);
 void imprimir_fila(FilaPrioridade* fila);
 void bloquear_vendas_publico(FilaPrioridade* fila);
 void adicionar_lote_empresas(FilaPrioridade* fila, int quantidade);
 int calcular_prioridade_cliente(Cliente* cliente);
+int limite_vendas_turno(Turno turno);
+void fila_definir_aviso_chegada(AvisoChegadaFila aviso);  // NULL = nenhum
+
+// Paciência por tipo: "tipo=segundos", antes de inicializar_fila
+int configurar_paciencia(const char* especificacao);
+int fila_expirar_desistencias(FilaPrioridade* fila);  // Retorna as desistências
+void obter_estatisticas_desistencia(FilaPrioridade* fila, EstatisticasDesistencia* destino);
+void exibir_relatorio_desistencias(FilaPrioridade* fila);
 
 // Getter para tamanho máximo da fila
 int get_max_fila(void);
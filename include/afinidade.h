@@ -0,0 +1,42 @@
+#ifndef AFINIDADE_H
+#define AFINIDADE_H
+
+#include <stddef.h>
+
+/* Fixação de threads em CPUs por classe e memória por nó NUMA.
+ * A topologia é lida do sysfs; sem configuração nada é fixado. */
+
+#define MAX_NOS_NUMA 64
+
+typedef enum {
+    CLASSE_AGENCIA,       // Trabalhadores do pool de agências
+    CLASSE_RH,            // Processos de contratação
+    CLASSE_TEMPORIZADOR,  // Recolhedor, rebalanceador, reposição, exportação, timers do RH
+    CLASSE_WEB,           // Threads do libmicrohttpd
+    CLASSE_PIPELINE,      // Estágios do pipeline de vendas
+    CLASSE_GERADOR,       // Produtores de chegadas sintéticas
+    NUM_CLASSES_THREAD
+} ClasseThread;
+
+/* "classe=lista", ex.: "agencias=0-3", "web=4", "rh=5,7" */
+int configurar_afinidade(const char* especificacao);
+int afinidade_configurada(ClasseThread classe);
+int num_cpus_classe(ClasseThread classe);
+
+/* Fixa a thread atual. indice >= 0 escolhe um só CPU do conjunto da
+ * classe (em roda); indice < 0 usa o conjunto inteiro. */
+int aplicar_afinidade_thread(ClasseThread classe, int indice);
+
+/* Topologia */
+int num_nos_numa(void);
+int no_numa_da_cpu(int cpu);
+int no_numa_atual(void);
+void exibir_topologia(void);
+
+/* Memória: no nó da thread atual, ou intercalada por todos os nós.
+ * Sem NUMA (ou se mbind falhar) comporta-se como memória normal. */
+void* alocar_memoria_local(size_t tamanho);
+void* alocar_memoria_intercalada(size_t tamanho);
+void libertar_memoria_numa(void* ptr, size_t tamanho);
+
+#endif
@@ -11,6 +11,19 @@
 #define TEMPO_CONTRATACAO_MAX 20 
 #define INTERVALO_EXIBICAO 30     
 
+/* Motor de eventos do RH: os prazos dos processos (entrada em análise,
+ * progresso e fim da análise) ficam numa roda temporal revista por uma
+ * thread; poucos trabalhadores executam os eventos vencidos. */
+#define ATRASO_INICIO_ANALISE_MS 2000
+#define INTERVALO_PROGRESSO_ANALISE 10    // Segundos entre avisos de progresso
+#define RESOLUCAO_RODA_RH_MS 100
+#define POSICOES_RODA_RH 256
+#define NUM_TRABALHADORES_RH 2
+
+/* Índices por id dos processos e dos contratados (tabelas de dispersão
+ * encadeadas pelos próprios registos; dobram acima de um por posição) */
+#define CAPACIDADE_INICIAL_INDICE_RH 64
+
 /* Estados do processo de contratação */
 typedef enum {
     PENDENTE,
@@ -21,27 +34,31 @@ typedef enum {
     CANCELADO
 } EstadoProcesso;
 
+#define NUM_ESTADOS_PROCESSO (CANCELADO + 1)
+
 /* Estrutura de um funcionário contratado */
 typedef struct Contratacao {
-    int id;
+    int id;                              // Primeiro campo: chave do índice
     char nome[100];
     char cargo[50];
     float salario;
     time_t data_contratacao;
     struct Contratacao *prox;
+    struct Contratacao *ant;             // Demissão sem percorrer a lista
+    struct Contratacao *prox_indice;
 } Contratacao;
 
 /* Estrutura de um processo de contratação */
 typedef struct ProcessoContratacao {
-    int id;
+    int id;                              // Primeiro campo: chave do índice
     char nome[100];
     char cargo[50];
     float salario;
     EstadoProcesso estado;
     time_t data_inicio;
     time_t data_conclusao;
-    pthread_t thread_processo;
     struct ProcessoContratacao *prox;
+    struct ProcessoContratacao *prox_indice;
 } ProcessoContratacao;
 
 /* Interface do módulo */
@@ -68,7 +85,7 @@ void rejeitar_processo(int id);
 void cancelar_processo(int id);
 
 // Gestão de funcionários
-void adicionar_contratado(int id, const char *nome, const char *cargo, float salario);
+int adicionar_contratado(int id, const char *nome, const char *cargo, float salario);  // 0 = sem memória
 void demitir_funcionario(int id);
 
 // Relatórios
@@ -77,14 +94,13 @@ void exibir_contratacoes(void);
 void exibir_estatisticas(void);
 void exibir_contratacoes_periodicas(void);
 
-// Thread para processo
-void* thread_processo_contratacao(void* arg);
-
 // Utilitários
 int get_vagas_disponiveis(void);
 int get_total_contratacoes(void);
 int get_total_demissoes(void);
 int get_funcionarios_ativos(void);
+int get_processos_ativos(void);     // PENDENTE + EM_ANALISE, sem o mutex
+void obter_contagem_estados(int destino[NUM_ESTADOS_PROCESSO]);   // Sem o mutex
 void limpar_lista(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef COORDENADOR_H
+#define COORDENADOR_H
+
+#include <stdint.h>
+
+/* Coordenador de estoque: um processo à parte dono do inventário, servido
+ * por socket Unix (ou TCP em loopback) a várias instâncias do simulador.
+ * Protocolo binário: cada pedido e cada resposta é um cabeçalho de 8 bytes
+ * seguido de 'quantidade' inteiros de 32 bits. Os pedidos podem seguir em
+ * rajada (pipelining): as respostas saem pela mesma ordem. */
+
+#define MAX_LIGACOES_COORDENADOR 64
+#define LOTE_MAXIMO_COORDENADOR 256       // Cartões por pedido
+#define TTL_CEDENCIA_COORDENADOR 86400    // Os cartões cedidos só voltam por pedido ou quarentena
+#define QUARENTENA_COORDENADOR 300        // Segundos retidos os cartões de um nó que caiu
+#define BUFFER_LIGACAO_COORDENADOR 16384
+#define INTERVALO_POLL_COORDENADOR_MS 200
+
+typedef enum {
+    COORD_RESERVAR = 1,   // quantidade = máximo pedido; resposta: ids cedidos
+    COORD_LIBERAR,        // ids cedidos que voltam ao estoque; resposta: aceites, ids recusados
+    COORD_VENDER,         // ids cedidos que foram vendidos; resposta: aceites, ids recusados
+    COORD_CONTAGEM        // resposta: disponíveis, cedidos, vendidos, total
+} OperacaoCoordenador;
+
+typedef struct {
+    uint32_t operacao;
+    uint32_t quantidade;
+} PedidoCoordenador;
+
+typedef struct {
+    int32_t estado;       // 0 = ok, -1 = pedido inválido
+    uint32_t quantidade;
+} RespostaCoordenador;
+
+/* "caminho" (socket Unix, ex.: /tmp/unitel.sock) ou "host:porta" (TCP).
+ * Retorna o descritor ou -1. */
+int coordenador_abrir_endereco(const char* endereco, int servidor);
+
+/* Serve até SIGINT/SIGTERM; usa o módulo de estoque deste processo */
+int executar_coordenador_estoque(const char* endereco);
+
+#endif
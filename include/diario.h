@@ -0,0 +1,47 @@
+#ifndef DIARIO_H
+#define DIARIO_H
+
+#include <stdint.h>
+#include <time.h>
+#include "Fila_prioridade.h"
+
+/* Diário binário de vendas: um registo de largura fixa por venda,
+ * acumulado em buffers por thread e escrito em blocos no ficheiro. */
+
+#define DIARIO_MAGIA "UNITELDV"
+#define DIARIO_VERSAO 1
+#define DIARIO_REGISTOS_POR_BUFFER 2048   // 64 KB por thread
+#define DIARIO_REGISTOS_POR_BLOCO 4096    // Leitura sequencial no exportador
+
+typedef struct {
+    char magia[8];
+    uint32_t versao;
+    uint32_t tamanho_registo;
+} CabecalhoDiario;
+
+typedef struct {
+    int64_t instante_ns;      // Relógio do sistema (real ou virtual)
+    int32_t cliente_id;
+    int32_t cartao_id;
+    int32_t agencia_id;       // 0 = venda do turno sequencial
+    int32_t espera_ms;        // Da chegada à fila até à venda
+    uint8_t tipo;             // TipoCliente
+    uint8_t turno;            // Turno
+    uint8_t reservado[6];
+} RegistoVenda;
+
+_Static_assert(sizeof(RegistoVenda) == 32, "RegistoVenda deve ter 32 bytes");
+
+int diario_abrir(const char* caminho);
+void diario_fechar(void);
+int diario_ativo(void);
+void diario_registar_venda(int cliente_id, TipoCliente tipo, time_t chegada,
+                           int cartao_id, int agencia_id, Turno turno);
+void diario_descarregar(void);          // Escreve o que ficou nos buffers
+long long diario_total_registos(void);
+
+/* Converte um diário em ficheiros por coluna (<prefixo>.<coluna>.col) e
+ * num manifesto <prefixo>.colunas.txt. Retorna o número de registos ou -1. */
+long long exportar_diario_colunar(const char* caminho_diario, const char* prefixo);
+
+#endif
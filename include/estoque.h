@@ -2,36 +2,130 @@
 #define ESTOQUE_H
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
 
-/* Número total de cartões SIM */
+/* Número inicial de cartões SIM */
 #define TOTAL_CARTOES 100
 
+/* Capacidade máxima do estoque (cartões iniciais + reposições) */
+#define MAX_CARTOES 65536
+
+/* Estados de um cartão (campo 'vendido') */
+#define CARTAO_DISPONIVEL 0
+#define CARTAO_VENDIDO    1
+#define CARTAO_RETIDO     2   // Reservado temporariamente (reserva em duas fases)
+
+/* Retenção temporária de cartões */
+#define TTL_RETENCAO_PADRAO 30   // Segundos até uma retenção expirar
+#define INTERVALO_RECOLHA   1    // Segundos entre varrimentos do recolhedor
+
+/* Fragmentação do estoque por agência */
+#define FRAGMENTOS_ESTOQUE_PADRAO  2    // Um por agência no arranque padrão
+#define MAX_FRAGMENTOS_ESTOQUE     64
+#define LIMIAR_REBALANCEAMENTO     4    // Livres abaixo disto pedem reposição
+#define LOTE_REBALANCEAMENTO       16   // Máximo de cartões movidos por vez
+#define INTERVALO_REBALANCEAMENTO  1    // Segundos entre passagens periódicas
+
+/* Limiares (watermarks) de disponibilidade */
+#define MAX_LIMIARES_ESTOQUE 16
+#define LIMIAR_ESTOQUE_BAIXO 10   // Alerta de estoque baixo
+
+/* Reposição de estoque */
+#define LOTE_REPOSICAO_PADRAO   50
+#define LIMIAR_REPOSICAO_PADRAO LIMIAR_ESTOQUE_BAIXO
+#define INTERVALO_REPOSICAO     2    // Segundos entre verificações periódicas
+
+/* Callback de limiar: 'descendo' = 1 se os disponíveis desceram até ao limiar */
+typedef void (*CallbackLimiarEstoque)(int limiar, int disponiveis, int descendo, void* arg);
+
+/* Anel de eventos de alteração (potência de 2) */
+#define CAPACIDADE_EVENTOS_ESTOQUE 4096
+
+/* Tipos de evento registados no anel */
+typedef enum {
+    EVENTO_VENDA,          // Cartão passou a vendido
+    EVENTO_LIBERACAO,      // Cartão vendido voltou ao estoque
+    EVENTO_RETENCAO,       // Cartão retido temporariamente
+    EVENTO_FIM_RETENCAO,   // Retenção cancelada ou expirada (cartão livre)
+    EVENTO_REPOSICAO       // Cartão novo adicionado ao estoque
+} TipoEventoEstoque;
+
+typedef struct {
+    unsigned long long seq;
+    TipoEventoEstoque tipo;
+    int cartao_id;
+    time_t instante;
+} EventoEstoque;
+
 /* Estrutura do cartão SIM */
 typedef struct {
     int id;        // Identificador único
-    int vendido;   // 0 = disponível | 1 = vendido
+    int vendido;   // 0 = disponível | 1 = vendido | 2 = retido
     time_t hora_venda; // Timestamp da venda (opcional para logs)
+    time_t retencao_expira; // Fim da retenção (apenas quando retido)
+    atomic_int fragmento;   // Fragmento dono do cartão
+    int posicao;            // Índice na lista de livres/retidos do fragmento (-1: reposto, ainda fora)
 } CartaoSIM;
 
 /* Recursos globais compartilhados */
-extern CartaoSIM estoque[TOTAL_CARTOES];
+extern CartaoSIM estoque[MAX_CARTOES];   // Válidos: [0, estoque_total())
 extern pthread_mutex_t estoque_lock;
 
 /* Estatísticas */
-extern int vendas_realizadas;
+extern atomic_int vendas_realizadas;
 extern int vendas_empresas;
 extern int vendas_publico;
 
 /* Funções de gestão do estoque */
 void inicializar_estoque();
+void inicializar_estoque_fragmentado(int num_fragmentos);
 void liberar_estoque();
 
 int reservar_proximo_cartao();  // NOVA: escolhe automaticamente
+int reservar_cartao_fragmento(int fragmento);  // Reserva local da agência
 int reservar_cartao_especifico(int id);  // Renomeada
 int liberar_cartao(int id);
 
+/* Reserva em duas fases: reter -> confirmar | cancelar */
+int reter_proximo_cartao(int ttl_segundos);  // -1 se estoque esgotado
+int reter_cartao_fragmento(int fragmento, int ttl_segundos);
+int confirmar_retencao(int id);              // O(1): retido -> vendido
+int cancelar_retencao(int id);               // O(1): retido -> disponível
+int renovar_retencao(int id, int ttl_segundos);   // Novo prazo para uma retenção em curso
+int recolher_retencoes_expiradas(void);      // Devolve em lote as expiradas
+void iniciar_recolhedor_retencoes(void);
+void parar_recolhedor_retencoes(void);
+
+/* Rebalanceamento de cartões livres entre fragmentos */
+int rebalancear_estoque(void);
+void iniciar_rebalanceador_estoque(void);
+void parar_rebalanceador_estoque(void);
+
 int estoque_disponivel();  // NOVA: conta disponíveis
+int estoque_esgotado(void);  // O(1), sem locks
+int estoque_total(void);     // Cartões existentes (iniciais + repostos)
 int estoque_vendido();     // NOVA: conta vendidos
+int estoque_retido();      // Cartões em retenção temporária
+int get_num_fragmentos_estoque(void);
+int estoque_disponivel_fragmento(int fragmento);
+void estoque_bloquear_leitura(void);    // Leitura consistente de estoque[]
+void estoque_desbloquear_leitura(void);
 void imprimir_estoque();   // NOVA: para debugging
 
+/* Reposição: lotes de cartões novos publicados de uma só vez */
+int reabastecer_estoque(int quantidade);
+void iniciar_reabastecedor_estoque(int lote, int limiar);
+void parar_reabastecedor_estoque(void);
+
+/* Notificações de limiar em vez de consultar estoque_disponivel() em ciclo */
+int estoque_registrar_limiar(int limiar, CallbackLimiarEstoque callback, void* arg);
+void estoque_remover_limiar(int id);
+int estoque_aguardar_limiar(int limiar, int acima, int timeout_ms);   // -1: sem slot livre
+
+/* Consumidores incrementais: "eventos desde seq N" (-1 = reconstruir) */
+unsigned long long estoque_seq_atual(void);
+int estoque_eventos_desde(unsigned long long seq, EventoEstoque* destino, int max,
+                          unsigned long long* proximo_seq);
+
 #endif
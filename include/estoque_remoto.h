@@ -0,0 +1,42 @@
+#ifndef ESTOQUE_REMOTO_H
+#define ESTOQUE_REMOTO_H
+
+/* Estoque partilhado por várias instâncias através do coordenador
+ * (coordenador.h). As agências reservam de uma cache local de cartões
+ * cedidos; uma thread sincronizadora repõe a cache e envia as vendas em
+ * lotes, com os pedidos encadeados numa só escrita, pelo que a ida e
+ * volta ao coordenador fica fora do caminho da venda. */
+
+#define LOTE_ESTOQUE_REMOTO 64            // Cartões pedidos de cada vez
+#define RESERVA_MINIMA_REMOTA 16          // Abaixo disto a cache é reposta
+#define CAPACIDADE_CACHE_REMOTA 256
+#define LOTE_CONFIRMACAO_REMOTA 64        // Vendas acumuladas antes de as enviar
+#define MAX_VENDAS_PENDENTES_REMOTAS 4096
+#define INTERVALO_SINCRONIZACAO_MS 100
+#define INTERVALO_RELIGACAO_REMOTA_MS 1000   // Tentativas depois de perder a ligação
+
+typedef struct {
+    long long trocas;              // Idas e voltas ao coordenador
+    long long tempo_trocas_ns;
+    long long cartoes_recebidos;
+    long long vendas_enviadas;
+    long long vendas_recusadas;    // Cartões que o coordenador já não reconhecia
+    long long reservas_locais;     // Servidas pela cache
+    long long faltas;              // Cache vazia no momento da reserva
+} EstatisticasEstoqueRemoto;
+
+int estoque_remoto_ligar(const char* endereco);
+void estoque_remoto_desligar(void);       // Envia as vendas e devolve a cache
+int estoque_remoto_ativo(void);
+
+/* Caminho da venda: só a cache local */
+int estoque_remoto_reservar(void);        // -1 se a cache estiver vazia
+void estoque_remoto_devolver(int id);     // Cartão não usado volta à cache
+void estoque_remoto_confirmar(int id);    // Vendido; pendente até o coordenador responder
+
+/* disponíveis, cedidos, vendidos e total no coordenador (síncrono) */
+int estoque_remoto_contagem(int valores[4]);
+void obter_estatisticas_estoque_remoto(EstatisticasEstoqueRemoto* destino);
+void exibir_relatorio_estoque_remoto(void);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FIBRAS_H
+#define FIBRAS_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* Fibras cooperativas (ucontext) sobre poucas threads portadoras. Cada
+ * fibra tem uma pilha pequena (com canário) e fica sempre na mesma
+ * portadora; as esperas (tempo ou fila de espera) cedem a portadora a
+ * outra fibra em vez de bloquear a thread. Só em tempo real. */
+
+#define PILHA_FIBRA_PADRAO (32 * 1024)
+#define MAX_PORTADORAS_FIBRAS 64
+
+typedef void (*FuncaoFibra)(void* arg);
+
+typedef struct Fibra Fibra;
+
+/* Fibras à espera de um aviso (ex.: chegada de clientes) */
+typedef struct {
+    pthread_mutex_t lock;
+    Fibra* inicio;
+    Fibra* fim;
+    atomic_int em_espera;
+} FilaEsperaFibras;
+
+#define FILA_ESPERA_FIBRAS_INICIALIZADOR { PTHREAD_MUTEX_INITIALIZER, NULL, NULL, 0 }
+
+int fibras_iniciar(int num_portadoras, size_t tamanho_pilha);
+int fibra_criar(FuncaoFibra funcao, void* arg);   // Distribuídas em roda pelas portadoras
+/* Acorda as que esperam e deixa de as adormecer; cada fibra deve ver a
+ * sua ordem de paragem e retornar. Junta as portadoras. */
+void fibras_aguardar(void);
+int fibras_vivas(void);
+
+/* Dentro de uma fibra */
+void fibra_ceder(void);
+void fibra_dormir_ate(long long instante_ns);
+int fibra_esperar(FilaEsperaFibras* fila, long long prazo_ns);   // 1 = avisada, 0 = prazo
+
+/* De qualquer thread ou fibra */
+int fibras_acordar_uma(FilaEsperaFibras* fila);
+void fibras_acordar_todas(FilaEsperaFibras* fila);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef GERADOR_H
+#define GERADOR_H
+
+#include "Fila_prioridade.h"
+
+/* Gerador sintético de chegadas para testes de carga. Cada tipo de
+ * cliente tem o seu processo (Poisson ou rajadas) e threads produtoras
+ * próprias; com a fila cheia a chegada é recusada e contada, para se
+ * ver o ponto de saturação e o comportamento da fila depois dele. */
+
+#define MAX_PRODUTORES_TIPO 16
+#define ESPERA_MAXIMA_PRODUTOR_MS 100      // Mesmo a taxas baixas, verifica a paragem
+#define LOTE_MAXIMO_PRODUTOR 4096          // Chegadas por passagem antes de rever a paragem
+#define INTERVALO_RELATORIO_GERADOR_MS 1000
+#define BLOCO_IDS_GERADOR 1024             // IDs reservados de cada vez por produtor
+#define ID_PRIMEIRO_CLIENTE_GERADO 100000
+
+// Rajadas: períodos ativos (exponenciais, média DURACAO_RAJADA_MS) à taxa
+// FATOR_RAJADA vezes a nominal, alternados com silêncios que mantêm a média
+#define DURACAO_RAJADA_MS 200
+#define FATOR_RAJADA 10.0
+
+typedef enum {
+    CHEGADAS_POISSON,
+    CHEGADAS_RAJADAS
+} ProcessoChegadas;
+
+typedef struct {
+    long long oferecidas;
+    long long aceites;
+    long long recusadas;   // Fila cheia ou limite de entrada
+} ContagemChegadas;
+
+typedef struct {
+    ContagemChegadas por_tipo[2];   // Indexado por TipoCliente
+    double duracao_s;
+} EstatisticasGerador;
+
+/* "tipo=processo:taxa[:produtores]", taxa em clientes/s, ex.:
+ * "publico=poisson:5000", "empresa=rajadas:200:2" */
+int configurar_gerador(const char* especificacao);
+int gerador_configurado(void);
+
+int iniciar_gerador(FilaPrioridade* fila);
+void parar_gerador(void);
+void obter_estatisticas_gerador(EstatisticasGerador* destino);
+void exibir_relatorio_gerador(void);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef LIMITADOR_H
+#define LIMITADOR_H
+
+#include "Fila_prioridade.h"
+
+/* Limites de ritmo por tipo de cliente, em duas etapas: a entrada na
+ * fila e o atendimento pelas agências. Cada limite é um balde de fichas
+ * (taxa por segundo, rajada em fichas) guardado como um único instante
+ * teórico atómico (GCRA), pelo que verificar é uma leitura e um CAS, sem
+ * locks. Os limites podem mudar a qualquer momento. */
+
+#define RAJADA_LIMITE_PADRAO 1
+
+typedef enum {
+    LIMITE_ENTRADA,        // Recusado: o cliente não entra na fila
+    LIMITE_ATENDIMENTO     // Adiado: fica na fila e passa outro tipo à frente
+} EtapaLimite;
+
+typedef struct {
+    double taxa;           // Fichas por segundo (0 = sem limite)
+    int rajada;
+    long long aceites;     // Só contados com limite ativo
+    long long recusados;
+} ContagemLimite;
+
+typedef struct {
+    ContagemLimite etapa[2][2];   // [EtapaLimite][TipoCliente]
+} EstatisticasLimites;
+
+/* "etapa:tipo=taxa[:rajada]", ex.: "entrada:publico=200:50",
+ * "atendimento:empresa=2"; taxa 0 retira o limite */
+int configurar_limite(const char* especificacao);
+void definir_limite(EtapaLimite etapa, TipoCliente tipo, double taxa, int rajada);
+int limite_ativo(EtapaLimite etapa, TipoCliente tipo);
+
+int limite_permitir(EtapaLimite etapa, TipoCliente tipo);   // 1 = consumiu uma ficha
+void limite_devolver(EtapaLimite etapa, TipoCliente tipo);  // Cliente devolvido sem ser servido
+
+void obter_estatisticas_limites(EstatisticasLimites* destino);
+void exibir_relatorio_limites(void);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef MULTIPROCESSO_H
+#define MULTIPROCESSO_H
+
+#include "Fila_prioridade.h"
+
+/* Agências como processos separados. Fila, estoque (bitmap) e contadores
+ * vivem num segmento shm_open/mmap, com mutexes PTHREAD_PROCESS_SHARED
+ * robustos (a morte de uma agência não deixa locks presos) e semáforos
+ * partilhados entre processos. O processo principal despacha clientes
+ * para o segmento e, no fim, devolve ao estoque e às estatísticas o que
+ * as agências fizeram. */
+
+#define PREFIXO_SEGMENTO_AGENCIAS "/unitel_agencias"   // + pid
+#define MAX_PROCESSOS_AGENCIA 64
+#define ESPERA_CLIENTE_PROCESSO_MS 10     // Espera por cliente antes de rever a paragem
+#define MARGEM_RETENCAO_PROCESSOS 60      // Segundos além do dia na retenção dos cartões
+
+/* Do turno indicado até ao fim da NOITE, com uma agência por processo
+ * (até MAX_PROCESSOS_AGENCIA). Retorna o número de vendas ou -1. */
+int executar_agencias_processos(FilaPrioridade* fila, Turno turno_inicial, int num_agencias);
+
+/* Fecha o dia em curso mais cedo (segura num handler de sinal): as
+ * agências param e o que fizeram é integrado como no fim normal */
+void pedir_paragem_agencias_processos(void);
+
+/* Mesma carga com as agências em threads e em processos, sem tempo de venda */
+void benchmark_agencias_processos(int num_clientes, int num_agencias);
+
+#endif
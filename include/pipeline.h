@@ -0,0 +1,20 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "Fila_prioridade.h"
+
+/* Venda em pipeline: quatro estágios (despacho, reserva de cartão,
+ * registo/diário e estatísticas), cada um numa thread, ligados por
+ * anéis lock-free de um produtor e um consumidor. */
+
+#define NUM_ESTAGIOS_PIPELINE 4
+#define CAPACIDADE_ANEL_PIPELINE 1024   // Potência de 2
+
+/* Executa um turno pelo pipeline até 'limite' vendas (0 = sem limite),
+ * fila vazia ou estoque esgotado. Retorna o número de vendas. */
+int executar_pipeline_vendas(FilaPrioridade* fila, Turno turno, int limite);
+
+/* Compara o caminho monolítico com o pipeline para 'num_clientes' vendas */
+void benchmark_pipeline_vendas(int num_clientes);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef RELOGIO_H
+#define RELOGIO_H
+
+#include <time.h>
+
+/* Relógio da simulação.
+ * REAL:    o tempo é o do sistema e as esperas dormem de facto.
+ * VIRTUAL: o tempo só avança quando a simulação o pede (eventos), pelo
+ *          que um dia de vendas corre tão depressa quanto o CPU permite,
+ *          com os mesmos instantes simulados. */
+typedef enum {
+    RELOGIO_REAL,
+    RELOGIO_VIRTUAL
+} ModoRelogio;
+
+#define NS_POR_SEGUNDO 1000000000LL
+
+/* Configuração (antes de arrancar os módulos). inicio = 0 usa a hora atual */
+void relogio_configurar(ModoRelogio modo, time_t inicio);
+int relogio_virtual(void);
+
+/* Tempo atual da simulação */
+time_t relogio_agora(void);
+long long relogio_agora_ns(void);
+
+/* Esperas: no modo virtual avançam o relógio em vez de dormir */
+void relogio_dormir_ms(long ms);
+void relogio_avancar_ate(long long instante_ns);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef REPRODUCAO_H
+#define REPRODUCAO_H
+
+#include "traco.h"
+
+/* Reprodução de um traço gravado pelas mesmas APIs (fila, bloqueio do
+ * público, RH). No modo rápido o relógio é virtual e começa no instante
+ * gravado, e os eventos entram no ciclo de simulação das agências: com
+ * a mesma semente, a mesma entrada dá as mesmas vendas. */
+
+typedef enum {
+    REPRODUCAO_TEMPO_ORIGINAL,   // Respeita os intervalos gravados (tempo real)
+    REPRODUCAO_RAPIDA            // Tempo virtual, sem esperas
+} ModoReproducao;
+
+typedef struct {
+    long long eventos;
+    long long chegadas;
+    long long recusadas;          // Fila cheia na reprodução
+    long long bloqueios;
+    long long contratacoes;
+    long long demissoes;
+    long long vendas_gravadas;
+    long long vendas_reproduzidas;
+    long long vendas_coincidentes;
+    long long primeira_divergencia;   // Número da venda (1..), -1 = nenhuma
+    double duracao_real_s;
+} EstatisticasReproducao;
+
+/* Antes de inicializar os módulos: abre o traço e repõe relógio, semente,
+ * turnos e limites de ritmo da gravação. O cabeçalho indica o número de
+ * agências. */
+int reproducao_preparar(const char* caminho, ModoReproducao modo, CabecalhoTraco* cabecalho);
+
+int reproducao_iniciar(FilaPrioridade* fila);
+int reproducao_em_curso(void);
+void reproducao_concluir(void);   // Modo rápido: executa já o resto do traço
+void reproducao_parar(void);
+void obter_estatisticas_reproducao(EstatisticasReproducao* destino);
+void exibir_relatorio_reproducao(void);
+
+#endif
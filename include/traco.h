@@ -0,0 +1,80 @@
+#ifndef TRACO_H
+#define TRACO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "Fila_prioridade.h"
+
+/* Traço de operações: chegadas, bloqueios do público, contratações,
+ * demissões e vendas, por ordem, num ficheiro binário compacto. As
+ * vendas servem de referência para comparar uma reprodução. */
+
+#define TRACO_MAGIA "UNITELTR"
+#define TRACO_VERSAO 2
+#define BUFFER_TRACO (1 << 20)
+
+typedef enum {
+    TRACO_CHEGADA,
+    TRACO_BLOQUEIO_PUBLICO,
+    TRACO_CONTRATACAO,
+    TRACO_DEMISSAO,
+    TRACO_VENDA
+} TipoEventoTraco;
+
+/* Configuração que a reprodução precisa de repor */
+typedef struct {
+    char magia[8];
+    uint32_t versao;
+    uint32_t tamanho_registo;
+    int64_t inicio_ns;            // Relógio no início da gravação
+    uint32_t semente;             // srand() da gravação
+    int32_t num_agencias;
+    int64_t duracao_turno_ms[3];
+    int32_t limite_turno[3];
+    int32_t reservado;
+    double taxa_limite[2][2];     // Limites de ritmo [EtapaLimite][TipoCliente] (0 = sem limite)
+    int32_t rajada_limite[2][2];
+} CabecalhoTraco;
+
+typedef struct {
+    int64_t instante_ns;          // Desde o início da gravação
+    int32_t id;                   // Cliente ou funcionário
+    int32_t valor;                // Cartão vendido ou salário (cêntimos)
+    int32_t agencia_id;
+    uint8_t evento;               // TipoEventoTraco
+    uint8_t tipo;                 // TipoCliente
+    uint8_t tamanho_nome;         // Contratação: nome e cargo seguem o registo
+    uint8_t tamanho_cargo;
+} RegistoTraco;
+
+_Static_assert(sizeof(RegistoTraco) == 24, "RegistoTraco deve ter 24 bytes");
+
+/* Observador das vendas (usado pela reprodução para comparar) */
+typedef void (*ObservadorVendas)(int cliente_id, int cartao_id, int agencia_id);
+
+/* Gravação */
+int traco_gravar(const char* caminho, unsigned semente, int num_agencias,
+                 const long duracao_turno_ms[3], const int limite_turno[3]);
+void traco_parar_gravacao(void);
+long long traco_total_registos(void);
+
+void traco_chegada(int cliente_id, TipoCliente tipo);
+void traco_bloqueio_publico(void);
+void traco_contratacao(const char* nome, const char* cargo, float salario);
+void traco_demissao(int id);
+void traco_venda(int cliente_id, TipoCliente tipo, int cartao_id, int agencia_id);
+void traco_observar_vendas(ObservadorVendas observador);
+
+/* Leitura sequencial */
+typedef struct {
+    FILE* ficheiro;
+    CabecalhoTraco cabecalho;
+    char nome[256];               // Texto da última contratação lida
+    char cargo[256];
+} LeitorTraco;
+
+int traco_abrir_leitura(LeitorTraco* leitor, const char* caminho);
+int traco_ler_evento(LeitorTraco* leitor, RegistoTraco* registo);  // 1 = lido, 0 = fim, -1 = erro
+void traco_fechar_leitura(LeitorTraco* leitor);
+
+#endif
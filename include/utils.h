@@ -30,4 +30,20 @@ char* get_current_time_str(void);
 void thread_safe_printf(const char* format, ...);
 int get_thread_id(void);
 
+/* Saída por venda. TERMINAL escreve logo no stdout; BUFFER acumula num
+ * buffer da thread e escreve em blocos; DESCARTAR não escreve nada. */
+typedef enum {
+    SAIDA_TERMINAL,
+    SAIDA_BUFFER,
+    SAIDA_DESCARTAR
+} ModoSaidaVendas;
+
+#define TAMANHO_BUFFER_SAIDA 65536
+
+void definir_modo_saida_vendas(ModoSaidaVendas modo);
+ModoSaidaVendas get_modo_saida_vendas(void);
+int saida_vendas_headless(void);
+void saida_venda(const char* format, ...);
+void saida_vendas_descarregar(void);   // Escreve o que ficou nos buffers
+
 #endif
\ No newline at end of file
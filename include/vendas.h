@@ -5,19 +5,32 @@
 #include <pthread.h>
 #include <time.h>
 
-#define NUM_AGENCIAS 2
+#define NUM_AGENCIAS_PADRAO 2
+#define MAX_AGENCIAS 65536
 #define TEMPO_VENDA_SIMULADO 5
 #define TEMPO_VENDA_REAL 1
+#define MAX_SLOTS_CONTADORES 256   // Threads com contadores de vendas próprios
+#define DURACAO_TURNO_PADRAO_MS 10000   // Duração de cada turno nas vendas concorrentes
+#define BUFFER_EXPORTACAO_CSV (1 << 20)  // Escritas em blocos de 1 MB
 
-// Estrutura de uma agência
+// Autoescala: agências ativas entre um mínimo e um máximo conforme a fila
+#define INTERVALO_AUTOESCALA_MS 500
+#define CLIENTES_POR_AGENCIA_ALVO 2      // Fila desejada por agência ativa
+#define CICLOS_HISTERESE_AUTOESCALA 3    // Avaliações baixas seguidas antes de reduzir
+
+// Estrutura de uma agência (executada pelo pool de trabalhadores).
+// Alinhada à linha de cache para que agências vizinhas no vetor não
+// partilhem linha ao atualizar contadores e lock.
 typedef struct {
-    int id;
+    _Alignas(64) int id;
     char nome[50];
-    pthread_t thread;
     int vendas_realizadas;
     int clientes_atendidos;
     int ativa;
     pthread_mutex_t lock;
+    long long proxima_execucao;  // Instante da próxima vez (ns, CLOCK_REALTIME)
+    int indice_agenda;           // Posição no heap do agendador (-1 = fora)
+    int em_execucao;             // Retirada da agenda por um trabalhador
 } Agencia;
 
 // Estrutura para estatísticas
@@ -28,25 +41,60 @@ typedef struct {
     int vendas_por_turno[3]; // 0=MANHA, 1=TARDE, 2=NOITE
 } EstatisticasVendas;
 
+// Exportação em segundo plano: fim do trabalho (sucesso = 1)
+typedef void (*CallbackExportacao)(const char* ficheiro, int sucesso, int linhas, void* arg);
+
+typedef struct {
+    int em_curso;               // Há um instantâneo pendente ou a ser escrito
+    int concluidas;
+    int falhadas;
+    int ultimo_sucesso;
+    int ultimas_linhas;
+    long long ultima_duracao_ns;
+    char ultimo_ficheiro[256];
+} EstadoExportacao;
+
+// Fonte de eventos externa no modo virtual (ex.: reprodução de um traço):
+// executa o que venceu até 'agora_ns' e retorna o instante do próximo (-1 = nenhum)
+typedef long long (*InjetorVirtual)(long long agora_ns);
+
 // Variáveis globais exportadas
-extern Agencia agencias[NUM_AGENCIAS];
-extern EstatisticasVendas estatisticas_vendas;
-extern pthread_mutex_t stats_lock;
+extern Agencia* agencias;
+extern int num_agencias;
 
 // Protótipos das funções públicas
+void definir_num_agencias(int quantidade);  // Antes de inicializar_sistema_vendas
 void inicializar_sistema_vendas(FilaPrioridade* fila_global);
 void iniciar_turno_vendas(Turno turno);
-void iniciar_vendas_concorrentes(Turno turno);
+void iniciar_vendas_concorrentes(Turno turno);  // Do turno indicado até ao fim da NOITE
+void configurar_turnos(const long duracao_ms[3], const int limites[3]);
+void obter_configuracao_turnos(long duracao_ms[3], int limites[3]);
+Turno get_turno_atual(void);
+int get_vendas_turno_atual(void);
 void parar_todas_agencias(void);
 void exibir_relatorio_vendas(void);
 void exibir_relatorio_agencias(void);
 void exportar_vendas_csv(const char* filename);
+int exportar_vendas_csv_async(const char* filename, CallbackExportacao callback, void* arg);
+void obter_estado_exportacao(EstadoExportacao* destino);
+void aguardar_exportacoes(void);
+void parar_exportador_vendas(void);
 void reinicializar_vendas(void);
+void definir_vendas_pipeline(int ativo);   // Turnos sequenciais pelo pipeline
+void definir_agencias_processos(int ativo);  // Vendas concorrentes em processos
+void definir_agencias_fibras(int ativo);     // Vendas concorrentes em fibras
+void configurar_autoescala(int minimo, int maximo);  // 0, 0 = todas as agências sempre
+void contabilizar_venda(TipoCliente tipo, Turno turno);  // Contadores da thread atual
+void definir_injetor_virtual(InjetorVirtual injetor);   // NULL = nenhum
 
 // Getters para outros módulos
+void obter_estatisticas_vendas(EstatisticasVendas* destino);  // Leitura consistente
 int get_vendas_totais(void);
 int get_vendas_empresas(void);
 int get_vendas_publico(void);
+int get_num_agencias(void);
+int get_num_trabalhadores(void);
+int get_agencias_ativas(void);
 int vendas_sistema_ativo(void);
 FilaPrioridade* get_fila_global(void);
 
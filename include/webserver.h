@@ -30,10 +30,13 @@ int get_webserver_port(void);
 
 /* Funções para gerar JSON */
 char* generate_estoque_json(void);
+char* generate_estoque_eventos_json(unsigned long long desde);
 char* generate_fila_json(void* fila);
 char* generate_rh_json(void);
 char* generate_vendas_json(void);
 char* generate_agencias_json(void);
 char* generate_dashboard_json(void);
+char* generate_exportacao_json(void);
+char* generate_limites_json(void);
 
 #endif /* WEBSERVER_H */
\ No newline at end of file
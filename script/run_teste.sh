@@ -76,6 +76,30 @@ test_compilation() {
     return $compile_status
 }
 
+# Lista dos módulos ligados aos testes de módulo (sem main.c nem webserver.c)
+FONTES_MODULOS=$(ls src/*.c 2>/dev/null | grep -v -e 'src/main.c' -e 'src/webserver.c')
+
+# Compila e executa um teste de módulo: testar_modulo <ficheiro sem .c> <nome>
+testar_modulo() {
+    local teste=$1
+    local nome=$2
+    
+    echo "  • Testando $nome..."
+    gcc -I./include -pthread -g $FONTES_MODULOS "$TEST_DIR/$teste.c" -o "$BIN_DIR/$teste" -lrt -lm 2>"$LOG_DIR/compile_$teste.log"
+    if [ $? -ne 0 ]; then
+        echo -e "Compilação $nome falhou"
+        return 1
+    fi
+    timeout 60 "$BIN_DIR/$teste" > "$LOG_DIR/test_$teste.log" 2>&1
+    if [ $? -eq 0 ]; then
+        echo -e "$nome: PASS"
+    else
+        echo -e "$nome: FAIL"
+        return 1
+    fi
+    return 0
+}
+
 # Função para testes unitários
 test_unitarios() {
     echo -e "Executando testes unitários..."
@@ -84,7 +108,7 @@ test_unitarios() {
     
     # Teste 1: Módulo Estoque
     echo "  • Testando módulo Estoque..."
-    gcc -I./include -pthread -g src/estoque.c "$TEST_DIR/teste_estoque.c" -o "$BIN_DIR/teste_estoque" 2>"$LOG_DIR/compile_estoque.log"
+    gcc -I./include -pthread -g src/estoque.c src/relogio.c src/afinidade.c "$TEST_DIR/teste_estoque.c" -o "$BIN_DIR/teste_estoque" 2>"$LOG_DIR/compile_estoque.log"
     if [ $? -eq 0 ]; then
         "$BIN_DIR/teste_estoque" > "$LOG_DIR/test_estoque.log" 2>&1
         if [ $? -eq 0 ]; then
@@ -100,7 +124,7 @@ test_unitarios() {
     
     # Teste 2: Módulo Fila Prioridade
     echo "  • Testando módulo Fila Prioridade..."
-    gcc -I./include -pthread -g src/estoque.c src/Fila_prioridade.c "$TEST_DIR/teste_fila.c" -o "$BIN_DIR/teste_fila" 2>"$LOG_DIR/compile_fila.log"
+    gcc -I./include -pthread -g src/estoque.c src/Fila_prioridade.c src/relogio.c src/afinidade.c src/utils.c src/diario.c src/traco.c src/limitador.c "$TEST_DIR/teste_fila.c" -o "$BIN_DIR/teste_fila" 2>"$LOG_DIR/compile_fila.log"
     if [ $? -eq 0 ]; then
         "$BIN_DIR/teste_fila" > "$LOG_DIR/test_fila.log" 2>&1
         if [ $? -eq 0 ]; then
@@ -117,7 +141,7 @@ test_unitarios() {
     # Teste 3: Teste de integração
     echo "  • Testando integração básica..."
     if [ -f "$TEST_DIR/teste_integracao.c" ]; then
-        gcc -I./include -pthread -g src/estoque.c src/Fila_prioridade.c "$TEST_DIR/teste_integracao.c" -o "$BIN_DIR/teste_integracao" 2>"$LOG_DIR/compile_integracao.log"
+        gcc -I./include -pthread -g src/estoque.c src/Fila_prioridade.c src/relogio.c src/afinidade.c src/utils.c src/diario.c src/traco.c src/limitador.c "$TEST_DIR/teste_integracao.c" -o "$BIN_DIR/teste_integracao" 2>"$LOG_DIR/compile_integracao.log"
         if [ $? -eq 0 ]; then
             timeout 10 "$BIN_DIR/teste_integracao" > "$LOG_DIR/test_integracao.log" 2>&1
             if [ $? -eq 0 ]; then
@@ -132,6 +156,31 @@ test_unitarios() {
         fi
     fi
     
+    # Testes de módulo
+    testar_modulo teste_eventos_estoque "Eventos de estoque" || all_passed=1
+    testar_modulo teste_limiares_estoque "Limiares de estoque" || all_passed=1
+    testar_modulo teste_estoque_concorrente "Estoque concorrente" || all_passed=1
+    testar_modulo teste_agencias_pool "Pool de agências" || all_passed=1
+    testar_modulo teste_tempo_virtual "Tempo virtual" || all_passed=1
+    testar_modulo teste_contadores_vendas "Contadores de vendas" || all_passed=1
+    testar_modulo teste_saida_vendas "Saída headless" || all_passed=1
+    testar_modulo teste_turnos "Calendário de turnos" || all_passed=1
+    testar_modulo teste_diario "Diário de vendas" || all_passed=1
+    testar_modulo teste_exportacao_csv "Exportação CSV" || all_passed=1
+    testar_modulo teste_pipeline "Pipeline de vendas" || all_passed=1
+    testar_modulo teste_afinidade "Afinidade e NUMA" || all_passed=1
+    testar_modulo teste_autoescala "Autoescala de agências" || all_passed=1
+    testar_modulo teste_gerador "Gerador de chegadas" || all_passed=1
+    testar_modulo teste_reproducao "Gravação e reprodução" || all_passed=1
+    testar_modulo teste_multiprocesso "Agências em processos" || all_passed=1
+    testar_modulo teste_coordenador "Coordenador de estoque" || all_passed=1
+    testar_modulo teste_fibras "Agências em fibras" || all_passed=1
+    testar_modulo teste_desistencias "Desistências" || all_passed=1
+    testar_modulo teste_limitador "Limitador de ritmo" || all_passed=1
+    testar_modulo teste_motor_rh "Motor de eventos do RH" || all_passed=1
+    testar_modulo teste_indice_rh "Índices do RH" || all_passed=1
+    testar_modulo teste_estados_rh "Contagens por estado do RH" || all_passed=1
+    
     return $all_passed
 }
 
@@ -245,7 +294,7 @@ int main() {
 }
 EOF
     
-    gcc -I./include -pthread -g src/estoque.c "$BIN_DIR/test_concorrencia.c" -o "$BIN_DIR/test_concorrencia" 2>"$LOG_DIR/compile_concorrencia.log"
+    gcc -I./include -pthread -g src/estoque.c src/relogio.c src/afinidade.c "$BIN_DIR/test_concorrencia.c" -o "$BIN_DIR/test_concorrencia" 2>"$LOG_DIR/compile_concorrencia.log"
     
     if [ $? -eq 0 ]; then
         "$BIN_DIR/test_concorrencia" > "$LOG_DIR/test_concorrencia.log" 2>&1
@@ -4,10 +4,142 @@
 #include <time.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdatomic.h>
 #include "Fila_prioridade.h"
 #include "estoque.h"
+#include "relogio.h"
+#include "utils.h"
+#include "diario.h"
+#include "traco.h"
+#include "limitador.h"
 
-#define MAX_FILA 200  // Tamanho máximo da fila
+static _Atomic(AvisoChegadaFila) aviso_chegada = NULL;
+
+static const char* const nomes_tipos[2] = { "empresa", "publico" };
+static long long paciencia_ns[2];   // 0 = sem desistência
+
+/* Chamado fora do lock da fila, depois de cada cliente entrar */
+static void avisar_chegada(void) {
+    AvisoChegadaFila aviso = atomic_load_explicit(&aviso_chegada, memory_order_acquire);
+    if (aviso) aviso();
+}
+
+void fila_definir_aviso_chegada(AvisoChegadaFila aviso) {
+    atomic_store_explicit(&aviso_chegada, aviso, memory_order_release);
+}
+
+
+/* "tipo=segundos": o cliente desse tipo desiste ao fim desse tempo na fila */
+int configurar_paciencia(const char* especificacao) {
+    if (!especificacao) return 0;
+    
+    const char* igual = strchr(especificacao, '=');
+    if (!igual) {
+        printf("[FILA] Paciência inválida: %s (esperado tipo=segundos)\n", especificacao);
+        return 0;
+    }
+    
+    int tipo = -1;
+    size_t tamanho_tipo = (size_t)(igual - especificacao);
+    for (int t = 0; t < 2; t++) {
+        if (strlen(nomes_tipos[t]) == tamanho_tipo &&
+            strncmp(nomes_tipos[t], especificacao, tamanho_tipo) == 0) tipo = t;
+    }
+    
+    char* fim;
+    double segundos = strtod(igual + 1, &fim);
+    if (tipo < 0 || *fim != '\0' || !(segundos >= 0) || segundos > 86400) {
+        printf("[FILA] Paciência inválida: %s (tipos: empresa, publico; 0-86400 s)\n",
+               especificacao);
+        return 0;
+    }
+    
+    paciencia_ns[tipo] = (long long)(segundos * NS_POR_SEGUNDO);
+    return 1;
+}
+
+/* ========== RODA DE DESISTÊNCIAS (lock da fila adquirido) ========== */
+
+static long long tique_de(long long instante_ns) {
+    return instante_ns / (RESOLUCAO_RODA_MS * 1000000LL);
+}
+
+/* Prazo de um cliente chegado em 'chegada_ns' (0 = nunca desiste) */
+static long long prazo_desistencia(TipoCliente tipo, long long chegada_ns) {
+    return paciencia_ns[tipo] > 0 ? chegada_ns + paciencia_ns[tipo] : 0;
+}
+
+static void roda_inserir(FilaPrioridade* fila, Node* no) {
+    no->prox_roda = no->ant_roda = NULL;
+    no->posicao_roda = -1;
+    if (no->prazo_desistencia_ns == 0) return;
+    
+    // Um prazo já passado cai no próximo tique a rever
+    long long tique = tique_de(no->prazo_desistencia_ns);
+    if (tique <= fila->tique_roda) tique = fila->tique_roda + 1;
+    
+    no->posicao_roda = (int)(tique % POSICOES_RODA);
+    no->prox_roda = fila->roda[no->posicao_roda];
+    if (no->prox_roda) no->prox_roda->ant_roda = no;
+    fila->roda[no->posicao_roda] = no;
+}
+
+static void roda_remover(FilaPrioridade* fila, Node* no) {
+    if (no->posicao_roda < 0) return;
+    
+    if (no->ant_roda) no->ant_roda->prox_roda = no->prox_roda;
+    else fila->roda[no->posicao_roda] = no->prox_roda;
+    if (no->prox_roda) no->prox_roda->ant_roda = no->ant_roda;
+    no->posicao_roda = -1;
+}
+
+/* Desliga o nó da fila e da roda; o chamador liberta-o */
+static void desligar_no(FilaPrioridade* fila, Node* no) {
+    if (no->prev) no->prev->next = no->next;
+    else fila->frente = no->next;
+    if (no->next) no->next->prev = no->prev;
+    else fila->fim = no->prev;
+    
+    roda_remover(fila, no);
+    fila->tamanho--;
+}
+
+/* Revê os tiques já decorridos até 'agora'. Cada posição guarda os prazos
+ * de várias voltas; só saem os vencidos, os restantes esperam pela volta
+ * seguinte. Um salto maior que a roda revê cada posição uma única vez. */
+static int expirar_ate(FilaPrioridade* fila, long long agora) {
+    long long alvo = tique_de(agora) - 1;   // Último tique completo
+    if (alvo < fila->tique_roda) {
+        // Relógio recuou (ex.: reprodução): recomeçar a partir daqui
+        fila->tique_roda = alvo;
+        return 0;
+    }
+    
+    long long inicio = fila->tique_roda + 1;
+    if (alvo - inicio >= POSICOES_RODA) inicio = alvo - POSICOES_RODA + 1;
+    fila->tique_roda = alvo;
+    
+    int expirados = 0;
+    for (long long tique = inicio; tique <= alvo; tique++) {
+        Node* no = fila->roda[tique % POSICOES_RODA];
+        while (no) {
+            Node* prox = no->prox_roda;
+            if (no->prazo_desistencia_ns <= agora) {
+                fila->desistencias[no->cliente.tipo]++;
+                desligar_no(fila, no);
+                free(no);
+                
+                // Sem ficha livre, uma retirada em curso fica com a deste
+                // cliente e encontra a fila com menos um
+                sem_trywait(&fila->semaforo_clientes);
+                sem_post(&fila->semaforo_espaco);
+                expirados++;
+            }
+            no = prox;
+        }
+    }
+    return expirados;
+}
 
 /* Getter para tamanho máximo */
 int get_max_fila(void) {
@@ -23,6 +155,17 @@ FilaPrioridade* inicializar_fila(void) {
     fila->fim = NULL;
     fila->tamanho = 0;
     
+    fila->roda = (Node**)calloc(POSICOES_RODA, sizeof(Node*));
+    if (!fila->roda) {
+        free(fila);
+        return NULL;
+    }
+    fila->tique_roda = tique_de(relogio_agora_ns()) - 1;
+    for (int t = 0; t < 2; t++) {
+        fila->chegadas[t] = 0;
+        fila->desistencias[t] = 0;
+    }
+    
     // Inicializar mutex
     pthread_mutex_init(&fila->lock, NULL);
     
@@ -53,6 +196,7 @@ void liberar_fila(FilaPrioridade* fila) {
     sem_destroy(&fila->semaforo_clientes);
     sem_destroy(&fila->semaforo_espaco);
     
+    free(fila->roda);
     free(fila);
 }
 
@@ -64,7 +208,7 @@ int calcular_prioridade_cliente(Cliente* cliente) {
     int prioridade_base = (cliente->tipo == EMPRESA) ? 10 : 1;
     
     // AGING: aumenta 1 ponto a cada 30 segundos de espera
-    time_t agora = time(NULL);
+    time_t agora = relogio_agora();
     double tempo_espera = difftime(agora, cliente->timestamp);
     int bonus_aging = (int)(tempo_espera / 30);
     
@@ -79,32 +223,17 @@ int calcular_prioridade_cliente(Cliente* cliente) {
     return prioridade_total;
 }
 
-/* Insere cliente na posição correta baseado na prioridade */
-void inserir_cliente(FilaPrioridade* fila, int id_cliente, TipoCliente tipo) {
-    if (!fila) return;
-    
-    // Aguardar espaço disponível na fila
-    sem_wait(&fila->semaforo_espaco);
-    
-    pthread_mutex_lock(&fila->lock);
-    
-    // Criar novo nó
-    Node* novo = (Node*)malloc(sizeof(Node));
-    if (!novo) {
-        pthread_mutex_unlock(&fila->lock);
-        sem_post(&fila->semaforo_espaco);
-        return;
-    }
-    
-    // Preenche dados do cliente
-    novo->cliente.id_cliente = id_cliente;
-    novo->cliente.tipo = tipo;
-    novo->cliente.timestamp = time(NULL);
-    novo->cliente.prioridade_calculada = 0;
-    novo->next = NULL;
+/* Liga o nó na posição da sua prioridade e o seu prazo na roda
+ * (lock da fila adquirido) */
+static void inserir_no_ordenado(FilaPrioridade* fila, Node* novo) {
+    // Desistências vencidas saem antes de ordenar
+    expirar_ate(fila, relogio_agora_ns());
+    roda_inserir(fila, novo);
     
     // Calcula prioridade
     calcular_prioridade_cliente(&novo->cliente);
+    novo->next = NULL;
+    novo->prev = NULL;
     
     // Caso 1: Fila vazia
     if (fila->frente == NULL) {
@@ -112,7 +241,6 @@ void inserir_cliente(FilaPrioridade* fila, int id_cliente, TipoCliente tipo) {
         fila->tamanho++;
         
         sem_post(&fila->semaforo_clientes);
-        pthread_mutex_unlock(&fila->lock);
         return;
     }
     
@@ -127,21 +255,172 @@ void inserir_cliente(FilaPrioridade* fila, int id_cliente, TipoCliente tipo) {
         atual = atual->next;
     }
     
+    novo->prev = anterior;
+    novo->next = atual;
     if (anterior == NULL) {
-        novo->next = fila->frente;
         fila->frente = novo;
     } else {
         anterior->next = novo;
-        novo->next = atual;
-        
-        if (atual == NULL) {
-            fila->fim = novo;
-        }
+    }
+    
+    if (atual == NULL) {
+        fila->fim = novo;
+    } else {
+        atual->prev = novo;
     }
     
     fila->tamanho++;
     sem_post(&fila->semaforo_clientes);
+}
+
+/* Insere cliente na posição correta baseado na prioridade */
+void inserir_cliente(FilaPrioridade* fila, int id_cliente, TipoCliente tipo) {
+    if (!fila) return;
+    
+    // Acima do limite de entrada do tipo o cliente não chega a entrar
+    if (!limite_permitir(LIMITE_ENTRADA, tipo)) return;
+    
+    // Aguardar espaço disponível na fila
+    sem_wait(&fila->semaforo_espaco);
+    
+    // Criar novo nó
+    Node* novo = (Node*)malloc(sizeof(Node));
+    if (!novo) {
+        sem_post(&fila->semaforo_espaco);
+        return;
+    }
+    
+    // Preenche dados do cliente
+    novo->cliente.id_cliente = id_cliente;
+    novo->cliente.tipo = tipo;
+    novo->cliente.timestamp = relogio_agora();
+    novo->cliente.prioridade_calculada = 0;
+    novo->prazo_desistencia_ns = prazo_desistencia(tipo, relogio_agora_ns());
+    
+    pthread_mutex_lock(&fila->lock);
+    fila->chegadas[tipo]++;
+    inserir_no_ordenado(fila, novo);
+    pthread_mutex_unlock(&fila->lock);
+    
+    avisar_chegada();
+    traco_chegada(id_cliente, tipo);
+}
+
+/* Como inserir_cliente, mas sem esperar por espaço: com a fila cheia
+ * o cliente é recusado. Retorna 1 se entrou na fila. */
+int tentar_inserir_cliente(FilaPrioridade* fila, int id_cliente, TipoCliente tipo) {
+    if (!fila) return 0;
+    
+    if (!limite_permitir(LIMITE_ENTRADA, tipo)) return 0;
+    
+    if (sem_trywait(&fila->semaforo_espaco) == -1) {
+        return 0;
+    }
+    
+    Node* novo = (Node*)malloc(sizeof(Node));
+    if (!novo) {
+        sem_post(&fila->semaforo_espaco);
+        return 0;
+    }
+    
+    novo->cliente.id_cliente = id_cliente;
+    novo->cliente.tipo = tipo;
+    novo->cliente.timestamp = relogio_agora();
+    novo->cliente.prioridade_calculada = 0;
+    novo->prazo_desistencia_ns = prazo_desistencia(tipo, relogio_agora_ns());
+    
+    pthread_mutex_lock(&fila->lock);
+    fila->chegadas[tipo]++;
+    inserir_no_ordenado(fila, novo);
+    pthread_mutex_unlock(&fila->lock);
+    
+    avisar_chegada();
+    traco_chegada(id_cliente, tipo);
+    return 1;
+}
+
+/* Cliente a atender (lock da fila adquirido): o da frente, a não ser que
+ * o seu tipo esteja no limite de atendimento; nesse caso passa o primeiro
+ * do outro tipo. NULL se nenhum dos dois tiver ficha. */
+static Node* escolher_para_atendimento(FilaPrioridade* fila) {
+    Node* no = fila->frente;
+    if (limite_permitir(LIMITE_ATENDIMENTO, no->cliente.tipo)) return no;
+    
+    TipoCliente outro = (no->cliente.tipo == EMPRESA) ? PUBLICO : EMPRESA;
+    while (no != NULL && no->cliente.tipo != outro) {
+        no = no->next;
+    }
+    if (no != NULL && limite_permitir(LIMITE_ATENDIMENTO, outro)) return no;
+    
+    return NULL;
+}
+
+/* Retira o próximo cliente a atender sem bloquear, copiando-o para
+ * 'destino'. Retorna 1 se havia cliente, 0 se a fila estava vazia ou
+ * os limites de atendimento adiaram todos. */
+int retirar_proximo_cliente(FilaPrioridade* fila, Cliente* destino) {
+    if (!fila || !destino) return 0;
+    
+    if (sem_trywait(&fila->semaforo_clientes) == -1) {
+        return 0;
+    }
+    
+    pthread_mutex_lock(&fila->lock);
+    
+    // A ficha pode ter sido de um cliente que entretanto desistiu
+    expirar_ate(fila, relogio_agora_ns());
+    Node* primeiro = fila->frente;
+    if (primeiro == NULL) {
+        pthread_mutex_unlock(&fila->lock);
+        return 0;
+    }
+    
+    primeiro = escolher_para_atendimento(fila);
+    if (primeiro == NULL) {
+        // Adiado: a ficha fica para quando houver atendimento disponível
+        pthread_mutex_unlock(&fila->lock);
+        sem_post(&fila->semaforo_clientes);
+        return 0;
+    }
+    
+    desligar_no(fila, primeiro);
+    
     pthread_mutex_unlock(&fila->lock);
+    
+    *destino = primeiro->cliente;
+    free(primeiro);
+    sem_post(&fila->semaforo_espaco);
+    
+    return 1;
+}
+
+/* Devolve à fila um cliente retirado e não atendido (mantém a chegada
+ * original, logo o aging). Não bloqueia: o lugar era do próprio cliente.
+ * A ficha de atendimento gasta ao retirá-lo volta ao balde do seu tipo. */
+void devolver_cliente(FilaPrioridade* fila, const Cliente* cliente) {
+    if (!fila || !cliente) return;
+    
+    limite_devolver(LIMITE_ATENDIMENTO, cliente->tipo);
+    
+    if (sem_trywait(&fila->semaforo_espaco) == -1) {
+        printf("[FILA] Sem espaço para devolver o cliente %d\n", cliente->id_cliente);
+        return;
+    }
+    
+    Node* novo = (Node*)malloc(sizeof(Node));
+    if (!novo) {
+        sem_post(&fila->semaforo_espaco);
+        return;
+    }
+    novo->cliente = *cliente;
+    novo->prazo_desistencia_ns = prazo_desistencia(cliente->tipo,
+                                                   (long long)cliente->timestamp * NS_POR_SEGUNDO);
+    
+    pthread_mutex_lock(&fila->lock);
+    inserir_no_ordenado(fila, novo);
+    pthread_mutex_unlock(&fila->lock);
+    
+    avisar_chegada();
 }
 
 /* Obtém próximo cliente (maior prioridade) sem remover */
@@ -155,9 +434,9 @@ Cliente* obter_proximo_cliente(FilaPrioridade* fila) {
     
     pthread_mutex_lock(&fila->lock);
     
+    // Fila vazia: a ficha era de um cliente que saiu sem a consumir
     if (fila->frente == NULL) {
         pthread_mutex_unlock(&fila->lock);
-        sem_post(&fila->semaforo_clientes);
         return NULL;
     }
     
@@ -180,10 +459,7 @@ void remover_cliente_processado(FilaPrioridade* fila, int id_cliente) {
     }
     
     Node* atual = fila->frente;
-    Node* anterior = NULL;
-    
     while (atual != NULL && atual->cliente.id_cliente != id_cliente) {
-        anterior = atual;
         atual = atual->next;
     }
     
@@ -192,36 +468,29 @@ void remover_cliente_processado(FilaPrioridade* fila, int id_cliente) {
         return;
     }
     
-    if (anterior == NULL) {
-        fila->frente = atual->next;
-        if (fila->frente == NULL) {
-            fila->fim = NULL;
-        }
-    } else {
-        anterior->next = atual->next;
-        if (atual->next == NULL) {
-            fila->fim = anterior;
-        }
-    }
-    
+    desligar_no(fila, atual);
     free(atual);
-    fila->tamanho--;
     
     sem_post(&fila->semaforo_espaco);
     pthread_mutex_unlock(&fila->lock);
 }
 
+/* Quota de vendas de um turno (0 se o turno for inválido) */
+int limite_vendas_turno(Turno turno) {
+    switch (turno) {
+        case MANHA: return LIMITE_VENDAS_MANHA;
+        case TARDE: return LIMITE_VENDAS_TARDE;
+        case NOITE: return LIMITE_VENDAS_NOITE;
+        default: return 0;
+    }
+}
+
 /* Processa vendas para um turno */
 int processar_vendas_turno(FilaPrioridade* fila, Turno turno_atual) {
     if (!fila) return 0;
     
-    int limite;
-    switch (turno_atual) {
-        case MANHA: limite = 35; break;
-        case TARDE: limite = 35; break;
-        case NOITE: limite = 30; break;
-        default: return 0;
-    }
+    int limite = limite_vendas_turno(turno_atual);
+    if (limite <= 0) return 0;
     
     printf("\n=== INICIANDO TURNO ===\n");
     printf("Turno: %s | Limite: %d vendas\n", 
@@ -232,8 +501,7 @@ int processar_vendas_turno(FilaPrioridade* fila, Turno turno_atual) {
     int vendas_realizadas = 0;
     
     while (vendas_realizadas < limite) {
-        int disponivel = estoque_disponivel();
-        if (disponivel <= 0) {
+        if (estoque_esgotado()) {
             printf("[ESTOQUE ESGOTADO] Vendidos: %d/%d\n", 
                    vendas_realizadas, limite);
             break;
@@ -248,13 +516,23 @@ int processar_vendas_turno(FilaPrioridade* fila, Turno turno_atual) {
         
         pthread_mutex_lock(&fila->lock);
         
+        // Sem cliente: a ficha era de um que desistiu entretanto
+        expirar_ate(fila, relogio_agora_ns());
         if (fila->frente == NULL) {
+            pthread_mutex_unlock(&fila->lock);
+            continue;
+        }
+        
+        // Os limites de atendimento valem também para este caminho
+        Node* escolhido = escolher_para_atendimento(fila);
+        if (escolhido == NULL) {
             pthread_mutex_unlock(&fila->lock);
             sem_post(&fila->semaforo_clientes);
+            relogio_dormir_ms(100);
             continue;
         }
         
-        Cliente* proximo = &(fila->frente->cliente);
+        Cliente* proximo = &escolhido->cliente;
         int id_cliente = proximo->id_cliente;
         TipoCliente tipo = proximo->tipo;
         time_t chegada = proximo->timestamp;
@@ -265,24 +543,29 @@ int processar_vendas_turno(FilaPrioridade* fila, Turno turno_atual) {
         int cartao_id = reservar_proximo_cartao();
         if (cartao_id == -1) {
             printf("[ERRO] Não foi possível reservar cartão\n");
+            limite_devolver(LIMITE_ATENDIMENTO, tipo);
             sem_post(&fila->semaforo_clientes);
             break;
         }
         
         char* tipo_str = (tipo == EMPRESA) ? "EMPRESA" : "PUBLICO";
-        double espera = difftime(time(NULL), chegada);
+        double espera = difftime(relogio_agora(), chegada);
         
-        printf("[VENDA %02d/%d] %-7s | Cliente: %03d | ", 
-               vendas_realizadas + 1, limite, tipo_str, id_cliente);
-        printf("Cartão: %03d | Prioridade: %d | Espera: %.0fs\n",
-               cartao_id, prioridade, espera);
+        saida_venda("[VENDA %02d/%d] %-7s | Cliente: %03d | "
+                    "Cartão: %03d | Prioridade: %d | Espera: %.0fs\n",
+                    vendas_realizadas + 1, limite, tipo_str, id_cliente,
+                    cartao_id, prioridade, espera);
+        diario_registar_venda(id_cliente, tipo, chegada, cartao_id, 0, turno_atual);
+        traco_venda(id_cliente, tipo, cartao_id, 0);
         
         remover_cliente_processado(fila, id_cliente);
         vendas_realizadas++;
         
-        usleep(100000);
+        relogio_dormir_ms(100);
     }
     
+    saida_vendas_descarregar();
+    diario_descarregar();
     printf("=== FIM DO TURNO ===\n");
     printf("Total vendido: %d/%d\n", vendas_realizadas, limite);
     printf("Estoque restante: %d cartões\n\n", estoque_disponivel());
@@ -305,7 +588,7 @@ void imprimir_fila(FilaPrioridade* fila) {
     while (atual != NULL) {
         Cliente* c = &atual->cliente;
         int prioridade = calcular_prioridade_cliente(c);
-        double espera = difftime(time(NULL), c->timestamp);
+        double espera = difftime(relogio_agora(), c->timestamp);
         
         printf("%2d. [%s] Cliente %03d | ", pos++,
                c->tipo == EMPRESA ? "EMP" : "PUB",
@@ -329,36 +612,23 @@ void imprimir_fila(FilaPrioridade* fila) {
 void bloquear_vendas_publico(FilaPrioridade* fila) {
     if (!fila) return;
     
+    traco_bloqueio_publico();
+    
     pthread_mutex_lock(&fila->lock);
     
     Node* atual = fila->frente;
-    Node* anterior = NULL;
     int removidos = 0;
     
     while (atual != NULL) {
+        Node* prox = atual->next;
         if (atual->cliente.tipo == PUBLICO) {
-            Node* remover = atual;
-            
-            if (anterior == NULL) {
-                fila->frente = atual->next;
-                atual = fila->frente;
-            } else {
-                anterior->next = atual->next;
-                atual = anterior->next;
-            }
-            
-            if (remover == fila->fim) {
-                fila->fim = anterior;
-            }
-            
-            free(remover);
-            fila->tamanho--;
+            desligar_no(fila, atual);
+            free(atual);
             removidos++;
+            sem_trywait(&fila->semaforo_clientes);
             sem_post(&fila->semaforo_espaco);
-        } else {
-            anterior = atual;
-            atual = atual->next;
         }
+        atual = prox;
     }
     
     pthread_mutex_unlock(&fila->lock);
@@ -381,4 +651,49 @@ void adicionar_lote_empresas(FilaPrioridade* fila, int quantidade) {
     }
     
     printf("[LOTE] %d empresas adicionadas à fila\n", quantidade);
-}
\ No newline at end of file
+}
+
+/* Expira já as desistências vencidas (para leituras da fila fora das
+ * entradas e saídas, ex.: estado do sistema e API) */
+int fila_expirar_desistencias(FilaPrioridade* fila) {
+    if (!fila) return 0;
+    
+    pthread_mutex_lock(&fila->lock);
+    int expirados = expirar_ate(fila, relogio_agora_ns());
+    pthread_mutex_unlock(&fila->lock);
+    
+    return expirados;
+}
+
+void obter_estatisticas_desistencia(FilaPrioridade* fila, EstatisticasDesistencia* destino) {
+    if (!fila || !destino) return;
+    
+    pthread_mutex_lock(&fila->lock);
+    expirar_ate(fila, relogio_agora_ns());
+    for (int t = 0; t < 2; t++) {
+        destino->paciencia_s[t] = (double)paciencia_ns[t] / NS_POR_SEGUNDO;
+        destino->chegadas[t] = fila->chegadas[t];
+        destino->desistencias[t] = fila->desistencias[t];
+    }
+    pthread_mutex_unlock(&fila->lock);
+}
+
+void exibir_relatorio_desistencias(FilaPrioridade* fila) {
+    EstatisticasDesistencia estatisticas;
+    if (!fila) return;
+    obter_estatisticas_desistencia(fila, &estatisticas);
+    
+    printf("\n=== DESISTÊNCIAS NA FILA ===\n");
+    for (int t = 0; t < 2; t++) {
+        if (estatisticas.paciencia_s[t] <= 0) {
+            printf("%-8s paciência sem limite | %lld chegadas\n",
+                   nomes_tipos[t], estatisticas.chegadas[t]);
+            continue;
+        }
+        printf("%-8s paciência %.0fs | %lld chegadas | %lld desistências (%.1f%%)\n",
+               nomes_tipos[t], estatisticas.paciencia_s[t], estatisticas.chegadas[t],
+               estatisticas.desistencias[t],
+               estatisticas.chegadas[t] > 0 ?
+                   estatisticas.desistencias[t] * 100.0 / estatisticas.chegadas[t] : 0);
+    }
+}
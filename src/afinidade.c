@@ -0,0 +1,237 @@
+/* CPU_SET e sched_getcpu são extensões GNU: o Makefile passa
+ * -D_GNU_SOURCE, mas os testes compilam o módulo sem ele */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "afinidade.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/* Políticas do mbind(2); definidas aqui para não depender de libnuma */
+#define POLITICA_PREFERIDA   1   // MPOL_PREFERRED
+#define POLITICA_INTERCALADA 3   // MPOL_INTERLEAVE
+
+static const char* nomes_classes[NUM_CLASSES_THREAD] = {
+    "agencias", "rh", "temporizadores", "web", "pipeline", "gerador"
+};
+
+static cpu_set_t cpus_classe[NUM_CLASSES_THREAD];
+static int classe_configurada[NUM_CLASSES_THREAD];
+
+/* Topologia (lida uma vez do sysfs) */
+static int no_da_cpu[CPU_SETSIZE];
+static int nos_numa = 1;
+static pthread_once_t topologia_once = PTHREAD_ONCE_INIT;
+
+/* Interpreta uma lista de CPUs do sysfs ou da linha de comando: "0-3,8,10-11" */
+static int interpretar_lista_cpus(const char* lista, cpu_set_t* destino) {
+    CPU_ZERO(destino);
+    const char* p = lista;
+    int encontrados = 0;
+
+    while (*p) {
+        while (*p == ',' || isspace((unsigned char)*p)) p++;
+        if (!*p) break;
+        if (!isdigit((unsigned char)*p)) return -1;
+
+        char* fim;
+        long inicio = strtol(p, &fim, 10);
+        long ultimo = inicio;
+        if (*fim == '-') {
+            if (!isdigit((unsigned char)fim[1])) return -1;
+            ultimo = strtol(fim + 1, &fim, 10);
+        }
+        if (inicio < 0 || ultimo < inicio || ultimo >= CPU_SETSIZE) return -1;
+
+        for (long cpu = inicio; cpu <= ultimo; cpu++) {
+            CPU_SET(cpu, destino);
+            encontrados++;
+        }
+        p = fim;
+    }
+    return encontrados;
+}
+
+static int ler_lista_sysfs(const char* caminho, cpu_set_t* destino) {
+    FILE* f = fopen(caminho, "r");
+    if (!f) return -1;
+
+    char linha[4096];
+    int n = -1;
+    if (fgets(linha, sizeof(linha), f)) n = interpretar_lista_cpus(linha, destino);
+    fclose(f);
+    return n;
+}
+
+/* /sys/devices/system/node/nodeN/cpulist: CPUs de cada nó */
+static void ler_topologia(void) {
+    memset(no_da_cpu, 0, sizeof(no_da_cpu));
+
+    int maior_no = -1;
+    for (int no = 0; no < MAX_NOS_NUMA; no++) {
+        char caminho[128];
+        cpu_set_t cpus;
+        snprintf(caminho, sizeof(caminho), "/sys/devices/system/node/node%d/cpulist", no);
+        if (ler_lista_sysfs(caminho, &cpus) < 0) continue;
+
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &cpus)) no_da_cpu[cpu] = no;
+        }
+        maior_no = no;
+    }
+    nos_numa = maior_no >= 0 ? maior_no + 1 : 1;
+}
+
+static void garantir_topologia(void) {
+    pthread_once(&topologia_once, ler_topologia);
+}
+
+/* ========== CONFIGURAÇÃO ========== */
+
+int configurar_afinidade(const char* especificacao) {
+    if (!especificacao) return 0;
+
+    const char* igual = strchr(especificacao, '=');
+    if (!igual) {
+        printf("[AFINIDADE] Especificação inválida: %s (esperado classe=lista)\n", especificacao);
+        return 0;
+    }
+
+    size_t tamanho_nome = (size_t)(igual - especificacao);
+    for (int c = 0; c < NUM_CLASSES_THREAD; c++) {
+        if (strlen(nomes_classes[c]) != tamanho_nome ||
+            strncmp(nomes_classes[c], especificacao, tamanho_nome) != 0) {
+            continue;
+        }
+
+        cpu_set_t cpus;
+        if (interpretar_lista_cpus(igual + 1, &cpus) <= 0) {
+            printf("[AFINIDADE] Lista de CPUs inválida: %s\n", igual + 1);
+            return 0;
+        }
+
+        // Só CPUs que existem nesta máquina
+        cpu_set_t online;
+        if (ler_lista_sysfs("/sys/devices/system/cpu/online", &online) > 0) {
+            CPU_AND(&cpus, &cpus, &online);
+            if (CPU_COUNT(&cpus) == 0) {
+                printf("[AFINIDADE] Nenhum CPU de '%s' está online\n", igual + 1);
+                return 0;
+            }
+        }
+
+        cpus_classe[c] = cpus;
+        classe_configurada[c] = 1;
+        return 1;
+    }
+
+    printf("[AFINIDADE] Classe de thread desconhecida: %.*s\n", (int)tamanho_nome, especificacao);
+    return 0;
+}
+
+int afinidade_configurada(ClasseThread classe) {
+    return classe >= 0 && classe < NUM_CLASSES_THREAD && classe_configurada[classe];
+}
+
+int num_cpus_classe(ClasseThread classe) {
+    return afinidade_configurada(classe) ? CPU_COUNT(&cpus_classe[classe]) : 0;
+}
+
+/* Fixar a thread atual segundo a configuração da classe */
+int aplicar_afinidade_thread(ClasseThread classe, int indice) {
+    if (!afinidade_configurada(classe)) return 0;
+
+    cpu_set_t destino = cpus_classe[classe];
+    if (indice >= 0) {
+        // O indice-ésimo CPU do conjunto, em roda
+        int alvo = indice % CPU_COUNT(&cpus_classe[classe]);
+        CPU_ZERO(&destino);
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &cpus_classe[classe]) && alvo-- == 0) {
+                CPU_SET(cpu, &destino);
+                break;
+            }
+        }
+    }
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(destino), &destino) != 0) {
+        printf("[AFINIDADE] Falha ao fixar thread da classe %s\n", nomes_classes[classe]);
+        return 0;
+    }
+    return 1;
+}
+
+/* ========== TOPOLOGIA ========== */
+
+int num_nos_numa(void) {
+    garantir_topologia();
+    return nos_numa;
+}
+
+int no_numa_da_cpu(int cpu) {
+    garantir_topologia();
+    return (cpu >= 0 && cpu < CPU_SETSIZE) ? no_da_cpu[cpu] : 0;
+}
+
+int no_numa_atual(void) {
+    return no_numa_da_cpu(sched_getcpu());
+}
+
+void exibir_topologia(void) {
+    garantir_topologia();
+    printf("[AFINIDADE] %ld CPUs online, %d nó(s) NUMA\n",
+           sysconf(_SC_NPROCESSORS_ONLN), nos_numa);
+
+    for (int c = 0; c < NUM_CLASSES_THREAD; c++) {
+        if (!classe_configurada[c]) continue;
+        printf("[AFINIDADE] %-15s CPUs:", nomes_classes[c]);
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &cpus_classe[c])) printf(" %d(nó %d)", cpu, no_da_cpu[cpu]);
+        }
+        printf("\n");
+    }
+}
+
+/* ========== MEMÓRIA POR NÓ ========== */
+
+static size_t arredondar_pagina(size_t tamanho) {
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    return (tamanho + pagina - 1) / pagina * pagina;
+}
+
+/* Páginas anónimas com política definida antes do primeiro acesso */
+static void* alocar_com_politica(size_t tamanho, int politica, unsigned long mascara) {
+    size_t total = arredondar_pagina(tamanho);
+    void* ptr = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) return NULL;
+
+    // Com um só nó não há o que escolher; se o mbind falhar fica a política normal
+    if (num_nos_numa() > 1) {
+        syscall(SYS_mbind, ptr, total, politica, &mascara, sizeof(mascara) * 8, 0);
+    }
+    return ptr;
+}
+
+void* alocar_memoria_local(size_t tamanho) {
+    int no = no_numa_atual();
+    if (no >= (int)(sizeof(unsigned long) * 8)) no = 0;
+    return alocar_com_politica(tamanho, POLITICA_PREFERIDA, 1UL << no);
+}
+
+void* alocar_memoria_intercalada(size_t tamanho) {
+    int nos = num_nos_numa();
+    unsigned long mascara = (nos >= (int)(sizeof(unsigned long) * 8))
+                            ? ~0UL : (1UL << nos) - 1;
+    return alocar_com_politica(tamanho, POLITICA_INTERCALADA, mascara);
+}
+
+void libertar_memoria_numa(void* ptr, size_t tamanho) {
+    if (ptr) munmap(ptr, arredondar_pagina(tamanho));
+}
@@ -1,9 +1,14 @@
 #include "contratacoes.h"
+#include "afinidade.h"
+#include "traco.h"
+#include "relogio.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdatomic.h>
 
 /* Variáveis internas ao módulo */
 static Contratacao *lista_contratados = NULL;
@@ -14,6 +19,10 @@ static int total_processos = 0;
 static int processos_aprovados = 0;
 static int processos_rejeitados = 0;
 
+/* Processos em cada estado: só mudam com o mutex adquirido (mudar_estado),
+ * mas leem-se sem ele */
+static atomic_int processos_por_estado[NUM_ESTADOS_PROCESSO];
+
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_t thread_timer;
 static pthread_t thread_verificacao;
@@ -21,6 +30,107 @@ static volatile int timer_ativa = 0;
 static volatile int verificacao_ativa = 0;
 static volatile int interrupcao_ativa = 0;
 
+static void iniciar_motor_rh(void);
+static void parar_motor_rh(void);
+
+/* Transição de estado com as contagens em dia (mutex adquirido) */
+static void mudar_estado(ProcessoContratacao *processo, EstadoProcesso novo) {
+    atomic_fetch_sub_explicit(&processos_por_estado[processo->estado], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&processos_por_estado[novo], 1, memory_order_relaxed);
+    processo->estado = novo;
+}
+
+/* ========== ÍNDICES POR ID (mutex adquirido) ========== */
+
+/* Tabela de dispersão encadeada pelos próprios registos: 'desloc_prox' é
+ * a posição do ponteiro de encadeamento e o id é o primeiro campo */
+typedef struct {
+    void **baldes;
+    int capacidade;          // Potência de 2
+    int total;
+    size_t desloc_prox;
+} IndiceId;
+
+_Static_assert(offsetof(Contratacao, id) == 0, "id deve ser o primeiro campo");
+_Static_assert(offsetof(ProcessoContratacao, id) == 0, "id deve ser o primeiro campo");
+
+static IndiceId indice_processos = { NULL, 0, 0, offsetof(ProcessoContratacao, prox_indice) };
+static IndiceId indice_contratados = { NULL, 0, 0, offsetof(Contratacao, prox_indice) };
+
+static void **ligacao_indice(const IndiceId *indice, void *registo) {
+    return (void **)((char *)registo + indice->desloc_prox);
+}
+
+static int posicao_indice(int id, int capacidade) {
+    return (int)(((unsigned)id * 2654435761u) & (unsigned)(capacidade - 1));
+}
+
+/* Duplica as posições e redistribui; se faltar memória fica como está
+ * (as cadeias só ficam mais longas) */
+static void crescer_indice(IndiceId *indice) {
+    int capacidade = indice->capacidade ? indice->capacidade * 2 : CAPACIDADE_INICIAL_INDICE_RH;
+    void **baldes = calloc((size_t)capacidade, sizeof(void *));
+    if (!baldes) return;
+    
+    for (int i = 0; i < indice->capacidade; i++) {
+        void *registo = indice->baldes[i];
+        while (registo) {
+            void *prox = *ligacao_indice(indice, registo);
+            int posicao = posicao_indice(*(int *)registo, capacidade);
+            *ligacao_indice(indice, registo) = baldes[posicao];
+            baldes[posicao] = registo;
+            registo = prox;
+        }
+    }
+    
+    free(indice->baldes);
+    indice->baldes = baldes;
+    indice->capacidade = capacidade;
+}
+
+/* Retorna 0 se não houve memória para a primeira tabela (o registo não
+ * fica indexado e o chamador deve desfazer a inserção) */
+static int indice_inserir(IndiceId *indice, void *registo) {
+    if (indice->total >= indice->capacidade) crescer_indice(indice);
+    if (!indice->baldes) return 0;
+    
+    int posicao = posicao_indice(*(int *)registo, indice->capacidade);
+    *ligacao_indice(indice, registo) = indice->baldes[posicao];
+    indice->baldes[posicao] = registo;
+    indice->total++;
+    return 1;
+}
+
+static void *indice_procurar(const IndiceId *indice, int id) {
+    if (!indice->baldes) return NULL;
+    
+    void *registo = indice->baldes[posicao_indice(id, indice->capacidade)];
+    while (registo && *(int *)registo != id) {
+        registo = *ligacao_indice(indice, registo);
+    }
+    return registo;
+}
+
+static void indice_remover(IndiceId *indice, void *registo) {
+    if (!indice->baldes) return;
+    
+    void **ligacao = &indice->baldes[posicao_indice(*(int *)registo, indice->capacidade)];
+    while (*ligacao && *ligacao != registo) {
+        ligacao = ligacao_indice(indice, *ligacao);
+    }
+    if (*ligacao) {
+        *ligacao = *ligacao_indice(indice, registo);
+        indice->total--;
+    }
+}
+
+static void indice_libertar(IndiceId *indice) {
+    free(indice->baldes);
+    indice->baldes = NULL;
+    indice->capacidade = 0;
+    indice->total = 0;
+}
+
 /* ========== INICIALIZAÇÃO/ENCERRAMENTO ========== */
 
 void inicializar_sistema_rh(void) {
@@ -35,6 +145,9 @@ void inicializar_sistema_rh(void) {
     // Iniciar thread de verificação periódica (em vez de SIGALRM)
     iniciar_thread_verificacao();
     
+    // Prazos dos processos de contratação
+    iniciar_motor_rh();
+    
     printf("[RH] Sistema pronto. Limite: %d funcionários\n", LIMITE_CONTRATACOES);
     printf("[RH] Timer de exibição configurado a cada %d segundos\n", INTERVALO_EXIBICAO);
 }
@@ -45,6 +158,7 @@ void encerrar_sistema_rh(void) {
     // Parar threads
     parar_timer_exibicao();
     parar_thread_verificacao();
+    parar_motor_rh();   // Antes de libertar os processos a que os eventos apontam
     
     // Limpar memória
     limpar_lista();
@@ -57,22 +171,28 @@ void encerrar_sistema_rh(void) {
 
 /* ========== SISTEMA DE INTERRUPÇÕES (CORRIGIDO) ========== */
 
+/* Alerta com os totais já lidos (serve quem tem o mutex adquirido) */
+static void alertar_interrupcao_rh(int contratacoes, int demissoes) {
+    interrupcao_ativa = 1;
+    
+    printf("\n  [INTERRUPÇÃO DO SISTEMA] \n");
+    printf("ALERTA: Contratações (%d) > Demissões (%d)\n", 
+           contratacoes, demissoes);
+    printf("Diferença: %d funcionário(s)\n", contratacoes - demissoes);
+    printf("Ação necessária: Verificar necessidade de demissões\n");
+    printf("  -------------------------- \n\n");
+}
+
 /* Handler de interrupção customizada */
 static void handler_interrupcao_rh(int sig) {
     (void)sig;
-    interrupcao_ativa = 1;
     
     pthread_mutex_lock(&mutex);
     int contratacoes = total_contratacoes;
     int demissoes = total_demissoes;
     pthread_mutex_unlock(&mutex);
     
-    printf("\n  [INTERRUPÇÃO DO SISTEMA] \n");
-    printf("ALERTA: Contratações (%d) > Demissões (%d)\n", 
-           contratacoes, demissoes);
-    printf("Diferença: %d funcionário(s)\n", contratacoes - demissoes);
-    printf("Ação necessária: Verificar necessidade de demissões\n");
-    printf("  -------------------------- \n\n");
+    alertar_interrupcao_rh(contratacoes, demissoes);
 }
 
 /* Configurar interrupções SEM SIGALRM */
@@ -87,6 +207,7 @@ void configurar_interrupcoes_rh(void) {
 /* Thread para verificação periódica (substitui SIGALRM) */
 static void* thread_verificacao_periodica(void* arg) {
     (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
     
     printf("[RH VERIFICAÇÃO] Thread de verificação iniciada\n");
     
@@ -135,6 +256,7 @@ void verificar_interrupcao_rh(void) {
 /* Thread para exibição periódica */
 static void* thread_exibicao_periodica(void* arg) {
     (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
     
     while (timer_ativa) {
         sleep(INTERVALO_EXIBICAO); // 30 segundos (3 minutos simulados)
@@ -163,41 +285,238 @@ void parar_timer_exibicao(void) {
     printf("[RH] Timer de exibição periódica parado\n");
 }
 
-/* ========== PROCESSO DE CONTRATAÇÃO ========== */
+/* ========== MOTOR DE EVENTOS (RODA TEMPORAL) ========== */
+
+typedef enum {
+    EVENTO_INICIAR_ANALISE,      // PENDENTE -> EM_ANALISE
+    EVENTO_PROGRESSO_ANALISE,
+    EVENTO_FIM_ANALISE
+} TipoEventoRH;
+
+typedef struct EventoRH {
+    TipoEventoRH tipo;
+    ProcessoContratacao *processo;   // Vive até limpar_lista, depois do motor parar
+    long long prazo_ns;              // CLOCK_MONOTONIC
+    int decorridos_s;                // Progresso
+    int duracao_s;                   // Tempo total da análise
+    struct EventoRH *prox;
+} EventoRH;
 
-/* Thread que simula o tempo de contratação */
-void* thread_processo_contratacao(void* arg) {
-    ProcessoContratacao* processo = (ProcessoContratacao*)arg;
+#define RESOLUCAO_RODA_RH_NS (RESOLUCAO_RODA_RH_MS * 1000000LL)
+
+/* Um lock só do motor: quem agenda pode ter o mutex do RH (ordem mutex ->
+ * motor.lock); a thread da roda nunca toma o mutex do RH */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond_roda;        // Primeiro evento agendado ou paragem
+    pthread_cond_t cond_prontos;     // Eventos vencidos para os trabalhadores
+    EventoRH *roda[POSICOES_RODA_RH];
+    long long tique;                 // Último tique completo já revisto
+    int pendentes;                   // Eventos na roda
+    EventoRH *prontos_inicio;
+    EventoRH *prontos_fim;
+    long long disparados;
+    int ativo;
+    pthread_t thread_roda;
+    pthread_t trabalhadores[NUM_TRABALHADORES_RH];
+} motor = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void executar_evento_rh(EventoRH *evento);
+
+static long long agora_monotonico_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * NS_POR_SEGUNDO + ts.tv_nsec;
+}
+
+/* Agenda um evento para daqui a 'atraso_ms'. Um prazo dentro de um tique
+ * já revisto cai no seguinte: nada dispara antes do prazo. */
+static void agendar_evento_rh(TipoEventoRH tipo, ProcessoContratacao *processo,
+                              long atraso_ms, int decorridos_s, int duracao_s) {
+    EventoRH *evento = malloc(sizeof(EventoRH));
+    if (!evento) {
+        printf("[RH ERRO] Sem memória para agendar o processo %03d\n", processo->id);
+        return;
+    }
+    evento->tipo = tipo;
+    evento->processo = processo;
+    evento->prazo_ns = agora_monotonico_ns() + atraso_ms * 1000000LL;
+    evento->decorridos_s = decorridos_s;
+    evento->duracao_s = duracao_s;
     
-    printf("[RH PROCESSO %03d] Iniciando análise...\n", processo->id);
+    pthread_mutex_lock(&motor.lock);
+    if (!motor.ativo) {
+        pthread_mutex_unlock(&motor.lock);
+        free(evento);
+        return;
+    }
+    
+    long long tique = evento->prazo_ns / RESOLUCAO_RODA_RH_NS;
+    if (tique <= motor.tique) tique = motor.tique + 1;
+    int posicao = (int)(tique % POSICOES_RODA_RH);
+    evento->prox = motor.roda[posicao];
+    motor.roda[posicao] = evento;
+    
+    if (motor.pendentes++ == 0) {
+        pthread_cond_signal(&motor.cond_roda);
+    }
+    pthread_mutex_unlock(&motor.lock);
+}
+
+/* Revê cada tique completo e passa os eventos vencidos aos trabalhadores.
+ * Uma posição guarda prazos de várias voltas: os restantes ficam. Sem
+ * eventos pendentes a thread dorme até ao próximo agendamento. */
+static void* thread_roda_rh(void* arg) {
+    (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
     
-    // Simular tempo de análise (1-2 minutos em segundos)
-    int tempo_analise = TEMPO_CONTRATACAO_MIN + 
-                       (rand() % (TEMPO_CONTRATACAO_MAX - TEMPO_CONTRATACAO_MIN + 1));
+    pthread_mutex_lock(&motor.lock);
+    while (motor.ativo) {
+        if (motor.pendentes == 0) {
+            pthread_cond_wait(&motor.cond_roda, &motor.lock);
+            continue;
+        }
+        
+        long long agora = agora_monotonico_ns();
+        long long alvo = agora / RESOLUCAO_RODA_RH_NS - 1;
+        if (alvo <= motor.tique) {
+            // Esperar que o tique seguinte fique completo
+            long long limite_ns = (motor.tique + 2) * RESOLUCAO_RODA_RH_NS;
+            struct timespec limite = { limite_ns / NS_POR_SEGUNDO, limite_ns % NS_POR_SEGUNDO };
+            pthread_cond_timedwait(&motor.cond_roda, &motor.lock, &limite);
+            continue;
+        }
+        
+        // Depois de uma pausa longa basta rever cada posição uma vez
+        long long inicio = motor.tique + 1;
+        if (alvo - inicio >= POSICOES_RODA_RH) inicio = alvo - POSICOES_RODA_RH + 1;
+        motor.tique = alvo;
+        
+        int vencidos = 0;
+        for (long long tique = inicio; tique <= alvo; tique++) {
+            EventoRH **ligacao = &motor.roda[tique % POSICOES_RODA_RH];
+            while (*ligacao) {
+                EventoRH *evento = *ligacao;
+                if (evento->prazo_ns > agora) {
+                    ligacao = &evento->prox;
+                    continue;
+                }
+                *ligacao = evento->prox;
+                motor.pendentes--;
+                
+                evento->prox = NULL;
+                if (motor.prontos_fim) motor.prontos_fim->prox = evento;
+                else motor.prontos_inicio = evento;
+                motor.prontos_fim = evento;
+                vencidos++;
+            }
+        }
+        
+        if (vencidos == 1) pthread_cond_signal(&motor.cond_prontos);
+        else if (vencidos > 1) pthread_cond_broadcast(&motor.cond_prontos);
+    }
+    pthread_mutex_unlock(&motor.lock);
     
-    printf("[RH PROCESSO %03d] Tempo estimado: %d segundos\n", 
-           processo->id, tempo_analise);
+    return NULL;
+}
+
+static void* thread_trabalhador_rh(void* arg) {
+    (void)arg;
+    aplicar_afinidade_thread(CLASSE_RH, -1);
     
-    // Aguardar tempo simulado
-    for (int i = 1; i <= tempo_analise; i++) {
-        if (processo->estado == CANCELADO || processo->estado == REJEITADO) {
-            printf("[RH PROCESSO %03d] Processo interrompido\n", processo->id);
-            return NULL;
+    pthread_mutex_lock(&motor.lock);
+    while (motor.ativo) {
+        EventoRH *evento = motor.prontos_inicio;
+        if (!evento) {
+            pthread_cond_wait(&motor.cond_prontos, &motor.lock);
+            continue;
         }
-        sleep(1);
+        motor.prontos_inicio = evento->prox;
+        if (!motor.prontos_inicio) motor.prontos_fim = NULL;
+        motor.disparados++;
+        pthread_mutex_unlock(&motor.lock);
         
-        // Mostrar progresso a cada 10 segundos
-        if (i % 10 == 0) {
-            printf("[RH PROCESSO %03d] Em análise... %d/%d segundos\n", 
-                   processo->id, i, tempo_analise);
+        executar_evento_rh(evento);
+        free(evento);
+        
+        pthread_mutex_lock(&motor.lock);
+    }
+    pthread_mutex_unlock(&motor.lock);
+    
+    return NULL;
+}
+
+static void iniciar_motor_rh(void) {
+    pthread_condattr_t atributos;
+    pthread_condattr_init(&atributos);
+    pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC);
+    pthread_cond_init(&motor.cond_roda, &atributos);
+    pthread_condattr_destroy(&atributos);
+    pthread_cond_init(&motor.cond_prontos, NULL);
+    
+    memset(motor.roda, 0, sizeof(motor.roda));
+    motor.tique = agora_monotonico_ns() / RESOLUCAO_RODA_RH_NS - 1;
+    motor.pendentes = 0;
+    motor.prontos_inicio = motor.prontos_fim = NULL;
+    motor.disparados = 0;
+    motor.ativo = 1;
+    
+    pthread_create(&motor.thread_roda, NULL, thread_roda_rh, NULL);
+    for (int i = 0; i < NUM_TRABALHADORES_RH; i++) {
+        pthread_create(&motor.trabalhadores[i], NULL, thread_trabalhador_rh, NULL);
+    }
+    printf("[RH] Motor de eventos iniciado (roda de %d x %dms, %d trabalhadores)\n",
+           POSICOES_RODA_RH, RESOLUCAO_RODA_RH_MS, NUM_TRABALHADORES_RH);
+}
+
+/* Eventos ainda por disparar são descartados: os processos ficam no
+ * estado em que estavam */
+static void parar_motor_rh(void) {
+    pthread_mutex_lock(&motor.lock);
+    motor.ativo = 0;
+    pthread_cond_broadcast(&motor.cond_roda);
+    pthread_cond_broadcast(&motor.cond_prontos);
+    pthread_mutex_unlock(&motor.lock);
+    
+    pthread_join(motor.thread_roda, NULL);
+    for (int i = 0; i < NUM_TRABALHADORES_RH; i++) {
+        pthread_join(motor.trabalhadores[i], NULL);
+    }
+    
+    int descartados = 0;
+    for (int p = 0; p < POSICOES_RODA_RH; p++) {
+        while (motor.roda[p]) {
+            EventoRH *evento = motor.roda[p];
+            motor.roda[p] = evento->prox;
+            free(evento);
+            descartados++;
         }
     }
+    while (motor.prontos_inicio) {
+        EventoRH *evento = motor.prontos_inicio;
+        motor.prontos_inicio = evento->prox;
+        free(evento);
+        descartados++;
+    }
+    motor.prontos_fim = NULL;
+    motor.pendentes = 0;
     
-    // Processo concluído
+    pthread_cond_destroy(&motor.cond_roda);
+    pthread_cond_destroy(&motor.cond_prontos);
+    printf("[RH] Motor de eventos parado (%lld disparados, %d descartados)\n",
+           motor.disparados, descartados);
+}
+
+/* ========== PROCESSO DE CONTRATAÇÃO ========== */
+
+/* Fim do tempo de análise de um processo */
+static void concluir_analise(ProcessoContratacao *processo) {
     pthread_mutex_lock(&mutex);
     
-    if (processo->estado == EM_ANALISE) {
-        processo->estado = APROVADO;
+    if (processo->estado == CANCELADO || processo->estado == REJEITADO) {
+        printf("[RH PROCESSO %03d] Processo interrompido\n", processo->id);
+    } else if (processo->estado == EM_ANALISE) {
+        mudar_estado(processo, APROVADO);
         processo->data_conclusao = time(NULL);
         processos_aprovados++;
         
@@ -208,31 +527,46 @@ void* thread_processo_contratacao(void* arg) {
         int ativos = total_contratacoes - total_demissoes;
         if (ativos < LIMITE_CONTRATACOES) {
             printf("[RH PROCESSO %03d] Vaga disponível! Concluindo automaticamente...\n", processo->id);
-            processo->estado = CONTRATADO;
-            adicionar_contratado(processo->id, processo->nome, processo->cargo, processo->salario);
+            if (adicionar_contratado(processo->id, processo->nome, processo->cargo, processo->salario)) {
+                mudar_estado(processo, CONTRATADO);
+            } else {
+                printf("[RH PROCESSO %03d] Sem memória: continua APROVADO\n", processo->id);
+            }
         }
     }
     
     pthread_mutex_unlock(&mutex);
+}
+
+static void executar_evento_rh(EventoRH *evento) {
+    ProcessoContratacao *processo = evento->processo;
     
-    return NULL;
+    switch (evento->tipo) {
+        case EVENTO_INICIAR_ANALISE:
+            analisar_processo(processo->id);
+            break;
+        case EVENTO_PROGRESSO_ANALISE:
+            pthread_mutex_lock(&mutex);
+            if (processo->estado == EM_ANALISE) {
+                printf("[RH PROCESSO %03d] Em análise... %d/%d segundos\n",
+                       processo->id, evento->decorridos_s, evento->duracao_s);
+            }
+            pthread_mutex_unlock(&mutex);
+            break;
+        case EVENTO_FIM_ANALISE:
+            concluir_analise(processo);
+            break;
+    }
 }
 
 /* Iniciar novo processo de contratação */
 void iniciar_processo_contratacao(const char *nome, const char *cargo, float salario) {
+    traco_contratacao(nome, cargo, salario);
+    
     pthread_mutex_lock(&mutex);
     
     // Verificar limite de processos simultâneos
-    ProcessoContratacao *aux_proc = lista_processos;
-    int processos_ativos = 0;
-    while (aux_proc) {
-        if (aux_proc->estado == PENDENTE || aux_proc->estado == EM_ANALISE) {
-            processos_ativos++;
-        }
-        aux_proc = aux_proc->prox;
-    }
-    
-    if (processos_ativos >= LIMITE_PROCESSOS_SIMULTANEOS) {
+    if (get_processos_ativos() >= LIMITE_PROCESSOS_SIMULTANEOS) {
         printf("[RH ERRO] Limite de %d processos simultâneos atingido!\n", 
                LIMITE_PROCESSOS_SIMULTANEOS);
         pthread_mutex_unlock(&mutex);
@@ -253,11 +587,19 @@ void iniciar_processo_contratacao(const char *nome, const char *cargo, float sal
         return;
     }
     
-    novo->id = ++total_processos;
+    novo->id = total_processos + 1;
+    if (!indice_inserir(&indice_processos, novo)) {
+        printf("[RH ERRO] Sem memória para indexar o processo\n");
+        free(novo);
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
+    total_processos++;
     strncpy(novo->nome, nome, sizeof(novo->nome) - 1);
     strncpy(novo->cargo, cargo, sizeof(novo->cargo) - 1);
     novo->salario = salario;
     novo->estado = PENDENTE;
+    atomic_fetch_add_explicit(&processos_por_estado[PENDENTE], 1, memory_order_relaxed);
     novo->data_inicio = time(NULL);
     novo->data_conclusao = 0;
     novo->prox = lista_processos;
@@ -271,40 +613,44 @@ void iniciar_processo_contratacao(const char *nome, const char *cargo, float sal
     printf("[RH] Estado: PENDENTE\n");
     printf("[RH] =============================\n");
     
-    pthread_mutex_unlock(&mutex);
-    
     // Colocar em análise automaticamente após 2 segundos
-    sleep(2);
-    analisar_processo(novo->id);
+    agendar_evento_rh(EVENTO_INICIAR_ANALISE, novo, ATRASO_INICIO_ANALISE_MS, 0, 0);
+    
+    pthread_mutex_unlock(&mutex);
 }
 
 /* Colocar processo em análise */
 void analisar_processo(int id) {
     pthread_mutex_lock(&mutex);
     
-    ProcessoContratacao *proc = lista_processos;
-    while (proc) {
-        if (proc->id == id) {
-            if (proc->estado == PENDENTE) {
-                proc->estado = EM_ANALISE;
-                printf("[RH PROCESSO %03d] Estado: EM ANÁLISE\n", id);
-                
-                // Iniciar thread para simular tempo de análise
-                pthread_create(&proc->thread_processo, NULL, 
-                              thread_processo_contratacao, proc);
-                pthread_detach(proc->thread_processo);
-                
-            } else {
-                printf("[RH PROCESSO %03d] Não pode ser analisado (estado: %d)\n", 
-                       id, proc->estado);
-            }
-            pthread_mutex_unlock(&mutex);
-            return;
+    ProcessoContratacao *proc = indice_procurar(&indice_processos, id);
+    if (!proc) {
+        printf("[RH ERRO] Processo %03d não encontrado!\n", id);
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
+    
+    if (proc->estado == PENDENTE) {
+        mudar_estado(proc, EM_ANALISE);
+        printf("[RH PROCESSO %03d] Estado: EM ANÁLISE\n", id);
+        
+        // Simular tempo de análise (1-2 minutos em segundos)
+        int tempo_analise = TEMPO_CONTRATACAO_MIN +
+                           (rand() % (TEMPO_CONTRATACAO_MAX - TEMPO_CONTRATACAO_MIN + 1));
+        printf("[RH PROCESSO %03d] Tempo estimado: %d segundos\n", id, tempo_analise);
+        
+        // Os avisos de progresso e o fim são eventos no motor
+        for (int s = INTERVALO_PROGRESSO_ANALISE; s < tempo_analise;
+             s += INTERVALO_PROGRESSO_ANALISE) {
+            agendar_evento_rh(EVENTO_PROGRESSO_ANALISE, proc, s * 1000L, s, tempo_analise);
         }
-        proc = proc->prox;
+        agendar_evento_rh(EVENTO_FIM_ANALISE, proc, tempo_analise * 1000L,
+                          tempo_analise, tempo_analise);
+    } else {
+        printf("[RH PROCESSO %03d] Não pode ser analisado (estado: %d)\n", 
+               id, proc->estado);
     }
     
-    printf("[RH ERRO] Processo %03d não encontrado!\n", id);
     pthread_mutex_unlock(&mutex);
 }
 
@@ -322,31 +668,32 @@ void concluir_contratacao(int id) {
         return;
     }
     
-    ProcessoContratacao *proc = lista_processos;
-    while (proc) {
-        if (proc->id == id && proc->estado == APROVADO) {
-            proc->estado = CONTRATADO;
-            proc->data_conclusao = time(NULL);
-            
-            // Adicionar à lista de contratados
-            adicionar_contratado(id, proc->nome, proc->cargo, proc->salario);
-            
-            printf("[RH] === CONTRATAÇÃO CONCLUÍDA ===\n");
-            printf("[RH] ID: %03d\n", id);
-            printf("[RH] Nome: %s\n", proc->nome);
-            printf("[RH] Cargo: %s\n", proc->cargo);
-            printf("[RH] Salário: %.2f\n", proc->salario);
-            printf("[RH] Vagas restantes: %d/%d\n", 
-                   LIMITE_CONTRATACOES - ativos - 1, LIMITE_CONTRATACOES);
-            printf("[RH] ============================\n");
-            
-            pthread_mutex_unlock(&mutex);
-            return;
-        }
-        proc = proc->prox;
+    ProcessoContratacao *proc = indice_procurar(&indice_processos, id);
+    if (!proc || proc->estado != APROVADO) {
+        printf("[RH ERRO] Processo %03d não encontrado ou não aprovado!\n", id);
+        pthread_mutex_unlock(&mutex);
+        return;
     }
     
-    printf("[RH ERRO] Processo %03d não encontrado ou não aprovado!\n", id);
+    // Adicionar à lista de contratados
+    if (!adicionar_contratado(id, proc->nome, proc->cargo, proc->salario)) {
+        printf("[RH ERRO] Sem memória para registar o funcionário %03d\n", id);
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
+    
+    mudar_estado(proc, CONTRATADO);
+    proc->data_conclusao = time(NULL);
+    
+    printf("[RH] === CONTRATAÇÃO CONCLUÍDA ===\n");
+    printf("[RH] ID: %03d\n", id);
+    printf("[RH] Nome: %s\n", proc->nome);
+    printf("[RH] Cargo: %s\n", proc->cargo);
+    printf("[RH] Salário: %.2f\n", proc->salario);
+    printf("[RH] Vagas restantes: %d/%d\n", 
+           LIMITE_CONTRATACOES - ativos - 1, LIMITE_CONTRATACOES);
+    printf("[RH] ============================\n");
+    
     pthread_mutex_unlock(&mutex);
 }
 
@@ -354,112 +701,112 @@ void concluir_contratacao(int id) {
 void rejeitar_processo(int id) {
     pthread_mutex_lock(&mutex);
     
-    ProcessoContratacao *proc = lista_processos;
-    while (proc) {
-        if (proc->id == id && 
-           (proc->estado == PENDENTE || proc->estado == EM_ANALISE)) {
-            proc->estado = REJEITADO;
-            proc->data_conclusao = time(NULL);
-            processos_rejeitados++;
-            
-            printf("[RH PROCESSO %03d] ❌ REJEITADO\n", id);
-            printf("[RH] Motivo: Não atende aos requisitos\n");
-            
-            pthread_mutex_unlock(&mutex);
-            return;
-        }
-        proc = proc->prox;
+    ProcessoContratacao *proc = indice_procurar(&indice_processos, id);
+    if (!proc || (proc->estado != PENDENTE && proc->estado != EM_ANALISE)) {
+        printf("[RH ERRO] Processo %03d não encontrado ou não pode ser rejeitado!\n", id);
+        pthread_mutex_unlock(&mutex);
+        return;
     }
     
-    printf("[RH ERRO] Processo %03d não encontrado ou não pode ser rejeitado!\n", id);
+    mudar_estado(proc, REJEITADO);
+    proc->data_conclusao = time(NULL);
+    processos_rejeitados++;
+    
     pthread_mutex_unlock(&mutex);
+    
+    printf("[RH PROCESSO %03d] ❌ REJEITADO\n", id);
+    printf("[RH] Motivo: Não atende aos requisitos\n");
 }
 
 /* Cancelar processo */
 void cancelar_processo(int id) {
     pthread_mutex_lock(&mutex);
     
-    ProcessoContratacao *proc = lista_processos;
-    while (proc) {
-        if (proc->id == id) {
-            proc->estado = CANCELADO;
-            proc->data_conclusao = time(NULL);
-            
-            printf("[RH PROCESSO %03d] CANCELADO\n", id);
-            
-            pthread_mutex_unlock(&mutex);
-            return;
-        }
-        proc = proc->prox;
+    ProcessoContratacao *proc = indice_procurar(&indice_processos, id);
+    if (!proc) {
+        printf("[RH ERRO] Processo %03d não encontrado!\n", id);
+        pthread_mutex_unlock(&mutex);
+        return;
     }
     
-    printf("[RH ERRO] Processo %03d não encontrado!\n", id);
+    mudar_estado(proc, CANCELADO);
+    proc->data_conclusao = time(NULL);
+    
     pthread_mutex_unlock(&mutex);
+    
+    printf("[RH PROCESSO %03d] CANCELADO\n", id);
 }
 
 /* ========== FUNÇÕES DE CONTRATADOS ========== */
 
-/* Adicionar funcionário contratado */
-void adicionar_contratado(int id, const char *nome, const char *cargo, float salario) {
+/* Adicionar funcionário contratado (mutex adquirido pelo chamador).
+ * Retorna 0 se faltou memória: nada fica registado. */
+int adicionar_contratado(int id, const char *nome, const char *cargo, float salario) {
     Contratacao *novo = malloc(sizeof(Contratacao));
-    if (!novo) return;
+    if (!novo) return 0;
 
     novo->id = id;
+    if (!indice_inserir(&indice_contratados, novo)) {
+        free(novo);
+        return 0;
+    }
+
     novo->data_contratacao = time(NULL);
     strncpy(novo->nome, nome, sizeof(novo->nome) - 1);
     strncpy(novo->cargo, cargo, sizeof(novo->cargo) - 1);
     novo->salario = salario;
+    novo->ant = NULL;
     novo->prox = lista_contratados;
+    if (lista_contratados) lista_contratados->ant = novo;
     lista_contratados = novo;
     total_contratacoes++;
     
-    // Verificar interrupção após adicionar
-    verificar_interrupcao_rh();
+    // Verificar interrupção após adicionar, sem voltar a tomar o mutex
+    if (total_contratacoes > total_demissoes) {
+        printf("[RH VERIFICAÇÃO] Condição de interrupção detectada!\n");
+        alertar_interrupcao_rh(total_contratacoes, total_demissoes);
+    }
+    return 1;
 }
 
 /* Demitir funcionário */
 void demitir_funcionario(int id) {
+    traco_demissao(id);
+    
     pthread_mutex_lock(&mutex);
 
-    Contratacao *anterior = NULL;
-    Contratacao *atual = lista_contratados;
-    
-    while (atual) {
-        if (atual->id == id) {
-            if (anterior) {
-                anterior->prox = atual->prox;
-            } else {
-                lista_contratados = atual->prox;
-            }
-            
-            printf("[RH] === DEMISSÃO REALIZADA ===\n");
-            printf("[RH] ID: %03d\n", id);
-            printf("[RH] Nome: %s\n", atual->nome);
-            printf("[RH] Cargo: %s\n", atual->cargo);
-            printf("[RH] =========================\n");
-            
-            free(atual);
-            total_demissoes++;
-            
-            // Verificar se há processos aprovados aguardando
-            ProcessoContratacao *proc = lista_processos;
-            while (proc) {
-                if (proc->estado == APROVADO) {
-                    printf("[RH AVISO] Processo %03d (%s) pode ser concluído agora!\n",
-                           proc->id, proc->nome);
-                }
-                proc = proc->prox;
-            }
-            
-            pthread_mutex_unlock(&mutex);
-            return;
-        }
-        anterior = atual;
-        atual = atual->prox;
+    Contratacao *atual = indice_procurar(&indice_contratados, id);
+    if (!atual) {
+        printf("[RH ERRO] Funcionário ID %03d não encontrado!\n", id);
+        pthread_mutex_unlock(&mutex);
+        return;
     }
-
-    printf("[RH ERRO] Funcionário ID %03d não encontrado!\n", id);
+    
+    indice_remover(&indice_contratados, atual);
+    if (atual->ant) atual->ant->prox = atual->prox;
+    else lista_contratados = atual->prox;
+    if (atual->prox) atual->prox->ant = atual->ant;
+    total_demissoes++;
+    
+    // Processos aprovados à espera de vaga: basta a contagem por estado,
+    // sem percorrer a lista de processos com o mutex adquirido
+    int aprovados = atomic_load_explicit(&processos_por_estado[APROVADO], memory_order_relaxed);
+    
     pthread_mutex_unlock(&mutex);
+    
+    if (aprovados > 0) {
+        printf("[RH AVISO] %d processo(s) aprovado(s) pode(m) ser concluído(s) agora!\n",
+               aprovados);
+    }
+    
+    // O registo já saiu da lista e do índice: imprimir fora do mutex
+    printf("[RH] === DEMISSÃO REALIZADA ===\n");
+    printf("[RH] ID: %03d\n", id);
+    printf("[RH] Nome: %s\n", atual->nome);
+    printf("[RH] Cargo: %s\n", atual->cargo);
+    printf("[RH] =========================\n");
+    
+    free(atual);
 }
 
 /* ========== FUNÇÕES DE RELATÓRIO ========== */
@@ -585,21 +932,20 @@ void exibir_estatisticas(void) {
     printf("[RH]    Processos aprovados: %d\n", processos_aprovados);
     printf("[RH]    Processos rejeitados: %d\n", processos_rejeitados);
     
-    int pendentes = 0, em_analise = 0, aprovados = 0;
-    ProcessoContratacao *proc = lista_processos;
-    while (proc) {
-        switch(proc->estado) {
-            case PENDENTE: pendentes++; break;
-            case EM_ANALISE: em_analise++; break;
-            case APROVADO: aprovados++; break;
-            default: break;
-        }
-        proc = proc->prox;
-    }
+    int estados[NUM_ESTADOS_PROCESSO];
+    obter_contagem_estados(estados);
+    
+    printf("[RH]    Processos pendentes: %d\n", estados[PENDENTE]);
+    printf("[RH]    Processos em análise: %d\n", estados[EM_ANALISE]);
+    printf("[RH]    Processos aprovados aguardando: %d\n", estados[APROVADO]);
+    printf("[RH]    Processos cancelados: %d\n", estados[CANCELADO]);
     
-    printf("[RH]    Processos pendentes: %d\n", pendentes);
-    printf("[RH]    Processos em análise: %d\n", em_analise);
-    printf("[RH]    Processos aprovados aguardando: %d\n", aprovados);
+    pthread_mutex_lock(&motor.lock);
+    int eventos_pendentes = motor.pendentes;
+    long long eventos_disparados = motor.disparados;
+    pthread_mutex_unlock(&motor.lock);
+    printf("[RH]    Eventos agendados: %d (disparados: %lld)\n",
+           eventos_pendentes, eventos_disparados);
     
     printf("\n[RH] 3. INTERRUPÇÕES:\n");
     printf("[RH]    Interrupções ativas: %s\n", interrupcao_ativa ? "SIM" : "NÃO");
@@ -641,6 +987,20 @@ int get_total_demissoes(void) {
     return d;
 }
 
+/* Processos que ocupam lugar no limite de simultâneos */
+int get_processos_ativos(void) {
+    return atomic_load_explicit(&processos_por_estado[PENDENTE], memory_order_relaxed) +
+           atomic_load_explicit(&processos_por_estado[EM_ANALISE], memory_order_relaxed);
+}
+
+/* Cópia das contagens por estado; cada valor é exato, mas entre dois
+ * estados pode faltar ou sobrar um processo em transição */
+void obter_contagem_estados(int destino[NUM_ESTADOS_PROCESSO]) {
+    for (int e = 0; e < NUM_ESTADOS_PROCESSO; e++) {
+        destino[e] = atomic_load_explicit(&processos_por_estado[e], memory_order_relaxed);
+    }
+}
+
 /* Obter funcionários ativos */
 int get_funcionarios_ativos(void) {
     return get_total_contratacoes() - get_total_demissoes();
@@ -663,6 +1023,9 @@ void limpar_lista(void) {
         lista_processos = lista_processos->prox;
         free(tmp);
     }
+    
+    indice_libertar(&indice_contratados);
+    indice_libertar(&indice_processos);
 
     total_contratacoes = 0;
     total_demissoes = 0;
@@ -670,6 +1033,9 @@ void limpar_lista(void) {
     processos_aprovados = 0;
     processos_rejeitados = 0;
     interrupcao_ativa = 0;
+    for (int e = 0; e < NUM_ESTADOS_PROCESSO; e++) {
+        atomic_store(&processos_por_estado[e], 0);
+    }
 
     pthread_mutex_unlock(&mutex);
 }
\ No newline at end of file
@@ -0,0 +1,373 @@
+#include "coordenador.h"
+#include "estoque.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define TAMANHO_MAXIMO_RESPOSTA (sizeof(RespostaCoordenador) + 4 * (LOTE_MAXIMO_COORDENADOR + 1))
+
+/* Um nó ligado: buffers de entrada e saída para servir pedidos em rajada */
+typedef struct {
+    int fd;
+    int entrada_tamanho;
+    int saida_tamanho;
+    int cedidos;              // Cartões deste nó por vender ou devolver
+    unsigned char entrada[BUFFER_LIGACAO_COORDENADOR];
+    unsigned char saida[BUFFER_LIGACAO_COORDENADOR];
+} LigacaoCoordenador;
+
+static LigacaoCoordenador ligacoes[MAX_LIGACOES_COORDENADOR];
+#define DONO_QUARENTENA -1
+
+static int dono_cartao[MAX_CARTOES];   // Ligação (+1) a quem o cartão foi cedido, ou quarentena
+static volatile sig_atomic_t coordenador_ativo = 0;
+static long long pedidos_servidos = 0;
+
+/* ========== ENDEREÇOS ========== */
+
+int coordenador_abrir_endereco(const char* endereco, int servidor) {
+    if (!endereco || !*endereco) return -1;
+
+    struct sockaddr_un unix_addr;
+    struct sockaddr_in tcp_addr;
+    struct sockaddr* addr;
+    socklen_t tamanho;
+    const char* dois_pontos = strrchr(endereco, ':');
+    int tcp = dois_pontos && !strchr(endereco, '/');
+
+    if (tcp) {
+        char host[64];
+        size_t tamanho_host = (size_t)(dois_pontos - endereco);
+        if (tamanho_host == 0 || tamanho_host >= sizeof(host)) return -1;
+        memcpy(host, endereco, tamanho_host);
+        host[tamanho_host] = '\0';
+
+        memset(&tcp_addr, 0, sizeof(tcp_addr));
+        tcp_addr.sin_family = AF_INET;
+        tcp_addr.sin_port = htons((uint16_t)atoi(dois_pontos + 1));
+        if (inet_pton(AF_INET, strcmp(host, "localhost") == 0 ? "127.0.0.1" : host,
+                      &tcp_addr.sin_addr) != 1) {
+            printf("[COORDENADOR] Endereço inválido: %s\n", endereco);
+            return -1;
+        }
+        addr = (struct sockaddr*)&tcp_addr;
+        tamanho = sizeof(tcp_addr);
+    } else {
+        memset(&unix_addr, 0, sizeof(unix_addr));
+        unix_addr.sun_family = AF_UNIX;
+        if (strlen(endereco) >= sizeof(unix_addr.sun_path)) {
+            printf("[COORDENADOR] Caminho do socket demasiado longo: %s\n", endereco);
+            return -1;
+        }
+        strcpy(unix_addr.sun_path, endereco);
+        addr = (struct sockaddr*)&unix_addr;
+        tamanho = sizeof(unix_addr);
+    }
+
+    int fd = socket(addr->sa_family, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    int um = 1;
+    if (servidor) {
+        if (tcp) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+        } else {
+            unlink(endereco);   // Socket deixado por uma execução anterior
+        }
+        if (bind(fd, addr, tamanho) != 0 || listen(fd, MAX_LIGACOES_COORDENADOR) != 0) {
+            printf("[COORDENADOR] Não foi possível escutar em %s: %s\n", endereco, strerror(errno));
+            close(fd);
+            return -1;
+        }
+    } else if (connect(fd, addr, tamanho) != 0) {
+        printf("[COORDENADOR] Não foi possível ligar a %s: %s\n", endereco, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    // Pedidos pequenos: sem esperar por mais dados antes de enviar
+    if (tcp) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um));
+    return fd;
+}
+
+/* ========== PEDIDOS ========== */
+
+static void escrever_inteiro(LigacaoCoordenador* l, int32_t valor) {
+    memcpy(l->saida + l->saida_tamanho, &valor, sizeof(valor));
+    l->saida_tamanho += sizeof(valor);
+}
+
+static void escrever_resposta(LigacaoCoordenador* l, int32_t estado, uint32_t quantidade) {
+    RespostaCoordenador resposta = { estado, quantidade };
+    memcpy(l->saida + l->saida_tamanho, &resposta, sizeof(resposta));
+    l->saida_tamanho += sizeof(resposta);
+}
+
+/* Executa um pedido completo; escreve a resposta no buffer de saída */
+static void executar_pedido(int indice, const PedidoCoordenador* pedido, const int32_t* ids) {
+    LigacaoCoordenador* l = &ligacoes[indice];
+    int aceites = 0;
+
+    switch (pedido->operacao) {
+        case COORD_RESERVAR: {
+            // Resposta escrita depois de saber quantos cartões houve
+            int inicio = l->saida_tamanho;
+            escrever_resposta(l, 0, 0);
+            for (uint32_t i = 0; i < pedido->quantidade; i++) {
+                int id = reter_cartao_fragmento(0, TTL_CEDENCIA_COORDENADOR);
+                if (id < 0) break;
+                dono_cartao[id] = indice + 1;
+                escrever_inteiro(l, id);
+                aceites++;
+            }
+            RespostaCoordenador resposta = { 0, (uint32_t)aceites };
+            memcpy(l->saida + inicio, &resposta, sizeof(resposta));
+            l->cedidos += aceites;
+            break;
+        }
+        case COORD_LIBERAR:
+        case COORD_VENDER: {
+            // Só conta o que foi cedido a este nó ou está em quarentena (o
+            // nó que o tinha voltou a ligar-se e confirma o que vendeu).
+            // Resposta: os aceites e depois os ids recusados
+            int inicio = l->saida_tamanho;
+            escrever_resposta(l, 0, 0);
+            escrever_inteiro(l, 0);
+            int recusados = 0;
+            for (uint32_t i = 0; i < pedido->quantidade; i++) {
+                int id = ids[i];
+                int aceite = 0;
+                if (id >= 0 && id < estoque_total() &&
+                    (dono_cartao[id] == indice + 1 || dono_cartao[id] == DONO_QUARENTENA)) {
+                    if (dono_cartao[id] == indice + 1) l->cedidos--;
+                    dono_cartao[id] = 0;
+                    aceite = pedido->operacao == COORD_VENDER ? confirmar_retencao(id)
+                                                              : cancelar_retencao(id);
+                }
+                if (aceite) {
+                    aceites++;
+                } else {
+                    escrever_inteiro(l, id);
+                    recusados++;
+                    if (pedido->operacao == COORD_VENDER) {
+                        printf("[COORDENADOR] Venda do cartão %d recusada: não está cedido a este nó "
+                               "(quarentena expirada?)\n", id);
+                    }
+                }
+            }
+            RespostaCoordenador resposta = { 0, (uint32_t)(1 + recusados) };
+            memcpy(l->saida + inicio, &resposta, sizeof(resposta));
+            memcpy(l->saida + inicio + sizeof(resposta), &aceites, sizeof(int32_t));
+            break;
+        }
+        case COORD_CONTAGEM:
+            escrever_resposta(l, 0, 4);
+            escrever_inteiro(l, estoque_disponivel());
+            escrever_inteiro(l, estoque_retido());
+            escrever_inteiro(l, estoque_vendido());
+            escrever_inteiro(l, estoque_total());
+            break;
+        default:
+            escrever_resposta(l, -1, 0);
+            break;
+    }
+    pedidos_servidos++;
+}
+
+/* Serve os pedidos completos no buffer de entrada enquanto houver espaço
+ * para a resposta. Retorna 0 se o nó enviou um pedido inválido. */
+static int processar_entrada(int indice) {
+    LigacaoCoordenador* l = &ligacoes[indice];
+    int consumido = 0;
+
+    while (l->entrada_tamanho - consumido >= (int)sizeof(PedidoCoordenador) &&
+           BUFFER_LIGACAO_COORDENADOR - l->saida_tamanho >= (int)TAMANHO_MAXIMO_RESPOSTA) {
+        PedidoCoordenador pedido;
+        memcpy(&pedido, l->entrada + consumido, sizeof(pedido));
+        if (pedido.quantidade > LOTE_MAXIMO_COORDENADOR) return 0;
+
+        int corpo = (pedido.operacao == COORD_LIBERAR || pedido.operacao == COORD_VENDER)
+                    ? (int)pedido.quantidade * 4 : 0;
+        if (l->entrada_tamanho - consumido < (int)sizeof(pedido) + corpo) break;
+
+        int32_t ids[LOTE_MAXIMO_COORDENADOR];
+        memcpy(ids, l->entrada + consumido + sizeof(pedido), corpo);
+        executar_pedido(indice, &pedido, ids);
+        consumido += sizeof(pedido) + corpo;
+    }
+
+    if (consumido > 0) {
+        memmove(l->entrada, l->entrada + consumido, l->entrada_tamanho - consumido);
+        l->entrada_tamanho -= consumido;
+    }
+    return 1;
+}
+
+/* Envia o que couber sem bloquear. Retorna 0 se a ligação caiu. */
+static int enviar_saida(LigacaoCoordenador* l) {
+    if (l->saida_tamanho == 0) return 1;
+
+    ssize_t enviado = send(l->fd, l->saida, l->saida_tamanho, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (enviado < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+
+    memmove(l->saida, l->saida + enviado, l->saida_tamanho - enviado);
+    l->saida_tamanho -= (int)enviado;
+    return 1;
+}
+
+/* ========== LIGAÇÕES ========== */
+
+static void aceitar_ligacao(int escuta) {
+    int fd = accept(escuta, NULL, NULL);
+    if (fd < 0) return;
+
+    for (int i = 0; i < MAX_LIGACOES_COORDENADOR; i++) {
+        if (ligacoes[i].fd >= 0) continue;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        int um = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um));   // Ignorado em Unix
+        ligacoes[i].fd = fd;
+        ligacoes[i].entrada_tamanho = 0;
+        ligacoes[i].saida_tamanho = 0;
+        ligacoes[i].cedidos = 0;
+        printf("[COORDENADOR] Nó %d ligado\n", i + 1);
+        return;
+    }
+
+    printf("[COORDENADOR] Ligação recusada: %d nós já ligados\n", MAX_LIGACOES_COORDENADOR);
+    close(fd);
+}
+
+/* Um nó que sai com cartões cedidos (normalmente porque caiu) pode já os
+ * ter vendido sem o ter confirmado: ficam em quarentena, retidos durante
+ * QUARENTENA_COORDENADOR segundos, em que o nó ainda os pode confirmar ou
+ * devolver; depois o recolhedor devolve-os ao estoque */
+static void fechar_ligacao(int indice) {
+    LigacaoCoordenador* l = &ligacoes[indice];
+    int em_quarentena = 0;
+
+    if (l->cedidos > 0) {
+        int total = estoque_total();
+        for (int id = 0; id < total; id++) {
+            if (dono_cartao[id] != indice + 1) continue;
+            dono_cartao[id] = DONO_QUARENTENA;
+            if (renovar_retencao(id, QUARENTENA_COORDENADOR)) em_quarentena++;
+        }
+    }
+
+    close(l->fd);
+    l->fd = -1;
+    if (em_quarentena > 0) {
+        printf("[COORDENADOR] Nó %d desligado (%d cartões em quarentena por %ds)\n",
+               indice + 1, em_quarentena, QUARENTENA_COORDENADOR);
+    } else {
+        printf("[COORDENADOR] Nó %d desligado\n", indice + 1);
+    }
+}
+
+static void tratar_ligacao(int indice, short eventos) {
+    LigacaoCoordenador* l = &ligacoes[indice];
+
+    // Com a entrada cheia não se lê (recv de 0 bytes retornaria 0, como
+    // um fecho): primeiro as respostas pendentes têm de sair
+    if ((eventos & (POLLIN | POLLHUP | POLLERR)) && l->entrada_tamanho < BUFFER_LIGACAO_COORDENADOR) {
+        ssize_t lido = recv(l->fd, l->entrada + l->entrada_tamanho,
+                            BUFFER_LIGACAO_COORDENADOR - l->entrada_tamanho, MSG_DONTWAIT);
+        if (lido == 0 || (lido < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            fechar_ligacao(indice);
+            return;
+        }
+        if (lido > 0) l->entrada_tamanho += (int)lido;
+    }
+
+    // Responder a tudo o que chegou com uma só escrita
+    if (!processar_entrada(indice)) {
+        printf("[COORDENADOR] Nó %d enviou um pedido inválido\n", indice + 1);
+        fechar_ligacao(indice);
+        return;
+    }
+    if (!enviar_saida(l)) fechar_ligacao(indice);
+}
+
+/* ========== SERVIDOR ========== */
+
+static void handler_parar_coordenador(int sig) {
+    (void)sig;
+    coordenador_ativo = 0;
+}
+
+int executar_coordenador_estoque(const char* endereco) {
+    int escuta = coordenador_abrir_endereco(endereco, 1);
+    if (escuta < 0) return 0;
+
+    // Um só fragmento: o coordenador é o único que vende
+    inicializar_estoque_fragmentado(1);
+    iniciar_recolhedor_retencoes();   // Fim das quarentenas
+    iniciar_reabastecedor_estoque(LOTE_REPOSICAO_PADRAO, LIMIAR_REPOSICAO_PADRAO);
+    memset(dono_cartao, 0, sizeof(dono_cartao));
+    for (int i = 0; i < MAX_LIGACOES_COORDENADOR; i++) ligacoes[i].fd = -1;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handler_parar_coordenador;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("[COORDENADOR] A servir o estoque em %s (%d cartões). Ctrl+C para terminar\n",
+           endereco, estoque_total());
+    fflush(stdout);
+
+    struct pollfd fds[MAX_LIGACOES_COORDENADOR + 1];
+    int indices[MAX_LIGACOES_COORDENADOR + 1];
+    coordenador_ativo = 1;
+
+    while (coordenador_ativo) {
+        int n = 0;
+        fds[n].fd = escuta;
+        fds[n].events = POLLIN;
+        indices[n++] = -1;
+        for (int i = 0; i < MAX_LIGACOES_COORDENADOR; i++) {
+            if (ligacoes[i].fd < 0) continue;
+            fds[n].fd = ligacoes[i].fd;
+            fds[n].events = (ligacoes[i].entrada_tamanho < BUFFER_LIGACAO_COORDENADOR ? POLLIN : 0) |
+                            (ligacoes[i].saida_tamanho > 0 ? POLLOUT : 0);
+            indices[n++] = i;
+        }
+
+        if (poll(fds, n, INTERVALO_POLL_COORDENADOR_MS) < 0) {
+            if (errno == EINTR) continue;
+            printf("[COORDENADOR] poll falhou: %s\n", strerror(errno));
+            break;
+        }
+
+        for (int k = 1; k < n; k++) {
+            if (fds[k].revents) tratar_ligacao(indices[k], fds[k].revents);
+        }
+        if (fds[0].revents & POLLIN) aceitar_ligacao(escuta);
+        fflush(stdout);
+    }
+
+    for (int i = 0; i < MAX_LIGACOES_COORDENADOR; i++) {
+        if (ligacoes[i].fd >= 0) fechar_ligacao(i);
+    }
+    close(escuta);
+    if (!strchr(endereco, ':') || strchr(endereco, '/')) unlink(endereco);
+
+    parar_reabastecedor_estoque();
+    printf("[COORDENADOR] Terminado: %lld pedidos, %d vendidos, %d disponíveis de %d\n",
+           pedidos_servidos, estoque_vendido(), estoque_disponivel(), estoque_total());
+    liberar_estoque();
+    return 1;
+}
@@ -0,0 +1,305 @@
+#include "diario.h"
+#include "relogio.h"
+#include "afinidade.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/* Buffer de registos de uma thread. O lock só é disputado quando o
+ * diário é descarregado por outra thread; no caminho normal cada thread
+ * usa o seu, sem partilha. */
+typedef struct BufferDiario {
+    pthread_mutex_t lock;
+    int usado;
+    int orfao;                      // A thread dona já terminou
+    struct BufferDiario* proximo;   // Lista de todos os buffers (para descarregar)
+    RegistoVenda registos[DIARIO_REGISTOS_POR_BUFFER];
+} BufferDiario;
+
+/* Ordem de locks: lista_mutex -> lock do buffer -> ficheiro_mutex */
+static FILE* ficheiro_diario = NULL;
+static atomic_int diario_ligado = 0;
+static atomic_llong total_registos = 0;
+static BufferDiario* buffers_diario = NULL;
+static pthread_mutex_t lista_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t ficheiro_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t chave_diario;
+static pthread_once_t chave_diario_once = PTHREAD_ONCE_INIT;
+
+/* Escreve os registos de um buffer no ficheiro (lock do buffer adquirido) */
+static void escrever_registos(BufferDiario* buffer) {
+    if (buffer->usado == 0) return;
+
+    pthread_mutex_lock(&ficheiro_mutex);
+    if (ficheiro_diario) {
+        fwrite(buffer->registos, sizeof(RegistoVenda), buffer->usado, ficheiro_diario);
+    }
+    pthread_mutex_unlock(&ficheiro_mutex);
+    buffer->usado = 0;
+}
+
+/* Fim da thread: o buffer fica registado até ser descarregado */
+static void marcar_diario_orfao(void* ptr) {
+    pthread_mutex_lock(&lista_mutex);
+    ((BufferDiario*)ptr)->orfao = 1;
+    pthread_mutex_unlock(&lista_mutex);
+}
+
+static void criar_chave_diario(void) {
+    pthread_key_create(&chave_diario, marcar_diario_orfao);
+}
+
+/* Buffer da thread atual */
+static BufferDiario* obter_buffer_diario(void) {
+    pthread_once(&chave_diario_once, criar_chave_diario);
+
+    BufferDiario* buffer = (BufferDiario*)pthread_getspecific(chave_diario);
+    if (!buffer) {
+        // No nó NUMA da thread que o vai usar
+        buffer = (BufferDiario*)alocar_memoria_local(sizeof(BufferDiario));
+        if (!buffer) return NULL;
+        pthread_mutex_init(&buffer->lock, NULL);
+        buffer->usado = 0;
+        buffer->orfao = 0;
+
+        pthread_mutex_lock(&lista_mutex);
+        buffer->proximo = buffers_diario;
+        buffers_diario = buffer;
+        pthread_mutex_unlock(&lista_mutex);
+
+        pthread_setspecific(chave_diario, buffer);
+    }
+    return buffer;
+}
+
+/* Abrir (ou criar) o diário; escreve o cabeçalho */
+int diario_abrir(const char* caminho) {
+    if (!caminho) return 0;
+
+    FILE* f = fopen(caminho, "wb");
+    if (!f) {
+        perror("[DIARIO] Erro ao abrir diário");
+        return 0;
+    }
+
+    CabecalhoDiario cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magia, DIARIO_MAGIA, sizeof(cabecalho.magia));
+    cabecalho.versao = DIARIO_VERSAO;
+    cabecalho.tamanho_registo = sizeof(RegistoVenda);
+    if (fwrite(&cabecalho, sizeof(cabecalho), 1, f) != 1) {
+        perror("[DIARIO] Erro ao escrever cabeçalho");
+        fclose(f);
+        return 0;
+    }
+
+    diario_fechar();
+
+    pthread_mutex_lock(&ficheiro_mutex);
+    ficheiro_diario = f;
+    pthread_mutex_unlock(&ficheiro_mutex);
+    atomic_store_explicit(&total_registos, 0, memory_order_relaxed);
+    atomic_store_explicit(&diario_ligado, 1, memory_order_release);
+
+    printf("[DIARIO] Diário de vendas em '%s'\n", caminho);
+    return 1;
+}
+
+/* Fechar o diário (depois de paradas as vendas) */
+void diario_fechar(void) {
+    if (!atomic_exchange_explicit(&diario_ligado, 0, memory_order_acq_rel)) return;
+
+    diario_descarregar();
+
+    pthread_mutex_lock(&ficheiro_mutex);
+    if (ficheiro_diario) {
+        fclose(ficheiro_diario);
+        ficheiro_diario = NULL;
+    }
+    pthread_mutex_unlock(&ficheiro_mutex);
+
+    printf("[DIARIO] Diário fechado: %lld vendas registadas\n", diario_total_registos());
+}
+
+int diario_ativo(void) {
+    return atomic_load_explicit(&diario_ligado, memory_order_acquire);
+}
+
+/* Registar uma venda no buffer da thread */
+void diario_registar_venda(int cliente_id, TipoCliente tipo, time_t chegada,
+                           int cartao_id, int agencia_id, Turno turno) {
+    if (!atomic_load_explicit(&diario_ligado, memory_order_acquire)) return;
+
+    BufferDiario* buffer = obter_buffer_diario();
+    if (!buffer) return;
+
+    long long agora = relogio_agora_ns();
+    long long espera_ms = (agora / NS_POR_SEGUNDO - (long long)chegada) * 1000;
+
+    pthread_mutex_lock(&buffer->lock);
+    RegistoVenda* registo = &buffer->registos[buffer->usado++];
+    memset(registo, 0, sizeof(*registo));
+    registo->instante_ns = agora;
+    registo->cliente_id = cliente_id;
+    registo->cartao_id = cartao_id;
+    registo->agencia_id = agencia_id;
+    registo->espera_ms = espera_ms > 0 ? (int32_t)espera_ms : 0;
+    registo->tipo = (uint8_t)tipo;
+    registo->turno = (uint8_t)turno;
+
+    if (buffer->usado == DIARIO_REGISTOS_POR_BUFFER) escrever_registos(buffer);
+    pthread_mutex_unlock(&buffer->lock);
+
+    atomic_fetch_add_explicit(&total_registos, 1, memory_order_relaxed);
+}
+
+/* Escrever os buffers de todas as threads e libertar os órfãos */
+void diario_descarregar(void) {
+    pthread_mutex_lock(&lista_mutex);
+
+    BufferDiario** ligacao = &buffers_diario;
+    while (*ligacao) {
+        BufferDiario* b = *ligacao;
+        pthread_mutex_lock(&b->lock);
+        escrever_registos(b);
+        pthread_mutex_unlock(&b->lock);
+
+        if (b->orfao) {
+            *ligacao = b->proximo;
+            pthread_mutex_destroy(&b->lock);
+            libertar_memoria_numa(b, sizeof(BufferDiario));
+        } else {
+            ligacao = &b->proximo;
+        }
+    }
+
+    pthread_mutex_lock(&ficheiro_mutex);
+    if (ficheiro_diario) fflush(ficheiro_diario);
+    pthread_mutex_unlock(&ficheiro_mutex);
+
+    pthread_mutex_unlock(&lista_mutex);
+}
+
+long long diario_total_registos(void) {
+    return atomic_load_explicit(&total_registos, memory_order_relaxed);
+}
+
+/* ========== EXPORTAÇÃO POR COLUNAS ========== */
+
+typedef struct {
+    const char* nome;
+    const char* tipo;
+    size_t deslocamento;
+    size_t tamanho;
+} ColunaDiario;
+
+static const ColunaDiario colunas_diario[] = {
+    {"instante_ns", "int64", offsetof(RegistoVenda, instante_ns), sizeof(int64_t)},
+    {"cliente_id",  "int32", offsetof(RegistoVenda, cliente_id),  sizeof(int32_t)},
+    {"cartao_id",   "int32", offsetof(RegistoVenda, cartao_id),   sizeof(int32_t)},
+    {"agencia_id",  "int32", offsetof(RegistoVenda, agencia_id),  sizeof(int32_t)},
+    {"espera_ms",   "int32", offsetof(RegistoVenda, espera_ms),   sizeof(int32_t)},
+    {"tipo",        "uint8", offsetof(RegistoVenda, tipo),        sizeof(uint8_t)},
+    {"turno",       "uint8", offsetof(RegistoVenda, turno),       sizeof(uint8_t)},
+};
+
+#define NUM_COLUNAS_DIARIO (int)(sizeof(colunas_diario) / sizeof(colunas_diario[0]))
+
+/* Lê o diário em blocos e espalha cada campo pelo ficheiro da sua coluna */
+static long long copiar_por_colunas(FILE* entrada, FILE* saidas[]) {
+    RegistoVenda* bloco = (RegistoVenda*)malloc(DIARIO_REGISTOS_POR_BLOCO * sizeof(RegistoVenda));
+    unsigned char* coluna = (unsigned char*)malloc(DIARIO_REGISTOS_POR_BLOCO * sizeof(int64_t));
+    if (!bloco || !coluna) {
+        printf("[ERRO] Falha ao alocar memória para exportação\n");
+        free(coluna);
+        free(bloco);
+        return -1;
+    }
+
+    long long registos = 0;
+    size_t lidos;
+    while ((lidos = fread(bloco, sizeof(RegistoVenda), DIARIO_REGISTOS_POR_BLOCO, entrada)) > 0) {
+        for (int c = 0; c < NUM_COLUNAS_DIARIO; c++) {
+            const ColunaDiario* col = &colunas_diario[c];
+            for (size_t i = 0; i < lidos; i++) {
+                memcpy(coluna + i * col->tamanho,
+                       (const unsigned char*)&bloco[i] + col->deslocamento, col->tamanho);
+            }
+            fwrite(coluna, col->tamanho, lidos, saidas[c]);
+        }
+        registos += (long long)lidos;
+    }
+
+    free(coluna);
+    free(bloco);
+    return registos;
+}
+
+/* Manifesto: número de linhas e tipo de cada coluna */
+static void escrever_manifesto(const char* prefixo, long long registos) {
+    char caminho[512];
+    snprintf(caminho, sizeof(caminho), "%s.colunas.txt", prefixo);
+    FILE* manifesto = fopen(caminho, "w");
+    if (!manifesto) {
+        perror("[DIARIO] Erro ao criar manifesto");
+        return;
+    }
+
+    fprintf(manifesto, "registos,%lld\n", registos);
+    for (int c = 0; c < NUM_COLUNAS_DIARIO; c++) {
+        fprintf(manifesto, "%s,%s,%s.%s.col\n", colunas_diario[c].nome,
+                colunas_diario[c].tipo, prefixo, colunas_diario[c].nome);
+    }
+    fclose(manifesto);
+}
+
+long long exportar_diario_colunar(const char* caminho_diario, const char* prefixo) {
+    if (!caminho_diario || !prefixo) {
+        printf("[ERRO] Caminho de diário inválido\n");
+        return -1;
+    }
+
+    FILE* entrada = fopen(caminho_diario, "rb");
+    if (!entrada) {
+        perror("[DIARIO] Erro ao abrir diário");
+        return -1;
+    }
+
+    CabecalhoDiario cabecalho;
+    if (fread(&cabecalho, sizeof(cabecalho), 1, entrada) != 1 ||
+        memcmp(cabecalho.magia, DIARIO_MAGIA, sizeof(cabecalho.magia)) != 0 ||
+        cabecalho.versao != DIARIO_VERSAO ||
+        cabecalho.tamanho_registo != sizeof(RegistoVenda)) {
+        printf("[DIARIO] '%s' não é um diário de vendas válido\n", caminho_diario);
+        fclose(entrada);
+        return -1;
+    }
+
+    FILE* saidas[NUM_COLUNAS_DIARIO] = {0};
+    int abertas = 0;
+    char caminho[512];
+    for (; abertas < NUM_COLUNAS_DIARIO; abertas++) {
+        snprintf(caminho, sizeof(caminho), "%s.%s.col", prefixo, colunas_diario[abertas].nome);
+        saidas[abertas] = fopen(caminho, "wb");
+        if (!saidas[abertas]) {
+            perror("[DIARIO] Erro ao criar ficheiro de coluna");
+            break;
+        }
+    }
+
+    long long registos = -1;
+    if (abertas == NUM_COLUNAS_DIARIO) {
+        registos = copiar_por_colunas(entrada, saidas);
+    }
+    for (int c = 0; c < abertas; c++) fclose(saidas[c]);
+    fclose(entrada);
+
+    if (registos >= 0) {
+        escrever_manifesto(prefixo, registos);
+        printf("[DIARIO] %lld vendas exportadas por colunas para '%s.*.col'\n", registos, prefixo);
+    }
+    return registos;
+}
@@ -1,138 +1,1208 @@
-#include "estoque.h" 
+#include "estoque.h"
+#include "relogio.h"
+#include "afinidade.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include <string.h>
 
 /* Estoque global de cartões SIM */
-CartaoSIM estoque[TOTAL_CARTOES];
+CartaoSIM estoque[MAX_CARTOES];
 
-/* Mutex global para sincronização */
+/* Cartões existentes. Publicado com release só depois de o lote estar
+ * inicializado: quem lê ids abaixo deste valor vê cartões completos. */
+static atomic_int total_cartoes = 0;
+static pthread_mutex_t reposicao_lock = PTHREAD_MUTEX_INITIALIZER;  // Serializa produtores
+
+/* Mutex global: serializa operações estruturais (rebalanceamento e
+ * leituras do estoque completo). As vendas usam apenas o lock do fragmento. */
 pthread_mutex_t estoque_lock;
 
 /* Estatísticas */
-int vendas_realizadas = 0;
+atomic_int vendas_realizadas = 0;
 int vendas_empresas = 0;
 int vendas_publico = 0;
 
+/* Fragmento do estoque: cada agência reserva do seu próprio fragmento.
+ * Alinhado à linha de cache para que fragmentos vizinhos não partilhem linha. */
+typedef struct {
+    _Alignas(64) pthread_mutex_t lock;
+    int* livres;               // Pilha de ids disponíveis
+    int num_livres;
+    int cap_livres;
+    int* retidos;              // Ids em retenção temporária
+    int num_retidos;
+    int cap_retidos;
+    time_t proxima_expiracao;  // Expiração mais próxima entre as retenções
+    atomic_int disponiveis;    // Cópia de num_livres legível sem lock
+    atomic_int retencoes;      // Cópia de num_retidos legível sem lock
+} FragmentoEstoque;
+
+static FragmentoEstoque* fragmentos = NULL;
+static int num_fragmentos = 0;
+
+/* Anel de eventos de alteração do estoque. Cada evento é publicado com o
+ * lock do fragmento do cartão adquirido, pelo que a ordem das sequências
+ * coincide com a ordem real das alterações de cada cartão. O 'selo' vale
+ * seq + 1 quando o slot está publicado (0 enquanto está a ser escrito). */
+typedef struct {
+    atomic_ullong selo;
+    atomic_int tipo;
+    atomic_int cartao_id;
+    atomic_llong instante;
+} SlotEvento;
+
+static SlotEvento anel_eventos[CAPACIDADE_EVENTOS_ESTOQUE];
+static atomic_ullong proximo_seq_evento = 0;
+
+/* Total de cartões livres. Atualizado com o lock do fragmento adquirido, o
+ * que dá a cada transição um valor anterior exato para detetar limiares. */
+static atomic_int disponiveis_total = 0;
+
+/* Limiares (watermarks) registados */
+typedef struct {
+    atomic_int ativo;
+    atomic_int limiar;
+    _Atomic(CallbackLimiarEstoque) callback;   // NULL: apenas acorda quem aguarda
+    _Atomic(void*) arg;                        // Slots são reutilizados sem parar as vendas
+} LimiarEstoque;
+
+static LimiarEstoque limiares[MAX_LIMIARES_ESTOQUE];
+static atomic_int limiares_usados = 0;   // Slots já usados alguma vez
+static pthread_mutex_t limiar_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t limiar_cond = PTHREAD_COND_INITIALIZER;
+
+/* Transições que cruzaram algum limiar numa operação, reduzidas a um
+ * par (antes do primeiro cruzamento, depois do último): cada operação
+ * só move o total num sentido, pelo que o par cruza os mesmos limiares
+ * que os passos. Notificadas depois de libertar o lock do fragmento. */
+typedef struct {
+    int n;          // 0 se nenhum passo cruzou
+    int antes;
+    int depois;
+} Cruzamentos;
+
+/* Thread recolhedora de retenções expiradas */
+static pthread_t thread_recolhedor;
+static volatile int recolhedor_ativo = 0;
+static pthread_mutex_t recolhedor_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t recolhedor_cond = PTHREAD_COND_INITIALIZER;
+
+/* Thread de rebalanceamento entre fragmentos */
+static pthread_t thread_rebalanceador;
+static volatile int rebalanceador_ativo = 0;
+static int rebalanceamento_pedido = 0;
+static pthread_mutex_t rebalanceador_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t rebalanceador_cond = PTHREAD_COND_INITIALIZER;
+
+/* Thread de reposição de estoque */
+static pthread_t thread_reabastecedor;
+static volatile int reabastecedor_ativo = 0;
+static int reposicao_pedida = 0;
+static int lote_reposicao = LOTE_REPOSICAO_PADRAO;
+static int limiar_reposicao = LIMIAR_REPOSICAO_PADRAO;
+static int id_limiar_reposicao = -1;
+static pthread_mutex_t reabastecedor_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reabastecedor_cond = PTHREAD_COND_INITIALIZER;
+
+/* ========== FUNÇÕES INTERNAS ========== */
+
+/* Garante espaço para mais um elemento num vetor dinâmico de ids */
+static int garantir_capacidade(int** vetor, int* capacidade, int necessario) {
+    if (necessario <= *capacidade) return 1;
+
+    int nova = (*capacidade > 0) ? *capacidade : 16;
+    while (nova < necessario) nova *= 2;
+
+    int* novo = (int*)realloc(*vetor, nova * sizeof(int));
+    if (!novo) return 0;
+
+    *vetor = novo;
+    *capacidade = nova;
+    return 1;
+}
+
+/* Espaço para mais 'n' cartões livres (lock do fragmento adquirido) */
+static int garantir_livres(FragmentoEstoque* f, int n) {
+    return garantir_capacidade(&f->livres, &f->cap_livres, f->num_livres + n);
+}
+
+/* Operações sobre as listas de um fragmento (lock do fragmento adquirido).
+ * 'posicao' guarda o índice do cartão na lista onde está, para remoção O(1).
+ * Empilhar retorna 0 sem memória, deixando o cartão como estava. */
+static int empilhar_livre(FragmentoEstoque* f, int indice_fragmento, int id) {
+    if (!garantir_livres(f, 1)) return 0;
+
+    estoque[id].posicao = f->num_livres;
+    atomic_store_explicit(&estoque[id].fragmento, indice_fragmento, memory_order_relaxed);
+    f->livres[f->num_livres++] = id;
+    atomic_store_explicit(&f->disponiveis, f->num_livres, memory_order_relaxed);
+    return 1;
+}
+
+static int desempilhar_livre(FragmentoEstoque* f) {
+    if (f->num_livres == 0) return -1;
+
+    int id = f->livres[--f->num_livres];
+    atomic_store_explicit(&f->disponiveis, f->num_livres, memory_order_relaxed);
+    return id;
+}
+
+static void remover_livre(FragmentoEstoque* f, int id) {
+    int pos = estoque[id].posicao;
+    int ultimo = f->livres[--f->num_livres];
+
+    f->livres[pos] = ultimo;
+    estoque[ultimo].posicao = pos;
+    atomic_store_explicit(&f->disponiveis, f->num_livres, memory_order_relaxed);
+}
+
+static int adicionar_retido(FragmentoEstoque* f, int id, time_t expira) {
+    if (!garantir_capacidade(&f->retidos, &f->cap_retidos, f->num_retidos + 1)) return 0;
+
+    estoque[id].posicao = f->num_retidos;
+    f->retidos[f->num_retidos++] = id;
+    if (f->num_retidos == 1 || expira < f->proxima_expiracao) {
+        f->proxima_expiracao = expira;
+    }
+    atomic_store_explicit(&f->retencoes, f->num_retidos, memory_order_relaxed);
+    return 1;
+}
+
+static void remover_retido(FragmentoEstoque* f, int id) {
+    int pos = estoque[id].posicao;
+    int ultimo = f->retidos[--f->num_retidos];
+
+    f->retidos[pos] = ultimo;
+    estoque[ultimo].posicao = pos;
+    atomic_store_explicit(&f->retencoes, f->num_retidos, memory_order_relaxed);
+}
+
+/* Bloqueia o fragmento dono de um cartão. O dono de um cartão livre pode
+ * mudar durante um rebalanceamento, por isso confirma-se após o lock. */
+static FragmentoEstoque* bloquear_fragmento_do_cartao(int id) {
+    for (;;) {
+        int indice = atomic_load_explicit(&estoque[id].fragmento, memory_order_relaxed);
+        FragmentoEstoque* f = &fragmentos[indice];
+
+        pthread_mutex_lock(&f->lock);
+        if (atomic_load_explicit(&estoque[id].fragmento, memory_order_relaxed) == indice) {
+            return f;
+        }
+        pthread_mutex_unlock(&f->lock);
+    }
+}
+
+/* Publica um evento no anel (lock do fragmento do cartão adquirido) */
+static void publicar_evento(TipoEventoEstoque tipo, int cartao_id, time_t instante) {
+    unsigned long long seq = atomic_fetch_add_explicit(&proximo_seq_evento, 1,
+                                                       memory_order_relaxed);
+    SlotEvento* slot = &anel_eventos[seq & (CAPACIDADE_EVENTOS_ESTOQUE - 1)];
+
+    atomic_store_explicit(&slot->selo, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&slot->tipo, tipo, memory_order_relaxed);
+    atomic_store_explicit(&slot->cartao_id, cartao_id, memory_order_relaxed);
+    atomic_store_explicit(&slot->instante, (long long)instante, memory_order_relaxed);
+
+    atomic_store_explicit(&slot->selo, seq + 1, memory_order_release);
+}
+
+/* Indica se a transição antes -> depois cruza o limiar */
+static int cruza_limiar(int antes, int depois, int limiar) {
+    return (depois <= limiar && limiar < antes) || (antes <= limiar && limiar < depois);
+}
+
+/* Ajusta o total de livres (lock do fragmento adquirido) e anota se a
+ * transição cruzou o zero ou algum limiar registado */
+static void ajustar_disponiveis(int delta, Cruzamentos* cz) {
+    int antes = atomic_fetch_add_explicit(&disponiveis_total, delta, memory_order_relaxed);
+    int depois = antes + delta;
+    int cruzou = cruza_limiar(antes, depois, 0);
+
+    int usados = atomic_load_explicit(&limiares_usados, memory_order_acquire);
+    for (int i = 0; i < usados && !cruzou; i++) {
+        if (atomic_load_explicit(&limiares[i].ativo, memory_order_acquire) &&
+            cruza_limiar(antes, depois,
+                         atomic_load_explicit(&limiares[i].limiar, memory_order_relaxed))) {
+            cruzou = 1;
+        }
+    }
+
+    if (cruzou && cz) {
+        if (cz->n == 0) cz->antes = antes;
+        cz->depois = depois;
+        cz->n = 1;
+    }
+}
+
+/* Chama os callbacks e acorda quem aguarda (sem locks de fragmento) */
+static void notificar_cruzamentos(Cruzamentos* cz) {
+    if (!cz || cz->n == 0) return;
+
+    int usados = atomic_load_explicit(&limiares_usados, memory_order_acquire);
+    for (int i = 0; i < usados; i++) {
+        if (!atomic_load_explicit(&limiares[i].ativo, memory_order_acquire)) continue;
+
+        int limiar = atomic_load_explicit(&limiares[i].limiar, memory_order_relaxed);
+        CallbackLimiarEstoque callback =
+            atomic_load_explicit(&limiares[i].callback, memory_order_relaxed);
+        if (callback && cruza_limiar(cz->antes, cz->depois, limiar)) {
+            callback(limiar, cz->depois, cz->depois < cz->antes,
+                     atomic_load_explicit(&limiares[i].arg, memory_order_relaxed));
+        }
+    }
+
+    pthread_mutex_lock(&limiar_lock);
+    pthread_cond_broadcast(&limiar_cond);
+    pthread_mutex_unlock(&limiar_lock);
+}
+
+/* Pede ao rebalanceador uma passagem (fora de qualquer lock de fragmento) */
+static void pedir_rebalanceamento(void) {
+    // Modo virtual: sem rebalanceador, a passagem corre já na thread que
+    // conduz a simulação (a reprodução tem de mover os mesmos cartões)
+    if (relogio_virtual()) {
+        rebalancear_estoque();
+        return;
+    }
+
+    pthread_mutex_lock(&rebalanceador_lock);
+    rebalanceamento_pedido = 1;
+    pthread_cond_signal(&rebalanceador_cond);
+    pthread_mutex_unlock(&rebalanceador_lock);
+}
+
+/* Retira um cartão livre, preferindo o fragmento indicado. Se o fragmento
+ * local estiver seco, rouba um cartão de outro e pede rebalanceamento. */
+static int obter_cartao_livre(int fragmento, int novo_estado, int ttl_segundos) {
+    if (num_fragmentos <= 0) return -1;
+
+    int inicio = (fragmento >= 0 ? fragmento : 0) % num_fragmentos;
+    int cartao_id = -1;
+    int pedir = 0;
+    Cruzamentos cz = {0};
+
+    for (int k = 0; k < num_fragmentos && cartao_id == -1; k++) {
+        int indice = (inicio + k) % num_fragmentos;
+        FragmentoEstoque* f = &fragmentos[indice];
+
+        pthread_mutex_lock(&f->lock);
+
+        cartao_id = desempilhar_livre(f);
+        if (cartao_id != -1 && novo_estado == CARTAO_RETIDO &&
+            !adicionar_retido(f, cartao_id, relogio_agora() + ttl_segundos)) {
+            // Sem memória para a retenção: volta ao lugar que acabou de deixar
+            empilhar_livre(f, indice, cartao_id);
+            printf("[ERRO] Sem memória para reter o cartão %d\n", cartao_id);
+            cartao_id = -1;
+        }
+        if (cartao_id != -1) {
+            time_t agora = relogio_agora();
+
+            ajustar_disponiveis(-1, &cz);
+
+            estoque[cartao_id].vendido = novo_estado;
+            if (novo_estado == CARTAO_RETIDO) {
+                estoque[cartao_id].retencao_expira = agora + ttl_segundos;
+                publicar_evento(EVENTO_RETENCAO, cartao_id, agora);
+            } else {
+                estoque[cartao_id].hora_venda = agora;
+                atomic_fetch_add(&vendas_realizadas, 1);
+                publicar_evento(EVENTO_VENDA, cartao_id, agora);
+            }
+        }
+
+        // Fragmento local abaixo do limiar: o rebalanceador repõe em lote
+        if (k == 0 && f->num_livres < LIMIAR_REBALANCEAMENTO) pedir = 1;
+
+        pthread_mutex_unlock(&f->lock);
+    }
+
+    notificar_cruzamentos(&cz);
+    if (pedir && num_fragmentos > 1) pedir_rebalanceamento();
+
+    return cartao_id;  // -1 se estoque esgotado
+}
+
+/* ========== INICIALIZAÇÃO ========== */
+
 /* Inicializa o estoque e o mutex */
 void inicializar_estoque() {
+    inicializar_estoque_fragmentado(FRAGMENTOS_ESTOQUE_PADRAO);
+}
+
+/* Inicializa o estoque dividido em 'n' fragmentos de tamanho igual */
+void inicializar_estoque_fragmentado(int n) {
+    if (n < 1) n = 1;
+    if (n > MAX_FRAGMENTOS_ESTOQUE) n = MAX_FRAGMENTOS_ESTOQUE;
+
+    if (fragmentos) liberar_estoque();
+
     pthread_mutex_init(&estoque_lock, NULL);
 
-    for (int i = 0; i < TOTAL_CARTOES; i++) {
-        estoque[i].id = i;
-        estoque[i].vendido = 0; // todos disponíveis no início
-        estoque[i].hora_venda = 0;
+    // Qualquer trabalhador serve qualquer agência: fragmentos intercalados pelos nós
+    fragmentos = (FragmentoEstoque*)alocar_memoria_intercalada(n * sizeof(FragmentoEstoque));
+    if (!fragmentos) {
+        num_fragmentos = 0;
+        return;
+    }
+    memset(fragmentos, 0, n * sizeof(FragmentoEstoque));
+    num_fragmentos = n;
+
+    for (int f = 0; f < n; f++) {
+        pthread_mutex_init(&fragmentos[f].lock, NULL);
+        atomic_init(&fragmentos[f].disponiveis, 0);
+        atomic_init(&fragmentos[f].retencoes, 0);
+    }
+
+    // Pilhas de livres já com a faixa inteira, para o enchimento não falhar a meio
+    for (int f = 0; f < n; f++) {
+        int tamanho = (int)((long)TOTAL_CARTOES * (f + 1) / n) - (int)((long)TOTAL_CARTOES * f / n);
+        if (!garantir_livres(&fragmentos[f], tamanho)) {
+            printf("[ERRO] Sem memória para os fragmentos do estoque\n");
+            liberar_estoque();
+            return;
+        }
+    }
+
+    atomic_store(&vendas_realizadas, 0);
+
+    // Novo estoque, nova história: consumidores com seq antigo reconstroem
+    for (int i = 0; i < CAPACIDADE_EVENTOS_ESTOQUE; i++) {
+        atomic_store_explicit(&anel_eventos[i].selo, 0, memory_order_relaxed);
+    }
+    atomic_store(&proximo_seq_evento, 0);
+
+    // Faixas contíguas por fragmento; empilhadas por ordem decrescente
+    // para que cada fragmento entregue primeiro os ids mais baixos
+    for (int f = 0; f < n; f++) {
+        int inicio = (int)((long)TOTAL_CARTOES * f / n);
+        int fim = (int)((long)TOTAL_CARTOES * (f + 1) / n);
+
+        for (int i = fim - 1; i >= inicio; i--) {
+            estoque[i].id = i;
+            estoque[i].vendido = CARTAO_DISPONIVEL; // todos disponíveis no início
+            estoque[i].hora_venda = 0;
+            estoque[i].retencao_expira = 0;
+            empilhar_livre(&fragmentos[f], f, i);
+        }
     }
+
+    atomic_store(&disponiveis_total, TOTAL_CARTOES);
+    atomic_store_explicit(&total_cartoes, TOTAL_CARTOES, memory_order_release);
 }
 
 /* Liberta os recursos do estoque */
 void liberar_estoque() {
+    parar_reabastecedor_estoque();
+    parar_recolhedor_retencoes();
+    parar_rebalanceador_estoque();
+
+    for (int f = 0; f < num_fragmentos; f++) {
+        pthread_mutex_destroy(&fragmentos[f].lock);
+        free(fragmentos[f].livres);
+        free(fragmentos[f].retidos);
+    }
+    libertar_memoria_numa(fragmentos, num_fragmentos * sizeof(FragmentoEstoque));
+    fragmentos = NULL;
+    num_fragmentos = 0;
+
     pthread_mutex_destroy(&estoque_lock);
 }
 
+/* ========== RESERVA E LIBERAÇÃO ========== */
+
 /* Reserva o próximo cartão SIM disponível */
 int reservar_proximo_cartao() {
-    int cartao_id = -1;
-
-    pthread_mutex_lock(&estoque_lock);
-
-    for (int i = 0; i < TOTAL_CARTOES; i++) {
-        if (estoque[i].vendido == 0) {
-            estoque[i].vendido = 1;
-            estoque[i].hora_venda = time(NULL);
-            cartao_id = i;
-            vendas_realizadas++;
-            break;
-        }
-    }
+    return reservar_cartao_fragmento(0);
+}
 
-    pthread_mutex_unlock(&estoque_lock);
-    return cartao_id;  // -1 se estoque esgotado
+/* Reserva um cartão do fragmento indicado (normalmente o da agência) */
+int reservar_cartao_fragmento(int fragmento) {
+    return obter_cartao_livre(fragmento, CARTAO_VENDIDO, 0);
 }
 
 /* Reserva um cartão SIM específico (para casos especiais) */
 int reservar_cartao_especifico(int id) {
     int sucesso = 0;
+    Cruzamentos cz = {0};
 
-    pthread_mutex_lock(&estoque_lock);
+    if (id < 0 || id >= estoque_total() || num_fragmentos <= 0) return 0;
 
-    if (id >= 0 && id < TOTAL_CARTOES) {
-        if (estoque[id].vendido == 0) {
-            estoque[id].vendido = 1;
-            estoque[id].hora_venda = time(NULL);
-            vendas_realizadas++;
-            sucesso = 1;
-        }
+    FragmentoEstoque* f = bloquear_fragmento_do_cartao(id);
+
+    // Um cartão de um lote já publicado mas ainda sem fatia entregue
+    // (posicao -1) não está em nenhuma pilha: não pode ser retirado
+    if (estoque[id].vendido == CARTAO_DISPONIVEL && estoque[id].posicao >= 0) {
+        remover_livre(f, id);
+        ajustar_disponiveis(-1, &cz);
+        estoque[id].vendido = CARTAO_VENDIDO;
+        estoque[id].hora_venda = relogio_agora();
+        atomic_fetch_add(&vendas_realizadas, 1);
+        publicar_evento(EVENTO_VENDA, id, estoque[id].hora_venda);
+        sucesso = 1;
     }
 
-    pthread_mutex_unlock(&estoque_lock);
+    pthread_mutex_unlock(&f->lock);
+    notificar_cruzamentos(&cz);
     return sucesso;
 }
 
 /* Libera um cartão SIM */
 int liberar_cartao(int id) {
     int sucesso = 0;
+    Cruzamentos cz = {0};
 
-    pthread_mutex_lock(&estoque_lock);
+    if (id < 0 || id >= estoque_total() || num_fragmentos <= 0) return 0;
+
+    FragmentoEstoque* f = bloquear_fragmento_do_cartao(id);
+
+    // Sem memória para o devolver à pilha: continua vendido
+    if (estoque[id].vendido == CARTAO_VENDIDO && empilhar_livre(f, (int)(f - fragmentos), id)) {
+        estoque[id].vendido = CARTAO_DISPONIVEL;
+        estoque[id].hora_venda = 0;
+        ajustar_disponiveis(+1, &cz);
+        atomic_fetch_sub(&vendas_realizadas, 1);
+        publicar_evento(EVENTO_LIBERACAO, id, relogio_agora());
+        sucesso = 1;
+    }
+
+    pthread_mutex_unlock(&f->lock);
+    notificar_cruzamentos(&cz);
+    return sucesso;
+}
+
+/* ========== RESERVA EM DUAS FASES ========== */
+
+/* Retém o próximo cartão disponível até confirmação, cancelamento ou expiração */
+int reter_proximo_cartao(int ttl_segundos) {
+    return reter_cartao_fragmento(0, ttl_segundos);
+}
 
-    if (id >= 0 && id < TOTAL_CARTOES) {
-        if (estoque[id].vendido == 1) {
-            estoque[id].vendido = 0;
-            estoque[id].hora_venda = 0;
-            vendas_realizadas--;
+/* Retém um cartão do fragmento indicado */
+int reter_cartao_fragmento(int fragmento, int ttl_segundos) {
+    if (ttl_segundos <= 0) ttl_segundos = TTL_RETENCAO_PADRAO;
+
+    return obter_cartao_livre(fragmento, CARTAO_RETIDO, ttl_segundos);
+}
+
+/* Confirma a venda de um cartão retido. Falha se a retenção já expirou. */
+int confirmar_retencao(int id) {
+    int sucesso = 0;
+    Cruzamentos cz = {0};
+
+    if (id < 0 || id >= estoque_total() || num_fragmentos <= 0) return 0;
+
+    FragmentoEstoque* f = bloquear_fragmento_do_cartao(id);
+
+    if (estoque[id].vendido == CARTAO_RETIDO) {
+        time_t agora = relogio_agora();
+
+        if (estoque[id].retencao_expira > agora) {
+            remover_retido(f, id);
+            estoque[id].vendido = CARTAO_VENDIDO;
+            estoque[id].hora_venda = agora;
+            estoque[id].retencao_expira = 0;
+            atomic_fetch_add(&vendas_realizadas, 1);
+            publicar_evento(EVENTO_VENDA, id, agora);
             sucesso = 1;
+        } else if (garantir_livres(f, 1)) {
+            // Expirou mas o recolhedor ainda não passou: devolver já
+            // (sem memória fica retido e o recolhedor tenta mais tarde)
+            remover_retido(f, id);
+            estoque[id].vendido = CARTAO_DISPONIVEL;
+            estoque[id].retencao_expira = 0;
+            empilhar_livre(f, (int)(f - fragmentos), id);
+            ajustar_disponiveis(+1, &cz);
+            publicar_evento(EVENTO_FIM_RETENCAO, id, agora);
         }
     }
 
-    pthread_mutex_unlock(&estoque_lock);
+    pthread_mutex_unlock(&f->lock);
+    notificar_cruzamentos(&cz);
     return sucesso;
 }
 
-/* Retorna quantidade de cartões disponíveis */
-int estoque_disponivel() {
-    int disponiveis = 0;
+/* Cancela uma retenção, devolvendo o cartão ao estoque */
+int cancelar_retencao(int id) {
+    int sucesso = 0;
+    Cruzamentos cz = {0};
+
+    if (id < 0 || id >= estoque_total() || num_fragmentos <= 0) return 0;
+
+    FragmentoEstoque* f = bloquear_fragmento_do_cartao(id);
+
+    // Sem memória para o devolver à pilha: a retenção mantém-se
+    if (estoque[id].vendido == CARTAO_RETIDO && garantir_livres(f, 1)) {
+        remover_retido(f, id);
+        estoque[id].vendido = CARTAO_DISPONIVEL;
+        estoque[id].retencao_expira = 0;
+        empilhar_livre(f, (int)(f - fragmentos), id);
+        ajustar_disponiveis(+1, &cz);
+        publicar_evento(EVENTO_FIM_RETENCAO, id, relogio_agora());
+        sucesso = 1;
+    }
+
+    pthread_mutex_unlock(&f->lock);
+    notificar_cruzamentos(&cz);
+    return sucesso;
+}
+
+/* Dá a uma retenção em curso um novo prazo, a contar de agora */
+int renovar_retencao(int id, int ttl_segundos) {
+    int sucesso = 0;
+
+    if (id < 0 || id >= estoque_total() || num_fragmentos <= 0) return 0;
+
+    FragmentoEstoque* f = bloquear_fragmento_do_cartao(id);
+
+    if (estoque[id].vendido == CARTAO_RETIDO) {
+        time_t expira = relogio_agora() + ttl_segundos;
+        estoque[id].retencao_expira = expira;
+        // Só pode antecipar a próxima expiração; o recolhedor recalcula-a
+        if (expira < f->proxima_expiracao) f->proxima_expiracao = expira;
+        sucesso = 1;
+    }
+
+    pthread_mutex_unlock(&f->lock);
+    return sucesso;
+}
+
+/* Devolve ao estoque, em lote, todas as retenções expiradas.
+ * Percorre apenas as listas de retidos dos fragmentos com expirações vencidas. */
+int recolher_retencoes_expiradas(void) {
+    int recolhidas = 0;
+    time_t agora = relogio_agora();
+    Cruzamentos cz = {0};
+
+    for (int i = 0; i < num_fragmentos; i++) {
+        FragmentoEstoque* f = &fragmentos[i];
+
+        // Caminho rápido sem lock: nada retido neste fragmento
+        if (atomic_load_explicit(&f->retencoes, memory_order_relaxed) == 0) continue;
+
+        pthread_mutex_lock(&f->lock);
+
+        if (f->num_retidos == 0 || agora < f->proxima_expiracao) {
+            pthread_mutex_unlock(&f->lock);
+            continue;
+        }
+
+        time_t nova_expiracao = 0;
+        int k = 0;
+        while (k < f->num_retidos) {
+            int id = f->retidos[k];
+
+            // Sem memória para a pilha de livres: fica para a próxima passagem
+            if (estoque[id].retencao_expira <= agora && garantir_livres(f, 1)) {
+                remover_retido(f, id);   // Traz o último para a posição k
+                estoque[id].vendido = CARTAO_DISPONIVEL;
+                estoque[id].retencao_expira = 0;
+                empilhar_livre(f, i, id);
+                ajustar_disponiveis(+1, &cz);
+                publicar_evento(EVENTO_FIM_RETENCAO, id, agora);
+                recolhidas++;
+            } else {
+                if (nova_expiracao == 0 || estoque[id].retencao_expira < nova_expiracao) {
+                    nova_expiracao = estoque[id].retencao_expira;
+                }
+                k++;
+            }
+        }
+        f->proxima_expiracao = nova_expiracao;
+
+        pthread_mutex_unlock(&f->lock);
+    }
+
+    notificar_cruzamentos(&cz);
+    return recolhidas;
+}
+
+/* Thread que devolve periodicamente as retenções expiradas */
+static void* thread_recolhedor_retencoes(void* arg) {
+    (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
+
+    pthread_mutex_lock(&recolhedor_lock);
+    while (recolhedor_ativo) {
+        struct timespec prazo;
+        clock_gettime(CLOCK_REALTIME, &prazo);
+        prazo.tv_sec += INTERVALO_RECOLHA;
+        pthread_cond_timedwait(&recolhedor_cond, &recolhedor_lock, &prazo);
+
+        if (!recolhedor_ativo) break;
+
+        pthread_mutex_unlock(&recolhedor_lock);
+        int recolhidas = recolher_retencoes_expiradas();
+        if (recolhidas > 0) {
+            printf("[ESTOQUE] %d retenção(ões) expirada(s) devolvida(s) ao estoque\n",
+                   recolhidas);
+        }
+        pthread_mutex_lock(&recolhedor_lock);
+    }
+    pthread_mutex_unlock(&recolhedor_lock);
+
+    return NULL;
+}
+
+/* Iniciar thread recolhedora. No modo virtual não há thread: a simulação
+ * chama recolher_retencoes_expiradas nos seus próprios instantes. */
+void iniciar_recolhedor_retencoes(void) {
+    if (relogio_virtual()) return;
+
+    pthread_mutex_lock(&recolhedor_lock);
+    if (recolhedor_ativo) {
+        pthread_mutex_unlock(&recolhedor_lock);
+        return;
+    }
+    recolhedor_ativo = 1;
+    pthread_mutex_unlock(&recolhedor_lock);
+
+    if (pthread_create(&thread_recolhedor, NULL, thread_recolhedor_retencoes, NULL) != 0) {
+        printf("[ERRO] Falha ao criar thread recolhedora de retenções\n");
+        recolhedor_ativo = 0;
+    }
+}
+
+/* Parar thread recolhedora */
+void parar_recolhedor_retencoes(void) {
+    pthread_mutex_lock(&recolhedor_lock);
+    if (!recolhedor_ativo) {
+        pthread_mutex_unlock(&recolhedor_lock);
+        return;
+    }
+    recolhedor_ativo = 0;
+    pthread_cond_signal(&recolhedor_cond);
+    pthread_mutex_unlock(&recolhedor_lock);
+
+    pthread_join(thread_recolhedor, NULL);
+}
+
+/* ========== REBALANCEAMENTO ENTRE FRAGMENTOS ========== */
+
+/* Uma passagem de rebalanceamento: cada fragmento abaixo do limiar recebe
+ * um lote do fragmento com mais cartões livres. Retorna cartões movidos. */
+int rebalancear_estoque(void) {
+    int movidos = 0;
+
+    if (num_fragmentos < 2) return 0;
 
     pthread_mutex_lock(&estoque_lock);
-    for (int i = 0; i < TOTAL_CARTOES; i++) {
-        if (estoque[i].vendido == 0) disponiveis++;
+
+    for (int r = 0; r < num_fragmentos; r++) {
+        int livres_r = atomic_load_explicit(&fragmentos[r].disponiveis, memory_order_relaxed);
+        if (livres_r >= LIMIAR_REBALANCEAMENTO) continue;
+
+        // Doador: o fragmento com mais cartões livres
+        int doador = -1, max_livres = livres_r + 1;
+        for (int d = 0; d < num_fragmentos; d++) {
+            int n = atomic_load_explicit(&fragmentos[d].disponiveis, memory_order_relaxed);
+            if (d != r && n > max_livres) {
+                max_livres = n;
+                doador = d;
+            }
+        }
+        if (doador < 0) continue;
+
+        // Locks sempre por ordem crescente de índice
+        FragmentoEstoque* primeiro = &fragmentos[r < doador ? r : doador];
+        FragmentoEstoque* segundo = &fragmentos[r < doador ? doador : r];
+        pthread_mutex_lock(&primeiro->lock);
+        pthread_mutex_lock(&segundo->lock);
+
+        FragmentoEstoque* origem = &fragmentos[doador];
+        FragmentoEstoque* destino = &fragmentos[r];
+
+        // Equilibra os dois sem deixar o doador abaixo do limiar
+        int lote = (origem->num_livres - destino->num_livres) / 2;
+        if (lote > origem->num_livres - LIMIAR_REBALANCEAMENTO) {
+            lote = origem->num_livres - LIMIAR_REBALANCEAMENTO;
+        }
+        if (lote > LOTE_REBALANCEAMENTO) lote = LOTE_REBALANCEAMENTO;
+
+        int transferidos = 0;
+        for (int k = 0; k < lote; k++) {
+            int id = desempilhar_livre(origem);
+            if (id == -1) break;
+            if (!empilhar_livre(destino, r, id)) {
+                // Sem memória no destino: fica no doador, no lugar que deixou
+                empilhar_livre(origem, doador, id);
+                printf("[ERRO] Sem memória para rebalancear o fragmento %d\n", r);
+                break;
+            }
+            transferidos++;
+        }
+        movidos += transferidos;
+
+        pthread_mutex_unlock(&segundo->lock);
+        pthread_mutex_unlock(&primeiro->lock);
+
+        if (transferidos > 0) {
+            printf("[ESTOQUE] Rebalanceamento: %d cartões do fragmento %d para o %d\n",
+                   transferidos, doador, r);
+        }
     }
+
     pthread_mutex_unlock(&estoque_lock);
+    return movidos;
+}
+
+/* Thread que rebalanceia quando um fragmento seca (ou periodicamente) */
+static void* thread_rebalanceador_estoque(void* arg) {
+    (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
+
+    pthread_mutex_lock(&rebalanceador_lock);
+    while (rebalanceador_ativo) {
+        if (!rebalanceamento_pedido) {
+            struct timespec prazo;
+            clock_gettime(CLOCK_REALTIME, &prazo);
+            prazo.tv_sec += INTERVALO_REBALANCEAMENTO;
+            pthread_cond_timedwait(&rebalanceador_cond, &rebalanceador_lock, &prazo);
+        }
+
+        if (!rebalanceador_ativo) break;
+        rebalanceamento_pedido = 0;
+
+        pthread_mutex_unlock(&rebalanceador_lock);
+        rebalancear_estoque();
+        pthread_mutex_lock(&rebalanceador_lock);
+    }
+    pthread_mutex_unlock(&rebalanceador_lock);
+
+    return NULL;
+}
 
-    return disponiveis;
+/* Iniciar thread de rebalanceamento (no modo virtual os pedidos são
+ * servidos na hora por pedir_rebalanceamento) */
+void iniciar_rebalanceador_estoque(void) {
+    if (relogio_virtual()) return;
+
+    pthread_mutex_lock(&rebalanceador_lock);
+    if (rebalanceador_ativo || num_fragmentos < 2) {
+        pthread_mutex_unlock(&rebalanceador_lock);
+        return;
+    }
+    rebalanceador_ativo = 1;
+    rebalanceamento_pedido = 0;
+    pthread_mutex_unlock(&rebalanceador_lock);
+
+    if (pthread_create(&thread_rebalanceador, NULL, thread_rebalanceador_estoque, NULL) != 0) {
+        printf("[ERRO] Falha ao criar thread de rebalanceamento do estoque\n");
+        rebalanceador_ativo = 0;
+    }
+}
+
+/* Parar thread de rebalanceamento */
+void parar_rebalanceador_estoque(void) {
+    pthread_mutex_lock(&rebalanceador_lock);
+    if (!rebalanceador_ativo) {
+        pthread_mutex_unlock(&rebalanceador_lock);
+        return;
+    }
+    rebalanceador_ativo = 0;
+    pthread_cond_signal(&rebalanceador_cond);
+    pthread_mutex_unlock(&rebalanceador_lock);
+
+    pthread_join(thread_rebalanceador, NULL);
+}
+
+/* ========== CONSULTAS ========== */
+
+/* Retorna quantidade de cartões disponíveis (O(1), sem locks) */
+int estoque_disponivel() {
+    return atomic_load_explicit(&disponiveis_total, memory_order_relaxed);
+}
+
+/* Cartões existentes, incluindo os repostos */
+int estoque_total(void) {
+    return atomic_load_explicit(&total_cartoes, memory_order_acquire);
+}
+
+/* Indica se o estoque está esgotado (O(1), sem locks) */
+int estoque_esgotado(void) {
+    return atomic_load_explicit(&disponiveis_total, memory_order_relaxed) <= 0;
 }
 
 /* Retorna quantidade de cartões vendidos */
 int estoque_vendido() {
-    int vendidos = 0;
+    return atomic_load(&vendas_realizadas);
+}
+
+/* Retorna quantidade de cartões em retenção temporária */
+int estoque_retido() {
+    int retidos = 0;
+
+    for (int f = 0; f < num_fragmentos; f++) {
+        retidos += atomic_load_explicit(&fragmentos[f].retencoes, memory_order_relaxed);
+    }
+
+    return retidos;
+}
+
+/* Número de fragmentos e cartões livres de cada um */
+int get_num_fragmentos_estoque(void) {
+    return num_fragmentos;
+}
+
+int estoque_disponivel_fragmento(int fragmento) {
+    if (fragmento < 0 || fragmento >= num_fragmentos) return 0;
+    return atomic_load_explicit(&fragmentos[fragmento].disponiveis, memory_order_relaxed);
+}
+
+/* ========== REPOSIÇÃO DE ESTOQUE ========== */
+
+/* Acrescenta um lote de cartões novos. O lote é inicializado fora de
+ * qualquer lock e publicado de uma vez; depois cada fragmento recebe a
+ * sua fatia com o próprio lock, pelo que as vendas só esperam pela
+ * fatia do fragmento onde estão. Retorna o número de cartões postos à
+ * venda. */
+int reabastecer_estoque(int quantidade) {
+    Cruzamentos cz = {0};
+
+    if (quantidade <= 0 || num_fragmentos <= 0) return 0;
+
+    pthread_mutex_lock(&reposicao_lock);
+
+    int inicio = atomic_load_explicit(&total_cartoes, memory_order_relaxed);
+    if (quantidade > MAX_CARTOES - inicio) quantidade = MAX_CARTOES - inicio;
+    if (quantidade <= 0) {
+        pthread_mutex_unlock(&reposicao_lock);
+        printf("[ESTOQUE] Capacidade máxima atingida (%d cartões)\n", MAX_CARTOES);
+        return 0;
+    }
+    int fim = inicio + quantidade;
+
+    // 1. Preparar o lote: ids >= total_cartoes ainda não são visíveis
+    for (int f = 0; f < num_fragmentos; f++) {
+        int a = inicio + (int)((long)quantidade * f / num_fragmentos);
+        int b = inicio + (int)((long)quantidade * (f + 1) / num_fragmentos);
+        for (int i = a; i < b; i++) {
+            estoque[i].id = i;
+            estoque[i].vendido = CARTAO_DISPONIVEL;
+            estoque[i].hora_venda = 0;
+            estoque[i].retencao_expira = 0;
+            estoque[i].posicao = -1;
+            atomic_store_explicit(&estoque[i].fragmento, f, memory_order_relaxed);
+        }
+    }
+
+    // 2. Publicar o lote inteiro de uma vez. Até a fatia chegar à pilha,
+    //    cada cartão novo tem posicao -1 e a reserva específica recusa-o;
+    //    publicar depois deixaria as vendas entregar ids ainda invisíveis
+    //    para confirmar_retencao e liberar_cartao
+    atomic_store_explicit(&total_cartoes, fim, memory_order_release);
+
+    // 3. Entregar cada fatia ao seu fragmento
+    time_t agora = relogio_agora();
+    int entregues = quantidade;
+    for (int f = 0; f < num_fragmentos; f++) {
+        int a = inicio + (int)((long)quantidade * f / num_fragmentos);
+        int b = inicio + (int)((long)quantidade * (f + 1) / num_fragmentos);
+        if (a == b) continue;
+
+        FragmentoEstoque* frag = &fragmentos[f];
+        pthread_mutex_lock(&frag->lock);
+        if (!garantir_livres(frag, b - a)) {
+            // A fatia fica fora das pilhas (posicao -1): existe mas não se vende
+            pthread_mutex_unlock(&frag->lock);
+            printf("[ERRO] Sem memória para repor %d cartões no fragmento %d\n", b - a, f);
+            entregues -= b - a;
+            continue;
+        }
+        for (int i = b - 1; i >= a; i--) {
+            empilhar_livre(frag, f, i);
+            ajustar_disponiveis(+1, &cz);
+            publicar_evento(EVENTO_REPOSICAO, i, agora);
+        }
+        pthread_mutex_unlock(&frag->lock);
+    }
+
+    pthread_mutex_unlock(&reposicao_lock);
+
+    notificar_cruzamentos(&cz);
+    return entregues;
+}
 
+/* Limiar de reposição cruzado a descer: acordar o reabastecedor */
+static void pedir_reposicao(int limiar, int disponiveis, int descendo, void* arg) {
+    (void)limiar;
+    (void)disponiveis;
+    (void)arg;
+
+    if (!descendo) return;
+
+    // Modo virtual: repor já, na thread que conduz a simulação, para que
+    // o tempo simulado não avance à frente do produtor
+    if (relogio_virtual()) {
+        reabastecer_estoque(lote_reposicao);
+        return;
+    }
+
+    pthread_mutex_lock(&reabastecedor_lock);
+    reposicao_pedida = 1;
+    pthread_cond_signal(&reabastecedor_cond);
+    pthread_mutex_unlock(&reabastecedor_lock);
+}
+
+/* Thread produtora: repõe um lote sempre que o estoque desce ao limiar */
+static void* thread_reabastecedor_estoque(void* arg) {
+    (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
+
+    pthread_mutex_lock(&reabastecedor_lock);
+    while (reabastecedor_ativo) {
+        if (!reposicao_pedida) {
+            struct timespec prazo;
+            clock_gettime(CLOCK_REALTIME, &prazo);
+            prazo.tv_sec += INTERVALO_REPOSICAO;
+            pthread_cond_timedwait(&reabastecedor_cond, &reabastecedor_lock, &prazo);
+        }
+
+        if (!reabastecedor_ativo) break;
+        reposicao_pedida = 0;
+        int lote = lote_reposicao;
+        int limiar = limiar_reposicao;
+
+        pthread_mutex_unlock(&reabastecedor_lock);
+        if (estoque_disponivel() <= limiar) {
+            int inicio = estoque_total();
+            int criados = reabastecer_estoque(lote);
+            if (criados > 0) {
+                printf("[ESTOQUE] Reposição: %d cartões novos (%03d-%03d)\n",
+                       criados, inicio, inicio + criados - 1);
+            }
+        }
+        pthread_mutex_lock(&reabastecedor_lock);
+    }
+    pthread_mutex_unlock(&reabastecedor_lock);
+
+    return NULL;
+}
+
+/* Iniciar thread de reposição */
+void iniciar_reabastecedor_estoque(int lote, int limiar) {
+    pthread_mutex_lock(&reabastecedor_lock);
+    if (reabastecedor_ativo) {
+        pthread_mutex_unlock(&reabastecedor_lock);
+        return;
+    }
+    reabastecedor_ativo = 1;
+    reposicao_pedida = 0;
+    lote_reposicao = (lote > 0) ? lote : LOTE_REPOSICAO_PADRAO;
+    limiar_reposicao = (limiar >= 0) ? limiar : LIMIAR_REPOSICAO_PADRAO;
+    pthread_mutex_unlock(&reabastecedor_lock);
+
+    id_limiar_reposicao = estoque_registrar_limiar(limiar_reposicao, pedir_reposicao, NULL);
+    if (id_limiar_reposicao < 0) {
+        printf("[ESTOQUE] Sem slots de limiar livres: reposição só periódica\n");
+    }
+
+    // Modo virtual: só o limiar, servido por pedir_reposicao na thread da
+    // simulação; uma verificação periódica em tempo real não seria reproduzível
+    if (relogio_virtual()) return;
+
+    if (pthread_create(&thread_reabastecedor, NULL, thread_reabastecedor_estoque, NULL) != 0) {
+        printf("[ERRO] Falha ao criar thread de reposição de estoque\n");
+        estoque_remover_limiar(id_limiar_reposicao);
+        id_limiar_reposicao = -1;
+        reabastecedor_ativo = 0;
+    }
+}
+
+/* Parar thread de reposição */
+void parar_reabastecedor_estoque(void) {
+    pthread_mutex_lock(&reabastecedor_lock);
+    if (!reabastecedor_ativo) {
+        pthread_mutex_unlock(&reabastecedor_lock);
+        return;
+    }
+    reabastecedor_ativo = 0;
+    pthread_cond_signal(&reabastecedor_cond);
+    pthread_mutex_unlock(&reabastecedor_lock);
+
+    if (!relogio_virtual()) pthread_join(thread_reabastecedor, NULL);
+
+    estoque_remover_limiar(id_limiar_reposicao);
+    id_limiar_reposicao = -1;
+}
+
+/* ========== LIMIARES DE ESTOQUE (WATERMARKS) ========== */
+
+/* Regista um limiar. O callback é chamado sempre que os disponíveis
+ * cruzam o limiar, em qualquer sentido, pela thread que causou a mudança.
+ * Retorna o id do registo ou -1 se não houver slots livres. */
+int estoque_registrar_limiar(int limiar, CallbackLimiarEstoque callback, void* arg) {
+    int id = -1;
+
+    pthread_mutex_lock(&limiar_lock);
+
+    int usados = atomic_load_explicit(&limiares_usados, memory_order_relaxed);
+    for (int i = 0; i < usados; i++) {
+        if (!atomic_load_explicit(&limiares[i].ativo, memory_order_relaxed)) {
+            id = i;
+            break;
+        }
+    }
+    if (id == -1 && usados < MAX_LIMIARES_ESTOQUE) id = usados;
+
+    if (id != -1) {
+        atomic_store_explicit(&limiares[id].callback, callback, memory_order_relaxed);
+        atomic_store_explicit(&limiares[id].arg, arg, memory_order_relaxed);
+        atomic_store_explicit(&limiares[id].limiar, limiar, memory_order_relaxed);
+        atomic_store_explicit(&limiares[id].ativo, 1, memory_order_release);
+        if (id == usados) {
+            atomic_store_explicit(&limiares_usados, usados + 1, memory_order_release);
+        }
+    }
+
+    pthread_mutex_unlock(&limiar_lock);
+    return id;
+}
+
+/* Remove um limiar registado */
+void estoque_remover_limiar(int id) {
+    if (id < 0 || id >= MAX_LIMIARES_ESTOQUE) return;
+
+    pthread_mutex_lock(&limiar_lock);
+    atomic_store_explicit(&limiares[id].ativo, 0, memory_order_release);
+    pthread_mutex_unlock(&limiar_lock);
+}
+
+/* Bloqueia até os disponíveis ficarem acima (acima=1) ou no máximo em
+ * (acima=0) 'limiar'. timeout_ms < 0 espera indefinidamente.
+ * Retorna 1 se a condição se verificou, 0 em timeout e -1, sem esperar,
+ * se não houver slot livre para o limiar. */
+int estoque_aguardar_limiar(int limiar, int acima, int timeout_ms) {
+    // Regista o limiar para que os cruzamentos acordem esta thread
+    int id = estoque_registrar_limiar(limiar, NULL, NULL);
+    if (id < 0) {
+        printf("[ESTOQUE] Sem slots de limiar livres (máximo %d): espera pelo limiar %d recusada\n",
+               MAX_LIMIARES_ESTOQUE, limiar);
+        return -1;
+    }
+
+    struct timespec prazo;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_REALTIME, &prazo);
+        prazo.tv_sec += timeout_ms / 1000;
+        prazo.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (prazo.tv_nsec >= 1000000000L) {
+            prazo.tv_sec++;
+            prazo.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&limiar_lock);
+
+    int satisfeito;
+    for (;;) {
+        int atual = atomic_load_explicit(&disponiveis_total, memory_order_relaxed);
+        satisfeito = acima ? (atual > limiar) : (atual <= limiar);
+        if (satisfeito) break;
+
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&limiar_cond, &limiar_lock);
+        } else if (pthread_cond_timedwait(&limiar_cond, &limiar_lock, &prazo) != 0) {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&limiar_lock);
+
+    estoque_remover_limiar(id);
+    return satisfeito;
+}
+
+/* ========== EVENTOS DE ALTERAÇÃO ========== */
+
+/* Sequência do próximo evento a publicar */
+unsigned long long estoque_seq_atual(void) {
+    return atomic_load_explicit(&proximo_seq_evento, memory_order_acquire);
+}
+
+/* Copia até 'max' eventos a partir de 'seq'. Retorna quantos copiou e
+ * coloca em 'proximo_seq' onde continuar. Retorna -1 se os eventos pedidos
+ * já foram sobrescritos: o consumidor deve reconstruir a sua vista. */
+int estoque_eventos_desde(unsigned long long seq, EventoEstoque* destino, int max,
+                          unsigned long long* proximo_seq) {
+    unsigned long long fim = atomic_load_explicit(&proximo_seq_evento, memory_order_acquire);
+    int copiados = 0;
+
+    if (proximo_seq) *proximo_seq = fim;
+
+    if (seq > fim || fim - seq > CAPACIDADE_EVENTOS_ESTOQUE) return -1;
+
+    while (seq < fim && copiados < max) {
+        SlotEvento* slot = &anel_eventos[seq & (CAPACIDADE_EVENTOS_ESTOQUE - 1)];
+
+        unsigned long long selo = atomic_load_explicit(&slot->selo, memory_order_acquire);
+        if (selo != seq + 1) {
+            if (selo > seq + 1) return -1;  // Sobrescrito por um produtor mais novo
+            break;                          // Ainda a ser publicado: continuar depois
+        }
+
+        EventoEstoque ev;
+        ev.seq = seq;
+        ev.tipo = (TipoEventoEstoque)atomic_load_explicit(&slot->tipo, memory_order_relaxed);
+        ev.cartao_id = atomic_load_explicit(&slot->cartao_id, memory_order_relaxed);
+        ev.instante = (time_t)atomic_load_explicit(&slot->instante, memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->selo, memory_order_relaxed) != selo) return -1;
+
+        destino[copiados++] = ev;
+        seq++;
+    }
+
+    if (proximo_seq) *proximo_seq = seq;
+    return copiados;
+}
+
+/* Congela o estoque inteiro para leitura consistente de estoque[] */
+void estoque_bloquear_leitura(void) {
     pthread_mutex_lock(&estoque_lock);
-    for (int i = 0; i < TOTAL_CARTOES; i++) {
-        if (estoque[i].vendido == 1) vendidos++;
+    for (int f = 0; f < num_fragmentos; f++) {
+        pthread_mutex_lock(&fragmentos[f].lock);
     }
-    pthread_mutex_unlock(&estoque_lock);
+}
 
-    return vendidos;
+void estoque_desbloquear_leitura(void) {
+    for (int f = num_fragmentos - 1; f >= 0; f--) {
+        pthread_mutex_unlock(&fragmentos[f].lock);
+    }
+    pthread_mutex_unlock(&estoque_lock);
 }
 
 /* Imprime status do estoque (para debugging) */
 void imprimir_estoque() {
-    pthread_mutex_lock(&estoque_lock);
-    
+    estoque_bloquear_leitura();
+
     printf("\n=== ESTOQUE DE CARTÕES ===\n");
-    
+
     // Calcular disponíveis manualmente para evitar chamar estoque_disponivel()
-    int disponiveis = 0, vendidos = 0;
-    for (int i = 0; i < TOTAL_CARTOES; i++) {
-        if (estoque[i].vendido == 0) disponiveis++;
+    int total = estoque_total();
+    int disponiveis = 0, vendidos = 0, retidos = 0;
+    for (int i = 0; i < total; i++) {
+        if (estoque[i].vendido == CARTAO_DISPONIVEL) disponiveis++;
+        else if (estoque[i].vendido == CARTAO_RETIDO) retidos++;
         else vendidos++;
     }
-    
-    printf("Total: %d | Disponíveis: %d | Vendidos: %d\n", 
-           TOTAL_CARTOES, disponiveis, vendidos);
-    
+
+    printf("Total: %d | Disponíveis: %d | Vendidos: %d | Retidos: %d\n",
+           total, disponiveis, vendidos, retidos);
+
+    printf("Fragmentos:");
+    for (int f = 0; f < num_fragmentos; f++) {
+        printf(" [%d: %d livres]", f, fragmentos[f].num_livres);
+    }
+    printf("\n");
+
     printf("\nCartões vendidos:\n");
     int count_vendidos = 0;
-    for (int i = 0; i < TOTAL_CARTOES; i++) {
+    for (int i = 0; i < total; i++) {
         if (estoque[i].vendido == 1) {
             count_vendidos++;
             if (estoque[i].hora_venda > 0) {
@@ -149,10 +1219,10 @@ void imprimir_estoque() {
             }
         }
     }
-    
+
     if (count_vendidos == 0) {
         printf("  (nenhum cartão vendido ainda)\n");
     }
-    
-    pthread_mutex_unlock(&estoque_lock);
+
+    estoque_desbloquear_leitura();
 }
\ No newline at end of file
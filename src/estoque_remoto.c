@@ -0,0 +1,453 @@
+#include "estoque_remoto.h"
+#include "coordenador.h"
+#include "estoque.h"
+#include "afinidade.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+static int ligacao = -1;
+static int ligado = 0;                      // Modo remoto configurado
+static char endereco_coordenador[256];      // Para voltar a ligar
+static atomic_int ligacao_perdida = 0;
+static pthread_mutex_t ligacao_lock = PTHREAD_MUTEX_INITIALIZER;   // Uma troca de cada vez
+
+// Cache local e vendas por enviar (cache_lock)
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sincronizar_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t espaco_cond = PTHREAD_COND_INITIALIZER;
+static int cache[CAPACIDADE_CACHE_REMOTA];
+static int cache_tamanho = 0;
+/* Ligação que cedeu cada cartão: ao religar, os da ligação anterior ficam
+ * em quarentena no coordenador e não podem voltar a ser vendidos */
+static unsigned geracao_ligacao = 0;
+static unsigned geracao_cartao[MAX_CARTOES];
+/* Vendas até o coordenador as confirmar. Sem ligação a cache não é
+ * reposta, pelo que além do limite normal cabe ainda o que nela restava */
+#define CAPACIDADE_VENDAS_PENDENTES (MAX_VENDAS_PENDENTES_REMOTAS + CAPACIDADE_CACHE_REMOTA)
+static int vendas_pendentes[CAPACIDADE_VENDAS_PENDENTES];
+static int num_vendas_pendentes = 0;
+static int sem_estoque_remoto = 0;          // Último pedido voltou vazio
+static int sincronizador_ativo = 0;
+static pthread_t sincronizador;
+static EstatisticasEstoqueRemoto estatisticas;
+
+/* ========== TROCAS COM O COORDENADOR ========== */
+
+static int escrever_tudo(const void* dados, size_t tamanho) {
+    const unsigned char* p = (const unsigned char*)dados;
+    while (tamanho > 0) {
+        ssize_t n = send(ligacao, p, tamanho, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        tamanho -= (size_t)n;
+    }
+    return 1;
+}
+
+static int ler_tudo(void* dados, size_t tamanho) {
+    unsigned char* p = (unsigned char*)dados;
+    while (tamanho > 0) {
+        ssize_t n = recv(ligacao, p, tamanho, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        tamanho -= (size_t)n;
+    }
+    return 1;
+}
+
+static void acrescentar_pedido(unsigned char* buffer, size_t* tamanho, OperacaoCoordenador operacao,
+                               const int* ids, int quantidade) {
+    PedidoCoordenador pedido = { (uint32_t)operacao, (uint32_t)quantidade };
+    memcpy(buffer + *tamanho, &pedido, sizeof(pedido));
+    *tamanho += sizeof(pedido);
+    if (ids) {
+        memcpy(buffer + *tamanho, ids, quantidade * sizeof(int));
+        *tamanho += quantidade * sizeof(int);
+    }
+}
+
+/* Lê uma resposta com até 'maximo' valores; retorna quantos ou -1 */
+static int ler_resposta(int* valores, int maximo) {
+    RespostaCoordenador resposta;
+    if (!ler_tudo(&resposta, sizeof(resposta)) || resposta.estado != 0 ||
+        resposta.quantidade > (uint32_t)maximo) {
+        return -1;
+    }
+    if (!ler_tudo(valores, resposta.quantidade * sizeof(int))) return -1;
+    return (int)resposta.quantidade;
+}
+
+/* Um pedido de venda e um de reserva na mesma escrita (qualquer um pode
+ * faltar); as respostas vêm pela mesma ordem. Com ligacao_lock. */
+static int trocar(OperacaoCoordenador operacao_lote, const int* ids, int num_ids,
+                  int pedir, int* recebidos) {
+    unsigned char buffer[2 * sizeof(PedidoCoordenador) + LOTE_MAXIMO_COORDENADOR * sizeof(int)];
+    int resultado_lote[1 + LOTE_MAXIMO_COORDENADOR];   // Aceites e ids recusados
+    size_t tamanho = 0;
+    if (num_ids > 0) acrescentar_pedido(buffer, &tamanho, operacao_lote, ids, num_ids);
+    if (pedir > 0) acrescentar_pedido(buffer, &tamanho, COORD_RESERVAR, NULL, pedir);
+    if (tamanho == 0) return 0;
+
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    if (!escrever_tudo(buffer, tamanho)) return -1;
+    int recusados = 0;
+    if (num_ids > 0 && (recusados = ler_resposta(resultado_lote, 1 + num_ids) - 1) < 0) return -1;
+    int n = 0;
+    if (pedir > 0 && (n = ler_resposta(recebidos, pedir)) < 0) return -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    pthread_mutex_lock(&cache_lock);
+    estatisticas.trocas++;
+    estatisticas.tempo_trocas_ns += (fim.tv_sec - inicio.tv_sec) * 1000000000LL +
+                                    (fim.tv_nsec - inicio.tv_nsec);
+    estatisticas.cartoes_recebidos += n;
+    if (operacao_lote == COORD_VENDER) {
+        estatisticas.vendas_enviadas += num_ids;
+        estatisticas.vendas_recusadas += recusados;
+    }
+    for (int i = 0; i < n; i++) {
+        if (recebidos[i] >= 0 && recebidos[i] < MAX_CARTOES) {
+            geracao_cartao[recebidos[i]] = geracao_ligacao;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    // Vendas que o coordenador já não reconhece (quarentena expirada e o
+    // cartão possivelmente cedido a outro nó): ficam à vista, não se perdem
+    if (operacao_lote == COORD_VENDER) {
+        for (int i = 1; i <= recusados; i++) {
+            printf("[ESTOQUE REMOTO] Venda do cartão %d recusada pelo coordenador\n",
+                   resultado_lote[i]);
+        }
+    }
+    return n;
+}
+
+static int trocar_com_lock(OperacaoCoordenador operacao_lote, const int* ids, int num_ids,
+                           int pedir, int* recebidos) {
+    pthread_mutex_lock(&ligacao_lock);
+    int n = trocar(operacao_lote, ids, num_ids, pedir, recebidos);
+    pthread_mutex_unlock(&ligacao_lock);
+    if (n < 0 && !atomic_exchange(&ligacao_perdida, 1)) {
+        printf("[ESTOQUE REMOTO] Ligação ao coordenador perdida\n");
+    }
+    return n;
+}
+
+/* Nova ligação depois de uma perdida: os cartões que o coordenador pôs
+ * em quarentena ainda podem ser confirmados ou devolvidos. Os que estavam
+ * na cache voltam já ao coordenador: passada a quarentena seriam cedidos
+ * a outro nó e vendidos duas vezes. */
+static int religar(void) {
+    int devolver[CAPACIDADE_CACHE_REMOTA];
+    int num_devolver;
+
+    pthread_mutex_lock(&ligacao_lock);
+    int fd = coordenador_abrir_endereco(endereco_coordenador, 0);
+    if (fd < 0) {
+        pthread_mutex_unlock(&ligacao_lock);
+        return 0;
+    }
+    close(ligacao);
+    ligacao = fd;
+    atomic_store(&ligacao_perdida, 0);
+
+    // Esvaziar a cache antes de se voltar a vender; os cartões da ligação
+    // anterior que ainda andam pelas agências são devolvidos um a um
+    pthread_mutex_lock(&cache_lock);
+    geracao_ligacao++;
+    num_devolver = cache_tamanho;
+    memcpy(devolver, cache, num_devolver * sizeof(int));
+    cache_tamanho = 0;
+    sem_estoque_remoto = 0;
+    pthread_mutex_unlock(&cache_lock);
+
+    int devolvidos = 0;
+    for (int i = 0; i < num_devolver; i += LOTE_MAXIMO_COORDENADOR) {
+        int n = num_devolver - i < LOTE_MAXIMO_COORDENADOR ? num_devolver - i : LOTE_MAXIMO_COORDENADOR;
+        if (trocar(COORD_LIBERAR, devolver + i, n, 0, NULL) < 0) {
+            // Os que faltam voltam ao estoque no fim da quarentena
+            atomic_store(&ligacao_perdida, 1);
+            break;
+        }
+        devolvidos += n;
+    }
+    int ok = !atomic_load(&ligacao_perdida);
+    pthread_mutex_unlock(&ligacao_lock);
+
+    printf("[ESTOQUE REMOTO] %s (%d cartões da cache devolvidos)\n",
+           ok ? "Religado ao coordenador" : "Ligação perdida outra vez ao religar", devolvidos);
+    return ok;
+}
+
+/* Retira as 'n' primeiras vendas pendentes, já confirmadas (cache_lock);
+ * as novas só entram no fim, pelo que são as mesmas que foram enviadas */
+static void retirar_vendas_confirmadas(int n) {
+    if (n <= 0) return;
+    num_vendas_pendentes -= n;
+    memmove(vendas_pendentes, vendas_pendentes + n, num_vendas_pendentes * sizeof(int));
+    pthread_cond_broadcast(&espaco_cond);
+}
+
+/* ========== SINCRONIZADOR ========== */
+
+static int precisa_sincronizar(void) {
+    return num_vendas_pendentes >= LOTE_CONFIRMACAO_REMOTA ||
+           (cache_tamanho < RESERVA_MINIMA_REMOTA && !sem_estoque_remoto);
+}
+
+/* Repõe a cache e envia as vendas: quando passam dos limites ou, no
+ * máximo, a cada INTERVALO_SINCRONIZACAO_MS. As vendas só saem das
+ * pendentes quando o coordenador responde; sem ligação, tenta religar a
+ * cada INTERVALO_RELIGACAO_REMOTA_MS */
+static void* thread_sincronizador(void* arg) {
+    (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
+
+    int vendidos[LOTE_MAXIMO_COORDENADOR];
+    int recebidos[LOTE_MAXIMO_COORDENADOR];
+
+    pthread_mutex_lock(&cache_lock);
+    while (sincronizador_ativo) {
+        int perdida = atomic_load(&ligacao_perdida);
+        long espera_ms = perdida ? INTERVALO_RELIGACAO_REMOTA_MS : INTERVALO_SINCRONIZACAO_MS;
+        struct timespec prazo;
+        clock_gettime(CLOCK_REALTIME, &prazo);
+        prazo.tv_nsec += espera_ms * 1000000L;
+        prazo.tv_sec += prazo.tv_nsec / 1000000000L;
+        prazo.tv_nsec %= 1000000000L;
+        while (sincronizador_ativo && (perdida || !precisa_sincronizar())) {
+            if (pthread_cond_timedwait(&sincronizar_cond, &cache_lock, &prazo) == ETIMEDOUT) break;
+        }
+        if (!sincronizador_ativo) break;
+
+        if (perdida) {
+            pthread_mutex_unlock(&cache_lock);
+            religar();
+            pthread_mutex_lock(&cache_lock);
+            continue;
+        }
+
+        int n = num_vendas_pendentes < LOTE_MAXIMO_COORDENADOR
+                ? num_vendas_pendentes : LOTE_MAXIMO_COORDENADOR;
+        memcpy(vendidos, vendas_pendentes, n * sizeof(int));
+
+        int pedir = 0;
+        if (cache_tamanho < RESERVA_MINIMA_REMOTA) {
+            pedir = CAPACIDADE_CACHE_REMOTA - cache_tamanho;
+            if (pedir > LOTE_ESTOQUE_REMOTO) pedir = LOTE_ESTOQUE_REMOTO;
+        }
+        pthread_mutex_unlock(&cache_lock);
+
+        int r = trocar_com_lock(COORD_VENDER, vendidos, n, pedir, recebidos);
+
+        pthread_mutex_lock(&cache_lock);
+        if (r < 0) continue;   // Ficam pendentes até voltar a haver ligação
+        retirar_vendas_confirmadas(n);
+
+        int cabem = CAPACIDADE_CACHE_REMOTA - cache_tamanho;
+        if (r > cabem) {
+            // Entretanto voltaram cartões à cache: o excesso volta ao coordenador
+            pthread_mutex_unlock(&cache_lock);
+            trocar_com_lock(COORD_LIBERAR, recebidos + cabem, r - cabem, 0, NULL);
+            pthread_mutex_lock(&cache_lock);
+            r = cabem;
+            if (r > CAPACIDADE_CACHE_REMOTA - cache_tamanho) r = CAPACIDADE_CACHE_REMOTA - cache_tamanho;
+        }
+        if (r > 0) {
+            memcpy(cache + cache_tamanho, recebidos, r * sizeof(int));
+            cache_tamanho += r;
+        }
+        sem_estoque_remoto = (pedir > 0 && r == 0);
+    }
+    pthread_cond_broadcast(&espaco_cond);
+    pthread_mutex_unlock(&cache_lock);
+    return NULL;
+}
+
+/* ========== LIGAÇÃO ========== */
+
+int estoque_remoto_ligar(const char* endereco) {
+    if (strlen(endereco) >= sizeof(endereco_coordenador)) {
+        printf("[ESTOQUE REMOTO] Endereço demasiado longo: %s\n", endereco);
+        return 0;
+    }
+    ligacao = coordenador_abrir_endereco(endereco, 0);
+    if (ligacao < 0) return 0;
+    strcpy(endereco_coordenador, endereco);
+
+    memset(&estatisticas, 0, sizeof(estatisticas));
+    atomic_store(&ligacao_perdida, 0);
+    ligado = 1;
+
+    // Primeira reserva antes de haver vendas
+    int n = trocar_com_lock(COORD_VENDER, NULL, 0, LOTE_ESTOQUE_REMOTO, cache);
+    if (n < 0) {
+        close(ligacao);
+        ligacao = -1;
+        ligado = 0;
+        return 0;
+    }
+    cache_tamanho = n;
+
+    sincronizador_ativo = 1;
+    if (pthread_create(&sincronizador, NULL, thread_sincronizador, NULL) != 0) {
+        printf("[ERRO] Falha ao criar thread de sincronização do estoque remoto\n");
+        sincronizador_ativo = 0;
+    }
+
+    printf("[ESTOQUE REMOTO] Ligado a %s: %d cartões cedidos (ida e volta %.1f µs)\n",
+           endereco, n, estatisticas.tempo_trocas_ns / 1000.0);
+    return 1;
+}
+
+void estoque_remoto_desligar(void) {
+    if (!ligado) return;
+
+    pthread_mutex_lock(&cache_lock);
+    int a_correr = sincronizador_ativo;
+    sincronizador_ativo = 0;
+    pthread_cond_broadcast(&sincronizar_cond);
+    pthread_mutex_unlock(&cache_lock);
+    if (a_correr) pthread_join(sincronizador, NULL);
+
+    // Já sem vendas: enviar as pendentes e devolver o que ficou na cache
+    if (atomic_load(&ligacao_perdida) && (num_vendas_pendentes > 0 || cache_tamanho > 0)) religar();
+    while (num_vendas_pendentes > 0 && !atomic_load(&ligacao_perdida)) {
+        int n = num_vendas_pendentes < LOTE_MAXIMO_COORDENADOR
+                ? num_vendas_pendentes : LOTE_MAXIMO_COORDENADOR;
+        if (trocar_com_lock(COORD_VENDER, vendas_pendentes, n, 0, NULL) < 0) break;
+        retirar_vendas_confirmadas(n);
+    }
+    if (num_vendas_pendentes > 0) {
+        printf("[ESTOQUE REMOTO] %d vendas por confirmar: os cartões ficam em quarentena "
+               "no coordenador\n", num_vendas_pendentes);
+    }
+    int devolvidos = 0;
+    while (cache_tamanho > 0 && !atomic_load(&ligacao_perdida)) {
+        int n = cache_tamanho < LOTE_MAXIMO_COORDENADOR ? cache_tamanho : LOTE_MAXIMO_COORDENADOR;
+        cache_tamanho -= n;
+        if (trocar_com_lock(COORD_LIBERAR, cache + cache_tamanho, n, 0, NULL) < 0) break;
+        devolvidos += n;
+    }
+
+    exibir_relatorio_estoque_remoto();
+    printf("[ESTOQUE REMOTO] Desligado (%d cartões devolvidos ao coordenador)\n", devolvidos);
+
+    close(ligacao);
+    ligacao = -1;
+    ligado = 0;
+    cache_tamanho = 0;
+    num_vendas_pendentes = 0;
+}
+
+int estoque_remoto_ativo(void) {
+    return ligado;
+}
+
+/* ========== CAMINHO DA VENDA ========== */
+
+int estoque_remoto_reservar(void) {
+    int id = -1;
+
+    pthread_mutex_lock(&cache_lock);
+    if (cache_tamanho > 0) {
+        id = cache[--cache_tamanho];
+        estatisticas.reservas_locais++;
+    } else {
+        estatisticas.faltas++;
+    }
+    if (cache_tamanho < RESERVA_MINIMA_REMOTA) pthread_cond_signal(&sincronizar_cond);
+    pthread_mutex_unlock(&cache_lock);
+
+    return id;
+}
+
+void estoque_remoto_devolver(int id) {
+    pthread_mutex_lock(&cache_lock);
+    if (geracao_cartao[id] != geracao_ligacao) {
+        // Cedido pela ligação anterior: está em quarentena, devolve-se já
+        pthread_mutex_unlock(&cache_lock);
+        trocar_com_lock(COORD_LIBERAR, &id, 1, 0, NULL);
+        return;
+    }
+    if (cache_tamanho < CAPACIDADE_CACHE_REMOTA) {
+        cache[cache_tamanho++] = id;
+    } else {
+        // Cache cheia (só se a reposição chegou entretanto): volta no próximo lote
+        pthread_mutex_unlock(&cache_lock);
+        trocar_com_lock(COORD_LIBERAR, &id, 1, 0, NULL);
+        return;
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+void estoque_remoto_confirmar(int id) {
+    pthread_mutex_lock(&cache_lock);
+    // Sincronizador atrasado: esperar que esvazie as pendentes. Sem
+    // ligação há a folga da cache; só além dela se espera pela religação
+    while (sincronizador_ativo &&
+           num_vendas_pendentes >= (atomic_load(&ligacao_perdida) ? CAPACIDADE_VENDAS_PENDENTES
+                                                                  : MAX_VENDAS_PENDENTES_REMOTAS)) {
+        pthread_cond_wait(&espaco_cond, &cache_lock);
+    }
+    if (num_vendas_pendentes < CAPACIDADE_VENDAS_PENDENTES) {
+        vendas_pendentes[num_vendas_pendentes++] = id;
+        if (num_vendas_pendentes >= LOTE_CONFIRMACAO_REMOTA) pthread_cond_signal(&sincronizar_cond);
+    } else {
+        printf("[ESTOQUE REMOTO] Venda do cartão %d sem lugar depois de desligar: "
+               "fica em quarentena no coordenador\n", id);
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+/* ========== CONSULTAS ========== */
+
+int estoque_remoto_contagem(int valores[4]) {
+    if (!ligado || atomic_load(&ligacao_perdida)) return 0;
+
+    pthread_mutex_lock(&ligacao_lock);
+    PedidoCoordenador pedido = { COORD_CONTAGEM, 0 };
+    int ok = escrever_tudo(&pedido, sizeof(pedido)) && ler_resposta(valores, 4) == 4;
+    pthread_mutex_unlock(&ligacao_lock);
+    return ok;
+}
+
+void obter_estatisticas_estoque_remoto(EstatisticasEstoqueRemoto* destino) {
+    pthread_mutex_lock(&cache_lock);
+    *destino = estatisticas;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+void exibir_relatorio_estoque_remoto(void) {
+    if (!ligado) return;
+
+    EstatisticasEstoqueRemoto e;
+    obter_estatisticas_estoque_remoto(&e);
+
+    printf("\n=== ESTOQUE REMOTO ===\n");
+    printf("Reservas servidas pela cache: %lld (%lld sem cartão)\n", e.reservas_locais, e.faltas);
+    printf("Trocas com o coordenador: %lld (média %.1f µs)\n",
+           e.trocas, e.trocas ? e.tempo_trocas_ns / 1000.0 / e.trocas : 0.0);
+    printf("Cartões recebidos: %lld (%.2f µs de rede por cartão)\n", e.cartoes_recebidos,
+           e.cartoes_recebidos ? e.tempo_trocas_ns / 1000.0 / e.cartoes_recebidos : 0.0);
+    printf("Vendas enviadas: %lld (%lld recusadas pelo coordenador)\n",
+           e.vendas_enviadas, e.vendas_recusadas);
+
+    int valores[4];
+    if (estoque_remoto_contagem(valores)) {
+        printf("Coordenador: %d disponíveis, %d cedidos, %d vendidos de %d\n",
+               valores[0], valores[1], valores[2], valores[3]);
+    }
+    printf("======================\n");
+}
@@ -0,0 +1,431 @@
+#include "fibras.h"
+#include "relogio.h"
+#include "afinidade.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+/* Valor no fundo de cada pilha, verificado a cada troca. Páginas de guarda
+ * partiriam cada pilha em dois mapeamentos e o limite do kernel
+ * (vm.max_map_count) ficaria abaixo das dezenas de milhares de fibras. */
+#define CANARIO_PILHA 0x46494252415321ULL
+
+typedef enum {
+    MOTIVO_CEDEU,        // Volta ao fim das prontas
+    MOTIVO_ESPEROU,      // Já está no heap e/ou numa fila de espera
+    MOTIVO_TERMINOU
+} MotivoTroca;
+
+typedef struct Portadora Portadora;
+
+struct Fibra {
+    ucontext_t contexto;
+    void* pilha;                  // Canário nos primeiros 8 bytes
+    FuncaoFibra funcao;
+    void* arg;
+    Portadora* portadora;
+    MotivoTroca motivo;
+
+    // Espera: ímpar = a esperar; cada espera tem o seu valor, para que
+    // um aviso atrasado não acorde a espera seguinte
+    atomic_llong espera;
+    long long acordar_ns;
+    int indice_heap;              // -1 = fora do heap
+    int avisada;
+    FilaEsperaFibras* fila_espera;
+    int na_fila;
+    Fibra* anterior_espera;
+    Fibra* seguinte_espera;
+
+    Fibra* seguinte_pronta;
+};
+
+struct Portadora {
+    pthread_t thread;
+    int indice;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    Fibra* prontas_inicio;
+    Fibra* prontas_fim;
+    Fibra** heap;                 // Adormecidas, por acordar_ns
+    int tamanho_heap;
+    int capacidade_heap;
+    int vivas;
+    Fibra* atual;
+    ucontext_t contexto_escalonador;
+};
+
+static Portadora* portadoras = NULL;
+static int num_portadoras = 0;
+static int proxima_portadora = 0;
+static size_t tamanho_pilha_fibras = PILHA_FIBRA_PADRAO;
+static atomic_int encerrar = 0;
+static atomic_int total_vivas = 0;
+static _Thread_local Portadora* portadora_atual = NULL;
+
+/* ========== HEAP DE ADORMECIDAS (lock da portadora) ========== */
+
+static void heap_trocar(Portadora* p, int a, int b) {
+    Fibra* f = p->heap[a];
+    p->heap[a] = p->heap[b];
+    p->heap[b] = f;
+    p->heap[a]->indice_heap = a;
+    p->heap[b]->indice_heap = b;
+}
+
+static void heap_subir(Portadora* p, int i) {
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (p->heap[pai]->acordar_ns <= p->heap[i]->acordar_ns) break;
+        heap_trocar(p, i, pai);
+        i = pai;
+    }
+}
+
+static void heap_descer(Portadora* p, int i) {
+    for (;;) {
+        int menor = i;
+        int esq = 2 * i + 1, dir = 2 * i + 2;
+        if (esq < p->tamanho_heap && p->heap[esq]->acordar_ns < p->heap[menor]->acordar_ns) menor = esq;
+        if (dir < p->tamanho_heap && p->heap[dir]->acordar_ns < p->heap[menor]->acordar_ns) menor = dir;
+        if (menor == i) return;
+        heap_trocar(p, i, menor);
+        i = menor;
+    }
+}
+
+static int heap_inserir(Portadora* p, Fibra* f) {
+    if (p->tamanho_heap == p->capacidade_heap) {
+        int capacidade = p->capacidade_heap ? 2 * p->capacidade_heap : 64;
+        Fibra** heap = (Fibra**)realloc(p->heap, capacidade * sizeof(Fibra*));
+        if (!heap) return 0;
+        p->heap = heap;
+        p->capacidade_heap = capacidade;
+    }
+    f->indice_heap = p->tamanho_heap++;
+    p->heap[f->indice_heap] = f;
+    heap_subir(p, f->indice_heap);
+    return 1;
+}
+
+static void heap_remover(Portadora* p, Fibra* f) {
+    int i = f->indice_heap;
+    if (i < 0) return;
+    f->indice_heap = -1;
+    if (--p->tamanho_heap == i) return;
+    p->heap[i] = p->heap[p->tamanho_heap];
+    p->heap[i]->indice_heap = i;
+    heap_subir(p, i);
+    heap_descer(p, i);
+}
+
+/* ========== PRONTAS (lock da portadora) ========== */
+
+static void colocar_pronta(Portadora* p, Fibra* f) {
+    f->seguinte_pronta = NULL;
+    if (p->prontas_fim) {
+        p->prontas_fim->seguinte_pronta = f;
+    } else {
+        p->prontas_inicio = f;
+    }
+    p->prontas_fim = f;
+}
+
+static Fibra* retirar_pronta(Portadora* p) {
+    Fibra* f = p->prontas_inicio;
+    if (f) {
+        p->prontas_inicio = f->seguinte_pronta;
+        if (!p->prontas_inicio) p->prontas_fim = NULL;
+    }
+    return f;
+}
+
+/* ========== FILAS DE ESPERA ========== */
+
+static void desligar_da_fila(FilaEsperaFibras* fila, Fibra* f) {
+    if (f->anterior_espera) f->anterior_espera->seguinte_espera = f->seguinte_espera;
+    else fila->inicio = f->seguinte_espera;
+    if (f->seguinte_espera) f->seguinte_espera->anterior_espera = f->anterior_espera;
+    else fila->fim = f->anterior_espera;
+    f->na_fila = 0;
+    atomic_fetch_sub(&fila->em_espera, 1);
+}
+
+/* Fim de espera por prazo ou interrupção (lock da portadora). A ordem dos
+ * locks é portadora -> fila; quem avisa nunca os segura ao mesmo tempo. */
+static void expirar_espera(Portadora* p, Fibra* f) {
+    long long valor = atomic_load(&f->espera);
+    if (!(valor & 1) || !atomic_compare_exchange_strong(&f->espera, &valor, valor + 1)) return;
+
+    heap_remover(p, f);
+    FilaEsperaFibras* fila = f->fila_espera;
+    if (fila) {
+        pthread_mutex_lock(&fila->lock);
+        if (f->na_fila) desligar_da_fila(fila, f);
+        pthread_mutex_unlock(&fila->lock);
+    }
+    f->avisada = 0;
+    colocar_pronta(p, f);
+}
+
+int fibras_acordar_uma(FilaEsperaFibras* fila) {
+    if (atomic_load_explicit(&fila->em_espera, memory_order_acquire) == 0) return 0;
+
+    for (;;) {
+        pthread_mutex_lock(&fila->lock);
+        Fibra* f = fila->inicio;
+        if (!f) {
+            pthread_mutex_unlock(&fila->lock);
+            return 0;
+        }
+        long long valor = atomic_load(&f->espera);
+        desligar_da_fila(fila, f);
+        pthread_mutex_unlock(&fila->lock);
+
+        // O prazo pode ter ganho entretanto: tentar a seguinte
+        if (!(valor & 1) || !atomic_compare_exchange_strong(&f->espera, &valor, valor + 1)) continue;
+
+        Portadora* p = f->portadora;
+        pthread_mutex_lock(&p->lock);
+        heap_remover(p, f);
+        f->avisada = 1;
+        colocar_pronta(p, f);
+        pthread_cond_signal(&p->cond);
+        pthread_mutex_unlock(&p->lock);
+        return 1;
+    }
+}
+
+void fibras_acordar_todas(FilaEsperaFibras* fila) {
+    while (fibras_acordar_uma(fila)) {
+    }
+}
+
+/* ========== DENTRO DE UMA FIBRA ========== */
+
+static void trocar_para_escalonador(Fibra* f, MotivoTroca motivo) {
+    f->motivo = motivo;
+    swapcontext(&f->contexto, &f->portadora->contexto_escalonador);
+}
+
+void fibra_ceder(void) {
+    Portadora* p = portadora_atual;
+    if (!p || !p->atual) return;
+    trocar_para_escalonador(p->atual, MOTIVO_CEDEU);
+}
+
+int fibra_esperar(FilaEsperaFibras* fila, long long prazo_ns) {
+    Portadora* p = portadora_atual;
+    if (!p || !p->atual) return 0;
+    Fibra* f = p->atual;
+    if (atomic_load(&encerrar)) return 0;   // A encerrar: nada adormece
+
+    f->avisada = 0;
+    f->fila_espera = fila;
+    long long valor = atomic_load(&f->espera) + 1;
+    atomic_store(&f->espera, valor);
+
+    // Primeiro o prazo: um aviso que chegue já encontra a fibra no heap
+    pthread_mutex_lock(&p->lock);
+    f->acordar_ns = prazo_ns;
+    if (prazo_ns >= 0 && !heap_inserir(p, f)) {
+        atomic_store(&f->espera, valor + 1);
+        pthread_mutex_unlock(&p->lock);
+        return 0;
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    if (fila) {
+        pthread_mutex_lock(&fila->lock);
+        f->seguinte_espera = NULL;
+        f->anterior_espera = fila->fim;
+        if (fila->fim) fila->fim->seguinte_espera = f;
+        else fila->inicio = f;
+        fila->fim = f;
+        f->na_fila = 1;
+        atomic_fetch_add(&fila->em_espera, 1);
+        pthread_mutex_unlock(&fila->lock);
+    }
+
+    trocar_para_escalonador(f, MOTIVO_ESPEROU);
+    return f->avisada;
+}
+
+void fibra_dormir_ate(long long instante_ns) {
+    fibra_esperar(NULL, instante_ns);
+}
+
+/* ========== PORTADORAS ========== */
+
+static void entrada_fibra(void) {
+    Fibra* f = portadora_atual->atual;
+    f->funcao(f->arg);
+    trocar_para_escalonador(f, MOTIVO_TERMINOU);
+}
+
+static void destruir_fibra(Fibra* f) {
+    munmap(f->pilha, tamanho_pilha_fibras);
+    free(f);
+}
+
+static void acordar_expiradas(Portadora* p, long long agora) {
+    while (p->tamanho_heap > 0 && p->heap[0]->acordar_ns <= agora) {
+        Fibra* f = p->heap[0];
+        heap_remover(p, f);
+        f->indice_heap = -1;
+        expirar_espera(p, f);
+    }
+}
+
+static void* thread_portadora(void* arg) {
+    Portadora* p = (Portadora*)arg;
+    portadora_atual = p;
+    aplicar_afinidade_thread(CLASSE_AGENCIA, p->indice);
+
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        acordar_expiradas(p, atomic_load(&encerrar) ? LLONG_MAX : relogio_agora_ns());
+
+        Fibra* f = retirar_pronta(p);
+        if (!f) {
+            if (p->vivas == 0 && atomic_load(&encerrar)) break;
+            if (p->tamanho_heap > 0) {
+                long long prazo_ns = p->heap[0]->acordar_ns;
+                struct timespec prazo = {
+                    .tv_sec = prazo_ns / NS_POR_SEGUNDO,
+                    .tv_nsec = prazo_ns % NS_POR_SEGUNDO
+                };
+                pthread_cond_timedwait(&p->cond, &p->lock, &prazo);
+            } else {
+                pthread_cond_wait(&p->cond, &p->lock);
+            }
+            continue;
+        }
+
+        p->atual = f;
+        pthread_mutex_unlock(&p->lock);
+        swapcontext(&p->contexto_escalonador, &f->contexto);
+        if (*(uint64_t*)f->pilha != CANARIO_PILHA) {
+            printf("[FIBRAS] A pilha de uma fibra transbordou (%zu bytes); aumente PILHA_FIBRA_PADRAO\n",
+                   tamanho_pilha_fibras);
+            abort();
+        }
+        pthread_mutex_lock(&p->lock);
+        p->atual = NULL;
+
+        if (f->motivo == MOTIVO_TERMINOU) {
+            destruir_fibra(f);
+            p->vivas--;
+            atomic_fetch_sub(&total_vivas, 1);
+        } else if (f->motivo == MOTIVO_CEDEU) {
+            colocar_pronta(p, f);
+        }
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+int fibras_iniciar(int n, size_t tamanho_pilha) {
+    if (portadoras) return 0;
+    if (n < 1) n = 1;
+    if (n > MAX_PORTADORAS_FIBRAS) n = MAX_PORTADORAS_FIBRAS;
+
+    long pagina = sysconf(_SC_PAGESIZE);
+    if (tamanho_pilha < (size_t)(4 * pagina)) tamanho_pilha = 4 * pagina;
+    tamanho_pilha_fibras = (tamanho_pilha + pagina - 1) / pagina * pagina;
+
+    portadoras = (Portadora*)calloc(n, sizeof(Portadora));
+    if (!portadoras) return 0;
+
+    atomic_store(&encerrar, 0);
+    proxima_portadora = 0;
+    for (int i = 0; i < n; i++) {
+        Portadora* p = &portadoras[i];
+        p->indice = i;
+        pthread_mutex_init(&p->lock, NULL);
+        pthread_cond_init(&p->cond, NULL);
+        if (pthread_create(&p->thread, NULL, thread_portadora, p) != 0) {
+            printf("[FIBRAS] Falha ao criar a portadora %d\n", i);
+            pthread_mutex_destroy(&p->lock);
+            pthread_cond_destroy(&p->cond);
+            break;
+        }
+        num_portadoras++;
+    }
+
+    if (num_portadoras == 0) {
+        free(portadoras);
+        portadoras = NULL;
+        return 0;
+    }
+    return num_portadoras;
+}
+
+int fibra_criar(FuncaoFibra funcao, void* arg) {
+    if (!portadoras) return 0;
+
+    Fibra* f = (Fibra*)calloc(1, sizeof(Fibra));
+    if (!f) return 0;
+
+    // Só as páginas tocadas ocupam memória
+    f->pilha = mmap(NULL, tamanho_pilha_fibras, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (f->pilha == MAP_FAILED) {
+        free(f);
+        return 0;
+    }
+    *(uint64_t*)f->pilha = CANARIO_PILHA;
+
+    getcontext(&f->contexto);
+    f->contexto.uc_stack.ss_sp = (char*)f->pilha + sizeof(uint64_t);
+    f->contexto.uc_stack.ss_size = tamanho_pilha_fibras - sizeof(uint64_t);
+    f->contexto.uc_link = NULL;
+    makecontext(&f->contexto, entrada_fibra, 0);
+
+    f->funcao = funcao;
+    f->arg = arg;
+    f->indice_heap = -1;
+    atomic_init(&f->espera, 0);
+
+    Portadora* p = &portadoras[proxima_portadora];
+    proxima_portadora = (proxima_portadora + 1) % num_portadoras;
+    f->portadora = p;
+
+    pthread_mutex_lock(&p->lock);
+    p->vivas++;
+    atomic_fetch_add(&total_vivas, 1);
+    colocar_pronta(p, f);
+    pthread_cond_signal(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+    return 1;
+}
+
+void fibras_aguardar(void) {
+    if (!portadoras) return;
+
+    atomic_store(&encerrar, 1);
+    for (int i = 0; i < num_portadoras; i++) {
+        pthread_mutex_lock(&portadoras[i].lock);
+        pthread_cond_signal(&portadoras[i].cond);
+        pthread_mutex_unlock(&portadoras[i].lock);
+    }
+    for (int i = 0; i < num_portadoras; i++) {
+        Portadora* p = &portadoras[i];
+        pthread_join(p->thread, NULL);
+        free(p->heap);
+        pthread_mutex_destroy(&p->lock);
+        pthread_cond_destroy(&p->cond);
+    }
+    free(portadoras);
+    portadoras = NULL;
+    num_portadoras = 0;
+}
+
+int fibras_vivas(void) {
+    return atomic_load(&total_vivas);
+}
@@ -0,0 +1,340 @@
+#include "gerador.h"
+#include "vendas.h"
+#include "relogio.h"
+#include "afinidade.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+static const char* nomes_tipos[2] = { "empresa", "publico" };
+static const char* nomes_processos[2] = { "poisson", "rajadas" };
+
+/* Configuração por tipo de cliente */
+static struct {
+    int configurado;
+    ProcessoChegadas processo;
+    double taxa;          // Total do tipo (clientes/s)
+    int produtores;
+} config_tipo[2];
+
+/* Estado de uma thread produtora */
+typedef struct {
+    TipoCliente tipo;
+    ProcessoChegadas processo;
+    double taxa;                  // Parte desta thread (clientes/s)
+    unsigned short semente[3];    // erand48: sequência própria, sem locks
+    int em_rajada;
+    long long fim_periodo;        // Fim da rajada ou do silêncio atual (ns)
+    int proximo_id;
+    int fim_ids;
+    pthread_t thread;
+} Produtor;
+
+static Produtor* produtores = NULL;
+static int num_produtores = 0;
+static FilaPrioridade* fila_gerador = NULL;
+static pthread_t thread_relatorio;
+static int relatorio_criado = 0;
+static atomic_int gerador_ativo = 0;
+static atomic_int proximo_bloco_ids = ID_PRIMEIRO_CLIENTE_GERADO;
+static long long inicio_ns = 0;
+static long long fim_ns = 0;
+static int vendas_inicio = 0;
+
+// Contadores globais, somados por lote para não disputar a linha a cada chegada
+static atomic_llong oferecidas[2];
+static atomic_llong aceites[2];
+static atomic_llong recusadas[2];
+
+/* ========== CONFIGURAÇÃO ========== */
+
+int configurar_gerador(const char* especificacao) {
+    if (!especificacao) return 0;
+
+    const char* igual = strchr(especificacao, '=');
+    const char* dois_pontos = igual ? strchr(igual, ':') : NULL;
+    if (!igual || !dois_pontos) {
+        printf("[GERADOR] Especificação inválida: %s (esperado tipo=processo:taxa[:produtores])\n",
+               especificacao);
+        return 0;
+    }
+
+    int tipo = -1;
+    size_t tamanho_tipo = (size_t)(igual - especificacao);
+    for (int t = 0; t < 2; t++) {
+        if (strlen(nomes_tipos[t]) == tamanho_tipo &&
+            strncmp(nomes_tipos[t], especificacao, tamanho_tipo) == 0) tipo = t;
+    }
+
+    int processo = -1;
+    size_t tamanho_processo = (size_t)(dois_pontos - igual - 1);
+    for (int p = 0; p < 2; p++) {
+        if (strlen(nomes_processos[p]) == tamanho_processo &&
+            strncmp(nomes_processos[p], igual + 1, tamanho_processo) == 0) processo = p;
+    }
+
+    if (tipo < 0 || processo < 0) {
+        printf("[GERADOR] Tipo ou processo desconhecido: %s (tipos: empresa, publico; "
+               "processos: poisson, rajadas)\n", especificacao);
+        return 0;
+    }
+
+    char* fim;
+    double taxa = strtod(dois_pontos + 1, &fim);
+    int num = 1;
+    if (*fim == ':') num = (int)strtol(fim + 1, &fim, 10);
+    if (*fim != '\0' || !(taxa > 0) || taxa > 1e9 || num < 1 || num > MAX_PRODUTORES_TIPO) {
+        printf("[GERADOR] Taxa ou produtores inválidos: %s (taxa 0-1e9/s, 1-%d produtores)\n",
+               dois_pontos + 1, MAX_PRODUTORES_TIPO);
+        return 0;
+    }
+
+    config_tipo[tipo].configurado = 1;
+    config_tipo[tipo].processo = (ProcessoChegadas)processo;
+    config_tipo[tipo].taxa = taxa;
+    config_tipo[tipo].produtores = num;
+    return 1;
+}
+
+int gerador_configurado(void) {
+    return config_tipo[EMPRESA].configurado || config_tipo[PUBLICO].configurado;
+}
+
+/* ========== PROCESSOS DE CHEGADA ========== */
+
+/* Intervalo exponencial (ns) para uma taxa em eventos/s */
+static long long intervalo_exponencial(Produtor* p, double taxa) {
+    double u = erand48(p->semente);
+    return (long long)(-log(1.0 - u) / taxa * NS_POR_SEGUNDO) + 1;
+}
+
+/* Instante da próxima chegada depois de 'instante'. Nas rajadas a taxa
+ * alterna entre taxa * FATOR_RAJADA e zero; como o processo não tem
+ * memória, basta recomeçar no fim de cada período. */
+static long long proxima_chegada(Produtor* p, long long instante) {
+    if (p->processo == CHEGADAS_POISSON) {
+        return instante + intervalo_exponencial(p, p->taxa);
+    }
+
+    for (;;) {
+        if (p->em_rajada) {
+            long long chegada = instante + intervalo_exponencial(p, p->taxa * FATOR_RAJADA);
+            if (chegada <= p->fim_periodo) return chegada;
+
+            // Fim da rajada: silêncio com média DURACAO_RAJADA_MS * (FATOR - 1)
+            instante = p->fim_periodo;
+            p->em_rajada = 0;
+            p->fim_periodo = instante + intervalo_exponencial(
+                p, 1000.0 / (DURACAO_RAJADA_MS * (FATOR_RAJADA - 1)));
+        } else {
+            instante = p->fim_periodo;
+            p->em_rajada = 1;
+            p->fim_periodo = instante + intervalo_exponencial(p, 1000.0 / DURACAO_RAJADA_MS);
+        }
+    }
+}
+
+static int novo_id_cliente(Produtor* p) {
+    if (p->proximo_id == p->fim_ids) {
+        p->proximo_id = atomic_fetch_add(&proximo_bloco_ids, BLOCO_IDS_GERADOR);
+        p->fim_ids = p->proximo_id + BLOCO_IDS_GERADOR;
+    }
+    return p->proximo_id++;
+}
+
+/* Produtor: gera as chegadas já vencidas e dorme até à próxima (ou um
+ * tique); se não acompanhar a taxa, vai produzindo sem dormir */
+static void* thread_produtor(void* arg) {
+    Produtor* p = (Produtor*)arg;
+    aplicar_afinidade_thread(CLASSE_GERADOR, (int)(p - produtores));
+
+    long long agora = relogio_agora_ns();
+    p->fim_periodo = agora;
+    p->em_rajada = 0;
+    long long proxima = proxima_chegada(p, agora);
+
+    while (atomic_load(&gerador_ativo)) {
+        agora = relogio_agora_ns();
+        long long lote_oferecidas = 0, lote_aceites = 0;
+
+        while (proxima <= agora && lote_oferecidas < LOTE_MAXIMO_PRODUTOR) {
+            lote_oferecidas++;
+            lote_aceites += tentar_inserir_cliente(fila_gerador, novo_id_cliente(p), p->tipo);
+            proxima = proxima_chegada(p, proxima);
+        }
+
+        if (lote_oferecidas > 0) {
+            atomic_fetch_add(&oferecidas[p->tipo], lote_oferecidas);
+            atomic_fetch_add(&aceites[p->tipo], lote_aceites);
+            atomic_fetch_add(&recusadas[p->tipo], lote_oferecidas - lote_aceites);
+        }
+
+        if (proxima > agora) {
+            long espera_ms = (long)((proxima - agora) / 1000000LL);
+            if (espera_ms < 1) espera_ms = 1;
+            if (espera_ms > ESPERA_MAXIMA_PRODUTOR_MS) espera_ms = ESPERA_MAXIMA_PRODUTOR_MS;
+            relogio_dormir_ms(espera_ms);
+        }
+    }
+    return NULL;
+}
+
+static long long total_contador(atomic_llong contador[2]) {
+    return atomic_load(&contador[EMPRESA]) + atomic_load(&contador[PUBLICO]);
+}
+
+/* Uma linha por intervalo: chegadas, recusas, fila e ritmo de vendas */
+static void* thread_relatorio_gerador(void* arg) {
+    (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
+
+    long long instante_anterior = relogio_agora_ns();
+    long long oferecidas_anteriores = 0, aceites_anteriores = 0, recusadas_anteriores = 0;
+    int vendas_anteriores = get_vendas_totais();
+
+    while (atomic_load(&gerador_ativo)) {
+        relogio_dormir_ms(INTERVALO_RELATORIO_GERADOR_MS);
+        if (!atomic_load(&gerador_ativo)) break;
+
+        long long agora = relogio_agora_ns();
+        double intervalo = (agora - instante_anterior) / 1e9;
+        long long total_oferecidas = total_contador(oferecidas);
+        long long total_aceites = total_contador(aceites);
+        long long total_recusadas = total_contador(recusadas);
+        int vendas = get_vendas_totais();
+
+        pthread_mutex_lock(&fila_gerador->lock);
+        int tamanho = fila_gerador->tamanho;
+        pthread_mutex_unlock(&fila_gerador->lock);
+
+        printf("[GERADOR] %6.1fs | oferecidas %10.0f/s | aceites %10.0f/s | "
+               "recusadas %10.0f/s | fila %3d/%d | vendas %8.1f/s\n",
+               (agora - inicio_ns) / 1e9,
+               (total_oferecidas - oferecidas_anteriores) / intervalo,
+               (total_aceites - aceites_anteriores) / intervalo,
+               (total_recusadas - recusadas_anteriores) / intervalo,
+               tamanho, MAX_FILA,
+               (vendas - vendas_anteriores) / intervalo);
+
+        instante_anterior = agora;
+        oferecidas_anteriores = total_oferecidas;
+        aceites_anteriores = total_aceites;
+        recusadas_anteriores = total_recusadas;
+        vendas_anteriores = vendas;
+    }
+    return NULL;
+}
+
+/* ========== CICLO DE VIDA ========== */
+
+int iniciar_gerador(FilaPrioridade* fila) {
+    if (!fila || !gerador_configurado()) return 0;
+    if (atomic_load(&gerador_ativo)) {
+        printf("[GERADOR] Já em execução\n");
+        return 0;
+    }
+    if (relogio_virtual()) {
+        // As threads produtoras vivem em tempo real; o tempo virtual só avança por eventos
+        printf("[GERADOR] Só disponível em tempo real\n");
+        return 0;
+    }
+
+    int total = config_tipo[EMPRESA].produtores * config_tipo[EMPRESA].configurado +
+                config_tipo[PUBLICO].produtores * config_tipo[PUBLICO].configurado;
+    produtores = (Produtor*)calloc((size_t)total, sizeof(Produtor));
+    if (!produtores) return 0;
+
+    fila_gerador = fila;
+    for (int t = 0; t < 2; t++) {
+        atomic_store(&oferecidas[t], 0);
+        atomic_store(&aceites[t], 0);
+        atomic_store(&recusadas[t], 0);
+    }
+    inicio_ns = relogio_agora_ns();
+    fim_ns = 0;
+    vendas_inicio = get_vendas_totais();
+    atomic_store(&gerador_ativo, 1);
+
+    num_produtores = 0;
+    for (int t = 0; t < 2; t++) {
+        if (!config_tipo[t].configurado) continue;
+
+        printf("[GERADOR] %s: %s a %.0f clientes/s em %d produtor(es)\n",
+               nomes_tipos[t], nomes_processos[config_tipo[t].processo],
+               config_tipo[t].taxa, config_tipo[t].produtores);
+
+        for (int k = 0; k < config_tipo[t].produtores; k++) {
+            Produtor* p = &produtores[num_produtores];
+            p->tipo = (TipoCliente)t;
+            p->processo = config_tipo[t].processo;
+            p->taxa = config_tipo[t].taxa / config_tipo[t].produtores;
+            p->semente[0] = (unsigned short)(inicio_ns >> 16);
+            p->semente[1] = (unsigned short)t;
+            p->semente[2] = (unsigned short)num_produtores;
+
+            if (pthread_create(&p->thread, NULL, thread_produtor, p) != 0) {
+                printf("[ERRO] Falha ao criar produtor %d de %s\n", k + 1, nomes_tipos[t]);
+                break;
+            }
+            num_produtores++;
+        }
+    }
+
+    relatorio_criado = pthread_create(&thread_relatorio, NULL, thread_relatorio_gerador, NULL) == 0;
+    if (!relatorio_criado) {
+        printf("[ERRO] Falha ao criar relatório do gerador\n");
+    }
+    return 1;
+}
+
+void parar_gerador(void) {
+    if (!atomic_exchange(&gerador_ativo, 0)) return;
+    fim_ns = relogio_agora_ns();
+
+    for (int i = 0; i < num_produtores; i++) {
+        pthread_join(produtores[i].thread, NULL);
+    }
+    if (relatorio_criado) pthread_join(thread_relatorio, NULL);
+    relatorio_criado = 0;
+
+    free(produtores);
+    produtores = NULL;
+    num_produtores = 0;
+}
+
+/* ========== ESTATÍSTICAS ========== */
+
+void obter_estatisticas_gerador(EstatisticasGerador* destino) {
+    if (!destino) return;
+
+    for (int t = 0; t < 2; t++) {
+        destino->por_tipo[t].oferecidas = atomic_load(&oferecidas[t]);
+        destino->por_tipo[t].aceites = atomic_load(&aceites[t]);
+        destino->por_tipo[t].recusadas = atomic_load(&recusadas[t]);
+    }
+    long long fim = atomic_load(&gerador_ativo) ? relogio_agora_ns() : fim_ns;
+    destino->duracao_s = inicio_ns > 0 ? (fim - inicio_ns) / 1e9 : 0;
+}
+
+void exibir_relatorio_gerador(void) {
+    EstatisticasGerador estatisticas;
+    obter_estatisticas_gerador(&estatisticas);
+    double duracao = estatisticas.duracao_s > 0 ? estatisticas.duracao_s : 1;
+
+    printf("\n=== RELATÓRIO DO GERADOR DE CHEGADAS ===\n");
+    printf("Duração: %.1fs\n", estatisticas.duracao_s);
+    for (int t = 0; t < 2; t++) {
+        if (!config_tipo[t].configurado) continue;
+        ContagemChegadas* c = &estatisticas.por_tipo[t];
+        printf("%-8s oferecidas %lld (%.0f/s), aceites %lld (%.0f/s), recusadas %lld (%.1f%%)\n",
+               nomes_tipos[t], c->oferecidas, c->oferecidas / duracao,
+               c->aceites, c->aceites / duracao, c->recusadas,
+               c->oferecidas > 0 ? 100.0 * c->recusadas / c->oferecidas : 0);
+    }
+    int vendas = get_vendas_totais() - vendas_inicio;
+    printf("Vendas: %d (%.1f/s)\n", vendas, vendas / duracao);
+    printf("========================================\n");
+}
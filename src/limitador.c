@@ -0,0 +1,179 @@
+#include "limitador.h"
+#include "relogio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+static const char* nomes_etapas[2] = { "entrada", "atendimento" };
+static const char* nomes_tipos[2] = { "empresa", "publico" };
+
+/* Um balde: a próxima ficha fica disponível em 'tat_ns'; com rajada R
+ * pode-se adiantar até (R - 1) intervalos a esse instante */
+typedef struct {
+    _Alignas(64) atomic_llong tat_ns;
+    atomic_llong intervalo_ns;     // 0 = sem limite
+    atomic_llong tolerancia_ns;
+    atomic_llong aceites;
+    atomic_llong recusados;
+} Balde;
+
+static Balde baldes[2][2];   // [EtapaLimite][TipoCliente]
+
+/* ========== CONFIGURAÇÃO ========== */
+
+void definir_limite(EtapaLimite etapa, TipoCliente tipo, double taxa, int rajada) {
+    Balde* balde = &baldes[etapa][tipo];
+    long long intervalo = taxa > 0 ? (long long)(NS_POR_SEGUNDO / taxa) : 0;
+    if (taxa > 0 && intervalo < 1) intervalo = 1;
+    if (rajada < 1) rajada = 1;
+
+    // Sem limite primeiro, para nenhuma verificação ver a tolerância nova
+    // com o intervalo antigo; o instante volta a zero (balde cheio)
+    atomic_store(&balde->intervalo_ns, 0);
+    atomic_store(&balde->tolerancia_ns, (rajada - 1) * intervalo);
+    atomic_store(&balde->tat_ns, 0);
+    atomic_store(&balde->intervalo_ns, intervalo);
+}
+
+int configurar_limite(const char* especificacao) {
+    if (!especificacao) return 0;
+
+    const char* dois_pontos = strchr(especificacao, ':');
+    const char* igual = dois_pontos ? strchr(dois_pontos, '=') : NULL;
+    if (!dois_pontos || !igual) {
+        printf("[LIMITES] Especificação inválida: %s (esperado etapa:tipo=taxa[:rajada])\n",
+               especificacao);
+        return 0;
+    }
+
+    int etapa = -1;
+    size_t tamanho_etapa = (size_t)(dois_pontos - especificacao);
+    for (int e = 0; e < 2; e++) {
+        if (strlen(nomes_etapas[e]) == tamanho_etapa &&
+            strncmp(nomes_etapas[e], especificacao, tamanho_etapa) == 0) etapa = e;
+    }
+
+    int tipo = -1;
+    size_t tamanho_tipo = (size_t)(igual - dois_pontos - 1);
+    for (int t = 0; t < 2; t++) {
+        if (strlen(nomes_tipos[t]) == tamanho_tipo &&
+            strncmp(nomes_tipos[t], dois_pontos + 1, tamanho_tipo) == 0) tipo = t;
+    }
+
+    if (etapa < 0 || tipo < 0) {
+        printf("[LIMITES] Etapa ou tipo desconhecido: %s (etapas: entrada, atendimento; "
+               "tipos: empresa, publico)\n", especificacao);
+        return 0;
+    }
+
+    char* fim;
+    double taxa = strtod(igual + 1, &fim);
+    long rajada = RAJADA_LIMITE_PADRAO;
+    if (*fim == ':') rajada = strtol(fim + 1, &fim, 10);
+    if (*fim != '\0' || !(taxa >= 0) || taxa > 1e9 || rajada < 1 || rajada > 1000000) {
+        printf("[LIMITES] Taxa ou rajada inválida: %s (taxa 0-1e9/s, rajada 1-1000000)\n",
+               igual + 1);
+        return 0;
+    }
+
+    definir_limite((EtapaLimite)etapa, (TipoCliente)tipo, taxa, (int)rajada);
+    printf("[LIMITES] %s de %s: %s\n", nomes_etapas[etapa], nomes_tipos[tipo],
+           taxa > 0 ? "limitada" : "sem limite");
+    return 1;
+}
+
+int limite_ativo(EtapaLimite etapa, TipoCliente tipo) {
+    return atomic_load_explicit(&baldes[etapa][tipo].intervalo_ns, memory_order_relaxed) > 0;
+}
+
+/* ========== VERIFICAÇÃO ========== */
+
+int limite_permitir(EtapaLimite etapa, TipoCliente tipo) {
+    Balde* balde = &baldes[etapa][tipo];
+    long long intervalo = atomic_load_explicit(&balde->intervalo_ns, memory_order_acquire);
+    if (intervalo == 0) return 1;
+
+    long long tolerancia = atomic_load_explicit(&balde->tolerancia_ns, memory_order_relaxed);
+    long long agora = relogio_agora_ns();
+    long long tat = atomic_load_explicit(&balde->tat_ns, memory_order_relaxed);
+    long long novo;
+
+    do {
+        long long base = tat > agora ? tat : agora;
+        if (base - agora > tolerancia) {
+            atomic_fetch_add_explicit(&balde->recusados, 1, memory_order_relaxed);
+            return 0;
+        }
+        novo = base + intervalo;
+    } while (!atomic_compare_exchange_weak_explicit(&balde->tat_ns, &tat, novo,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+
+    atomic_fetch_add_explicit(&balde->aceites, 1, memory_order_relaxed);
+    return 1;
+}
+
+/* Devolve a ficha de um 'limite_permitir' cujo cliente não chegou a ser
+ * servido: recua o instante teórico um intervalo, sem o pôr antes de
+ * agora (o balde não fica mais cheio do que a rajada permite) */
+void limite_devolver(EtapaLimite etapa, TipoCliente tipo) {
+    Balde* balde = &baldes[etapa][tipo];
+    long long intervalo = atomic_load_explicit(&balde->intervalo_ns, memory_order_acquire);
+    if (intervalo == 0) return;
+
+    long long agora = relogio_agora_ns();
+    long long tat = atomic_load_explicit(&balde->tat_ns, memory_order_relaxed);
+    long long novo;
+
+    do {
+        if (tat <= agora) return;   // Balde já cheio: nada a devolver
+        novo = tat - intervalo;
+        if (novo < agora) novo = agora;
+    } while (!atomic_compare_exchange_weak_explicit(&balde->tat_ns, &tat, novo,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+
+    atomic_fetch_sub_explicit(&balde->aceites, 1, memory_order_relaxed);
+}
+
+/* ========== ESTATÍSTICAS ========== */
+
+void obter_estatisticas_limites(EstatisticasLimites* destino) {
+    if (!destino) return;
+
+    for (int e = 0; e < 2; e++) {
+        for (int t = 0; t < 2; t++) {
+            Balde* balde = &baldes[e][t];
+            ContagemLimite* contagem = &destino->etapa[e][t];
+            long long intervalo = atomic_load(&balde->intervalo_ns);
+
+            contagem->taxa = intervalo > 0 ? (double)NS_POR_SEGUNDO / intervalo : 0;
+            contagem->rajada = intervalo > 0 ?
+                (int)(atomic_load(&balde->tolerancia_ns) / intervalo) + 1 : 0;
+            contagem->aceites = atomic_load(&balde->aceites);
+            contagem->recusados = atomic_load(&balde->recusados);
+        }
+    }
+}
+
+void exibir_relatorio_limites(void) {
+    EstatisticasLimites estatisticas;
+    obter_estatisticas_limites(&estatisticas);
+
+    printf("\n=== LIMITES DE RITMO ===\n");
+    for (int e = 0; e < 2; e++) {
+        for (int t = 0; t < 2; t++) {
+            ContagemLimite* c = &estatisticas.etapa[e][t];
+            long long total = c->aceites + c->recusados;
+            if (c->taxa <= 0 && total == 0) continue;
+
+            printf("%-11s %-7s | ", nomes_etapas[e], nomes_tipos[t]);
+            if (c->taxa > 0) printf("%.1f/s rajada %-4d | ", c->taxa, c->rajada);
+            else printf("sem limite         | ");
+            printf("%lld aceites | %lld %s (%.1f%%)\n", c->aceites, c->recusados,
+                   e == LIMITE_ENTRADA ? "recusados" : "adiados",
+                   total > 0 ? c->recusados * 100.0 / total : 0);
+        }
+    }
+}
@@ -5,12 +5,26 @@
 #include <time.h>
 #include <pthread.h>
 #include <string.h>
+#include <getopt.h>
+#include <limits.h>
 
 #include "estoque.h"
 #include "Fila_prioridade.h"
 #include "vendas.h"
 #include "contratacoes.h"
 #include "webserver.h"
+#include "relogio.h"
+#include "utils.h"
+#include "diario.h"
+#include "pipeline.h"
+#include "afinidade.h"
+#include "gerador.h"
+#include "traco.h"
+#include "reproducao.h"
+#include "multiprocesso.h"
+#include "coordenador.h"
+#include "estoque_remoto.h"
+#include "limitador.h"
 
 #define SIMULACAO_ATIVA 1
 #define TEMPO_TOTAL_SIMULACAO 60
@@ -18,6 +32,20 @@
 
 static volatile int sistema_executando = 1;
 static volatile int modo_interativo = 0;
+static int num_agencias_config = NUM_AGENCIAS_PADRAO;
+static const char* caminho_diario = NULL;
+static int clientes_benchmark = 0;   // > 0: só correr o benchmark do pipeline
+static int clientes_benchmark_processos = 0;   // > 0: threads vs processos
+static int agencias_processos = 0;   // Uma agência por processo
+static int agencias_fibras = 0;      // Uma fibra por agência
+static int desistencias_configuradas = 0;   // Alguma paciência definida
+static int limites_configurados = 0;        // Algum limite de ritmo definido
+static const char* endereco_coordenador = NULL;      // Servir o estoque e sair
+static const char* endereco_estoque_remoto = NULL;   // Vender do coordenador
+static const char* caminho_traco = NULL;        // Gravar operações
+static const char* caminho_reproducao = NULL;   // Reproduzir um traço
+static ModoReproducao modo_reproducao = REPRODUCAO_TEMPO_ORIGINAL;
+static unsigned semente = 0;
 
 // Variáveis globais exportadas
 FilaPrioridade* fila_global = NULL;
@@ -29,6 +57,7 @@ void handler_sigint(int sig) {
     printf("\n\n⚠️  INTERRUPÇÃO RECEBIDA - Ctrl+C\n");
     printf("Encerrando sistema de forma segura...\n");
     sistema_executando = 0;
+    pedir_paragem_agencias_processos();
 }
 
 /* Handler para SIGTERM */
@@ -36,6 +65,7 @@ void handler_sigterm(int sig) {
     (void)sig;
     printf("\n\n⚠️  SINAL DE TÉRMINO RECEBIDO\n");
     sistema_executando = 0;
+    pedir_paragem_agencias_processos();
 }
 
 /* Configurar handlers de sinal */
@@ -86,6 +116,20 @@ static void* wrapper_demissao(void* arg) {
     return NULL;
 }
 
+/* Alerta de limiar de estoque (chamado por quem alterou o estoque) */
+static void alerta_limiar_estoque(int limiar, int disponiveis, int descendo, void* arg) {
+    (void)arg;
+
+    if (limiar == 0 && descendo) {
+        printf("\n[ALERTA] 📦 Estoque esgotado!\n");
+    } else if (limiar == 0) {
+        printf("\n[ALERTA] 📦 Estoque reposto: %d disponíveis\n", disponiveis);
+    } else if (descendo) {
+        printf("\n[ALERTA] 📦 Estoque baixo: %d disponíveis (limiar %d)\n",
+               disponiveis, limiar);
+    }
+}
+
 /* Inicializar todos os módulos */
 int inicializar_sistema(void) {
     printf("\n");
@@ -98,10 +142,23 @@ int inicializar_sistema(void) {
     printf("[SISTEMA] 🔧 Inicializando módulos...\n");
     printf("────────────────────────────────────────────────────\n");
     
+    exibir_topologia();
+    
     printf("[SISTEMA] 📦 Inicializando estoque... ");
     fflush(stdout);
-    inicializar_estoque();
-    printf("OK (%d cartões)\n", TOTAL_CARTOES);
+    inicializar_estoque_fragmentado(num_agencias_config);
+    iniciar_recolhedor_retencoes();
+    iniciar_rebalanceador_estoque();
+    iniciar_reabastecedor_estoque(LOTE_REPOSICAO_PADRAO, LIMIAR_REPOSICAO_PADRAO);
+    if (estoque_registrar_limiar(LIMIAR_ESTOQUE_BAIXO, alerta_limiar_estoque, NULL) < 0 ||
+        estoque_registrar_limiar(0, alerta_limiar_estoque, NULL) < 0) {
+        printf("\n[SISTEMA] ⚠️  Sem slots de limiar livres: alertas de estoque desligados\n");
+    }
+    printf("OK (%d cartões, %d fragmentos)\n", TOTAL_CARTOES, get_num_fragmentos_estoque());
+    
+    if (endereco_estoque_remoto && !estoque_remoto_ligar(endereco_estoque_remoto)) {
+        return 0;
+    }
     
     printf("[SISTEMA] 👥 Inicializando fila de prioridade... ");
     fflush(stdout);
@@ -114,8 +171,22 @@ int inicializar_sistema(void) {
     
     printf("[SISTEMA] 🏢 Inicializando agências... ");
     fflush(stdout);
+    definir_num_agencias(num_agencias_config);
     inicializar_sistema_vendas(fila_global);
-    printf("OK (%d agências)\n", NUM_AGENCIAS);
+    printf("OK (%d agências, %d trabalhadores)\n", get_num_agencias(), get_num_trabalhadores());
+    
+    if (caminho_diario && !diario_abrir(caminho_diario)) {
+        return 0;
+    }
+    
+    if (caminho_traco) {
+        long duracoes[3];
+        int limites[3];
+        obter_configuracao_turnos(duracoes, limites);
+        if (!traco_gravar(caminho_traco, semente, num_agencias_config, duracoes, limites)) {
+            return 0;
+        }
+    }
     
     printf("[SISTEMA] 👔 Inicializando RH... ");
     fflush(stdout);
@@ -159,6 +230,47 @@ void popular_dados_iniciais(void) {
     printf("────────────────────────────────────────────────────\n\n");
 }
 
+/* Teste de carga: o gerador alimenta a fila enquanto todas as agências
+ * vendem, sem quotas por turno, até ao fim da NOITE */
+void executar_teste_carga(void) {
+    printf("\n--- TESTE DE CARGA ---\n");
+    
+    int sem_quota[3] = { INT_MAX, INT_MAX, INT_MAX };
+    configurar_turnos(NULL, sem_quota);
+    
+    if (!iniciar_gerador(fila_global)) {
+        printf("[SISTEMA] Gerador de chegadas não iniciado\n");
+        return;
+    }
+    iniciar_vendas_concorrentes(MANHA);
+    parar_gerador();
+    
+    exibir_relatorio_gerador();
+}
+
+/* Dia de vendas concorrentes com as entradas de um traço; as vendas
+ * feitas são comparadas com as gravadas */
+void executar_reproducao(void) {
+    printf("\n--- REPRODUÇÃO DE TRAÇO ---\n");
+    
+    if (!reproducao_iniciar(fila_global)) {
+        printf("[SISTEMA] Reprodução não iniciada\n");
+        return;
+    }
+    iniciar_vendas_concorrentes(MANHA);
+    
+    if (modo_reproducao == REPRODUCAO_RAPIDA) {
+        reproducao_concluir();
+    } else {
+        while (sistema_executando && reproducao_em_curso()) {
+            relogio_dormir_ms(1000);
+        }
+    }
+    reproducao_parar();
+    
+    exibir_relatorio_reproducao();
+}
+
 /* Loop principal */
 void loop_principal(void) {
     printf("\n══════════════════════════════════════════════════════════\n");
@@ -167,11 +279,11 @@ void loop_principal(void) {
     
     printf("📌 Sistema em execução - Pressione Ctrl+C para encerrar\n\n");
     
-    time_t inicio = time(NULL);
+    time_t inicio = relogio_agora();
     int ciclos = 0;
     
     while (sistema_executando) {
-        if (difftime(time(NULL), inicio) >= TEMPO_TOTAL_SIMULACAO) {
+        if (difftime(relogio_agora(), inicio) >= TEMPO_TOTAL_SIMULACAO) {
             printf("\n⏰ Tempo de simulação concluído (%d segundos)\n", 
                    TEMPO_TOTAL_SIMULACAO);
             break;
@@ -185,15 +297,22 @@ void loop_principal(void) {
             printf("════════════════════════════════════════════\n");
             
             printf("📦 Estoque: %d/%d disponíveis\n", 
-                   estoque_disponivel(), TOTAL_CARTOES);
+                   estoque_disponivel(), estoque_total());
             printf("👔 RH: %d/%d funcionários\n", 
                    get_funcionarios_ativos(), LIMITE_CONTRATACOES);
+            fila_expirar_desistencias(fila_global);
             printf("👥 Fila: %d clientes\n", fila_global->tamanho);
+            if (desistencias_configuradas) {
+                EstatisticasDesistencia desistencias;
+                obter_estatisticas_desistencia(fila_global, &desistencias);
+                printf("🚶 Desistências: %lld empresas, %lld público\n",
+                       desistencias.desistencias[EMPRESA], desistencias.desistencias[PUBLICO]);
+            }
             printf("💰 Vendas: %d total\n", get_vendas_totais());
             printf("════════════════════════════════════════════\n");
         }
         
-        sleep(1);
+        relogio_dormir_ms(1000);
     }
 }
 
@@ -204,15 +323,15 @@ void gerar_relatorio_final(void) {
     printf("              RELATÓRIO FINAL DO SISTEMA\n");
     printf("══════════════════════════════════════════════════════════\n\n");
     
-    time_t agora = time(NULL);
+    time_t agora = relogio_agora();
     struct tm* tm_info = localtime(&agora);
     char timestamp[26];
     strftime(timestamp, 26, "%Y-%m-%d %H:%M:%S", tm_info);
     printf("📅 Data/Hora: %s\n\n", timestamp);
     
     printf("📦 ESTOQUE:\n");
-    printf("   • Disponíveis: %d/%d\n", estoque_disponivel(), TOTAL_CARTOES);
-    printf("   • Vendidos: %d/%d\n", estoque_vendido(), TOTAL_CARTOES);
+    printf("   • Disponíveis: %d/%d\n", estoque_disponivel(), estoque_total());
+    printf("   • Vendidos: %d/%d\n", estoque_vendido(), estoque_total());
     
     printf("\n👔 RECURSOS HUMANOS:\n");
     printf("   • Funcionários ativos: %d/%d\n", 
@@ -245,11 +364,27 @@ void encerrar_sistema(void) {
     parar_todas_agencias();
     printf("OK\n");
     
+    parar_exportador_vendas();
+    traco_parar_gravacao();
+    estoque_remoto_desligar();
+    
+    if (caminho_diario) {
+        diario_fechar();
+        exportar_diario_colunar(caminho_diario, caminho_diario);
+    }
+    
     printf("[SISTEMA] 👔 Encerrando RH... ");
     fflush(stdout);
     encerrar_sistema_rh();
     printf("OK\n");
     
+    if (desistencias_configuradas && fila_global) {
+        exibir_relatorio_desistencias(fila_global);
+    }
+    if (limites_configurados) {
+        exibir_relatorio_limites();
+    }
+    
     printf("[SISTEMA] 👥 Liberando fila... ");
     fflush(stdout);
     if (fila_global) {
@@ -268,8 +403,222 @@ void encerrar_sistema(void) {
     printf("\n[SISTEMA] ✅ Sistema encerrado com sucesso!\n");
 }
 
+/* Opções da linha de comando */
+static void mostrar_uso(const char* programa) {
+    printf("Uso: %s [opções]\n", programa);
+    printf("  -a, --agencias N   Número de agências (1-%d, padrão %d)\n",
+           MAX_AGENCIAS, NUM_AGENCIAS_PADRAO);
+    printf("  -v, --virtual      Tempo virtual: simula sem esperas reais\n");
+    printf("  -q, --headless[=buffer|descartar]\n");
+    printf("                     Sem linha por venda no terminal (padrão: descartar)\n");
+    printf("  -t, --duracao-turno MS\n");
+    printf("                     Duração de cada turno nas vendas concorrentes (padrão %d)\n",
+           DURACAO_TURNO_PADRAO_MS);
+    printf("  -j, --diario FICHEIRO\n");
+    printf("                     Diário binário por venda, exportado por colunas no fim\n");
+    printf("  -p, --pipeline     Turnos sequenciais pelo pipeline de estágios\n");
+    printf("  -b, --benchmark-pipeline N\n");
+    printf("                     Comparar monolítico e pipeline com N vendas e sair\n");
+    printf("  -c, --cpus CLASSE=LISTA\n");
+    printf("                     Fixar uma classe de threads (agencias, rh, temporizadores, web,\n");
+    printf("                     pipeline, gerador) nos CPUs indicados, ex.: agencias=0-3\n");
+    printf("  -s, --autoescala MIN:MAX\n");
+    printf("                     Ativar agências entre MIN e MAX conforme a fila\n");
+    printf("  -g, --gerador TIPO=PROCESSO:TAXA[:PRODUTORES]\n");
+    printf("                     Teste de carga: chegadas sintéticas (empresa, publico;\n");
+    printf("                     poisson, rajadas), ex.: publico=poisson:5000\n");
+    printf("  -w, --gravar FICHEIRO\n");
+    printf("                     Gravar chegadas, bloqueios, RH e vendas num traço\n");
+    printf("                     (o dia corre pelas vendas concorrentes)\n");
+    printf("  -r, --reproduzir FICHEIRO\n");
+    printf("                     Reproduzir um traço com os intervalos gravados\n");
+    printf("  -R, --reproduzir-rapido FICHEIRO\n");
+    printf("                     Reproduzir em tempo virtual, sem esperas (determinístico)\n");
+    printf("  -P, --processos    Vendas concorrentes com uma agência por processo\n");
+    printf("                     (fila e estoque em memória partilhada; só tempo real)\n");
+    printf("  -B, --benchmark-processos N\n");
+    printf("                     Comparar agências em threads e em processos com N vendas e sair\n");
+    printf("  -f, --fibras       Vendas concorrentes com uma fibra por agência sobre poucas\n");
+    printf("                     threads (dezenas de milhares de agências; só tempo real)\n");
+    printf("  -e, --coordenador-estoque ENDERECO\n");
+    printf("                     Só servir o estoque a outras instâncias (socket Unix ou\n");
+    printf("                     host:porta), até Ctrl+C\n");
+    printf("  -E, --estoque-remoto ENDERECO\n");
+    printf("                     Vender do estoque partilhado de um coordenador\n");
+    printf("  -d, --desistencia TIPO=SEGUNDOS\n");
+    printf("                     Clientes do tipo (empresa, publico) desistem ao fim de\n");
+    printf("                     SEGUNDOS na fila (repetível; reproduzir com o mesmo valor)\n");
+    printf("  -l, --limite ETAPA:TIPO=TAXA[:RAJADA]\n");
+    printf("                     Limitar a TAXA/s a entrada na fila ou o atendimento de um\n");
+    printf("                     tipo (repetível; também em POST /api com \"tipo\":\"limite\")\n");
+    printf("  -h, --ajuda        Mostrar esta ajuda\n");
+}
+
+static int processar_argumentos(int argc, char* argv[]) {
+    static const struct option opcoes[] = {
+        {"agencias", required_argument, NULL, 'a'},
+        {"virtual",  no_argument,       NULL, 'v'},
+        {"headless", optional_argument, NULL, 'q'},
+        {"duracao-turno", required_argument, NULL, 't'},
+        {"diario",   required_argument, NULL, 'j'},
+        {"pipeline", no_argument,       NULL, 'p'},
+        {"benchmark-pipeline", required_argument, NULL, 'b'},
+        {"cpus",     required_argument, NULL, 'c'},
+        {"autoescala", required_argument, NULL, 's'},
+        {"gerador",  required_argument, NULL, 'g'},
+        {"gravar",   required_argument, NULL, 'w'},
+        {"reproduzir", required_argument, NULL, 'r'},
+        {"reproduzir-rapido", required_argument, NULL, 'R'},
+        {"processos", no_argument,      NULL, 'P'},
+        {"benchmark-processos", required_argument, NULL, 'B'},
+        {"fibras",   no_argument,       NULL, 'f'},
+        {"coordenador-estoque", required_argument, NULL, 'e'},
+        {"estoque-remoto", required_argument, NULL, 'E'},
+        {"desistencia", required_argument, NULL, 'd'},
+        {"limite",   required_argument, NULL, 'l'},
+        {"ajuda",    no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    
+    int opcao;
+    while ((opcao = getopt_long(argc, argv, "a:vq::t:j:pb:c:s:g:w:r:R:PB:fe:E:d:l:h", opcoes, NULL)) != -1) {
+        switch (opcao) {
+            case 'a':
+                num_agencias_config = atoi(optarg);
+                if (num_agencias_config < 1 || num_agencias_config > MAX_AGENCIAS) {
+                    printf("[SISTEMA] Número de agências inválido: %s\n", optarg);
+                    return 0;
+                }
+                break;
+            case 'v':
+                relogio_configurar(RELOGIO_VIRTUAL, 0);
+                break;
+            case 'q':
+                if (!optarg || strcmp(optarg, "descartar") == 0) {
+                    definir_modo_saida_vendas(SAIDA_DESCARTAR);
+                } else if (strcmp(optarg, "buffer") == 0) {
+                    definir_modo_saida_vendas(SAIDA_BUFFER);
+                } else {
+                    printf("[SISTEMA] Modo de saída inválido: %s\n", optarg);
+                    return 0;
+                }
+                break;
+            case 't': {
+                long duracao = atol(optarg);
+                if (duracao < 1) {
+                    printf("[SISTEMA] Duração de turno inválida: %s\n", optarg);
+                    return 0;
+                }
+                long duracoes[3] = { duracao, duracao, duracao };
+                configurar_turnos(duracoes, NULL);
+                break;
+            }
+            case 'j':
+                caminho_diario = optarg;
+                break;
+            case 'p':
+                definir_vendas_pipeline(1);
+                break;
+            case 'b':
+                clientes_benchmark = atoi(optarg);
+                if (clientes_benchmark < 1) {
+                    printf("[SISTEMA] Número de vendas inválido: %s\n", optarg);
+                    return 0;
+                }
+                break;
+            case 'c':
+                if (!configurar_afinidade(optarg)) return 0;
+                break;
+            case 's': {
+                int minimo, maximo;
+                if (sscanf(optarg, "%d:%d", &minimo, &maximo) != 2 ||
+                    minimo < 1 || maximo < minimo) {
+                    printf("[SISTEMA] Limites de autoescala inválidos: %s (esperado MIN:MAX)\n", optarg);
+                    return 0;
+                }
+                configurar_autoescala(minimo, maximo);
+                break;
+            }
+            case 'g':
+                if (!configurar_gerador(optarg)) return 0;
+                break;
+            case 'w':
+                caminho_traco = optarg;
+                break;
+            case 'r':
+            case 'R':
+                caminho_reproducao = optarg;
+                modo_reproducao = (opcao == 'R') ? REPRODUCAO_RAPIDA : REPRODUCAO_TEMPO_ORIGINAL;
+                break;
+            case 'P':
+                agencias_processos = 1;
+                definir_agencias_processos(1);
+                break;
+            case 'B':
+                clientes_benchmark_processos = atoi(optarg);
+                if (clientes_benchmark_processos < 1) {
+                    printf("[SISTEMA] Número de vendas inválido: %s\n", optarg);
+                    return 0;
+                }
+                break;
+            case 'f':
+                agencias_fibras = 1;
+                definir_agencias_fibras(1);
+                break;
+            case 'e':
+                endereco_coordenador = optarg;
+                break;
+            case 'E':
+                endereco_estoque_remoto = optarg;
+                break;
+            case 'd':
+                if (!configurar_paciencia(optarg)) return 0;
+                desistencias_configuradas = 1;
+                break;
+            case 'l':
+                if (!configurar_limite(optarg)) return 0;
+                limites_configurados = 1;
+                break;
+            case 'h':
+            default:
+                mostrar_uso(argv[0]);
+                return 0;
+        }
+    }
+    
+    if (agencias_processos && endereco_estoque_remoto) {
+        // As agências em processos recebem emprestado o estoque local
+        printf("[SISTEMA] --processos não se combina com --estoque-remoto\n");
+        return 0;
+    }
+    
+    return 1;
+}
+
 /* Main */
-int main(void) {
+int main(int argc, char* argv[]) {
+    if (!processar_argumentos(argc, argv)) {
+        return 1;
+    }
+    
+    if (clientes_benchmark > 0) {
+        // Só o estoque é preciso: sem agências, RH nem web server
+        inicializar_estoque();
+        benchmark_pipeline_vendas(clientes_benchmark);
+        liberar_estoque();
+        return 0;
+    }
+    
+    if (endereco_coordenador) {
+        return executar_coordenador_estoque(endereco_coordenador) ? 0 : 1;
+    }
+    
+    if (clientes_benchmark_processos > 0) {
+        // Estoque sintético no próprio segmento
+        benchmark_agencias_processos(clientes_benchmark_processos, num_agencias_config);
+        return 0;
+    }
+    
     printf("\n");
     printf("╔══════════════════════════════════════════════════════════╗\n");
     printf("║                                                          ║\n");
@@ -277,20 +626,43 @@ int main(void) {
     printf("║                                                          ║\n");
     printf("╚══════════════════════════════════════════════════════════╝\n\n");
     
-    srand(time(NULL));
+    // A reprodução repõe a semente, o relógio, os turnos e os limites da gravação
+    if (caminho_reproducao) {
+        CabecalhoTraco cabecalho;
+        if (!reproducao_preparar(caminho_reproducao, modo_reproducao, &cabecalho)) {
+            return 1;
+        }
+        num_agencias_config = cabecalho.num_agencias;
+    } else {
+        semente = (unsigned)time(NULL);
+        srand(semente);
+    }
     
     if (!inicializar_sistema()) {
         printf("[SISTEMA] ❌ Erro fatal na inicialização. Abortando.\n");
         return 1;
     }
     
-    popular_dados_iniciais();
-    
-    // Executar um turno de exemplo
-    printf("\n--- EXECUTANDO TURNO DE TESTE ---\n");
-    iniciar_turno_vendas(MANHA);
-    
-    loop_principal();
+    if (caminho_reproducao) {
+        // As chegadas vêm todas do traço
+        executar_reproducao();
+    } else {
+        popular_dados_iniciais();
+        
+        if (gerador_configurado()) {
+            executar_teste_carga();
+        } else if (caminho_traco || agencias_processos || agencias_fibras || endereco_estoque_remoto) {
+            // O mesmo caminho que a reprodução usa, para as vendas serem comparáveis
+            printf("\n--- DIA DE VENDAS %s---\n", caminho_traco ? "GRAVADO " : "");
+            iniciar_vendas_concorrentes(MANHA);
+        } else {
+            // Executar um turno de exemplo
+            printf("\n--- EXECUTANDO TURNO DE TESTE ---\n");
+            iniciar_turno_vendas(MANHA);
+        }
+        
+        loop_principal();
+    }
     gerar_relatorio_final();
     encerrar_sistema();
     
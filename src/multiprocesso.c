@@ -0,0 +1,631 @@
+#include "multiprocesso.h"
+#include "vendas.h"
+#include "estoque.h"
+#include "relogio.h"
+#include "afinidade.h"
+#include "diario.h"
+#include "traco.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define PALAVRAS_BITMAP (MAX_CARTOES / 64)
+#define DESPACHO_OCIOSO_MS 5      // Fila principal vazia: espera do despachante
+
+typedef enum {
+    AGENCIA_A_CORRER,
+    AGENCIA_TERMINOU,
+    AGENCIA_FALHOU
+} EstadoAgenciaProcesso;
+
+/* Contadores de uma agência: só ela escreve, o processo principal lê no
+ * fim. Uma linha de cache por agência. */
+typedef struct {
+    _Alignas(64) pid_t pid;
+    atomic_int estado;
+    int vendas;
+    int vendas_tipo_turno[2][3];
+} SlotAgenciaProcesso;
+
+/* Um registo passa a EM_CURSO quando o cliente sai da fila e a
+ * CONFIRMADO quando a venda está escrita; cada passagem é uma só escrita
+ * de 'estado', pelo que uma agência morta deixa o registo num dos três */
+typedef enum {
+    REGISTO_LIVRE,          // Reservado por uma agência, ainda sem cliente
+    REGISTO_EM_CURSO,       // Cliente retirado da fila, venda por escrever
+    REGISTO_CONFIRMADO
+} EstadoRegistoVenda;
+
+typedef struct {
+    Cliente cliente;
+    int cartao;                 // Índice no segmento
+    int agencia;                // Índice da agência (0..)
+    uint8_t turno;
+    atomic_int estado;          // Escrito por último, com release
+} VendaProcesso;
+
+typedef struct {
+    // Fila: um anel por tipo de cliente; entre as duas cabeças decide a
+    // prioridade com aging, como na FilaPrioridade
+    pthread_mutex_t fila_lock;
+    sem_t clientes;
+    sem_t espaco;
+    Cliente aneis[2][MAX_FILA];
+    int cabeca[2];
+    int quantidade[2];
+
+    // Estoque emprestado pelo processo principal: bit a 1 = livre
+    pthread_mutex_t estoque_lock;
+    int num_cartoes;
+    int livres;
+    int dica;                   // Palavra onde a última procura parou
+    uint64_t bitmap[PALAVRAS_BITMAP];
+    int cartoes[MAX_CARTOES];   // Índice -> id no estoque principal
+
+    // Calendário de turnos
+    int num_turnos;
+    Turno turnos[3];
+    long long inicio_turno_ns[4];   // [num_turnos] = fim do dia
+    int limite_turno[3];
+    atomic_int vendas_turno[3];
+
+    // Controlo
+    atomic_int parar;
+    int alvo_vendas;            // > 0: parar ao chegar a este total
+    long tempo_venda_ms;
+    sem_t concluido;
+
+    // Cada venda ocupa um cartão e cada agência tem no máximo um registo
+    // reservado por usar, logo cabem todos
+    atomic_int num_registos;
+    atomic_int num_vendas;      // Registos confirmados
+    VendaProcesso vendas[MAX_CARTOES + MAX_PROCESSOS_AGENCIA];
+
+    int num_agencias;
+    SlotAgenciaProcesso agencias[MAX_PROCESSOS_AGENCIA];
+} SegmentoAgencias;
+
+/* Agências em threads (benchmark) */
+typedef struct {
+    SegmentoAgencias* segmento;
+    int indice;
+} ArgAgenciaSegmento;
+
+static pthread_t threads_agencias[MAX_PROCESSOS_AGENCIA];
+static ArgAgenciaSegmento args_agencias[MAX_PROCESSOS_AGENCIA];
+
+/* Ctrl+C no processo principal: o despachante fecha o dia mais cedo */
+static volatile sig_atomic_t paragem_pedida = 0;
+
+/* ========== SEGMENTO ========== */
+
+/* Uma agência pode morrer com o lock: as secções críticas só atualizam
+ * as contagens no fim, pelo que o estado protegido fica consistente */
+static void bloquear_partilhado(pthread_mutex_t* mutex) {
+    if (pthread_mutex_lock(mutex) == EOWNERDEAD) {
+        pthread_mutex_consistent(mutex);
+    }
+}
+
+static void iniciar_mutex_partilhado(pthread_mutex_t* mutex) {
+    pthread_mutexattr_t atributos;
+    pthread_mutexattr_init(&atributos);
+    pthread_mutexattr_setpshared(&atributos, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&atributos, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(mutex, &atributos);
+    pthread_mutexattr_destroy(&atributos);
+}
+
+static SegmentoAgencias* criar_segmento(char* nome, size_t tamanho_nome) {
+    snprintf(nome, tamanho_nome, "%s.%d", PREFIXO_SEGMENTO_AGENCIAS, (int)getpid());
+
+    int fd = shm_open(nome, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        printf("[MULTIPROCESSO] shm_open(%s) falhou: %s\n", nome, strerror(errno));
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(SegmentoAgencias)) != 0) {
+        printf("[MULTIPROCESSO] ftruncate falhou: %s\n", strerror(errno));
+        close(fd);
+        shm_unlink(nome);
+        return NULL;
+    }
+
+    void* ptr = mmap(NULL, sizeof(SegmentoAgencias), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        printf("[MULTIPROCESSO] mmap falhou: %s\n", strerror(errno));
+        shm_unlink(nome);
+        return NULL;
+    }
+
+    // ftruncate deixa o segmento a zeros: só falta o que precisa de init
+    SegmentoAgencias* segmento = (SegmentoAgencias*)ptr;
+    iniciar_mutex_partilhado(&segmento->fila_lock);
+    iniciar_mutex_partilhado(&segmento->estoque_lock);
+    sem_init(&segmento->clientes, 1, 0);
+    sem_init(&segmento->espaco, 1, MAX_FILA);
+    sem_init(&segmento->concluido, 1, 0);
+    return segmento;
+}
+
+static void destruir_segmento(SegmentoAgencias* segmento, const char* nome) {
+    pthread_mutex_destroy(&segmento->fila_lock);
+    pthread_mutex_destroy(&segmento->estoque_lock);
+    sem_destroy(&segmento->clientes);
+    sem_destroy(&segmento->espaco);
+    sem_destroy(&segmento->concluido);
+    munmap(segmento, sizeof(SegmentoAgencias));
+    shm_unlink(nome);
+}
+
+/* ========== ESTOQUE NO SEGMENTO ========== */
+
+static void adicionar_cartao_segmento(SegmentoAgencias* s, int id) {
+    int indice = s->num_cartoes++;
+    s->cartoes[indice] = id;
+    s->bitmap[indice / 64] |= 1ULL << (indice % 64);
+    s->livres++;
+}
+
+static int reservar_cartao_segmento(SegmentoAgencias* s) {
+    bloquear_partilhado(&s->estoque_lock);
+
+    int palavras = (s->num_cartoes + 63) / 64;
+    for (int k = 0; s->livres > 0 && k < palavras; k++) {
+        int palavra = (s->dica + k) % palavras;
+        if (s->bitmap[palavra] == 0) continue;
+
+        int bit = __builtin_ctzll(s->bitmap[palavra]);
+        s->bitmap[palavra] &= ~(1ULL << bit);
+        s->livres--;
+        s->dica = palavra;
+        pthread_mutex_unlock(&s->estoque_lock);
+        return palavra * 64 + bit;
+    }
+
+    pthread_mutex_unlock(&s->estoque_lock);
+    return -1;
+}
+
+static void devolver_cartao_segmento(SegmentoAgencias* s, int indice) {
+    bloquear_partilhado(&s->estoque_lock);
+    s->bitmap[indice / 64] |= 1ULL << (indice % 64);
+    s->livres++;
+    pthread_mutex_unlock(&s->estoque_lock);
+}
+
+/* ========== FILA NO SEGMENTO ========== */
+
+/* O chamador já garantiu espaço (semáforo 'espaco') */
+static void colocar_cliente_segmento(SegmentoAgencias* s, const Cliente* cliente) {
+    int t = (cliente->tipo == EMPRESA) ? EMPRESA : PUBLICO;
+
+    bloquear_partilhado(&s->fila_lock);
+    int posicao = (s->cabeca[t] + s->quantidade[t]) % MAX_FILA;
+    s->aneis[t][posicao] = *cliente;
+    s->quantidade[t]++;
+    pthread_mutex_unlock(&s->fila_lock);
+
+    sem_post(&s->clientes);
+}
+
+/* O cliente retirado fica no registo, que passa a EM_CURSO com o lock:
+ * se a agência morrer a seguir, o processo principal devolve-o à fila */
+static int retirar_cliente_segmento(SegmentoAgencias* s, VendaProcesso* registo, int espera_ms) {
+    struct timespec prazo;
+    clock_gettime(CLOCK_REALTIME, &prazo);
+    prazo.tv_nsec += (long)espera_ms * 1000000L;
+    prazo.tv_sec += prazo.tv_nsec / NS_POR_SEGUNDO;
+    prazo.tv_nsec %= NS_POR_SEGUNDO;
+    if (sem_timedwait(&s->clientes, &prazo) != 0) return 0;
+
+    bloquear_partilhado(&s->fila_lock);
+
+    int t;
+    if (s->quantidade[EMPRESA] == 0) {
+        t = PUBLICO;
+    } else if (s->quantidade[PUBLICO] == 0) {
+        t = EMPRESA;
+    } else {
+        Cliente* empresa = &s->aneis[EMPRESA][s->cabeca[EMPRESA]];
+        Cliente* publico = &s->aneis[PUBLICO][s->cabeca[PUBLICO]];
+        t = calcular_prioridade_cliente(publico) > calcular_prioridade_cliente(empresa)
+            ? PUBLICO : EMPRESA;
+    }
+
+    // Só acontece se uma agência morreu entre o semáforo e o lock
+    if (s->quantidade[t] == 0) {
+        pthread_mutex_unlock(&s->fila_lock);
+        return 0;
+    }
+
+    registo->cliente = s->aneis[t][s->cabeca[t]];
+    s->cabeca[t] = (s->cabeca[t] + 1) % MAX_FILA;
+    s->quantidade[t]--;
+    atomic_store_explicit(&registo->estado, REGISTO_EM_CURSO, memory_order_release);
+    pthread_mutex_unlock(&s->fila_lock);
+
+    sem_post(&s->espaco);
+    return 1;
+}
+
+/* ========== CALENDÁRIO ========== */
+
+static void preparar_calendario(SegmentoAgencias* s, Turno inicial, long long inicio_ns) {
+    long duracoes[3];
+    int limites[3];
+    obter_configuracao_turnos(duracoes, limites);
+
+    long long instante = inicio_ns;
+    s->num_turnos = 0;
+    for (int turno = inicial; turno <= NOITE; turno++) {
+        int k = s->num_turnos++;
+        s->turnos[k] = (Turno)turno;
+        s->inicio_turno_ns[k] = instante;
+        s->limite_turno[k] = limites[turno];
+        instante += duracoes[turno] * 1000000LL;
+    }
+    s->inicio_turno_ns[s->num_turnos] = instante;
+}
+
+static int indice_turno_segmento(SegmentoAgencias* s, long long agora) {
+    for (int k = 0; k < s->num_turnos; k++) {
+        if (agora < s->inicio_turno_ns[k + 1]) return k;
+    }
+    return -1;
+}
+
+static int reservar_quota_segmento(SegmentoAgencias* s, int k) {
+    int vendas = atomic_load(&s->vendas_turno[k]);
+    while (vendas < s->limite_turno[k]) {
+        if (atomic_compare_exchange_weak(&s->vendas_turno[k], &vendas, vendas + 1)) return 1;
+    }
+    return 0;
+}
+
+/* ========== AGÊNCIA ========== */
+
+/* Ciclo de uma agência: quota do turno, cartão, cliente, venda. Corre
+ * num processo filho ou numa thread; só toca no segmento e no relógio. */
+static void executar_agencia_segmento(SegmentoAgencias* s, int indice) {
+    SlotAgenciaProcesso* slot = &s->agencias[indice];
+    VendaProcesso* registo = NULL;   // Reservado e ainda por usar
+
+    while (!atomic_load(&s->parar)) {
+        long long agora = relogio_agora_ns();
+        int k = indice_turno_segmento(s, agora);
+        if (k < 0) break;   // Fim do dia
+
+        if (!reservar_quota_segmento(s, k)) {
+            // Quota esgotada: esperar pelo próximo turno, em fatias
+            long long falta_ms = (s->inicio_turno_ns[k + 1] - agora) / 1000000LL + 1;
+            relogio_dormir_ms(falta_ms < 100 ? (long)falta_ms : 100);
+            continue;
+        }
+
+        int cartao = reservar_cartao_segmento(s);
+        if (cartao < 0) {
+            atomic_fetch_sub(&s->vendas_turno[k], 1);
+            break;   // O estoque emprestado acabou
+        }
+
+        if (!registo) registo = &s->vendas[atomic_fetch_add(&s->num_registos, 1)];
+        registo->cartao = cartao;
+        registo->agencia = indice;
+        registo->turno = (uint8_t)s->turnos[k];
+
+        if (!retirar_cliente_segmento(s, registo, ESPERA_CLIENTE_PROCESSO_MS)) {
+            devolver_cartao_segmento(s, cartao);
+            atomic_fetch_sub(&s->vendas_turno[k], 1);
+            continue;
+        }
+
+        TipoCliente tipo = registo->cliente.tipo;
+        atomic_store_explicit(&registo->estado, REGISTO_CONFIRMADO, memory_order_release);
+        registo = NULL;
+        int numero = atomic_fetch_add(&s->num_vendas, 1);
+
+        slot->vendas++;
+        slot->vendas_tipo_turno[tipo == EMPRESA ? 0 : 1][s->turnos[k]]++;
+
+        if (s->alvo_vendas > 0 && numero + 1 == s->alvo_vendas) {
+            atomic_store(&s->parar, 1);
+            sem_post(&s->concluido);
+        }
+
+        if (s->tempo_venda_ms > 0) relogio_dormir_ms(s->tempo_venda_ms);
+    }
+
+    atomic_store(&slot->estado, AGENCIA_TERMINOU);
+}
+
+static void* thread_agencia_segmento(void* arg) {
+    ArgAgenciaSegmento* a = (ArgAgenciaSegmento*)arg;
+    aplicar_afinidade_thread(CLASSE_AGENCIA, a->indice);
+    executar_agencia_segmento(a->segmento, a->indice);
+    return NULL;
+}
+
+/* Lança as agências; retorna quantas arrancaram */
+static int lancar_agencias(SegmentoAgencias* s, int usar_processos) {
+    for (int i = 0; i < s->num_agencias; i++) {
+        SlotAgenciaProcesso* slot = &s->agencias[i];
+        atomic_store(&slot->estado, AGENCIA_A_CORRER);
+
+        if (!usar_processos) {
+            args_agencias[i].segmento = s;
+            args_agencias[i].indice = i;
+            if (pthread_create(&threads_agencias[i], NULL, thread_agencia_segmento,
+                               &args_agencias[i]) != 0) {
+                printf("[ERRO] Falha ao criar thread da agência %d\n", i + 1);
+                s->num_agencias = i;
+                break;
+            }
+            continue;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            // Filho: o Ctrl+C é tratado pelo processo principal, que manda parar
+            signal(SIGINT, SIG_IGN);
+            aplicar_afinidade_thread(CLASSE_AGENCIA, i);
+            executar_agencia_segmento(s, i);
+            _exit(0);
+        }
+        if (pid < 0) {
+            printf("[ERRO] fork da agência %d falhou: %s\n", i + 1, strerror(errno));
+            s->num_agencias = i;
+            break;
+        }
+        slot->pid = pid;
+    }
+    return s->num_agencias;
+}
+
+/* Estado final de um processo recolhido por waitpid */
+static void registar_fim_processo(SlotAgenciaProcesso* slot, int indice, int estado_saida) {
+    if (WIFSIGNALED(estado_saida)) {
+        atomic_store(&slot->estado, AGENCIA_FALHOU);
+        printf("[MULTIPROCESSO] Agência %d (pid %d) terminou com o sinal %d; "
+               "as restantes continuam\n", indice + 1, (int)slot->pid, WTERMSIG(estado_saida));
+    } else {
+        atomic_store(&slot->estado, AGENCIA_TERMINOU);
+    }
+    slot->pid = 0;
+}
+
+/* Recolhe os processos que já terminaram; retorna quantos continuam */
+static int recolher_processos(SegmentoAgencias* s, int bloquear) {
+    int vivos = 0;
+    for (int i = 0; i < s->num_agencias; i++) {
+        SlotAgenciaProcesso* slot = &s->agencias[i];
+        if (slot->pid <= 0) continue;
+
+        int estado_saida;
+        pid_t pid = waitpid(slot->pid, &estado_saida, bloquear ? 0 : WNOHANG);
+        if (pid == slot->pid) {
+            registar_fim_processo(slot, i, estado_saida);
+        } else {
+            vivos++;
+        }
+    }
+    return vivos;
+}
+
+static void aguardar_agencias(SegmentoAgencias* s, int usar_processos) {
+    atomic_store(&s->parar, 1);
+    if (usar_processos) {
+        recolher_processos(s, 1);
+        return;
+    }
+    for (int i = 0; i < s->num_agencias; i++) {
+        pthread_join(threads_agencias[i], NULL);
+    }
+}
+
+/* ========== EXECUÇÃO ========== */
+
+/* Devolve ao processo principal o que ficou e o que foi vendido; conta
+ * em 'interrompidos' os clientes de agências que morreram a meio */
+static int integrar_resultados(SegmentoAgencias* s, FilaPrioridade* fila, int* interrompidos) {
+    // Clientes por atender voltam à fila com a chegada original (logo o aging)
+    for (int t = 0; t < 2; t++) {
+        while (s->quantidade[t] > 0) {
+            devolver_cliente(fila, &s->aneis[t][s->cabeca[t]]);
+            s->cabeca[t] = (s->cabeca[t] + 1) % MAX_FILA;
+            s->quantidade[t]--;
+        }
+    }
+
+    // Só contam registos confirmados: os outros são de agências que
+    // morreram antes de escrever a venda
+    int total = 0;
+    *interrompidos = 0;
+    int registos = atomic_load(&s->num_registos);
+    for (int n = 0; n < registos; n++) {
+        VendaProcesso* venda = &s->vendas[n];
+        int estado = atomic_load_explicit(&venda->estado, memory_order_acquire);
+        if (estado == REGISTO_LIVRE) continue;
+
+        int cartao_id = s->cartoes[venda->cartao];
+        if (estado == REGISTO_EM_CURSO) {
+            // Venda a meio: o cliente volta à fila e o cartão ao estoque
+            devolver_cliente(fila, &venda->cliente);
+            cancelar_retencao(cartao_id);
+            (*interrompidos)++;
+            continue;
+        }
+
+        const Cliente* cliente = &venda->cliente;
+        confirmar_retencao(cartao_id);
+        diario_registar_venda(cliente->id_cliente, cliente->tipo, cliente->timestamp,
+                              cartao_id, venda->agencia + 1, (Turno)venda->turno);
+        traco_venda(cliente->id_cliente, cliente->tipo, cartao_id, venda->agencia + 1);
+        contabilizar_venda(cliente->tipo, (Turno)venda->turno);
+        total++;
+    }
+    diario_descarregar();
+
+    // Cartões não vendidos saem da retenção; os que uma agência morta
+    // tinha reservado sem chegar a ter cliente expiram pelo recolhedor
+    for (int i = 0; i < s->num_cartoes; i++) {
+        if (s->bitmap[i / 64] & (1ULL << (i % 64))) cancelar_retencao(s->cartoes[i]);
+    }
+
+    for (int i = 0; i < s->num_agencias && i < num_agencias; i++) {
+        pthread_mutex_lock(&agencias[i].lock);
+        agencias[i].vendas_realizadas += s->agencias[i].vendas;
+        agencias[i].clientes_atendidos += s->agencias[i].vendas;
+        pthread_mutex_unlock(&agencias[i].lock);
+    }
+    return total;
+}
+
+int executar_agencias_processos(FilaPrioridade* fila, Turno turno_inicial, int num_agencias_pedidas) {
+    if (!fila) return -1;
+    if (relogio_virtual()) {
+        // Cada processo teria o seu relógio virtual
+        printf("[MULTIPROCESSO] Só disponível em tempo real\n");
+        return -1;
+    }
+
+    char nome[64];
+    SegmentoAgencias* s = criar_segmento(nome, sizeof(nome));
+    if (!s) return -1;
+
+    s->num_agencias = num_agencias_pedidas < MAX_PROCESSOS_AGENCIA
+                      ? num_agencias_pedidas : MAX_PROCESSOS_AGENCIA;
+    s->tempo_venda_ms = TEMPO_VENDA_REAL * 1000L;
+    preparar_calendario(s, turno_inicial, relogio_agora_ns());
+    long long fim_dia = s->inicio_turno_ns[s->num_turnos];
+
+    // Empréstimo do estoque: retidos até ao fim do dia (e uma margem)
+    int ttl = (int)((fim_dia - s->inicio_turno_ns[0]) / NS_POR_SEGUNDO) + MARGEM_RETENCAO_PROCESSOS;
+    for (int f = 0; f < get_num_fragmentos_estoque(); f++) {
+        int id;
+        while (s->num_cartoes < MAX_CARTOES && (id = reter_cartao_fragmento(f, ttl)) >= 0) {
+            adicionar_cartao_segmento(s, id);
+        }
+    }
+
+    printf("\n=== AGÊNCIAS EM PROCESSOS ===\n");
+    printf("Segmento %s: %zu KB, %d cartões emprestados, %d agências\n",
+           nome, sizeof(SegmentoAgencias) / 1024, s->num_cartoes, s->num_agencias);
+
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    fflush(stdout);   // Os filhos não herdam linhas por escrever
+    lancar_agencias(s, 1);
+
+    // Despachante: da fila principal para o segmento, até ao fim do dia
+    // ou a um Ctrl+C
+    while (!paragem_pedida && relogio_agora_ns() < fim_dia && recolher_processos(s, 0) > 0) {
+        Cliente cliente;
+        if (!retirar_proximo_cliente(fila, &cliente)) {
+            relogio_dormir_ms(DESPACHO_OCIOSO_MS);
+            continue;
+        }
+
+        struct timespec prazo;
+        clock_gettime(CLOCK_REALTIME, &prazo);
+        prazo.tv_sec += 1;
+        if (sem_timedwait(&s->espaco, &prazo) == 0) {
+            colocar_cliente_segmento(s, &cliente);
+        } else {
+            devolver_cliente(fila, &cliente);
+        }
+    }
+
+    aguardar_agencias(s, 1);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    int falhadas = 0;
+    for (int i = 0; i < s->num_agencias; i++) {
+        if (atomic_load(&s->agencias[i].estado) == AGENCIA_FALHOU) falhadas++;
+    }
+
+    int interrompidos;
+    int vendas = integrar_resultados(s, fila, &interrompidos);
+    double duracao = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    printf("[MULTIPROCESSO] %d vendas por %d processos em %.3fs (%d falharam, "
+           "%d clientes a meio da venda devolvidos à fila)\n",
+           vendas, s->num_agencias, duracao, falhadas, interrompidos);
+
+    destruir_segmento(s, nome);
+    return vendas;
+}
+
+/* Chamado pelo handler de sinal do processo principal */
+void pedir_paragem_agencias_processos(void) {
+    paragem_pedida = 1;
+}
+
+/* ========== BENCHMARK ========== */
+
+void benchmark_agencias_processos(int num_clientes, int num_agencias_pedidas) {
+    if (num_clientes > MAX_CARTOES) num_clientes = MAX_CARTOES;
+    if (num_agencias_pedidas > MAX_PROCESSOS_AGENCIA) num_agencias_pedidas = MAX_PROCESSOS_AGENCIA;
+    if (num_clientes < 1 || num_agencias_pedidas < 1) return;
+
+    printf("\n=== BENCHMARK: AGÊNCIAS EM THREADS vs PROCESSOS ===\n");
+    printf("%d vendas, %d agências, mesmo segmento partilhado\n", num_clientes, num_agencias_pedidas);
+
+    double tempos[2] = { 0, 0 };
+    for (int usar_processos = 0; usar_processos < 2; usar_processos++) {
+        char nome[64];
+        SegmentoAgencias* s = criar_segmento(nome, sizeof(nome));
+        if (!s) return;
+
+        // Cartões sintéticos e um só turno sem quota nem fim
+        for (int i = 0; i < num_clientes; i++) adicionar_cartao_segmento(s, i);
+        s->num_turnos = 1;
+        s->turnos[0] = MANHA;
+        s->inicio_turno_ns[0] = 0;
+        s->inicio_turno_ns[1] = LLONG_MAX;
+        s->limite_turno[0] = INT_MAX;
+        s->alvo_vendas = num_clientes;
+        s->num_agencias = num_agencias_pedidas;
+
+        struct timespec inicio, fim;
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        fflush(stdout);
+        lancar_agencias(s, usar_processos);
+
+        for (int i = 0; i < num_clientes; i++) {
+            Cliente cliente = {
+                .id_cliente = i + 1,
+                .tipo = (i % 3) ? PUBLICO : EMPRESA,
+                .timestamp = relogio_agora(),
+                .prioridade_calculada = 0
+            };
+            sem_wait(&s->espaco);
+            colocar_cliente_segmento(s, &cliente);
+        }
+        sem_wait(&s->concluido);
+        aguardar_agencias(s, usar_processos);
+        clock_gettime(CLOCK_MONOTONIC, &fim);
+
+        tempos[usar_processos] = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+        printf("%-10s %d vendas em %.3fs (%.0f vendas/s)\n",
+               usar_processos ? "Processos:" : "Threads:", atomic_load(&s->num_vendas),
+               tempos[usar_processos], atomic_load(&s->num_vendas) / tempos[usar_processos]);
+        destruir_segmento(s, nome);
+    }
+
+    if (tempos[0] > 0) {
+        printf("Custo relativo dos processos: %.2fx o tempo das threads\n", tempos[1] / tempos[0]);
+    }
+    printf("==================================================\n");
+}
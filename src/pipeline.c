@@ -0,0 +1,356 @@
+// pthread_setaffinity_np (fixar as etapas) mesmo sem -D_GNU_SOURCE
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "pipeline.h"
+#include "estoque.h"
+#include "vendas.h"
+#include "diario.h"
+#include "traco.h"
+#include "relogio.h"
+#include "utils.h"
+#include "afinidade.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define ESPERAS_ANTES_DE_CEDER 64   // Tentativas em espera ativa antes de sched_yield
+
+/* Item que atravessa o pipeline. cliente.id_cliente == -1 marca o fim. */
+typedef struct {
+    Cliente cliente;
+    int cartao_id;
+} VendaPipeline;
+
+/* Anel SPSC: só o produtor escreve 'cauda', só o consumidor escreve
+ * 'cabeca'. Cada lado guarda uma cópia do índice do outro para não
+ * ler a linha de cache alheia em cada operação. */
+typedef struct {
+    _Alignas(64) atomic_size_t cabeca;
+    size_t cauda_vista;                  // Cópia do consumidor
+    _Alignas(64) atomic_size_t cauda;
+    size_t cabeca_vista;                 // Cópia do produtor
+    _Alignas(64) VendaPipeline itens[CAPACIDADE_ANEL_PIPELINE];
+} AnelPipeline;
+
+typedef struct {
+    FilaPrioridade* fila;
+    Turno turno;
+    int limite;
+    AnelPipeline* aneis;                 // NUM_ESTAGIOS_PIPELINE - 1 anéis
+    atomic_int sem_estoque;
+    int vendas;
+} ContextoPipeline;
+
+/* ========== ANEL SPSC ========== */
+
+static void anel_inicializar(AnelPipeline* anel) {
+    atomic_init(&anel->cabeca, 0);
+    atomic_init(&anel->cauda, 0);
+    anel->cauda_vista = 0;
+    anel->cabeca_vista = 0;
+}
+
+static void esperar_vez(int* tentativas) {
+    if (++(*tentativas) >= ESPERAS_ANTES_DE_CEDER) {
+        sched_yield();
+        *tentativas = 0;
+    }
+}
+
+static void anel_colocar(AnelPipeline* anel, const VendaPipeline* item) {
+    size_t cauda = atomic_load_explicit(&anel->cauda, memory_order_relaxed);
+    int tentativas = 0;
+
+    while (cauda - anel->cabeca_vista == CAPACIDADE_ANEL_PIPELINE) {
+        anel->cabeca_vista = atomic_load_explicit(&anel->cabeca, memory_order_acquire);
+        if (cauda - anel->cabeca_vista < CAPACIDADE_ANEL_PIPELINE) break;
+        esperar_vez(&tentativas);
+    }
+
+    anel->itens[cauda & (CAPACIDADE_ANEL_PIPELINE - 1)] = *item;
+    atomic_store_explicit(&anel->cauda, cauda + 1, memory_order_release);
+}
+
+static void anel_retirar(AnelPipeline* anel, VendaPipeline* destino) {
+    size_t cabeca = atomic_load_explicit(&anel->cabeca, memory_order_relaxed);
+    int tentativas = 0;
+
+    while (cabeca == anel->cauda_vista) {
+        anel->cauda_vista = atomic_load_explicit(&anel->cauda, memory_order_acquire);
+        if (cabeca != anel->cauda_vista) break;
+        esperar_vez(&tentativas);
+    }
+
+    *destino = anel->itens[cabeca & (CAPACIDADE_ANEL_PIPELINE - 1)];
+    atomic_store_explicit(&anel->cabeca, cabeca + 1, memory_order_release);
+}
+
+static int fim_do_pipeline(const VendaPipeline* item) {
+    return item->cliente.id_cliente == -1;
+}
+
+/* Fixar a thread num núcleo: os CPUs configurados para o pipeline ou,
+ * sem configuração, o núcleo com o número do estágio se houver que chegue */
+static void fixar_estagio(int estagio) {
+    if (aplicar_afinidade_thread(CLASSE_PIPELINE, estagio)) return;
+    
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nucleos < NUM_ESTAGIOS_PIPELINE) return;
+
+    cpu_set_t conjunto;
+    CPU_ZERO(&conjunto);
+    CPU_SET(estagio % nucleos, &conjunto);
+    pthread_setaffinity_np(pthread_self(), sizeof(conjunto), &conjunto);
+}
+
+/* ========== ESTÁGIOS ========== */
+
+/* 1. Despacho: retira clientes da fila de prioridade */
+static void estagio_despacho(ContextoPipeline* ctx) {
+    VendaPipeline item;
+    memset(&item, 0, sizeof(item));
+    int despachados = 0;
+
+    while ((ctx->limite <= 0 || despachados < ctx->limite) &&
+           !atomic_load_explicit(&ctx->sem_estoque, memory_order_relaxed) &&
+           retirar_proximo_cliente(ctx->fila, &item.cliente)) {
+        anel_colocar(&ctx->aneis[0], &item);
+        despachados++;
+    }
+
+    item.cliente.id_cliente = -1;
+    anel_colocar(&ctx->aneis[0], &item);
+}
+
+/* 2. Reserva do cartão. Sem estoque, os clientes já despachados voltam à fila. */
+static void* estagio_reserva(void* arg) {
+    ContextoPipeline* ctx = (ContextoPipeline*)arg;
+    fixar_estagio(1);
+
+    VendaPipeline item;
+    for (;;) {
+        anel_retirar(&ctx->aneis[0], &item);
+        if (fim_do_pipeline(&item)) break;
+
+        if (!atomic_load_explicit(&ctx->sem_estoque, memory_order_relaxed)) {
+            item.cartao_id = reservar_proximo_cartao();
+            if (item.cartao_id != -1) {
+                anel_colocar(&ctx->aneis[1], &item);
+                continue;
+            }
+            atomic_store_explicit(&ctx->sem_estoque, 1, memory_order_relaxed);
+        }
+        devolver_cliente(ctx->fila, &item.cliente);
+    }
+
+    anel_colocar(&ctx->aneis[1], &item);
+    return NULL;
+}
+
+/* 3. Registo: linha da venda e diário */
+static void* estagio_registo(void* arg) {
+    ContextoPipeline* ctx = (ContextoPipeline*)arg;
+    fixar_estagio(2);
+
+    VendaPipeline item;
+    for (;;) {
+        anel_retirar(&ctx->aneis[1], &item);
+        if (fim_do_pipeline(&item)) break;
+
+        saida_venda("[PIPELINE] %-7s | Cliente: %03d | Cartão: %03d\n",
+                    item.cliente.tipo == EMPRESA ? "EMPRESA" : "PUBLICO",
+                    item.cliente.id_cliente, item.cartao_id);
+        diario_registar_venda(item.cliente.id_cliente, item.cliente.tipo,
+                              item.cliente.timestamp, item.cartao_id, 0, ctx->turno);
+        traco_venda(item.cliente.id_cliente, item.cliente.tipo, item.cartao_id, 0);
+        anel_colocar(&ctx->aneis[2], &item);
+    }
+
+    anel_colocar(&ctx->aneis[2], &item);
+    return NULL;
+}
+
+/* 4. Estatísticas: contadores próprios desta thread */
+static void* estagio_estatisticas(void* arg) {
+    ContextoPipeline* ctx = (ContextoPipeline*)arg;
+    fixar_estagio(3);
+
+    VendaPipeline item;
+    for (;;) {
+        anel_retirar(&ctx->aneis[2], &item);
+        if (fim_do_pipeline(&item)) break;
+
+        contabilizar_venda(item.cliente.tipo, ctx->turno);
+        ctx->vendas++;
+    }
+    return NULL;
+}
+
+/* ========== FUNÇÕES PÚBLICAS ========== */
+
+/* A thread que chama faz o despacho; os outros estágios têm thread própria */
+int executar_pipeline_vendas(FilaPrioridade* fila, Turno turno, int limite) {
+    if (!fila) return 0;
+
+    ContextoPipeline ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.fila = fila;
+    ctx.turno = turno;
+    ctx.limite = limite;
+    atomic_init(&ctx.sem_estoque, 0);
+    ctx.aneis = (AnelPipeline*)aligned_alloc(64, (NUM_ESTAGIOS_PIPELINE - 1) * sizeof(AnelPipeline));
+    if (!ctx.aneis) {
+        printf("[ERRO] Falha ao alocar anéis do pipeline\n");
+        return 0;
+    }
+    for (int i = 0; i < NUM_ESTAGIOS_PIPELINE - 1; i++) anel_inicializar(&ctx.aneis[i]);
+
+    void* (*estagios[NUM_ESTAGIOS_PIPELINE - 1])(void*) = {
+        estagio_reserva, estagio_registo, estagio_estatisticas
+    };
+    pthread_t threads[NUM_ESTAGIOS_PIPELINE - 1];
+    for (int i = 0; i < NUM_ESTAGIOS_PIPELINE - 1; i++) {
+        if (pthread_create(&threads[i], NULL, estagios[i], &ctx) != 0) {
+            // Sem todos os estágios não há pipeline: terminar os já criados
+            printf("[ERRO] Falha ao criar estágio %d do pipeline\n", i + 2);
+            VendaPipeline fim;
+            memset(&fim, 0, sizeof(fim));
+            fim.cliente.id_cliente = -1;
+            for (int k = 0; k < i; k++) anel_colocar(&ctx.aneis[k], &fim);
+            for (int k = 0; k < i; k++) pthread_join(threads[k], NULL);
+            free(ctx.aneis);
+            return 0;
+        }
+    }
+
+    cpu_set_t original;
+    int com_afinidade = pthread_getaffinity_np(pthread_self(), sizeof(original), &original) == 0;
+    fixar_estagio(0);
+
+    estagio_despacho(&ctx);
+
+    for (int i = 0; i < NUM_ESTAGIOS_PIPELINE - 1; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    if (com_afinidade) pthread_setaffinity_np(pthread_self(), sizeof(original), &original);
+
+    free(ctx.aneis);
+    return ctx.vendas;
+}
+
+/* ========== BENCHMARK ========== */
+
+/* Caminho monolítico: uma venda inteira sob um lock, como numa agência */
+static int venda_monolitica(FilaPrioridade* fila, pthread_mutex_t* lock, Turno turno) {
+    pthread_mutex_lock(lock);
+
+    Cliente cliente;
+    if (!retirar_proximo_cliente(fila, &cliente)) {
+        pthread_mutex_unlock(lock);
+        return 0;
+    }
+
+    int cartao_id = reservar_proximo_cartao();
+    if (cartao_id == -1) {
+        devolver_cliente(fila, &cliente);
+        pthread_mutex_unlock(lock);
+        return 0;
+    }
+
+    saida_venda("[MONOLITICO] %-7s | Cliente: %03d | Cartão: %03d\n",
+                cliente.tipo == EMPRESA ? "EMPRESA" : "PUBLICO",
+                cliente.id_cliente, cartao_id);
+    diario_registar_venda(cliente.id_cliente, cliente.tipo, cliente.timestamp,
+                          cartao_id, 0, turno);
+    traco_venda(cliente.id_cliente, cliente.tipo, cartao_id, 0);
+    contabilizar_venda(cliente.tipo, turno);
+
+    pthread_mutex_unlock(lock);
+    return 1;
+}
+
+static void encher_fila(FilaPrioridade* fila, int primeiro_id, int quantidade) {
+    for (int i = 0; i < quantidade; i++) {
+        int id = primeiro_id + i;
+        inserir_cliente(fila, id, id % 3 == 0 ? EMPRESA : PUBLICO);
+    }
+}
+
+/* Garante 'quantidade' cartões disponíveis; 0 se não couberem */
+static int preparar_estoque(int quantidade) {
+    int falta = quantidade - estoque_disponivel();
+    return falta <= 0 || reabastecer_estoque(falta) == falta;
+}
+
+/* Vendas em lotes de MAX_FILA (a fila não guarda mais). Só o
+ * processamento de cada lote é cronometrado, não o enchimento. */
+static double medir_vendas(int pipeline, int num_clientes, int* vendas) {
+    FilaPrioridade* fila = inicializar_fila();
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    long long total_ns = 0;
+    *vendas = 0;
+
+    if (!fila) return 0;
+
+    for (int feitos = 0; feitos < num_clientes; ) {
+        int lote = num_clientes - feitos < MAX_FILA ? num_clientes - feitos : MAX_FILA;
+        encher_fila(fila, feitos, lote);
+
+        long long inicio = relogio_agora_ns();
+        int vendidas = 0;
+        if (pipeline) {
+            vendidas = executar_pipeline_vendas(fila, MANHA, 0);
+        } else {
+            while (venda_monolitica(fila, &lock, MANHA)) vendidas++;
+        }
+        total_ns += relogio_agora_ns() - inicio;
+
+        *vendas += vendidas;
+        feitos += lote;
+        if (vendidas < lote) break;   // Sem estoque
+    }
+
+    liberar_fila(fila);
+    return total_ns / 1e9;
+}
+
+void benchmark_pipeline_vendas(int num_clientes) {
+    int maximo = (MAX_CARTOES - estoque_total()) / 2;
+    if (num_clientes > maximo) num_clientes = maximo;
+    if (num_clientes < 1) {
+        printf("[PIPELINE] Sem capacidade de estoque para o benchmark\n");
+        return;
+    }
+
+    printf("\n=== BENCHMARK: MONOLÍTICO vs PIPELINE ===\n");
+    printf("Clientes por modo: %d | Estágios: %d | Núcleos: %ld\n",
+           num_clientes, NUM_ESTAGIOS_PIPELINE, sysconf(_SC_NPROCESSORS_ONLN));
+
+    const char* nomes[2] = { "Monolítico", "Pipeline" };
+    double taxas[2] = { 0, 0 };
+    for (int modo = 0; modo < 2; modo++) {
+        if (!preparar_estoque(num_clientes)) {
+            printf("[PIPELINE] Falha ao repor estoque para o benchmark\n");
+            return;
+        }
+
+        int vendas;
+        double segundos = medir_vendas(modo, num_clientes, &vendas);
+        saida_vendas_descarregar();
+        taxas[modo] = segundos > 0 ? vendas / segundos : 0;
+        printf("%-11s %8d vendas em %.4fs (%.0f vendas/s)\n",
+               nomes[modo], vendas, segundos, taxas[modo]);
+    }
+
+    if (taxas[0] > 0) {
+        printf("Pipeline / monolítico: %.2fx\n", taxas[1] / taxas[0]);
+    }
+    if (sysconf(_SC_NPROCESSORS_ONLN) < NUM_ESTAGIOS_PIPELINE) {
+        printf("Aviso: menos núcleos do que estágios; os estágios partilham CPU\n");
+    }
+}
@@ -0,0 +1,70 @@
+#include "relogio.h"
+#include <stdatomic.h>
+
+static ModoRelogio modo_relogio = RELOGIO_REAL;
+
+/* Instante virtual em ns; só cresce */
+static atomic_llong instante_virtual = 0;
+
+/* ========== FUNÇÕES INTERNAS ========== */
+
+static long long tempo_sistema_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * NS_POR_SEGUNDO + ts.tv_nsec;
+}
+
+/* Dorme até ao instante absoluto (tempo real). Um sinal (ex.: Ctrl+C)
+ * interrompe a espera e o chamador decide se continua. */
+static void dormir_ate_ns(long long instante_ns) {
+    struct timespec prazo = {
+        .tv_sec = instante_ns / NS_POR_SEGUNDO,
+        .tv_nsec = instante_ns % NS_POR_SEGUNDO
+    };
+    clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &prazo, NULL);
+}
+
+/* ========== FUNÇÕES PÚBLICAS ========== */
+
+void relogio_configurar(ModoRelogio modo, time_t inicio) {
+    modo_relogio = modo;
+    long long base = (inicio > 0) ? (long long)inicio * NS_POR_SEGUNDO : tempo_sistema_ns();
+    atomic_store(&instante_virtual, base);
+}
+
+int relogio_virtual(void) {
+    return modo_relogio == RELOGIO_VIRTUAL;
+}
+
+long long relogio_agora_ns(void) {
+    if (modo_relogio == RELOGIO_REAL) return tempo_sistema_ns();
+    return atomic_load_explicit(&instante_virtual, memory_order_acquire);
+}
+
+time_t relogio_agora(void) {
+    if (modo_relogio == RELOGIO_REAL) return time(NULL);
+    return (time_t)(relogio_agora_ns() / NS_POR_SEGUNDO);
+}
+
+/* Leva o relógio até 'instante_ns' (nunca para trás). No modo virtual
+ * quem conduz a simulação é uma só thread; avanços concorrentes ficam
+ * com o maior instante pedido. */
+void relogio_avancar_ate(long long instante_ns) {
+    if (modo_relogio == RELOGIO_REAL) {
+        if (instante_ns > tempo_sistema_ns()) dormir_ate_ns(instante_ns);
+        return;
+    }
+
+    long long atual = atomic_load_explicit(&instante_virtual, memory_order_relaxed);
+    while (instante_ns > atual &&
+           !atomic_compare_exchange_weak_explicit(&instante_virtual, &atual, instante_ns,
+                                                  memory_order_release,
+                                                  memory_order_relaxed)) {
+        // 'atual' foi atualizado pela falha do CAS
+    }
+}
+
+void relogio_dormir_ms(long ms) {
+    if (ms <= 0) return;
+    relogio_avancar_ate(relogio_agora_ns() + (long long)ms * 1000000LL);
+}
@@ -0,0 +1,303 @@
+#include "reproducao.h"
+#include "vendas.h"
+#include "contratacoes.h"
+#include "relogio.h"
+#include "limitador.h"
+#include "afinidade.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+static ModoReproducao modo_reproducao = REPRODUCAO_TEMPO_ORIGINAL;
+static LeitorTraco leitor_eventos;     // Entradas a reproduzir
+static LeitorTraco leitor_vendas;      // Vendas gravadas, para comparar
+static FilaPrioridade* fila_reproducao = NULL;
+static RegistoTraco pendente;          // Próxima entrada (lida antecipadamente)
+static int pendente_valido = 0;
+static long long inicio_reproducao_ns = 0;
+static struct timespec inicio_real, fim_real;
+
+static pthread_t thread_reproducao;
+static int thread_criada = 0;
+static atomic_int reproducao_ativa = 0;
+
+static EstatisticasReproducao estatisticas;
+static pthread_mutex_t estatisticas_mutex = PTHREAD_MUTEX_INITIALIZER;
+static RegistoTraco venda_divergente_gravada;
+static int venda_divergente[3];        // cliente, cartão, agência reproduzidos
+
+/* ========== LEITURA DO TRAÇO ========== */
+
+/* Próxima entrada: as vendas gravadas não se reproduzem, comparam-se */
+static void ler_proxima_entrada(void) {
+    int lido;
+    while ((lido = traco_ler_evento(&leitor_eventos, &pendente)) == 1 &&
+           pendente.evento == TRACO_VENDA) {
+    }
+    if (lido < 0) printf("[REPRODUCAO] Traço truncado ou corrompido\n");
+    pendente_valido = (lido == 1);
+}
+
+static int ler_proxima_venda_gravada(RegistoTraco* venda) {
+    int lido;
+    while ((lido = traco_ler_evento(&leitor_vendas, venda)) == 1 &&
+           venda->evento != TRACO_VENDA) {
+    }
+    return lido == 1;
+}
+
+static void contar(long long* contador) {
+    pthread_mutex_lock(&estatisticas_mutex);
+    (*contador)++;
+    pthread_mutex_unlock(&estatisticas_mutex);
+}
+
+/* A análise corre no motor de eventos do RH: não bloqueia a reprodução */
+static void reproduzir_contratacao(const RegistoTraco* registo) {
+    iniciar_processo_contratacao(leitor_eventos.nome, leitor_eventos.cargo,
+                                 registo->valor / 100.0f);
+}
+
+/* Executa uma entrada pela API que a gerou na gravação */
+static void executar_entrada(const RegistoTraco* registo) {
+    contar(&estatisticas.eventos);
+    switch (registo->evento) {
+        case TRACO_CHEGADA:
+            // Sem bloquear: no modo rápido não há quem esvazie a fila enquanto esperamos
+            contar(&estatisticas.chegadas);
+            if (!tentar_inserir_cliente(fila_reproducao, registo->id, (TipoCliente)registo->tipo)) {
+                contar(&estatisticas.recusadas);
+            }
+            break;
+        case TRACO_BLOQUEIO_PUBLICO:
+            contar(&estatisticas.bloqueios);
+            bloquear_vendas_publico(fila_reproducao);
+            break;
+        case TRACO_CONTRATACAO:
+            contar(&estatisticas.contratacoes);
+            reproduzir_contratacao(registo);
+            break;
+        case TRACO_DEMISSAO:
+            contar(&estatisticas.demissoes);
+            demitir_funcionario(registo->id);
+            break;
+        default:
+            break;
+    }
+}
+
+/* ========== COMPARAÇÃO DAS VENDAS ========== */
+
+static void comparar_venda(int cliente_id, int cartao_id, int agencia_id) {
+    pthread_mutex_lock(&estatisticas_mutex);
+    long long numero = ++estatisticas.vendas_reproduzidas;
+
+    RegistoTraco gravada;
+    int existe = ler_proxima_venda_gravada(&gravada);
+    if (existe) estatisticas.vendas_gravadas++;
+
+    if (existe && gravada.id == cliente_id && gravada.valor == cartao_id &&
+        gravada.agencia_id == agencia_id) {
+        estatisticas.vendas_coincidentes++;
+    } else if (estatisticas.primeira_divergencia < 0) {
+        estatisticas.primeira_divergencia = numero;
+        if (existe) {
+            venda_divergente_gravada = gravada;
+        } else {
+            memset(&venda_divergente_gravada, 0, sizeof(venda_divergente_gravada));
+        }
+        venda_divergente[0] = cliente_id;
+        venda_divergente[1] = cartao_id;
+        venda_divergente[2] = agencia_id;
+    }
+    pthread_mutex_unlock(&estatisticas_mutex);
+}
+
+/* ========== CONDUÇÃO ========== */
+
+/* Modo rápido: chamado pelo ciclo de simulação com o relógio em 'agora' */
+static long long injetar_entradas(long long agora_ns) {
+    while (pendente_valido && inicio_reproducao_ns + pendente.instante_ns <= agora_ns) {
+        executar_entrada(&pendente);
+        ler_proxima_entrada();
+    }
+    return pendente_valido ? inicio_reproducao_ns + pendente.instante_ns : -1;
+}
+
+/* Tempo original: dorme até cada entrada, em fatias para poder parar */
+static void* thread_reproduzir(void* arg) {
+    (void)arg;
+
+    while (atomic_load(&reproducao_ativa) && pendente_valido) {
+        long long alvo = inicio_reproducao_ns + pendente.instante_ns;
+        long long agora = relogio_agora_ns();
+        if (agora < alvo) {
+            long espera_ms = (long)((alvo - agora) / 1000000LL);
+            if (espera_ms > 100) {
+                relogio_dormir_ms(100);
+                continue;
+            }
+            relogio_avancar_ate(alvo);
+        }
+        executar_entrada(&pendente);
+        ler_proxima_entrada();
+    }
+
+    atomic_store(&reproducao_ativa, 0);
+    return NULL;
+}
+
+/* ========== FUNÇÕES PÚBLICAS ========== */
+
+int reproducao_preparar(const char* caminho, ModoReproducao modo, CabecalhoTraco* cabecalho) {
+    if (!traco_abrir_leitura(&leitor_eventos, caminho)) return 0;
+    if (!traco_abrir_leitura(&leitor_vendas, caminho)) {
+        traco_fechar_leitura(&leitor_eventos);
+        return 0;
+    }
+
+    CabecalhoTraco* gravado = &leitor_eventos.cabecalho;
+    modo_reproducao = modo;
+
+    // Relógio fixo: o tempo virtual recomeça no segundo em que a gravação começou
+    if (modo == REPRODUCAO_RAPIDA) {
+        relogio_configurar(RELOGIO_VIRTUAL, (time_t)(gravado->inicio_ns / NS_POR_SEGUNDO));
+    }
+    srand(gravado->semente);
+
+    long duracoes[3];
+    int limites[3];
+    for (int t = 0; t < 3; t++) {
+        duracoes[t] = (long)gravado->duracao_turno_ms[t];
+        limites[t] = gravado->limite_turno[t];
+    }
+    configurar_turnos(duracoes, limites);
+
+    // Limites de ritmo da gravação (substituem os da linha de comandos)
+    for (int e = 0; e < 2; e++) {
+        for (int t = 0; t < 2; t++) {
+            definir_limite((EtapaLimite)e, (TipoCliente)t,
+                           gravado->taxa_limite[e][t], gravado->rajada_limite[e][t]);
+        }
+    }
+
+    if (cabecalho) *cabecalho = *gravado;
+    printf("[REPRODUCAO] %s: semente %u, %d agências, modo %s\n",
+           caminho, gravado->semente, gravado->num_agencias,
+           modo == REPRODUCAO_RAPIDA ? "rápido (tempo virtual)" : "tempo original");
+    return 1;
+}
+
+int reproducao_iniciar(FilaPrioridade* fila) {
+    if (!fila || !leitor_eventos.ficheiro) return 0;
+
+    fila_reproducao = fila;
+    memset(&estatisticas, 0, sizeof(estatisticas));
+    estatisticas.primeira_divergencia = -1;
+
+    ler_proxima_entrada();
+    inicio_reproducao_ns = relogio_agora_ns();
+    clock_gettime(CLOCK_MONOTONIC, &inicio_real);
+    traco_observar_vendas(comparar_venda);
+    atomic_store(&reproducao_ativa, 1);
+
+    if (modo_reproducao == REPRODUCAO_RAPIDA) {
+        // As entradas vencidas já e as seguintes como eventos da simulação
+        injetar_entradas(inicio_reproducao_ns);
+        definir_injetor_virtual(injetar_entradas);
+        return 1;
+    }
+
+    thread_criada = pthread_create(&thread_reproducao, NULL, thread_reproduzir, NULL) == 0;
+    if (!thread_criada) {
+        printf("[ERRO] Falha ao criar thread de reprodução\n");
+        atomic_store(&reproducao_ativa, 0);
+        traco_observar_vendas(NULL);
+        return 0;
+    }
+    return 1;
+}
+
+int reproducao_em_curso(void) {
+    if (modo_reproducao == REPRODUCAO_RAPIDA) {
+        return atomic_load(&reproducao_ativa) && pendente_valido;
+    }
+    return atomic_load(&reproducao_ativa);
+}
+
+void reproducao_concluir(void) {
+    if (modo_reproducao != REPRODUCAO_RAPIDA || !atomic_load(&reproducao_ativa)) return;
+
+    while (pendente_valido) {
+        relogio_avancar_ate(inicio_reproducao_ns + pendente.instante_ns);
+        executar_entrada(&pendente);
+        ler_proxima_entrada();
+    }
+}
+
+void reproducao_parar(void) {
+    atomic_store(&reproducao_ativa, 0);
+    if (thread_criada) {
+        pthread_join(thread_reproducao, NULL);
+        thread_criada = 0;
+    }
+    definir_injetor_virtual(NULL);
+    traco_observar_vendas(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &fim_real);
+
+    // Vendas gravadas que a reprodução não chegou a fazer
+    RegistoTraco venda;
+    while (ler_proxima_venda_gravada(&venda)) {
+        estatisticas.vendas_gravadas++;
+        if (estatisticas.primeira_divergencia < 0) {
+            estatisticas.primeira_divergencia = estatisticas.vendas_reproduzidas + 1;
+            venda_divergente_gravada = venda;
+            memset(venda_divergente, 0, sizeof(venda_divergente));
+        }
+    }
+
+    traco_fechar_leitura(&leitor_eventos);
+    traco_fechar_leitura(&leitor_vendas);
+    pendente_valido = 0;
+}
+
+void obter_estatisticas_reproducao(EstatisticasReproducao* destino) {
+    if (!destino) return;
+
+    pthread_mutex_lock(&estatisticas_mutex);
+    *destino = estatisticas;
+    pthread_mutex_unlock(&estatisticas_mutex);
+
+    struct timespec fim = fim_real;
+    if (atomic_load(&reproducao_ativa)) clock_gettime(CLOCK_MONOTONIC, &fim);
+    destino->duracao_real_s = (fim.tv_sec - inicio_real.tv_sec) +
+                              (fim.tv_nsec - inicio_real.tv_nsec) / 1e9;
+}
+
+void exibir_relatorio_reproducao(void) {
+    EstatisticasReproducao e;
+    obter_estatisticas_reproducao(&e);
+
+    printf("\n=== RELATÓRIO DA REPRODUÇÃO ===\n");
+    printf("Eventos: %lld (chegadas %lld, recusadas %lld, bloqueios %lld, "
+           "contratações %lld, demissões %lld)\n",
+           e.eventos, e.chegadas, e.recusadas, e.bloqueios, e.contratacoes, e.demissoes);
+    printf("Vendas: gravadas %lld, reproduzidas %lld, coincidentes %lld\n",
+           e.vendas_gravadas, e.vendas_reproduzidas, e.vendas_coincidentes);
+
+    if (e.primeira_divergencia < 0) {
+        printf("Resultado: reprodução idêntica à gravação\n");
+    } else {
+        printf("Primeira divergência na venda %lld: gravada cliente %d/cartão %d/agência %d, "
+               "reproduzida cliente %d/cartão %d/agência %d\n",
+               e.primeira_divergencia,
+               venda_divergente_gravada.id, venda_divergente_gravada.valor,
+               venda_divergente_gravada.agencia_id,
+               venda_divergente[0], venda_divergente[1], venda_divergente[2]);
+    }
+    printf("Duração real: %.3fs\n", e.duracao_real_s);
+    printf("===============================\n");
+}
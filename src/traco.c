@@ -0,0 +1,217 @@
+#include "traco.h"
+#include "relogio.h"
+#include "limitador.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/* Um só ficheiro para todas as threads: a ordem dos registos é a ordem
+ * em que as operações aconteceram, que é o que a reprodução repete */
+static FILE* ficheiro_traco = NULL;
+static char* buffer_traco = NULL;
+static pthread_mutex_t traco_mutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int a_gravar = 0;
+static long long inicio_traco_ns = 0;
+static long long registos_gravados = 0;
+static ObservadorVendas observador_vendas = NULL;
+
+/* ========== GRAVAÇÃO ========== */
+
+int traco_gravar(const char* caminho, unsigned semente, int num_agencias,
+                 const long duracao_turno_ms[3], const int limite_turno[3]) {
+    if (!caminho) return 0;
+
+    FILE* f = fopen(caminho, "wb");
+    if (!f) {
+        printf("[TRACO] Não foi possível criar %s\n", caminho);
+        return 0;
+    }
+
+    buffer_traco = (char*)malloc(BUFFER_TRACO);
+    if (buffer_traco) setvbuf(f, buffer_traco, _IOFBF, BUFFER_TRACO);
+
+    CabecalhoTraco cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magia, TRACO_MAGIA, sizeof(cabecalho.magia));
+    cabecalho.versao = TRACO_VERSAO;
+    cabecalho.tamanho_registo = sizeof(RegistoTraco);
+    cabecalho.semente = semente;
+    cabecalho.num_agencias = num_agencias;
+    for (int t = 0; t < 3; t++) {
+        cabecalho.duracao_turno_ms[t] = duracao_turno_ms[t];
+        cabecalho.limite_turno[t] = limite_turno[t];
+    }
+
+    // Os limites de ritmo decidem quem entra e quem é atendido primeiro
+    EstatisticasLimites limites_ritmo;
+    obter_estatisticas_limites(&limites_ritmo);
+    for (int e = 0; e < 2; e++) {
+        for (int t = 0; t < 2; t++) {
+            cabecalho.taxa_limite[e][t] = limites_ritmo.etapa[e][t].taxa;
+            cabecalho.rajada_limite[e][t] = limites_ritmo.etapa[e][t].rajada;
+        }
+    }
+
+    pthread_mutex_lock(&traco_mutex);
+    inicio_traco_ns = relogio_agora_ns();
+    cabecalho.inicio_ns = inicio_traco_ns;
+    fwrite(&cabecalho, sizeof(cabecalho), 1, f);
+    ficheiro_traco = f;
+    registos_gravados = 0;
+    atomic_store(&a_gravar, 1);
+    pthread_mutex_unlock(&traco_mutex);
+
+    printf("[TRACO] A gravar operações em %s (semente %u)\n", caminho, semente);
+    return 1;
+}
+
+void traco_parar_gravacao(void) {
+    if (!atomic_exchange(&a_gravar, 0)) return;
+
+    pthread_mutex_lock(&traco_mutex);
+    fclose(ficheiro_traco);
+    ficheiro_traco = NULL;
+    free(buffer_traco);
+    buffer_traco = NULL;
+    long long total = registos_gravados;
+    pthread_mutex_unlock(&traco_mutex);
+
+    printf("[TRACO] Gravação terminada: %lld eventos\n", total);
+}
+
+long long traco_total_registos(void) {
+    pthread_mutex_lock(&traco_mutex);
+    long long total = registos_gravados;
+    pthread_mutex_unlock(&traco_mutex);
+    return total;
+}
+
+/* O instante é lido com o lock, para que os registos saiam por ordem */
+static void gravar_evento(RegistoTraco* registo, const char* nome, const char* cargo) {
+    pthread_mutex_lock(&traco_mutex);
+    if (ficheiro_traco) {
+        registo->instante_ns = relogio_agora_ns() - inicio_traco_ns;
+        fwrite(registo, sizeof(*registo), 1, ficheiro_traco);
+        if (registo->tamanho_nome) fwrite(nome, 1, registo->tamanho_nome, ficheiro_traco);
+        if (registo->tamanho_cargo) fwrite(cargo, 1, registo->tamanho_cargo, ficheiro_traco);
+        registos_gravados++;
+    }
+    pthread_mutex_unlock(&traco_mutex);
+}
+
+static void preencher_registo(RegistoTraco* registo, TipoEventoTraco evento) {
+    memset(registo, 0, sizeof(*registo));
+    registo->evento = (uint8_t)evento;
+}
+
+void traco_chegada(int cliente_id, TipoCliente tipo) {
+    if (!atomic_load_explicit(&a_gravar, memory_order_relaxed)) return;
+
+    RegistoTraco registo;
+    preencher_registo(&registo, TRACO_CHEGADA);
+    registo.id = cliente_id;
+    registo.tipo = (uint8_t)tipo;
+    gravar_evento(&registo, NULL, NULL);
+}
+
+void traco_bloqueio_publico(void) {
+    if (!atomic_load_explicit(&a_gravar, memory_order_relaxed)) return;
+
+    RegistoTraco registo;
+    preencher_registo(&registo, TRACO_BLOQUEIO_PUBLICO);
+    gravar_evento(&registo, NULL, NULL);
+}
+
+void traco_contratacao(const char* nome, const char* cargo, float salario) {
+    if (!atomic_load_explicit(&a_gravar, memory_order_relaxed)) return;
+
+    size_t tamanho_nome = nome ? strlen(nome) : 0;
+    size_t tamanho_cargo = cargo ? strlen(cargo) : 0;
+
+    RegistoTraco registo;
+    preencher_registo(&registo, TRACO_CONTRATACAO);
+    registo.valor = (int32_t)(salario * 100.0f + 0.5f);
+    registo.tamanho_nome = (uint8_t)(tamanho_nome > 255 ? 255 : tamanho_nome);
+    registo.tamanho_cargo = (uint8_t)(tamanho_cargo > 255 ? 255 : tamanho_cargo);
+    gravar_evento(&registo, nome, cargo);
+}
+
+void traco_demissao(int id) {
+    if (!atomic_load_explicit(&a_gravar, memory_order_relaxed)) return;
+
+    RegistoTraco registo;
+    preencher_registo(&registo, TRACO_DEMISSAO);
+    registo.id = id;
+    gravar_evento(&registo, NULL, NULL);
+}
+
+void traco_venda(int cliente_id, TipoCliente tipo, int cartao_id, int agencia_id) {
+    if (observador_vendas) observador_vendas(cliente_id, cartao_id, agencia_id);
+    if (!atomic_load_explicit(&a_gravar, memory_order_relaxed)) return;
+
+    RegistoTraco registo;
+    preencher_registo(&registo, TRACO_VENDA);
+    registo.id = cliente_id;
+    registo.valor = cartao_id;
+    registo.agencia_id = agencia_id;
+    registo.tipo = (uint8_t)tipo;
+    gravar_evento(&registo, NULL, NULL);
+}
+
+/* Definido antes de arrancarem as threads que vendem */
+void traco_observar_vendas(ObservadorVendas observador) {
+    observador_vendas = observador;
+}
+
+/* ========== LEITURA ========== */
+
+int traco_abrir_leitura(LeitorTraco* leitor, const char* caminho) {
+    if (!leitor || !caminho) return 0;
+    memset(leitor, 0, sizeof(*leitor));
+
+    leitor->ficheiro = fopen(caminho, "rb");
+    if (!leitor->ficheiro) {
+        printf("[TRACO] Não foi possível abrir %s\n", caminho);
+        return 0;
+    }
+
+    CabecalhoTraco* cabecalho = &leitor->cabecalho;
+    if (fread(cabecalho, sizeof(*cabecalho), 1, leitor->ficheiro) != 1 ||
+        memcmp(cabecalho->magia, TRACO_MAGIA, sizeof(cabecalho->magia)) != 0 ||
+        cabecalho->versao != TRACO_VERSAO ||
+        cabecalho->tamanho_registo != sizeof(RegistoTraco)) {
+        printf("[TRACO] %s não é um traço válido (versão %d)\n", caminho, TRACO_VERSAO);
+        traco_fechar_leitura(leitor);
+        return 0;
+    }
+    return 1;
+}
+
+int traco_ler_evento(LeitorTraco* leitor, RegistoTraco* registo) {
+    if (!leitor->ficheiro) return -1;
+    if (fread(registo, sizeof(*registo), 1, leitor->ficheiro) != 1) {
+        return feof(leitor->ficheiro) ? 0 : -1;
+    }
+    if (registo->evento > TRACO_VENDA) return -1;
+
+    leitor->nome[0] = leitor->cargo[0] = '\0';
+    if (registo->tamanho_nome &&
+        fread(leitor->nome, 1, registo->tamanho_nome, leitor->ficheiro) != registo->tamanho_nome) {
+        return -1;
+    }
+    leitor->nome[registo->tamanho_nome] = '\0';
+    if (registo->tamanho_cargo &&
+        fread(leitor->cargo, 1, registo->tamanho_cargo, leitor->ficheiro) != registo->tamanho_cargo) {
+        return -1;
+    }
+    leitor->cargo[registo->tamanho_cargo] = '\0';
+    return 1;
+}
+
+void traco_fechar_leitura(LeitorTraco* leitor) {
+    if (leitor && leitor->ficheiro) {
+        fclose(leitor->ficheiro);
+        leitor->ficheiro = NULL;
+    }
+}
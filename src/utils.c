@@ -1,4 +1,5 @@
 #include "utils.h"
+#include "afinidade.h"
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,6 +23,20 @@ static FILE* log_file = NULL;
 static LogLevel current_level = LOG_INFO;
 static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* Saída por venda */
+typedef struct BufferSaida {
+    char dados[TAMANHO_BUFFER_SAIDA];
+    size_t usado;
+    int orfao;                     // A thread dona já terminou
+    struct BufferSaida* proximo;   // Lista de todos os buffers (para descarregar)
+} BufferSaida;
+
+static ModoSaidaVendas modo_saida = SAIDA_TERMINAL;
+static BufferSaida* buffers_saida = NULL;
+static pthread_mutex_t saida_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t chave_buffer;
+static pthread_once_t chave_buffer_once = PTHREAD_ONCE_INIT;
+
 /* Inicializar sistema de logs */
 void init_logging(const char* filename) {
     pthread_mutex_lock(&log_mutex);
@@ -132,6 +147,126 @@ void thread_safe_printf(const char* format, ...) {
     pthread_mutex_unlock(&log_mutex);
 }
 
+/* ========== SAÍDA POR VENDA ========== */
+
+void definir_modo_saida_vendas(ModoSaidaVendas modo) {
+    modo_saida = modo;
+}
+
+ModoSaidaVendas get_modo_saida_vendas(void) {
+    return modo_saida;
+}
+
+int saida_vendas_headless(void) {
+    return modo_saida != SAIDA_TERMINAL;
+}
+
+/* Escreve o conteúdo de um buffer no stdout de uma só vez (saida_mutex adquirido) */
+static void escrever_buffer(BufferSaida* buffer) {
+    if (buffer->usado == 0) return;
+    
+    fwrite(buffer->dados, 1, buffer->usado, stdout);
+    buffer->usado = 0;
+}
+
+/* Fim da thread: o buffer fica registado até ser descarregado */
+static void marcar_buffer_orfao(void* ptr) {
+    pthread_mutex_lock(&saida_mutex);
+    ((BufferSaida*)ptr)->orfao = 1;
+    pthread_mutex_unlock(&saida_mutex);
+}
+
+static void criar_chave_buffer(void) {
+    pthread_key_create(&chave_buffer, marcar_buffer_orfao);
+}
+
+/* Buffer da thread atual */
+static BufferSaida* obter_buffer_thread(void) {
+    pthread_once(&chave_buffer_once, criar_chave_buffer);
+    
+    BufferSaida* buffer = (BufferSaida*)pthread_getspecific(chave_buffer);
+    if (!buffer) {
+        // No nó NUMA da thread que o vai usar
+        buffer = (BufferSaida*)alocar_memoria_local(sizeof(BufferSaida));
+        if (!buffer) return NULL;
+        buffer->usado = 0;
+        buffer->orfao = 0;
+        
+        pthread_mutex_lock(&saida_mutex);
+        buffer->proximo = buffers_saida;
+        buffers_saida = buffer;
+        pthread_mutex_unlock(&saida_mutex);
+        
+        pthread_setspecific(chave_buffer, buffer);
+    }
+    return buffer;
+}
+
+/* Linha de uma venda: sem lock partilhado por venda nos modos headless */
+void saida_venda(const char* format, ...) {
+    if (modo_saida == SAIDA_DESCARTAR) return;
+    
+    va_list args;
+    va_start(args, format);
+    
+    if (modo_saida == SAIDA_TERMINAL) {
+        vprintf(format, args);
+        va_end(args);
+        return;
+    }
+    
+    BufferSaida* buffer = obter_buffer_thread();
+    if (!buffer) {
+        va_end(args);
+        return;
+    }
+    
+    va_list copia;
+    va_copy(copia, args);
+    int n = vsnprintf(buffer->dados + buffer->usado,
+                      TAMANHO_BUFFER_SAIDA - buffer->usado, format, args);
+    if (n >= 0 && buffer->usado + (size_t)n >= TAMANHO_BUFFER_SAIDA) {
+        // Não coube: despejar o buffer e voltar a formatar no início
+        pthread_mutex_lock(&saida_mutex);
+        escrever_buffer(buffer);
+        pthread_mutex_unlock(&saida_mutex);
+        n = vsnprintf(buffer->dados, TAMANHO_BUFFER_SAIDA, format, copia);
+        if (n >= TAMANHO_BUFFER_SAIDA) n = TAMANHO_BUFFER_SAIDA - 1;
+    }
+    if (n > 0) buffer->usado += (size_t)n;
+    va_end(copia);
+    va_end(args);
+}
+
+/* Escreve o que ficou em todos os buffers e liberta os das threads que
+ * já terminaram. Chamar com as vendas paradas. */
+void saida_vendas_descarregar(void) {
+    pthread_mutex_lock(&saida_mutex);
+    
+    // A lista está do mais recente para o mais antigo: escrever ao contrário
+    int n = 0;
+    for (BufferSaida* b = buffers_saida; b; b = b->proximo) n++;
+    for (int i = n - 1; i >= 0; i--) {
+        BufferSaida* b = buffers_saida;
+        for (int k = 0; k < i; k++) b = b->proximo;
+        escrever_buffer(b);
+    }
+    
+    BufferSaida** ligacao = &buffers_saida;
+    while (*ligacao) {
+        BufferSaida* b = *ligacao;
+        if (b->orfao) {
+            *ligacao = b->proximo;
+            libertar_memoria_numa(b, sizeof(BufferSaida));
+        } else {
+            ligacao = &b->proximo;
+        }
+    }
+    
+    fflush(stdout);
+    pthread_mutex_unlock(&saida_mutex);
+}
+
 /* Obter ID da thread - VERSÃO CORRIGIDA */
 int get_thread_id(void) {
 #ifdef __linux__
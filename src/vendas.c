@@ -1,124 +1,942 @@
 #include "vendas.h"
 #include "estoque.h"
+#include "relogio.h"
+#include "utils.h"
+#include "diario.h"
+#include "traco.h"
+#include "pipeline.h"
+#include "afinidade.h"
+#include "multiprocesso.h"
+#include "estoque_remoto.h"
+#include "fibras.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <unistd.h>
 
 // Variáveis globais do módulo - AGORA NÃO SÃO STATIC para serem acessíveis
-Agencia agencias[NUM_AGENCIAS];
-EstatisticasVendas estatisticas_vendas;  // Renomeado de 'estatisticas' para 'estatisticas_vendas'
-pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+Agencia* agencias = NULL;
+int num_agencias = 0;
 
 static FilaPrioridade* fila_global = NULL;
 static int sistema_ativa = 0;
+static int num_agencias_pedido = NUM_AGENCIAS_PADRAO;
+static int usar_pipeline = 0;
+static int usar_processos = 0;
+static int usar_fibras = 0;
 
-// Nomes das agências
-static const char* nomes_agencias[NUM_AGENCIAS] = {
+/* Agências em fibras: esperas por clientes e por estoque cedem a portadora */
+static atomic_int fibras_em_curso = 0;
+static FilaEsperaFibras espera_clientes_fibras = FILA_ESPERA_FIBRAS_INICIALIZADOR;
+static FilaEsperaFibras espera_estoque_fibras = FILA_ESPERA_FIBRAS_INICIALIZADOR;
+
+// Nomes das primeiras agências; as restantes são numeradas
+static const char* nomes_agencias[] = {
     "Agência Centro", "Agência Sul"
 };
 
-/* Declaração antecipada */
-static void processar_venda_agencia(Agencia* agencia);
+/* Agendador: heap de agências ordenado pela próxima execução, servido
+ * por um pool de trabalhadores do tamanho do número de núcleos */
+static Agencia** agenda = NULL;
+static int tamanho_agenda = 0;
+static Agencia** estacionadas = NULL;    // Sem estoque: aguardam reposição
+static int num_estacionadas = 0;
+static pthread_mutex_t agenda_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t agenda_cond = PTHREAD_COND_INITIALIZER;
+
+static pthread_t* trabalhadores = NULL;
+static int num_trabalhadores = 0;
+static int trabalhadores_criados = 0;
+static volatile int pool_ativo = 0;
+static int id_limiar_retoma = -1;
+static int agencias_ativas = 0;          // Agências [0, agencias_ativas) em operação
+static InjetorVirtual injetor_virtual = NULL;
+
+/* Autoescala (desligada com maximo == 0). O estado é só do controlador. */
+static int autoescala_minimo = 0;
+static int autoescala_maximo = 0;
+static pthread_t thread_autoescala;
+static atomic_int autoescala_em_curso = 0;
+static struct {
+    long long instante_anterior;
+    int vendas_anteriores;
+    double espera_media;        // Média móvel da espera estimada (s)
+    int ciclos_baixos;          // Avaliações seguidas abaixo do limiar inferior
+    long long proxima_avaliacao;
+} autoescala;
+
+/* Contadores de vendas por thread: cada thread escreve só no seu slot,
+ * numa linha de cache própria, e os leitores somam os slots. O seqcount
+ * de cada slot garante que uma venda é lida inteira (total, tipo e turno). */
+typedef struct {
+    _Alignas(64) atomic_uint seq;   // Ímpar durante uma atualização
+    atomic_int total_vendas;
+    atomic_int vendas_empresas;
+    atomic_int vendas_publico;
+    atomic_int vendas_por_turno[3];
+    int indice;                     // Posição em slots_contadores
+} SlotContadores;
+
+/* Cada slot é alocado pela primeira thread dona, no seu nó NUMA, e
+ * reutilizado por outras threads depois de esta terminar */
+static _Atomic(SlotContadores*) slots_contadores[MAX_SLOTS_CONTADORES - 1];
+static atomic_int slots_atribuidos = 0;
+static _Thread_local SlotContadores* slot_thread = NULL;
+static pthread_key_t chave_slot;
+static pthread_once_t chave_slot_once = PTHREAD_ONCE_INIT;
+
+/* Threads para além dos slots próprios (ou sem memória) partilham este.
+ * Guarda também as vendas das threads que já terminaram. */
+static SlotContadores slot_partilhado;
+static pthread_mutex_t slot_partilhado_lock = PTHREAD_MUTEX_INITIALIZER;
+#define SLOT_PARTILHADO (&slot_partilhado)
+
+/* Slots devolvidos por threads terminadas (protegido por slot_partilhado_lock) */
+static int slots_livres[MAX_SLOTS_CONTADORES - 1];
+static int num_slots_livres = 0;
+
+/* Ímpar enquanto um slot é transferido para o partilhado: os leitores
+ * repetem a soma para não contarem essas vendas duas vezes (ou nenhuma) */
+static atomic_uint seq_transferencias = 0;
+
+/* Calendário de turnos das vendas concorrentes. O turno em curso e as
+ * vendas já feitas nele partilham uma palavra atómica:
+ * (índice do turno desde o início << 32) | vendas no turno.
+ * Assim a quota é reservada e a mudança de turno feita com um CAS, sem
+ * que uma venda possa ser contada no turno errado. */
+static long long duracao_turno_ns[3] = {
+    DURACAO_TURNO_PADRAO_MS * 1000000LL,
+    DURACAO_TURNO_PADRAO_MS * 1000000LL,
+    DURACAO_TURNO_PADRAO_MS * 1000000LL
+};
+static int limite_turno[3] = { LIMITE_VENDAS_MANHA, LIMITE_VENDAS_TARDE, LIMITE_VENDAS_NOITE };
+static long long inicio_turnos_ns = 0;
+static Turno turno_inicial = MANHA;
+static int num_turnos_calendario = 3;  // Turnos até ao fim da NOITE
+static atomic_ullong estado_turno = 0;
+
+/* Exportação CSV: um instantâneo copiado numa secção curta e escrito em
+ * disco por uma thread própria. Dois buffers: enquanto um é escrito, o
+ * outro pode receber o pedido seguinte. */
+typedef struct {
+    int id;
+    char nome[50];
+    int vendas_realizadas;
+    int clientes_atendidos;
+    int ativa;
+} ResumoAgencia;
+
+typedef struct {
+    ResumoAgencia* agencias;
+    int capacidade;
+    int num;
+    EstatisticasVendas estatisticas;
+    char ficheiro[256];
+    CallbackExportacao callback;
+    void* arg;
+} InstantaneoVendas;
+
+static InstantaneoVendas instantaneos[2];
+static int instantaneo_pendente = -1;    // Capturado, à espera do escritor
+static int instantaneo_em_escrita = -1;  // A ser escrito agora
+static EstadoExportacao estado_exportacao;
+static pthread_mutex_t exportacao_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t exportacao_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t thread_exportador;
+static int exportador_ativo = 0;
+
+/* Resultado de um passo de uma agência */
+#define PASSO_VENDEU     0
+#define PASSO_SEM_CLIENTE 1
+#define PASSO_SEM_ESTOQUE 2
+#define PASSO_SEM_QUOTA   3
+
+/* Sem vendas no intervalo com clientes à espera: espera tratada como longa */
+#define ESPERA_SEM_VENDAS_S 60.0
+
+/* Declarações antecipadas */
+static int processar_venda_agencia(Agencia* agencia);
+static void iniciar_trabalhadores(void);
 
 /* ========== FUNÇÕES INTERNAS ========== */
 
+/* Operações do heap da agenda (agenda_lock adquirido) */
+static void agenda_trocar(int i, int j) {
+    Agencia* tmp = agenda[i];
+    agenda[i] = agenda[j];
+    agenda[j] = tmp;
+    agenda[i]->indice_agenda = i;
+    agenda[j]->indice_agenda = j;
+}
+
+static void agenda_subir(int i) {
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (agenda[pai]->proxima_execucao <= agenda[i]->proxima_execucao) break;
+        agenda_trocar(i, pai);
+        i = pai;
+    }
+}
+
+static void agenda_descer(int i) {
+    for (;;) {
+        int menor = i;
+        int esq = 2 * i + 1, dir = 2 * i + 2;
+        if (esq < tamanho_agenda &&
+            agenda[esq]->proxima_execucao < agenda[menor]->proxima_execucao) menor = esq;
+        if (dir < tamanho_agenda &&
+            agenda[dir]->proxima_execucao < agenda[menor]->proxima_execucao) menor = dir;
+        if (menor == i) break;
+        agenda_trocar(i, menor);
+        i = menor;
+    }
+}
+
+static void agenda_inserir(Agencia* agencia) {
+    int i = tamanho_agenda++;
+    agenda[i] = agencia;
+    agencia->indice_agenda = i;
+    agenda_subir(i);
+
+    // Nova agência mais urgente: acordar um trabalhador para reavaliar o prazo
+    if (agencia->indice_agenda == 0) pthread_cond_signal(&agenda_cond);
+}
+
+static Agencia* agenda_retirar_topo(void) {
+    Agencia* topo = agenda[0];
+    tamanho_agenda--;
+    if (tamanho_agenda > 0) {
+        agenda[0] = agenda[tamanho_agenda];
+        agenda[0]->indice_agenda = 0;
+        agenda_descer(0);
+    }
+    topo->indice_agenda = -1;
+    topo->em_execucao = 1;
+    return topo;
+}
+
+static void agenda_remover(Agencia* agencia) {
+    int i = agencia->indice_agenda;
+    if (i < 0) return;
+    
+    tamanho_agenda--;
+    agencia->indice_agenda = -1;
+    if (i == tamanho_agenda) return;
+    
+    Agencia* ultima = agenda[tamanho_agenda];
+    agenda[i] = ultima;
+    ultima->indice_agenda = i;
+    agenda_subir(i);
+    agenda_descer(ultima->indice_agenda);
+}
+
+/* Ativar ou recolher agências até ficarem 'alvo' em operação (agenda_lock
+ * adquirido). Uma agência a meio de um passo só volta à agenda pelo seu
+ * trabalhador, que vê o novo valor de 'ativa'. */
+static void ajustar_agencias_ativas(int alvo) {
+    long long agora = relogio_agora_ns();
+    
+    while (agencias_ativas < alvo) {
+        Agencia* agencia = &agencias[agencias_ativas++];
+        agencia->ativa = 1;
+        if (!agencia->em_execucao && agencia->indice_agenda < 0) {
+            agencia->proxima_execucao = agora;
+            agenda_inserir(agencia);
+        }
+    }
+    
+    while (agencias_ativas > alvo) {
+        Agencia* agencia = &agencias[--agencias_ativas];
+        agencia->ativa = 0;
+        agenda_remover(agencia);
+        for (int k = 0; k < num_estacionadas; k++) {
+            if (estacionadas[k] == agencia) {
+                estacionadas[k] = estacionadas[--num_estacionadas];
+                break;
+            }
+        }
+    }
+}
+
+/* Estoque voltou a ficar disponível: reagendar agências estacionadas */
+static void retomar_agencias(int limiar, int disponiveis, int descendo, void* arg) {
+    (void)limiar;
+    (void)disponiveis;
+    (void)arg;
+
+    if (descendo) return;
+
+    if (atomic_load(&fibras_em_curso)) fibras_acordar_todas(&espera_estoque_fibras);
+
+    pthread_mutex_lock(&agenda_lock);
+    long long agora = relogio_agora_ns();
+    while (num_estacionadas > 0) {
+        Agencia* agencia = estacionadas[--num_estacionadas];
+        if (!agencia->ativa) continue;   // Recolhida pela autoescala
+        agencia->proxima_execucao = agora;
+        agenda_inserir(agencia);
+    }
+    pthread_cond_broadcast(&agenda_cond);
+    pthread_mutex_unlock(&agenda_lock);
+}
+
+static void somar_contador(atomic_int* contador, int delta) {
+    atomic_store_explicit(contador,
+        atomic_load_explicit(contador, memory_order_relaxed) + delta,
+        memory_order_relaxed);
+}
+
+/* Fim da thread: as vendas do slot passam para o partilhado e o slot
+ * fica livre para a próxima thread que vender */
+static void devolver_slot_thread(void* ptr) {
+    SlotContadores* slot = (SlotContadores*)ptr;
+    
+    pthread_mutex_lock(&slot_partilhado_lock);
+    unsigned transf = atomic_load_explicit(&seq_transferencias, memory_order_relaxed);
+    atomic_store_explicit(&seq_transferencias, transf + 1, memory_order_relaxed);
+    unsigned seq_p = atomic_load_explicit(&slot_partilhado.seq, memory_order_relaxed);
+    unsigned seq_s = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot_partilhado.seq, seq_p + 1, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq_s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    
+    somar_contador(&slot_partilhado.total_vendas,
+                   atomic_exchange_explicit(&slot->total_vendas, 0, memory_order_relaxed));
+    somar_contador(&slot_partilhado.vendas_empresas,
+                   atomic_exchange_explicit(&slot->vendas_empresas, 0, memory_order_relaxed));
+    somar_contador(&slot_partilhado.vendas_publico,
+                   atomic_exchange_explicit(&slot->vendas_publico, 0, memory_order_relaxed));
+    for (int t = 0; t < 3; t++) {
+        somar_contador(&slot_partilhado.vendas_por_turno[t],
+                       atomic_exchange_explicit(&slot->vendas_por_turno[t], 0, memory_order_relaxed));
+    }
+    
+    atomic_store_explicit(&slot->seq, seq_s + 2, memory_order_release);
+    atomic_store_explicit(&slot_partilhado.seq, seq_p + 2, memory_order_release);
+    atomic_store_explicit(&seq_transferencias, transf + 2, memory_order_release);
+    
+    slots_livres[num_slots_livres++] = slot->indice;
+    pthread_mutex_unlock(&slot_partilhado_lock);
+}
+
+static void criar_chave_slot(void) {
+    pthread_key_create(&chave_slot, devolver_slot_thread);
+}
+
+/* Slot de contadores da thread atual (atribuído na primeira venda) */
+static SlotContadores* obter_slot_thread(void) {
+    if (!slot_thread) {
+        pthread_once(&chave_slot_once, criar_chave_slot);
+        slot_thread = SLOT_PARTILHADO;
+        
+        // Primeiro um slot deixado por uma thread terminada (já a zero)
+        SlotContadores* slot = NULL;
+        pthread_mutex_lock(&slot_partilhado_lock);
+        if (num_slots_livres > 0) {
+            slot = atomic_load_explicit(&slots_contadores[slots_livres[--num_slots_livres]],
+                                        memory_order_acquire);
+        }
+        pthread_mutex_unlock(&slot_partilhado_lock);
+        
+        if (!slot) {
+            int indice = atomic_fetch_add_explicit(&slots_atribuidos, 1, memory_order_relaxed);
+            if (indice < MAX_SLOTS_CONTADORES - 1) {
+                // Páginas novas e a zero, publicadas só depois de prontas
+                slot = (SlotContadores*)alocar_memoria_local(sizeof(SlotContadores));
+                if (slot) {
+                    slot->indice = indice;
+                    atomic_store_explicit(&slots_contadores[indice], slot, memory_order_release);
+                }
+            }
+        }
+        
+        if (slot) {
+            pthread_setspecific(chave_slot, slot);
+            slot_thread = slot;
+        }
+    }
+    return slot_thread;
+}
+
+/* Slot i para os leitores: 0..MAX-2 próprios (NULL se ainda por alocar), MAX-1 partilhado */
+static SlotContadores* slot_indice(int i) {
+    if (i == MAX_SLOTS_CONTADORES - 1) return SLOT_PARTILHADO;
+    return atomic_load_explicit(&slots_contadores[i], memory_order_acquire);
+}
+
+/* Regista vendas no slot da thread: sem locks partilhados no caminho normal */
+static void contar_vendas(int empresas, int publico, int turno, int vendas_turno) {
+    SlotContadores* slot = obter_slot_thread();
+    int partilhado = (slot == SLOT_PARTILHADO);
+    if (partilhado) pthread_mutex_lock(&slot_partilhado_lock);
+    
+    unsigned seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    
+    somar_contador(&slot->total_vendas, empresas + publico);
+    somar_contador(&slot->vendas_empresas, empresas);
+    somar_contador(&slot->vendas_publico, publico);
+    if (turno >= 0 && turno < 3) somar_contador(&slot->vendas_por_turno[turno], vendas_turno);
+    
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+    
+    if (partilhado) pthread_mutex_unlock(&slot_partilhado_lock);
+}
+
+/* ========== CALENDÁRIO DE TURNOS ========== */
+
+static const char* nome_turno(Turno turno) {
+    return turno == MANHA ? "MANHÃ" : turno == TARDE ? "TARDE" : "NOITE";
+}
+
+static Turno turno_do_indice(int indice) {
+    return (Turno)((turno_inicial + indice) % 3);
+}
+
+/* Instante de início do turno com este índice */
+static long long inicio_turno_indice(int indice) {
+    long long inicio = inicio_turnos_ns;
+    for (int k = 0; k < indice; k++) inicio += duracao_turno_ns[turno_do_indice(k)];
+    return inicio;
+}
+
+/* Índice do turno que contém o instante 'agora' */
+static int indice_turno_em(long long agora) {
+    int indice = 0;
+    long long fim = inicio_turnos_ns + duracao_turno_ns[turno_do_indice(0)];
+    while (agora >= fim) {
+        indice++;
+        fim += duracao_turno_ns[turno_do_indice(indice)];
+    }
+    return indice;
+}
+
+/* Reserva uma venda na quota do turno em curso, mudando de turno se o
+ * calendário já o tiver ultrapassado. Retorna 1 e o índice do turno, ou
+ * 0 se a quota do turno está esgotada. */
+static int reservar_quota_turno(int* indice_turno) {
+    int indice_agora = indice_turno_em(relogio_agora_ns());
+    if (indice_agora >= num_turnos_calendario) return 0;  // Fim da NOITE
+    
+    unsigned long long estado = atomic_load_explicit(&estado_turno, memory_order_acquire);
+    
+    for (;;) {
+        int indice = (int)(estado >> 32);
+        
+        // O calendário avançou: a primeira thread a reparar abre o novo turno
+        if (indice_agora > indice) {
+            unsigned long long novo = (unsigned long long)indice_agora << 32;
+            if (atomic_compare_exchange_weak_explicit(&estado_turno, &estado, novo,
+                                                      memory_order_acq_rel,
+                                                      memory_order_acquire)) {
+                printf("[TURNOS] Turno %s fechado com %u vendas; início do turno %s (quota: %d)\n",
+                       nome_turno(turno_do_indice(indice)), (unsigned)(estado & 0xffffffffu),
+                       nome_turno(turno_do_indice(indice_agora)),
+                       limite_turno[turno_do_indice(indice_agora)]);
+                estado = novo;
+            }
+            continue;
+        }
+        
+        *indice_turno = indice;
+        unsigned vendidas = (unsigned)(estado & 0xffffffffu);
+        if ((int)vendidas >= limite_turno[turno_do_indice(indice)]) return 0;
+        
+        if (atomic_compare_exchange_weak_explicit(&estado_turno, &estado, estado + 1,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            return 1;
+        }
+    }
+}
+
+/* Devolve uma reserva não usada, se o turno ainda for o mesmo */
+static void devolver_quota_turno(int indice_turno) {
+    unsigned long long estado = atomic_load_explicit(&estado_turno, memory_order_acquire);
+    while ((int)(estado >> 32) == indice_turno && (estado & 0xffffffffu) > 0) {
+        if (atomic_compare_exchange_weak_explicit(&estado_turno, &estado, estado - 1,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            return;
+        }
+    }
+}
+
+/* Recomeça o calendário no turno indicado, a partir do instante atual */
+static void iniciar_calendario_turnos(Turno turno) {
+    turno_inicial = turno;
+    num_turnos_calendario = 3 - (int)turno;
+    inicio_turnos_ns = relogio_agora_ns();
+    atomic_store_explicit(&estado_turno, 0, memory_order_release);
+}
+
+/* Configurar duração (ms) e quota de cada turno; NULL mantém o atual */
+void configurar_turnos(const long duracao_ms[3], const int limites[3]) {
+    for (int t = 0; t < 3; t++) {
+        if (duracao_ms && duracao_ms[t] > 0) duracao_turno_ns[t] = duracao_ms[t] * 1000000LL;
+        if (limites && limites[t] >= 0) limite_turno[t] = limites[t];
+    }
+}
+
+void obter_configuracao_turnos(long duracao_ms[3], int limites[3]) {
+    for (int t = 0; t < 3; t++) {
+        if (duracao_ms) duracao_ms[t] = (long)(duracao_turno_ns[t] / 1000000LL);
+        if (limites) limites[t] = limite_turno[t];
+    }
+}
+
+Turno get_turno_atual(void) {
+    unsigned long long estado = atomic_load_explicit(&estado_turno, memory_order_acquire);
+    return turno_do_indice((int)(estado >> 32));
+}
+
+int get_vendas_turno_atual(void) {
+    unsigned long long estado = atomic_load_explicit(&estado_turno, memory_order_acquire);
+    return (int)(estado & 0xffffffffu);
+}
+
+/* Venda contada fora deste módulo (ex.: estágio de estatísticas do pipeline) */
+void contabilizar_venda(TipoCliente tipo, Turno turno) {
+    contar_vendas(tipo == EMPRESA, tipo != EMPRESA, turno, 1);
+}
+
+/* Zera todos os slots (sem vendas em curso: agências paradas) */
+static void zerar_contadores(void) {
+    // Uma thread a terminar pode estar a transferir o seu slot
+    pthread_mutex_lock(&slot_partilhado_lock);
+    for (int i = 0; i < MAX_SLOTS_CONTADORES; i++) {
+        SlotContadores* slot = slot_indice(i);
+        if (!slot) continue;
+        unsigned seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+        atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        atomic_store_explicit(&slot->total_vendas, 0, memory_order_relaxed);
+        atomic_store_explicit(&slot->vendas_empresas, 0, memory_order_relaxed);
+        atomic_store_explicit(&slot->vendas_publico, 0, memory_order_relaxed);
+        for (int t = 0; t < 3; t++) {
+            atomic_store_explicit(&slot->vendas_por_turno[t], 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+    }
+    pthread_mutex_unlock(&slot_partilhado_lock);
+}
+
+/* Cartões da venda: do fragmento da agência ou, ligado a um coordenador,
+ * da cache de cartões cedidos (estoque_remoto.c) */
+static int reter_cartao_venda(Agencia* agencia) {
+    if (estoque_remoto_ativo()) return estoque_remoto_reservar();
+    return reter_cartao_fragmento(agencia->id - 1, TTL_RETENCAO_PADRAO);
+}
+
+static int confirmar_cartao_venda(int cartao_id) {
+    if (estoque_remoto_ativo()) {
+        estoque_remoto_confirmar(cartao_id);
+        return 1;
+    }
+    return confirmar_retencao(cartao_id);
+}
+
 /* Processar uma venda em uma agência */
-static void processar_venda_agencia(Agencia* agencia) {
+static int processar_venda_agencia(Agencia* agencia) {
     pthread_mutex_lock(&agencia->lock);
     
-    // 1. Verificar se há estoque
-    if (estoque_disponivel() <= 0) {
-        printf("[AGÊNCIA %d] Sem estoque disponível\n", agencia->id);
+    // 0. Reservar a venda na quota do turno (partilhada por todas as agências)
+    int indice_turno;
+    if (!reservar_quota_turno(&indice_turno)) {
         pthread_mutex_unlock(&agencia->lock);
-        return;
+        return PASSO_SEM_QUOTA;
     }
+    Turno turno = turno_do_indice(indice_turno);
     
-    // 2. Verificar se há clientes na fila
-    Cliente* proximo = obter_proximo_cliente(fila_global);
-    if (!proximo) {
-        printf("[AGÊNCIA %d] Nenhum cliente na fila\n", agencia->id);
+    // 1. Retirar o próximo cliente sem bloquear o trabalhador. Primeiro o
+    // cliente: um passo sem ninguém na fila não toca no estoque (nem
+    // eventos de retenção, nem limiares, nem roubos entre fragmentos)
+    Cliente cliente;
+    if (!retirar_proximo_cliente(fila_global, &cliente)) {
+        devolver_quota_turno(indice_turno);
         pthread_mutex_unlock(&agencia->lock);
-        return;
+        return PASSO_SEM_CLIENTE;
     }
     
-    // 3. Reservar cartão
-    int cartao_id = reservar_proximo_cartao();
+    // 2. Reter um cartão enquanto o cliente é atendido (sem segurar estoque_lock)
+    int cartao_id = reter_cartao_venda(agencia);
     if (cartao_id == -1) {
-        printf("[AGÊNCIA %d] Falha ao reservar cartão\n", agencia->id);
+        saida_venda("[AGÊNCIA %d] Sem estoque disponível\n", agencia->id);
+        devolver_cliente(fila_global, &cliente);
+        devolver_quota_turno(indice_turno);
         pthread_mutex_unlock(&agencia->lock);
-        return;
+        return PASSO_SEM_ESTOQUE;
+    }
+    
+    // 3. Confirmar a retenção do cartão
+    if (!confirmar_cartao_venda(cartao_id)) {
+        saida_venda("[AGÊNCIA %d] Retenção do cartão %03d expirou\n", agencia->id, cartao_id);
+        devolver_cliente(fila_global, &cliente);
+        devolver_quota_turno(indice_turno);
+        pthread_mutex_unlock(&agencia->lock);
+        return PASSO_SEM_CLIENTE;
     }
     
     // 4. Registrar venda
-    char* tipo_str = (proximo->tipo == EMPRESA) ? "EMPRESA" : "PUBLICO";
+    char* tipo_str = (cliente.tipo == EMPRESA) ? "EMPRESA" : "PUBLICO";
     
-    printf("[AGÊNCIA %d] Venda realizada: Cartão %03d para %s (Cliente %d)\n",
-           agencia->id, cartao_id, tipo_str, proximo->id_cliente);
+    saida_venda("[AGÊNCIA %d] Venda realizada: Cartão %03d para %s (Cliente %d)\n",
+                agencia->id, cartao_id, tipo_str, cliente.id_cliente);
+    diario_registar_venda(cliente.id_cliente, cliente.tipo, cliente.timestamp,
+                          cartao_id, agencia->id, turno);
+    traco_venda(cliente.id_cliente, cliente.tipo, cartao_id, agencia->id);
     
     // 5. Atualizar estatísticas da agência
     agencia->vendas_realizadas++;
     agencia->clientes_atendidos++;
     
-    // 6. Atualizar estatísticas globais
-    pthread_mutex_lock(&stats_lock);
-    estatisticas_vendas.total_vendas++;
-    if (proximo->tipo == EMPRESA) {
-        estatisticas_vendas.vendas_empresas++;
+    // 6. Atualizar estatísticas globais (slot da thread, sem lock)
+    contar_vendas(cliente.tipo == EMPRESA, cliente.tipo != EMPRESA, turno, 1);
+    
+    pthread_mutex_unlock(&agencia->lock);
+    return PASSO_VENDEU;
+}
+
+/* Depois de um passo: reagendar ou estacionar a agência (agenda_lock adquirido) */
+static void reagendar_agencia(Agencia* agencia, int resultado) {
+    // Sem estoque: estacionar até a reposição (verificado com agenda_lock,
+    // que o callback de retoma também usa, para não perder o aviso). Sem
+    // esse callback registado, volta a tentar como num passo normal
+    if (resultado == PASSO_SEM_ESTOQUE && id_limiar_retoma >= 0 && estoque_esgotado()) {
+        estacionadas[num_estacionadas++] = agencia;
+        return;
+    }
+    
+    long long agora = relogio_agora_ns();
+    if (resultado == PASSO_SEM_QUOTA) {
+        // Quota do turno esgotada: voltar quando abrir o turno seguinte
+        agencia->proxima_execucao = inicio_turno_indice(indice_turno_em(agora) + 1);
     } else {
-        estatisticas_vendas.vendas_publico++;
+        // Esperar tempo simulado
+        agencia->proxima_execucao = agora + TEMPO_VENDA_REAL * NS_POR_SEGUNDO;
     }
-    pthread_mutex_unlock(&stats_lock);
+    agenda_inserir(agencia);
+}
+
+/* ========== AUTOESCALA ========== */
+
+/* Uma avaliação do controlador: compara a fila e a tendência da espera
+ * com as agências ativas. Sobe logo que a fila passa o limiar superior;
+ * só desce depois de CICLOS_HISTERESE_AUTOESCALA avaliações seguidas
+ * abaixo do limiar inferior, e a metade da distância de cada vez. */
+static void avaliar_autoescala(void) {
+    long long agora = relogio_agora_ns();
+    int vendas = get_vendas_totais();
+    double intervalo = (agora - autoescala.instante_anterior) / 1e9;
+    double ritmo = intervalo > 0 ? (vendas - autoescala.vendas_anteriores) / intervalo : 0;
+    autoescala.instante_anterior = agora;
+    autoescala.vendas_anteriores = vendas;
     
-    // 7. Remover cliente da fila
-    remover_cliente_processado(fila_global, proximo->id_cliente);
+    fila_expirar_desistencias(fila_global);
+    pthread_mutex_lock(&fila_global->lock);
+    int fila = fila_global->tamanho;
+    pthread_mutex_unlock(&fila_global->lock);
     
-    pthread_mutex_unlock(&agencia->lock);
+    // Espera estimada (lei de Little): clientes na fila / ritmo de vendas
+    double espera = fila == 0 ? 0 : (ritmo > 0 ? fila / ritmo : ESPERA_SEM_VENDAS_S);
+    double tendencia = espera - autoescala.espera_media;
+    autoescala.espera_media = 0.7 * autoescala.espera_media + 0.3 * espera;
+    
+    pthread_mutex_lock(&agenda_lock);
+    if (!pool_ativo) {
+        pthread_mutex_unlock(&agenda_lock);
+        return;
+    }
+    
+    int ativas = agencias_ativas;
+    int desejadas = (fila + CLIENTES_POR_AGENCIA_ALVO - 1) / CLIENTES_POR_AGENCIA_ALVO;
+    int limiar_superior = 2 * ativas * CLIENTES_POR_AGENCIA_ALVO;
+    int limiar_inferior = ativas * CLIENTES_POR_AGENCIA_ALVO / 2;
+    int novo = ativas;
+    const char* motivo = NULL;
+    
+    if (ativas < autoescala_maximo &&
+        (fila > limiar_superior || (tendencia > 0 && fila > ativas * CLIENTES_POR_AGENCIA_ALVO))) {
+        novo = desejadas > ativas ? desejadas : ativas + 1;
+        motivo = fila > limiar_superior ? "fila acima do limiar superior" : "espera a subir";
+        autoescala.ciclos_baixos = 0;
+    } else if (ativas > autoescala_minimo && fila < limiar_inferior && tendencia <= 0) {
+        if (++autoescala.ciclos_baixos >= CICLOS_HISTERESE_AUTOESCALA) {
+            novo = ativas - (ativas - desejadas + 1) / 2;
+            motivo = "fila abaixo do limiar inferior";
+            autoescala.ciclos_baixos = 0;
+        }
+    } else {
+        autoescala.ciclos_baixos = 0;
+    }
+    
+    if (novo > autoescala_maximo) novo = autoescala_maximo;
+    if (novo < autoescala_minimo) novo = autoescala_minimo;
+    if (novo != ativas) ajustar_agencias_ativas(novo);
+    pthread_mutex_unlock(&agenda_lock);
+    
+    if (novo != ativas) {
+        printf("[AUTOESCALA] %d -> %d agências: %s "
+               "(fila %d, espera estimada %.1fs, tendência %+.1fs, %.1f vendas/s)\n",
+               ativas, novo, motivo, fila, espera, tendencia, ritmo);
+    }
 }
 
-/* Thread de uma agência */
-static void* thread_agencia(void* arg) {
-    Agencia* agencia = (Agencia*)arg;
+static void* thread_controlador_autoescala(void* arg) {
+    (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
     
-    printf("[AGÊNCIA %d] %s iniciou operações\n", 
-           agencia->id, agencia->nome);
+    while (atomic_load(&autoescala_em_curso)) {
+        relogio_dormir_ms(INTERVALO_AUTOESCALA_MS);
+        if (atomic_load(&autoescala_em_curso)) avaliar_autoescala();
+    }
+    return NULL;
+}
+
+/* No modo virtual as avaliações são eventos do ciclo de simulação */
+static void iniciar_autoescala(void) {
+    long long agora = relogio_agora_ns();
+    autoescala.instante_anterior = agora;
+    autoescala.vendas_anteriores = get_vendas_totais();
+    autoescala.espera_media = 0;
+    autoescala.ciclos_baixos = 0;
+    autoescala.proxima_avaliacao = agora + INTERVALO_AUTOESCALA_MS * 1000000LL;
+    atomic_store(&autoescala_em_curso, 1);
     
-    while (agencia->ativa && sistema_ativa) {
-        // Processar uma venda
-        processar_venda_agencia(agencia);
-        
-        // Esperar tempo simulado
-        sleep(TEMPO_VENDA_REAL);
+    if (!relogio_virtual() &&
+        pthread_create(&thread_autoescala, NULL, thread_controlador_autoescala, NULL) != 0) {
+        printf("[ERRO] Falha ao criar controlador de autoescala\n");
+        atomic_store(&autoescala_em_curso, 0);
+        return;
     }
+    printf("[AUTOESCALA] Entre %d e %d agências (alvo: %d clientes por agência)\n",
+           autoescala_minimo, autoescala_maximo, CLIENTES_POR_AGENCIA_ALVO);
+}
+
+static void parar_autoescala(void) {
+    if (!atomic_exchange(&autoescala_em_curso, 0)) return;
+    if (!relogio_virtual()) pthread_join(thread_autoescala, NULL);
+}
+
+/* Trabalhador do pool: executa um passo da agência mais urgente e
+ * reagenda-a, em vez de cada agência ter a sua thread a dormir */
+static void* thread_trabalhador(void* arg) {
+    aplicar_afinidade_thread(CLASSE_AGENCIA, (int)(intptr_t)arg);
     
-    printf("[AGÊNCIA %d] %s encerrou operações\n", 
-           agencia->id, agencia->nome);
+    pthread_mutex_lock(&agenda_lock);
+    while (pool_ativo) {
+        if (tamanho_agenda == 0) {
+            pthread_cond_wait(&agenda_cond, &agenda_lock);
+            continue;
+        }
+        
+        long long prazo_ns = agenda[0]->proxima_execucao;
+        if (prazo_ns > relogio_agora_ns()) {
+            struct timespec prazo = {
+                .tv_sec = prazo_ns / NS_POR_SEGUNDO,
+                .tv_nsec = prazo_ns % NS_POR_SEGUNDO
+            };
+            pthread_cond_timedwait(&agenda_cond, &agenda_lock, &prazo);
+            continue;
+        }
+        
+        Agencia* agencia = agenda_retirar_topo();
+        int ativa = agencia->ativa;
+        pthread_mutex_unlock(&agenda_lock);
+        
+        int resultado = (ativa && sistema_ativa)
+                        ? processar_venda_agencia(agencia) : PASSO_SEM_CLIENTE;
+        
+        pthread_mutex_lock(&agenda_lock);
+        agencia->em_execucao = 0;
+        if (!agencia->ativa || !pool_ativo) continue;
+        
+        reagendar_agencia(agencia, resultado);
+    }
+    pthread_mutex_unlock(&agenda_lock);
     
     return NULL;
 }
 
+/* Agência em fibra: o mesmo passo de venda, mas as esperas são da fibra.
+ * Sem cliente espera pelo aviso de chegada; sem estoque pela reposição. */
+static void fibra_agencia(void* arg) {
+    Agencia* agencia = (Agencia*)arg;
+    
+    while (atomic_load(&fibras_em_curso)) {
+        int resultado = (agencia->ativa && sistema_ativa)
+                        ? processar_venda_agencia(agencia) : PASSO_SEM_CLIENTE;
+        long long agora = relogio_agora_ns();
+        
+        switch (resultado) {
+            case PASSO_SEM_QUOTA:
+                fibra_dormir_ate(inicio_turno_indice(indice_turno_em(agora) + 1));
+                break;
+            case PASSO_SEM_ESTOQUE:
+                fibra_esperar(&espera_estoque_fibras, agora + TEMPO_VENDA_REAL * NS_POR_SEGUNDO);
+                break;
+            case PASSO_SEM_CLIENTE:
+                if (agencia->ativa) {
+                    fibra_esperar(&espera_clientes_fibras, agora + TEMPO_VENDA_REAL * NS_POR_SEGUNDO);
+                } else {
+                    fibra_dormir_ate(agora + INTERVALO_AUTOESCALA_MS * 1000000LL);
+                }
+                break;
+            default:
+                fibra_dormir_ate(agora + TEMPO_VENDA_REAL * NS_POR_SEGUNDO);
+                break;
+        }
+    }
+}
+
+static void avisar_chegada_fibras(void) {
+    fibras_acordar_uma(&espera_clientes_fibras);
+}
+
+/* Uma fibra por agência sobre num_trabalhadores portadoras */
+static int iniciar_agencias_fibras(void) {
+    int portadoras = fibras_iniciar(num_trabalhadores, PILHA_FIBRA_PADRAO);
+    if (portadoras == 0) return 0;
+    
+    atomic_store(&fibras_em_curso, 1);
+    fila_definir_aviso_chegada(avisar_chegada_fibras);
+    int criadas = 0;
+    for (int i = 0; i < num_agencias; i++) {
+        criadas += fibra_criar(fibra_agencia, &agencias[i]);
+    }
+    printf("Agências iniciadas em %d fibras (pilhas de %d KB) sobre %d portadoras.\n",
+           criadas, PILHA_FIBRA_PADRAO / 1024, portadoras);
+    return 1;
+}
+
+static void parar_agencias_fibras(void) {
+    if (!atomic_exchange(&fibras_em_curso, 0)) return;
+    fila_definir_aviso_chegada(NULL);
+    fibras_aguardar();
+}
+
+/* Modo virtual: a agenda é a fila de eventos. Uma só thread avança o
+ * relógio até à agência mais urgente e executa-a, sem nunca dormir. */
+static void simular_agencias_virtual(long long duracao_ns) {
+    long long fim = relogio_agora_ns() + duracao_ns;
+    long long proximo_injetado = injetor_virtual ? injetor_virtual(relogio_agora_ns()) : -1;
+    long long proxima_recolha = relogio_agora_ns() + INTERVALO_RECOLHA * NS_POR_SEGUNDO;
+    
+    pthread_mutex_lock(&agenda_lock);
+    while (pool_ativo && tamanho_agenda > 0 && agenda[0]->proxima_execucao <= fim) {
+        // Eventos externos que caem antes do próximo passo
+        if (proximo_injetado >= 0 && proximo_injetado <= agenda[0]->proxima_execucao) {
+            relogio_avancar_ate(proximo_injetado);
+            pthread_mutex_unlock(&agenda_lock);
+            proximo_injetado = injetor_virtual(proximo_injetado);
+            pthread_mutex_lock(&agenda_lock);
+            continue;
+        }
+        
+        // Avaliações da autoescala que caem antes do próximo passo
+        if (atomic_load(&autoescala_em_curso) &&
+            autoescala.proxima_avaliacao <= agenda[0]->proxima_execucao) {
+            relogio_avancar_ate(autoescala.proxima_avaliacao);
+            autoescala.proxima_avaliacao += INTERVALO_AUTOESCALA_MS * 1000000LL;
+            pthread_mutex_unlock(&agenda_lock);
+            avaliar_autoescala();
+            pthread_mutex_lock(&agenda_lock);
+            continue;
+        }
+        
+        // Retenções expiradas: o recolhedor não corre no modo virtual
+        if (proxima_recolha <= agenda[0]->proxima_execucao) {
+            relogio_avancar_ate(proxima_recolha);
+            proxima_recolha += INTERVALO_RECOLHA * NS_POR_SEGUNDO;
+            pthread_mutex_unlock(&agenda_lock);
+            int recolhidas = recolher_retencoes_expiradas();
+            if (recolhidas > 0) {
+                printf("[ESTOQUE] %d retenção(ões) expirada(s) devolvida(s) ao estoque\n",
+                       recolhidas);
+            }
+            pthread_mutex_lock(&agenda_lock);
+            continue;
+        }
+        
+        Agencia* agencia = agenda_retirar_topo();
+        relogio_avancar_ate(agencia->proxima_execucao);
+        pthread_mutex_unlock(&agenda_lock);
+        
+        int resultado = (agencia->ativa && sistema_ativa)
+                        ? processar_venda_agencia(agencia) : PASSO_SEM_CLIENTE;
+        
+        pthread_mutex_lock(&agenda_lock);
+        agencia->em_execucao = 0;
+        if (!agencia->ativa) continue;
+        reagendar_agencia(agencia, resultado);
+    }
+    pthread_mutex_unlock(&agenda_lock);
+    
+    // Sem mais eventos no intervalo: saltar para o fim
+    relogio_avancar_ate(fim);
+}
+
 /* ========== FUNÇÕES PÚBLICAS ========== */
 
+/* Definir quantas agências criar (antes de inicializar_sistema_vendas) */
+void definir_num_agencias(int quantidade) {
+    if (quantidade < 1) quantidade = 1;
+    if (quantidade > MAX_AGENCIAS) quantidade = MAX_AGENCIAS;
+    num_agencias_pedido = quantidade;
+}
+
 /* Inicializar sistema de vendas */
 void inicializar_sistema_vendas(FilaPrioridade* fila) {
     fila_global = fila;
     
     // Inicializar estatísticas
-    memset(&estatisticas_vendas, 0, sizeof(EstatisticasVendas));
+    zerar_contadores();
+    
+    // Inicializar agências (alinhadas à linha de cache: sem partilha falsa).
+    // Qualquer trabalhador serve qualquer agência: intercaladas pelos nós NUMA.
+    Agencia* novas = (Agencia*)alocar_memoria_intercalada(num_agencias_pedido * sizeof(Agencia));
+    Agencia** nova_agenda = (Agencia**)malloc(num_agencias_pedido * sizeof(Agencia*));
+    Agencia** novas_estacionadas = (Agencia**)malloc(num_agencias_pedido * sizeof(Agencia*));
+    if (!novas || !nova_agenda || !novas_estacionadas) {
+        printf("[ERRO] Memória insuficiente para %d agências\n", num_agencias_pedido);
+        libertar_memoria_numa(novas, num_agencias_pedido * sizeof(Agencia));
+        free(nova_agenda);
+        free(novas_estacionadas);
+        return;
+    }
+    memset(novas, 0, num_agencias_pedido * sizeof(Agencia));
+    agencias = novas;
+    agenda = nova_agenda;
+    estacionadas = novas_estacionadas;
+    num_agencias = num_agencias_pedido;
     
-    // Inicializar agências
-    for (int i = 0; i < NUM_AGENCIAS; i++) {
+    int num_nomes = (int)(sizeof(nomes_agencias) / sizeof(nomes_agencias[0]));
+    for (int i = 0; i < num_agencias; i++) {
         agencias[i].id = i + 1;
-        snprintf(agencias[i].nome, sizeof(agencias[i].nome), "%s", nomes_agencias[i]);
+        if (i < num_nomes) {
+            snprintf(agencias[i].nome, sizeof(agencias[i].nome), "%s", nomes_agencias[i]);
+        } else {
+            snprintf(agencias[i].nome, sizeof(agencias[i].nome), "Agência %03d", i + 1);
+        }
         agencias[i].vendas_realizadas = 0;
         agencias[i].clientes_atendidos = 0;
         agencias[i].ativa = 0;
-        agencias[i].thread = 0;
+        agencias[i].indice_agenda = -1;
+        agencias[i].em_execucao = 0;
         pthread_mutex_init(&agencias[i].lock, NULL);
     }
     
+    // Trabalhadores: um por núcleo (da classe, se configurada), nunca mais do que agências
+    long nucleos = afinidade_configurada(CLASSE_AGENCIA)
+                   ? num_cpus_classe(CLASSE_AGENCIA) : sysconf(_SC_NPROCESSORS_ONLN);
+    num_trabalhadores = (nucleos > 0) ? (int)nucleos : 1;
+    if (num_trabalhadores > num_agencias) num_trabalhadores = num_agencias;
+    
     sistema_ativa = 1;
-    printf("[VENDAS] Sistema inicializado com %d agências\n", NUM_AGENCIAS);
+    printf("[VENDAS] Sistema inicializado com %d agências (%d trabalhadores)\n",
+           num_agencias, num_trabalhadores);
 }
 
 /* Iniciar turno de vendas */
@@ -136,13 +954,19 @@ void iniciar_turno_vendas(Turno turno) {
     int estoque_inicial = estoque_disponivel();
     printf("Estoque inicial: %d cartões\n", estoque_inicial);
     
-    // Usar função do módulo FilaPrioridade
-    int vendas = processar_vendas_turno(fila_global, turno);
-    
-    // Atualizar estatísticas do turno
-    pthread_mutex_lock(&stats_lock);
-    estatisticas_vendas.vendas_por_turno[turno] += vendas;
-    pthread_mutex_unlock(&stats_lock);
+    int vendas;
+    if (usar_pipeline) {
+        // O estágio de estatísticas já conta cada venda e o seu turno
+        vendas = executar_pipeline_vendas(fila_global, turno, limite_vendas_turno(turno));
+        saida_vendas_descarregar();
+        diario_descarregar();
+    } else {
+        // Usar função do módulo FilaPrioridade
+        vendas = processar_vendas_turno(fila_global, turno);
+        
+        // Atualizar estatísticas do turno
+        contar_vendas(0, 0, turno, vendas);
+    }
     
     printf("Vendas realizadas no turno: %d\n", vendas);
     printf("Estoque final: %d cartões\n", estoque_disponivel());
@@ -151,49 +975,129 @@ void iniciar_turno_vendas(Turno turno) {
 
 /* Iniciar vendas concorrentes (todas agências) */
 void iniciar_vendas_concorrentes(Turno turno) {
-    (void)turno; // Parâmetro não usado
-    
-    if (!sistema_ativa) {
+    if (!sistema_ativa || num_agencias == 0) {
         printf("[VENDAS] Sistema não está ativo\n");
         return;
     }
+    if (pool_ativo) {
+        printf("[VENDAS] Agências já em operação\n");
+        return;
+    }
+    
+    if (turno < MANHA || turno > NOITE) turno = MANHA;
+    
+    if (usar_processos) {
+        if (executar_agencias_processos(fila_global, turno, num_agencias) >= 0) return;
+        printf("[VENDAS] Modo de processos indisponível; a usar threads\n");
+    }
     
     printf("\n=== VENDAS CONCORRENTES ===\n");
-    printf("Iniciando %d agências simultaneamente...\n", NUM_AGENCIAS);
-    
-    // Ativar todas as agências
-    for (int i = 0; i < NUM_AGENCIAS; i++) {
-        agencias[i].ativa = 1;
-        int result = pthread_create(&agencias[i].thread, NULL, thread_agencia, &agencias[i]);
-        if (result != 0) {
-            printf("[ERRO] Falha ao criar thread para agência %d\n", agencias[i].id);
-            agencias[i].ativa = 0;
-        }
+    printf("Iniciando %d agências em %d trabalhadores...\n",
+           num_agencias, num_trabalhadores);
+    
+    // Do turno pedido até ao fim da NOITE
+    iniciar_calendario_turnos(turno);
+    long long fim_ns = inicio_turno_indice(num_turnos_calendario);
+    printf("Turnos: %s até NOITE (%.1fs de tempo simulado)\n",
+           nome_turno(turno), (fim_ns - inicio_turnos_ns) / 1e9);
+    
+    // Ativar todas as agências, ou o mínimo da autoescala
+    int autoescala_ligada = autoescala_maximo > 0;
+    if (autoescala_maximo > num_agencias) autoescala_maximo = num_agencias;
+    if (autoescala_minimo > autoescala_maximo) autoescala_minimo = autoescala_maximo;
+    pthread_mutex_lock(&agenda_lock);
+    agencias_ativas = 0;
+    ajustar_agencias_ativas(autoescala_ligada ? autoescala_minimo : num_agencias);
+    pool_ativo = 1;
+    pthread_mutex_unlock(&agenda_lock);
+    
+    id_limiar_retoma = estoque_registrar_limiar(0, retomar_agencias, NULL);
+    if (id_limiar_retoma < 0) {
+        printf("[VENDAS] Sem slots de limiar livres: sem estoque, as agências tentam periodicamente\n");
     }
+    if (autoescala_ligada) iniciar_autoescala();
     
-    printf("Agências iniciadas. Operando por 10 segundos...\n");
-    sleep(10);
+    // Medição em tempo real (mesmo no modo virtual): mede o motor de vendas
+    int vendas_antes = get_vendas_totais();
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    
+    if (relogio_virtual()) {
+        if (usar_fibras) printf("[VENDAS] Fibras só em tempo real; a usar o ciclo virtual\n");
+        printf("Agências iniciadas (tempo virtual).\n");
+        simular_agencias_virtual(fim_ns - relogio_agora_ns());
+    } else if (usar_fibras && iniciar_agencias_fibras()) {
+        relogio_avancar_ate(fim_ns);
+    } else {
+        iniciar_trabalhadores();
+        printf("Agências iniciadas.\n");
+        relogio_avancar_ate(fim_ns);
+    }
     
     // Parar agências
     parar_todas_agencias();
-    printf("Vendas concorrentes concluídas.\n");
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    saida_vendas_descarregar();
+    diario_descarregar();
+    
+    double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    int vendas = get_vendas_totais() - vendas_antes;
+    printf("[TURNOS] Turno %s fechado com %d vendas\n",
+           nome_turno(get_turno_atual()), get_vendas_turno_atual());
+    printf("Vendas concorrentes concluídas: %d vendas em %.3fs (%.0f vendas/s)\n",
+           vendas, segundos, segundos > 0 ? vendas / segundos : 0);
+}
+
+/* Criar os trabalhadores do pool */
+static void iniciar_trabalhadores(void) {
+    trabalhadores = (pthread_t*)malloc(num_trabalhadores * sizeof(pthread_t));
+    trabalhadores_criados = 0;
+    for (int i = 0; trabalhadores && i < num_trabalhadores; i++) {
+        if (pthread_create(&trabalhadores[trabalhadores_criados], NULL,
+                           thread_trabalhador, (void*)(intptr_t)i) != 0) {
+            printf("[ERRO] Falha ao criar trabalhador %d\n", i);
+            continue;
+        }
+        trabalhadores_criados++;
+    }
 }
 
 /* Parar todas as agências */
 void parar_todas_agencias() {
     printf("[VENDAS] Parando todas as agências...\n");
     
+    parar_autoescala();
+    parar_agencias_fibras();
+    
     // Sinalizar para parar
-    for (int i = 0; i < NUM_AGENCIAS; i++) {
+    pthread_mutex_lock(&agenda_lock);
+    int estava_ativo = pool_ativo;
+    for (int i = 0; i < num_agencias; i++) {
         agencias[i].ativa = 0;
     }
+    pool_ativo = 0;
+    tamanho_agenda = 0;
+    num_estacionadas = 0;
+    agencias_ativas = 0;
+    pthread_cond_broadcast(&agenda_cond);
+    pthread_mutex_unlock(&agenda_lock);
     
-    // Esperar threads terminarem
-    for (int i = 0; i < NUM_AGENCIAS; i++) {
-        if (agencias[i].thread != 0) {
-            pthread_join(agencias[i].thread, NULL);
-            agencias[i].thread = 0;
+    // Esperar trabalhadores terminarem
+    if (estava_ativo) {
+        for (int i = 0; i < trabalhadores_criados; i++) {
+            pthread_join(trabalhadores[i], NULL);
         }
+        trabalhadores_criados = 0;
+        free(trabalhadores);
+        trabalhadores = NULL;
+        
+        estoque_remover_limiar(id_limiar_retoma);
+        id_limiar_retoma = -1;
+    }
+    
+    for (int i = 0; i < num_agencias; i++) {
+        agencias[i].indice_agenda = -1;
+        agencias[i].em_execucao = 0;
     }
     
     printf("[VENDAS] Todas as agências paradas\n");
@@ -201,7 +1105,8 @@ void parar_todas_agencias() {
 
 /* Exibir relatório de vendas */
 void exibir_relatorio_vendas() {
-    pthread_mutex_lock(&stats_lock);
+    EstatisticasVendas estatisticas;
+    obter_estatisticas_vendas(&estatisticas);
     
     printf("\n════════════════════════════════════════════\n");
     printf("        RELATÓRIO DE VENDAS\n");
@@ -209,25 +1114,25 @@ void exibir_relatorio_vendas() {
     
     // Estatísticas gerais
     printf("\n📊 ESTATÍSTICAS GERAIS:\n");
-    printf("   • Total de vendas:      %d\n", estatisticas_vendas.total_vendas);
+    printf("   • Total de vendas:      %d\n", estatisticas.total_vendas);
     printf("   • Vendas para empresas: %d (%.1f%%)\n", 
-           estatisticas_vendas.vendas_empresas,
-           estatisticas_vendas.total_vendas > 0 ? 
-           (estatisticas_vendas.vendas_empresas * 100.0) / estatisticas_vendas.total_vendas : 0);
+           estatisticas.vendas_empresas,
+           estatisticas.total_vendas > 0 ? 
+           (estatisticas.vendas_empresas * 100.0) / estatisticas.total_vendas : 0);
     printf("   • Vendas para público:  %d (%.1f%%)\n", 
-           estatisticas_vendas.vendas_publico,
-           estatisticas_vendas.total_vendas > 0 ? 
-           (estatisticas_vendas.vendas_publico * 100.0) / estatisticas_vendas.total_vendas : 0);
+           estatisticas.vendas_publico,
+           estatisticas.total_vendas > 0 ? 
+           (estatisticas.vendas_publico * 100.0) / estatisticas.total_vendas : 0);
     
     // Vendas por turno
     printf("\n🕒 VENDAS POR TURNO:\n");
-    printf("   • Manhã:  %d vendas\n", estatisticas_vendas.vendas_por_turno[MANHA]);
-    printf("   • Tarde:  %d vendas\n", estatisticas_vendas.vendas_por_turno[TARDE]);
-    printf("   • Noite:  %d vendas\n", estatisticas_vendas.vendas_por_turno[NOITE]);
+    printf("   • Manhã:  %d vendas\n", estatisticas.vendas_por_turno[MANHA]);
+    printf("   • Tarde:  %d vendas\n", estatisticas.vendas_por_turno[TARDE]);
+    printf("   • Noite:  %d vendas\n", estatisticas.vendas_por_turno[NOITE]);
     
     // Média por turno
     int total_turnos = 0;
-    for (int i = 0; i < 3; i++) total_turnos += estatisticas_vendas.vendas_por_turno[i];
+    for (int i = 0; i < 3; i++) total_turnos += estatisticas.vendas_por_turno[i];
     if (total_turnos > 0) {
         printf("\n📈 MÉDIA POR TURNO:\n");
         printf("   • %.1f vendas/turno\n", total_turnos / 3.0);
@@ -236,15 +1141,13 @@ void exibir_relatorio_vendas() {
     // Estoque atual
     printf("\n📦 ESTOQUE ATUAL:\n");
     printf("   • Disponíveis: %d/%d (%.1f%%)\n", 
-           estoque_disponivel(), TOTAL_CARTOES,
-           (float)estoque_disponivel() / TOTAL_CARTOES * 100);
+           estoque_disponivel(), estoque_total(),
+           (float)estoque_disponivel() / estoque_total() * 100);
     printf("   • Vendidos:    %d/%d (%.1f%%)\n", 
-           estoque_vendido(), TOTAL_CARTOES,
-           (float)estoque_vendido() / TOTAL_CARTOES * 100);
+           estoque_vendido(), estoque_total(),
+           (float)estoque_vendido() / estoque_total() * 100);
     
     printf("\n════════════════════════════════════════════\n");
-    
-    pthread_mutex_unlock(&stats_lock);
 }
 
 /* Exibir relatório por agência */
@@ -256,7 +1159,7 @@ void exibir_relatorio_agencias() {
     int total_vendas_agencias = 0;
     int total_clientes = 0;
     
-    for (int i = 0; i < NUM_AGENCIAS; i++) {
+    for (int i = 0; i < num_agencias; i++) {
         pthread_mutex_lock(&agencias[i].lock);
         
         printf("\n🏢 %s (ID: %d)\n", agencias[i].nome, agencias[i].id);
@@ -278,77 +1181,310 @@ void exibir_relatorio_agencias() {
     printf("   • Vendas: %d\n", total_vendas_agencias);
     printf("   • Clientes: %d\n", total_clientes);
     printf("   • Média: %.1f vendas/agência\n", 
-           (float)total_vendas_agencias / NUM_AGENCIAS);
+           num_agencias > 0 ? (float)total_vendas_agencias / num_agencias : 0);
     
     printf("\n════════════════════════════════════════════\n");
 }
 
-/* Exportar vendas para CSV */
-void exportar_vendas_csv(const char* filename) {
-    if (!filename) {
-        printf("[ERRO] Nome de arquivo inválido\n");
-        return;
+/* ========== EXPORTAÇÃO CSV ========== */
+
+/* Copiar o estado das agências e os totais. Cada agência fica bloqueada
+ * só o tempo de copiar os contadores; nenhum fprintf com locks. */
+static int capturar_instantaneo(InstantaneoVendas* inst) {
+    if (inst->capacidade < num_agencias) {
+        ResumoAgencia* novo = (ResumoAgencia*)realloc(inst->agencias,
+                                                      num_agencias * sizeof(ResumoAgencia));
+        if (!novo) return 0;
+        inst->agencias = novo;
+        inst->capacidade = num_agencias;
+    }
+    
+    inst->num = num_agencias;
+    
+    // 'ativa' é do agendador: copiada de uma vez sob agenda_lock
+    pthread_mutex_lock(&agenda_lock);
+    for (int i = 0; i < num_agencias; i++) {
+        inst->agencias[i].ativa = agencias[i].ativa;
     }
+    pthread_mutex_unlock(&agenda_lock);
     
+    for (int i = 0; i < num_agencias; i++) {
+        ResumoAgencia* r = &inst->agencias[i];
+        pthread_mutex_lock(&agencias[i].lock);
+        r->id = agencias[i].id;
+        memcpy(r->nome, agencias[i].nome, sizeof(r->nome));
+        r->vendas_realizadas = agencias[i].vendas_realizadas;
+        r->clientes_atendidos = agencias[i].clientes_atendidos;
+        pthread_mutex_unlock(&agencias[i].lock);
+    }
+    obter_estatisticas_vendas(&inst->estatisticas);
+    return 1;
+}
+
+/* Escrever um instantâneo em CSV. Retorna o número de linhas de agência
+ * ou -1 em caso de erro. */
+static int escrever_instantaneo_csv(const InstantaneoVendas* inst, const char* filename) {
     FILE* file = fopen(filename, "w");
     if (!file) {
         perror("[ERRO] Erro ao abrir arquivo CSV");
-        return;
+        return -1;
     }
+    setvbuf(file, NULL, _IOFBF, BUFFER_EXPORTACAO_CSV);
     
     // Cabeçalho
     fprintf(file, "agencia_id,agencia_nome,vendas_realizadas,clientes_atendidos,status\n");
     
     // Dados das agências
-    for (int i = 0; i < NUM_AGENCIAS; i++) {
-        pthread_mutex_lock(&agencias[i].lock);
-        
+    for (int i = 0; i < inst->num; i++) {
+        const ResumoAgencia* r = &inst->agencias[i];
         fprintf(file, "%d,\"%s\",%d,%d,%s\n",
-                agencias[i].id,
-                agencias[i].nome,
-                agencias[i].vendas_realizadas,
-                agencias[i].clientes_atendidos,
-                agencias[i].ativa ? "ATIVA" : "INATIVA");
-        
-        pthread_mutex_unlock(&agencias[i].lock);
+                r->id,
+                r->nome,
+                r->vendas_realizadas,
+                r->clientes_atendidos,
+                r->ativa ? "ATIVA" : "INATIVA");
     }
     
     // Estatísticas gerais
-    pthread_mutex_lock(&stats_lock);
+    const EstatisticasVendas* estatisticas = &inst->estatisticas;
     fprintf(file, "\n# Estatísticas Gerais\n");
-    fprintf(file, "# Total Vendas,%d\n", estatisticas_vendas.total_vendas);
-    fprintf(file, "# Vendas Empresas,%d\n", estatisticas_vendas.vendas_empresas);
-    fprintf(file, "# Vendas Público,%d\n", estatisticas_vendas.vendas_publico);
-    fprintf(file, "# Vendas Manhã,%d\n", estatisticas_vendas.vendas_por_turno[MANHA]);
-    fprintf(file, "# Vendas Tarde,%d\n", estatisticas_vendas.vendas_por_turno[TARDE]);
-    fprintf(file, "# Vendas Noite,%d\n", estatisticas_vendas.vendas_por_turno[NOITE]);
-    pthread_mutex_unlock(&stats_lock);
+    fprintf(file, "# Total Vendas,%d\n", estatisticas->total_vendas);
+    fprintf(file, "# Vendas Empresas,%d\n", estatisticas->vendas_empresas);
+    fprintf(file, "# Vendas Público,%d\n", estatisticas->vendas_publico);
+    fprintf(file, "# Vendas Manhã,%d\n", estatisticas->vendas_por_turno[MANHA]);
+    fprintf(file, "# Vendas Tarde,%d\n", estatisticas->vendas_por_turno[TARDE]);
+    fprintf(file, "# Vendas Noite,%d\n", estatisticas->vendas_por_turno[NOITE]);
     
-    fclose(file);
-    printf("[VENDAS] Dados exportados para '%s'\n", filename);
+    int erro = ferror(file);
+    if (fclose(file) != 0 || erro) {
+        printf("[ERRO] Falha ao escrever '%s'\n", filename);
+        return -1;
+    }
+    return inst->num;
+}
+
+/* Exportar vendas para CSV (síncrono, mas sem locks durante a escrita) */
+void exportar_vendas_csv(const char* filename) {
+    if (!filename) {
+        printf("[ERRO] Nome de arquivo inválido\n");
+        return;
+    }
+    
+    InstantaneoVendas inst;
+    memset(&inst, 0, sizeof(inst));
+    if (!capturar_instantaneo(&inst)) {
+        printf("[ERRO] Falha ao alocar memória para exportação\n");
+        return;
+    }
+    
+    if (escrever_instantaneo_csv(&inst, filename) >= 0) {
+        printf("[VENDAS] Dados exportados para '%s'\n", filename);
+    }
+    free(inst.agencias);
+}
+
+/* Thread de exportação: escreve os instantâneos pendentes, um de cada vez */
+static void* thread_exportacao(void* arg) {
+    (void)arg;
+    aplicar_afinidade_thread(CLASSE_TEMPORIZADOR, -1);
+    
+    pthread_mutex_lock(&exportacao_lock);
+    for (;;) {
+        while (instantaneo_pendente == -1 && exportador_ativo) {
+            pthread_cond_wait(&exportacao_cond, &exportacao_lock);
+        }
+        if (instantaneo_pendente == -1) break;  // Parado e sem trabalho
+        
+        instantaneo_em_escrita = instantaneo_pendente;
+        instantaneo_pendente = -1;
+        InstantaneoVendas* inst = &instantaneos[instantaneo_em_escrita];
+        char ficheiro[sizeof(inst->ficheiro)];
+        memcpy(ficheiro, inst->ficheiro, sizeof(ficheiro));
+        CallbackExportacao callback = inst->callback;
+        void* callback_arg = inst->arg;
+        pthread_mutex_unlock(&exportacao_lock);
+        
+        long long inicio = relogio_agora_ns();
+        int linhas = escrever_instantaneo_csv(inst, ficheiro);
+        long long duracao = relogio_agora_ns() - inicio;
+        
+        pthread_mutex_lock(&exportacao_lock);
+        instantaneo_em_escrita = -1;
+        estado_exportacao.ultimo_sucesso = linhas >= 0;
+        estado_exportacao.ultimas_linhas = linhas >= 0 ? linhas : 0;
+        estado_exportacao.ultima_duracao_ns = duracao;
+        memcpy(estado_exportacao.ultimo_ficheiro, ficheiro, sizeof(ficheiro));
+        if (linhas >= 0) estado_exportacao.concluidas++;
+        else estado_exportacao.falhadas++;
+        pthread_cond_broadcast(&exportacao_cond);
+        pthread_mutex_unlock(&exportacao_lock);
+        
+        if (linhas >= 0) {
+            printf("[VENDAS] Exportação em segundo plano concluída: '%s' (%d agências)\n",
+                   ficheiro, linhas);
+        }
+        if (callback) callback(ficheiro, linhas >= 0, linhas >= 0 ? linhas : 0, callback_arg);
+        
+        pthread_mutex_lock(&exportacao_lock);
+    }
+    pthread_mutex_unlock(&exportacao_lock);
+    return NULL;
+}
+
+/* Pedir uma exportação em segundo plano. Retorna 1 se o instantâneo foi
+ * capturado, 0 se já havia outro à espera ou em caso de erro. */
+int exportar_vendas_csv_async(const char* filename, CallbackExportacao callback, void* arg) {
+    if (!filename || strlen(filename) >= sizeof(instantaneos[0].ficheiro)) {
+        printf("[ERRO] Nome de arquivo inválido\n");
+        return 0;
+    }
+    
+    pthread_mutex_lock(&exportacao_lock);
+    if (instantaneo_pendente != -1) {
+        pthread_mutex_unlock(&exportacao_lock);
+        printf("[VENDAS] Já existe uma exportação pendente\n");
+        return 0;
+    }
+    
+    // O buffer livre é o que não está a ser escrito
+    int livre = (instantaneo_em_escrita == 0) ? 1 : 0;
+    InstantaneoVendas* inst = &instantaneos[livre];
+    if (!capturar_instantaneo(inst)) {
+        pthread_mutex_unlock(&exportacao_lock);
+        printf("[ERRO] Falha ao alocar memória para exportação\n");
+        return 0;
+    }
+    strcpy(inst->ficheiro, filename);
+    inst->callback = callback;
+    inst->arg = arg;
+    
+    if (!exportador_ativo) {
+        if (pthread_create(&thread_exportador, NULL, thread_exportacao, NULL) != 0) {
+            pthread_mutex_unlock(&exportacao_lock);
+            printf("[ERRO] Falha ao criar thread de exportação\n");
+            return 0;
+        }
+        exportador_ativo = 1;
+    }
+    
+    instantaneo_pendente = livre;
+    pthread_cond_broadcast(&exportacao_cond);
+    pthread_mutex_unlock(&exportacao_lock);
+    return 1;
+}
+
+void obter_estado_exportacao(EstadoExportacao* destino) {
+    if (!destino) return;
+    pthread_mutex_lock(&exportacao_lock);
+    *destino = estado_exportacao;
+    destino->em_curso = instantaneo_pendente != -1 || instantaneo_em_escrita != -1;
+    pthread_mutex_unlock(&exportacao_lock);
+}
+
+/* Esperar que não haja exportações pendentes nem em escrita */
+void aguardar_exportacoes(void) {
+    pthread_mutex_lock(&exportacao_lock);
+    while (instantaneo_pendente != -1 || instantaneo_em_escrita != -1) {
+        pthread_cond_wait(&exportacao_cond, &exportacao_lock);
+    }
+    pthread_mutex_unlock(&exportacao_lock);
+}
+
+/* Terminar a thread de exportação (depois de escrever o que falta) */
+void parar_exportador_vendas(void) {
+    pthread_mutex_lock(&exportacao_lock);
+    if (!exportador_ativo) {
+        pthread_mutex_unlock(&exportacao_lock);
+        return;
+    }
+    exportador_ativo = 0;
+    pthread_cond_broadcast(&exportacao_cond);
+    pthread_mutex_unlock(&exportacao_lock);
+    
+    pthread_join(thread_exportador, NULL);
+    
+    for (int i = 0; i < 2; i++) {
+        free(instantaneos[i].agencias);
+        instantaneos[i].agencias = NULL;
+        instantaneos[i].capacidade = 0;
+    }
 }
 
 /* ========== GETTERS PARA OUTROS MÓDULOS ========== */
 
+/* Leitura consistente de todos os contadores, sem locks: cada slot é
+ * relido até não haver uma venda a meio de ser registada, e a soma toda
+ * é repetida se entretanto uma thread transferiu o seu slot */
+void obter_estatisticas_vendas(EstatisticasVendas* destino) {
+    if (!destino) return;
+    unsigned transf_antes, transf_depois;
+    
+    do {
+        transf_antes = atomic_load_explicit(&seq_transferencias, memory_order_acquire);
+        memset(destino, 0, sizeof(EstatisticasVendas));
+        if (transf_antes & 1) {
+            transf_depois = transf_antes + 1;
+            continue;
+        }
+        
+        int usados = atomic_load_explicit(&slots_atribuidos, memory_order_relaxed);
+        if (usados > MAX_SLOTS_CONTADORES - 1) usados = MAX_SLOTS_CONTADORES - 1;
+        
+        for (int i = 0; i <= usados; i++) {
+            // O último passo lê o slot partilhado
+            SlotContadores* slot = slot_indice(i == usados ? MAX_SLOTS_CONTADORES - 1 : i);
+            if (!slot) continue;
+            EstatisticasVendas parcial;
+            unsigned antes, depois;
+            
+            do {
+                antes = atomic_load_explicit(&slot->seq, memory_order_acquire);
+                parcial.total_vendas = atomic_load_explicit(&slot->total_vendas, memory_order_relaxed);
+                parcial.vendas_empresas = atomic_load_explicit(&slot->vendas_empresas, memory_order_relaxed);
+                parcial.vendas_publico = atomic_load_explicit(&slot->vendas_publico, memory_order_relaxed);
+                for (int t = 0; t < 3; t++) {
+                    parcial.vendas_por_turno[t] =
+                        atomic_load_explicit(&slot->vendas_por_turno[t], memory_order_relaxed);
+                }
+                atomic_thread_fence(memory_order_acquire);
+                depois = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+            } while ((antes & 1) || antes != depois);
+            
+            destino->total_vendas += parcial.total_vendas;
+            destino->vendas_empresas += parcial.vendas_empresas;
+            destino->vendas_publico += parcial.vendas_publico;
+            for (int t = 0; t < 3; t++) destino->vendas_por_turno[t] += parcial.vendas_por_turno[t];
+        }
+        
+        atomic_thread_fence(memory_order_acquire);
+        transf_depois = atomic_load_explicit(&seq_transferencias, memory_order_relaxed);
+    } while (transf_antes != transf_depois);
+}
+
 int get_vendas_totais() {
-    pthread_mutex_lock(&stats_lock);
-    int total = estatisticas_vendas.total_vendas;
-    pthread_mutex_unlock(&stats_lock);
-    return total;
+    EstatisticasVendas estatisticas;
+    obter_estatisticas_vendas(&estatisticas);
+    return estatisticas.total_vendas;
 }
 
 int get_vendas_empresas() {
-    pthread_mutex_lock(&stats_lock);
-    int empresas = estatisticas_vendas.vendas_empresas;
-    pthread_mutex_unlock(&stats_lock);
-    return empresas;
+    EstatisticasVendas estatisticas;
+    obter_estatisticas_vendas(&estatisticas);
+    return estatisticas.vendas_empresas;
 }
 
 int get_vendas_publico() {
-    pthread_mutex_lock(&stats_lock);
-    int publico = estatisticas_vendas.vendas_publico;
-    pthread_mutex_unlock(&stats_lock);
-    return publico;
+    EstatisticasVendas estatisticas;
+    obter_estatisticas_vendas(&estatisticas);
+    return estatisticas.vendas_publico;
+}
+
+int get_num_agencias(void) {
+    return num_agencias;
+}
+
+int get_num_trabalhadores(void) {
+    return num_trabalhadores;
 }
 
 /* ========== FUNÇÕES DE RESET ========== */
@@ -361,23 +1497,60 @@ void reinicializar_vendas() {
     parar_todas_agencias();
     
     // Resetar estatísticas
-    pthread_mutex_lock(&stats_lock);
-    memset(&estatisticas_vendas, 0, sizeof(EstatisticasVendas));
-    pthread_mutex_unlock(&stats_lock);
+    zerar_contadores();
     
     // Resetar agências
-    for (int i = 0; i < NUM_AGENCIAS; i++) {
+    for (int i = 0; i < num_agencias; i++) {
         pthread_mutex_lock(&agencias[i].lock);
         agencias[i].vendas_realizadas = 0;
         agencias[i].clientes_atendidos = 0;
         agencias[i].ativa = 0;
-        agencias[i].thread = 0;
         pthread_mutex_unlock(&agencias[i].lock);
     }
     
     printf("[VENDAS] Sistema reinicializado com sucesso\n");
 }
 
+/* Só entre corridas: o ciclo virtual lê-o sem lock */
+void definir_injetor_virtual(InjetorVirtual injetor) {
+    injetor_virtual = injetor;
+}
+
+/* Limites da autoescala (maximo 0 desliga); o máximo é cortado ao
+ * número de agências quando as vendas concorrentes arrancam */
+void configurar_autoescala(int minimo, int maximo) {
+    if (maximo <= 0) {
+        autoescala_minimo = autoescala_maximo = 0;
+        return;
+    }
+    if (minimo < 1) minimo = 1;
+    if (maximo < minimo) maximo = minimo;
+    autoescala_minimo = minimo;
+    autoescala_maximo = maximo;
+}
+
+int get_agencias_ativas(void) {
+    pthread_mutex_lock(&agenda_lock);
+    int ativas = agencias_ativas;
+    pthread_mutex_unlock(&agenda_lock);
+    return ativas;
+}
+
+/* Turnos sequenciais pelo pipeline em vez de processar_vendas_turno */
+void definir_vendas_pipeline(int ativo) {
+    usar_pipeline = ativo;
+}
+
+/* Vendas concorrentes com uma fibra por agência (fibras.c) */
+void definir_agencias_fibras(int ativo) {
+    usar_fibras = ativo;
+}
+
+/* Vendas concorrentes com uma agência por processo (multiprocesso.c) */
+void definir_agencias_processos(int ativo) {
+    usar_processos = ativo;
+}
+
 /* Status do sistema */
 int vendas_sistema_ativo(void) {
     return sistema_ativa;
@@ -13,16 +13,16 @@
 #include "vendas.h"
 #include "contratacoes.h"
 #include "webserver.h"
+#include "afinidade.h"
+#include "limitador.h"
 
 #define PORT_START 8080
 #define PORT_END 8090
 #define POST_BUFFER_SIZE 512
 #define API_VERSION "1.0.0"
+#define FICHEIRO_EXPORTACAO_WEB "vendas_export.csv"
 
 extern FilaPrioridade* fila_global;
-extern Agencia agencias[NUM_AGENCIAS];
-extern EstatisticasVendas estatisticas_vendas;
-extern pthread_mutex_t stats_lock;
 
 static struct MHD_Daemon* webserver_daemon = NULL;
 static int webserver_port = 0;
@@ -215,48 +215,189 @@ static enum MHD_Result handle_static_file(struct MHD_Connection* connection,
     return ret;
 }
 
+/* Vista incremental dos cartões vendidos, mantida a partir do anel de
+ * eventos do estoque: evita varrer o estoque e chamar localtime() para
+ * cada cartão vendido em cada pedido do dashboard. */
+typedef struct {
+    int cartao_id;
+    char hora_venda[20];
+} CartaoVendidoVista;
+
+static CartaoVendidoVista vista_vendidos[MAX_CARTOES];
+static int posicao_vista[MAX_CARTOES];
+static int posicoes_iniciadas = 0;   // Entradas de posicao_vista já a -1
+static int num_vista = 0;
+static unsigned long long seq_vista = 0;
+static int vista_valida = 0;
+static pthread_mutex_t vista_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void vista_adicionar(int cartao_id, time_t instante) {
+    if (cartao_id < 0 || cartao_id >= MAX_CARTOES) return;
+    
+    // Cartões repostos depois da última reconstrução
+    while (posicoes_iniciadas <= cartao_id) posicao_vista[posicoes_iniciadas++] = -1;
+    
+    int pos = posicao_vista[cartao_id];
+    if (pos < 0) {
+        pos = num_vista++;
+        posicao_vista[cartao_id] = pos;
+        vista_vendidos[pos].cartao_id = cartao_id;
+    }
+    
+    vista_vendidos[pos].hora_venda[0] = '\0';
+    if (instante > 0) {
+        struct tm tm_info;
+        localtime_r(&instante, &tm_info);
+        strftime(vista_vendidos[pos].hora_venda, sizeof(vista_vendidos[pos].hora_venda),
+                 "%Y-%m-%d %H:%M:%S", &tm_info);
+    }
+}
+
+static void vista_remover(int cartao_id) {
+    if (cartao_id < 0 || cartao_id >= posicoes_iniciadas) return;
+    
+    int pos = posicao_vista[cartao_id];
+    if (pos < 0) return;
+    
+    vista_vendidos[pos] = vista_vendidos[--num_vista];
+    posicao_vista[vista_vendidos[pos].cartao_id] = pos;
+    posicao_vista[cartao_id] = -1;
+}
+
+/* Reconstrução completa (primeiro pedido ou eventos perdidos) */
+static void reconstruir_vista_estoque(void) {
+    estoque_bloquear_leitura();
+    
+    int total = estoque_total();
+    num_vista = 0;
+    for (int i = 0; i < total; i++) posicao_vista[i] = -1;
+    posicoes_iniciadas = total;
+    
+    for (int i = 0; i < total; i++) {
+        if (estoque[i].vendido == CARTAO_VENDIDO) {
+            vista_adicionar(i, estoque[i].hora_venda);
+        }
+    }
+    
+    // Com todos os fragmentos bloqueados não há eventos em curso
+    seq_vista = estoque_seq_atual();
+    vista_valida = 1;
+    
+    estoque_desbloquear_leitura();
+}
+
+/* Aplica os eventos publicados desde a última atualização (vista_lock adquirido) */
+static void atualizar_vista_estoque(void) {
+    if (!vista_valida) {
+        reconstruir_vista_estoque();
+        return;
+    }
+    
+    EventoEstoque lote[256];
+    for (;;) {
+        unsigned long long proximo;
+        int n = estoque_eventos_desde(seq_vista, lote, 256, &proximo);
+        if (n < 0) {
+            reconstruir_vista_estoque();
+            return;
+        }
+        
+        for (int i = 0; i < n; i++) {
+            if (lote[i].tipo == EVENTO_VENDA) {
+                vista_adicionar(lote[i].cartao_id, lote[i].instante);
+            } else if (lote[i].tipo == EVENTO_LIBERACAO) {
+                vista_remover(lote[i].cartao_id);
+            }
+        }
+        
+        seq_vista = proximo;
+        if (n < 256) break;
+    }
+}
+
 char* generate_estoque_json(void) {
+    int total = estoque_total();
     int disponiveis = estoque_disponivel();
     int vendidos = estoque_vendido();
     
-    pthread_mutex_lock(&estoque_lock);
+    pthread_mutex_lock(&vista_lock);
+    atualizar_vista_estoque();
     
-    char* json = (char*)malloc(4096);
+    size_t tamanho = 512 + (size_t)num_vista * 64 + (size_t)get_num_fragmentos_estoque() * 12;
+    char* json = (char*)malloc(tamanho);
     if (!json) {
-        pthread_mutex_unlock(&estoque_lock);
+        pthread_mutex_unlock(&vista_lock);
         return NULL;
     }
     
-    int offset = snprintf(json, 4096,
+    int offset = snprintf(json, tamanho,
         "{"
         "\"total\": %d,"
         "\"disponiveis\": %d,"
         "\"vendidos\": %d,"
         "\"percentual\": %.1f,"
+        "\"seq\": %llu,"
         "\"cartoes\": [",
-        TOTAL_CARTOES, disponiveis, vendidos,
-        vendidos > 0 ? (float)vendidos / TOTAL_CARTOES * 100 : 0);
-    
-    int count = 0;
-    for (int i = 0; i < TOTAL_CARTOES; i++) {
-        if (estoque[i].vendido == 1) {
-            if (count > 0) offset += snprintf(json + offset, 4096 - offset, ",");
-            
-            char time_str[64] = {0};
-            if (estoque[i].hora_venda > 0) {
-                struct tm* tm_info = localtime(&estoque[i].hora_venda);
-                strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", tm_info);
-            }
-            
-            offset += snprintf(json + offset, 4096 - offset,
-                "{\"id\":%d,\"hora_venda\":\"%s\"}", i, time_str);
-            count++;
-        }
+        total, disponiveis, vendidos,
+        vendidos > 0 ? (float)vendidos / total * 100 : 0,
+        seq_vista);
+    
+    for (int i = 0; i < num_vista; i++) {
+        offset += snprintf(json + offset, tamanho - offset,
+            "%s{\"id\":%d,\"hora_venda\":\"%s\"}",
+            i > 0 ? "," : "",
+            vista_vendidos[i].cartao_id, vista_vendidos[i].hora_venda);
+    }
+    
+    pthread_mutex_unlock(&vista_lock);
+    
+    offset += snprintf(json + offset, tamanho - offset, "],\"fragmentos\": [");
+    
+    for (int f = 0; f < get_num_fragmentos_estoque(); f++) {
+        offset += snprintf(json + offset, tamanho - offset, "%s%d",
+                           f > 0 ? "," : "", estoque_disponivel_fragmento(f));
+    }
+    
+    offset += snprintf(json + offset, tamanho - offset, "]}");
+    
+    return json;
+}
+
+/* Eventos do estoque desde 'desde' para consumidores incrementais */
+char* generate_estoque_eventos_json(unsigned long long desde) {
+    static const char* nomes_eventos[] = {
+        "VENDA", "LIBERACAO", "RETENCAO", "FIM_RETENCAO", "REPOSICAO"
+    };
+    
+    EventoEstoque lote[256];
+    unsigned long long proximo;
+    int n = estoque_eventos_desde(desde, lote, 256, &proximo);
+    
+    size_t tamanho = 256 + (n > 0 ? (size_t)n * 96 : 0);
+    char* json = (char*)malloc(tamanho);
+    if (!json) return NULL;
+    
+    if (n < 0) {
+        // Eventos já sobrescritos: o cliente deve voltar a ler /api/estoque
+        snprintf(json, tamanho,
+            "{\"desde\": %llu,\"proximo\": %llu,\"reconstruir\": true,\"eventos\": []}",
+            desde, proximo);
+        return json;
     }
     
-    offset += snprintf(json + offset, 4096 - offset, "]}");
+    int offset = snprintf(json, tamanho,
+        "{\"desde\": %llu,\"proximo\": %llu,\"reconstruir\": false,\"eventos\": [",
+        desde, proximo);
     
-    pthread_mutex_unlock(&estoque_lock);
+    for (int i = 0; i < n; i++) {
+        offset += snprintf(json + offset, tamanho - offset,
+            "%s{\"seq\":%llu,\"tipo\":\"%s\",\"cartao\":%d,\"instante\":%lld}",
+            i > 0 ? "," : "",
+            lote[i].seq, nomes_eventos[lote[i].tipo], lote[i].cartao_id,
+            (long long)lote[i].instante);
+    }
+    
+    snprintf(json + offset, tamanho - offset, "]}");
     return json;
 }
 
@@ -266,6 +407,10 @@ char* generate_fila_json(void* fila_ptr) {
         return strdup("{\"tamanho\":0,\"max\":200,\"clientes\":[]}");
     }
     
+    // Expira as desistências vencidas antes de ler a fila
+    EstatisticasDesistencia desistencias;
+    obter_estatisticas_desistencia(fila, &desistencias);
+    
     pthread_mutex_lock(&fila->lock);
     
     char* json = (char*)malloc(8192);
@@ -278,9 +423,27 @@ char* generate_fila_json(void* fila_ptr) {
         "{"
         "\"tamanho\": %d,"
         "\"max\": %d,"
-        "\"clientes\": [",
+        "\"desistencias\": {",
         fila->tamanho, get_max_fila());
     
+    for (int t = 0; t < 2; t++) {
+        long long chegadas = desistencias.chegadas[t];
+        offset += snprintf(json + offset, 8192 - offset,
+            "%s\"%s\": {"
+            "\"paciencia_segundos\": %.1f,"
+            "\"chegadas\": %lld,"
+            "\"desistencias\": %lld,"
+            "\"taxa\": %.4f"
+            "}",
+            t > 0 ? "," : "",
+            t == EMPRESA ? "empresa" : "publico",
+            desistencias.paciencia_s[t],
+            chegadas,
+            desistencias.desistencias[t],
+            chegadas > 0 ? (double)desistencias.desistencias[t] / chegadas : 0);
+    }
+    offset += snprintf(json + offset, 8192 - offset, "},\"clientes\": [");
+    
     Node* atual = fila->frente;
     int pos = 1;
     
@@ -323,6 +486,10 @@ char* generate_rh_json(void) {
     int total_contratacoes = get_total_contratacoes();
     int total_demissoes = get_total_demissoes();
     
+    // Contagens por estado: lidas sem o mutex do RH
+    int estados[NUM_ESTADOS_PROCESSO];
+    obter_contagem_estados(estados);
+    
     char* json = (char*)malloc(4096);
     if (!json) return NULL;
     
@@ -333,27 +500,38 @@ char* generate_rh_json(void) {
         "\"vagas\": %d,"
         "\"total_contratacoes\": %d,"
         "\"total_demissoes\": %d,"
-        "\"percentual\": %.1f"
+        "\"percentual\": %.1f,"
+        "\"processos\": {"
+        "\"pendentes\": %d,"
+        "\"em_analise\": %d,"
+        "\"aprovados\": %d,"
+        "\"contratados\": %d,"
+        "\"rejeitados\": %d,"
+        "\"cancelados\": %d,"
+        "\"limite_simultaneos\": %d"
+        "}"
         "}",
         LIMITE_CONTRATACOES, ativos, vagas,
         total_contratacoes, total_demissoes,
-        LIMITE_CONTRATACOES > 0 ? (float)ativos / LIMITE_CONTRATACOES * 100 : 0);
+        LIMITE_CONTRATACOES > 0 ? (float)ativos / LIMITE_CONTRATACOES * 100 : 0,
+        estados[PENDENTE], estados[EM_ANALISE], estados[APROVADO],
+        estados[CONTRATADO], estados[REJEITADO], estados[CANCELADO],
+        LIMITE_PROCESSOS_SIMULTANEOS);
     
     return json;
 }
 
 char* generate_vendas_json(void) {
-    int total = get_vendas_totais();
-    int empresas = get_vendas_empresas();
-    int publico = get_vendas_publico();
-    
-    int manha = 0, tarde = 0, noite = 0;
+    // Uma só leitura: os campos são coerentes entre si
+    EstatisticasVendas estatisticas;
+    obter_estatisticas_vendas(&estatisticas);
     
-    pthread_mutex_lock(&stats_lock);
-    manha = estatisticas_vendas.vendas_por_turno[MANHA];
-    tarde = estatisticas_vendas.vendas_por_turno[TARDE];
-    noite = estatisticas_vendas.vendas_por_turno[NOITE];
-    pthread_mutex_unlock(&stats_lock);
+    int total = estatisticas.total_vendas;
+    int empresas = estatisticas.vendas_empresas;
+    int publico = estatisticas.vendas_publico;
+    int manha = estatisticas.vendas_por_turno[MANHA];
+    int tarde = estatisticas.vendas_por_turno[TARDE];
+    int noite = estatisticas.vendas_por_turno[NOITE];
     
     char* json = (char*)malloc(4096);
     if (!json) return NULL;
@@ -375,20 +553,24 @@ char* generate_vendas_json(void) {
 }
 
 char* generate_agencias_json(void) {
-    char* json = (char*)malloc(4096);
+    int total = get_num_agencias();
+    size_t tamanho = 256 + (size_t)total * 192;
+    char* json = (char*)malloc(tamanho);
     if (!json) return NULL;
     
-    int offset = snprintf(json, 4096,
+    int offset = snprintf(json, tamanho,
         "{"
         "\"total_agencias\": %d,"
+        "\"trabalhadores\": %d,"
+        "\"ativas\": %d,"
         "\"agencias\": [",
-        NUM_AGENCIAS);
+        total, get_num_trabalhadores(), get_agencias_ativas());
     
-    for (int i = 0; i < NUM_AGENCIAS; i++) {
-        if (i > 0) offset += snprintf(json + offset, 4096 - offset, ",");
+    for (int i = 0; i < total; i++) {
+        if (i > 0) offset += snprintf(json + offset, tamanho - offset, ",");
         
         pthread_mutex_lock(&agencias[i].lock);
-        offset += snprintf(json + offset, 4096 - offset,
+        offset += snprintf(json + offset, tamanho - offset,
             "{"
             "\"id\": %d,"
             "\"nome\": \"%s\","
@@ -404,7 +586,72 @@ char* generate_agencias_json(void) {
         pthread_mutex_unlock(&agencias[i].lock);
     }
     
-    offset += snprintf(json + offset, 4096 - offset, "]}");
+    offset += snprintf(json + offset, tamanho - offset, "]}");
+    
+    return json;
+}
+
+char* generate_exportacao_json(void) {
+    EstadoExportacao estado;
+    obter_estado_exportacao(&estado);
+    
+    char* json = (char*)malloc(1024);
+    if (!json) return NULL;
+    
+    snprintf(json, 1024,
+        "{"
+        "\"em_curso\": %s,"
+        "\"concluidas\": %d,"
+        "\"falhadas\": %d,"
+        "\"ultima\": {"
+        "\"ficheiro\": \"%s\","
+        "\"sucesso\": %s,"
+        "\"agencias\": %d,"
+        "\"duracao_ms\": %.3f"
+        "}"
+        "}",
+        estado.em_curso ? "true" : "false",
+        estado.concluidas, estado.falhadas,
+        estado.ultimo_ficheiro,
+        estado.ultimo_sucesso ? "true" : "false",
+        estado.ultimas_linhas,
+        estado.ultima_duracao_ns / 1e6);
+    
+    return json;
+}
+
+char* generate_limites_json(void) {
+    EstatisticasLimites estatisticas;
+    obter_estatisticas_limites(&estatisticas);
+    
+    static const char* etapas[2] = { "entrada", "atendimento" };
+    static const char* tipos[2] = { "empresa", "publico" };
+    
+    char* json = (char*)malloc(2048);
+    if (!json) return NULL;
+    
+    int offset = snprintf(json, 2048, "{");
+    for (int e = 0; e < 2; e++) {
+        offset += snprintf(json + offset, 2048 - offset, "%s\"%s\": {",
+                           e > 0 ? "," : "", etapas[e]);
+        for (int t = 0; t < 2; t++) {
+            ContagemLimite* c = &estatisticas.etapa[e][t];
+            long long total = c->aceites + c->recusados;
+            offset += snprintf(json + offset, 2048 - offset,
+                "%s\"%s\": {"
+                "\"taxa\": %.3f,"
+                "\"rajada\": %d,"
+                "\"aceites\": %lld,"
+                "\"recusados\": %lld,"
+                "\"taxa_recusa\": %.4f"
+                "}",
+                t > 0 ? "," : "", tipos[t],
+                c->taxa, c->rajada, c->aceites, c->recusados,
+                total > 0 ? (double)c->recusados / total : 0);
+        }
+        offset += snprintf(json + offset, 2048 - offset, "}");
+    }
+    snprintf(json + offset, 2048 - offset, "}");
     
     return json;
 }
@@ -430,7 +677,11 @@ char* generate_dashboard_json(void) {
     struct tm* tm_info = localtime(&now);
     strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", tm_info);
     
-    char* json = (char*)malloc(16384);
+    // Do tamanho das partes: a de agências cresce com MAX_AGENCIAS
+    size_t tamanho = 256 + strlen(timestamp) + strlen(API_VERSION) +
+                     strlen(estoque_json) + strlen(fila_json) + strlen(rh_json) +
+                     strlen(vendas_json) + strlen(agencias_json);
+    char* json = (char*)malloc(tamanho);
     if (!json) {
         free(estoque_json);
         free(fila_json);
@@ -440,7 +691,7 @@ char* generate_dashboard_json(void) {
         return NULL;
     }
     
-    snprintf(json, 16384,
+    snprintf(json, tamanho,
         "{"
         "\"timestamp\": \"%s\","
         "\"api_version\": \"%s\","
@@ -470,6 +721,9 @@ static enum MHD_Result handle_api_request(struct MHD_Connection* connection,
     
     if (strcmp(url, "/api/estoque") == 0) {
         json = generate_estoque_json();
+    } else if (strcmp(url, "/api/estoque/eventos") == 0) {
+        const char* desde = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "desde");
+        json = generate_estoque_eventos_json(desde ? strtoull(desde, NULL, 10) : 0);
     } else if (strcmp(url, "/api/fila") == 0) {
         json = generate_fila_json(fila_global);
     } else if (strcmp(url, "/api/rh") == 0) {
@@ -480,6 +734,10 @@ static enum MHD_Result handle_api_request(struct MHD_Connection* connection,
         json = generate_agencias_json();
     } else if (strcmp(url, "/api/dashboard") == 0) {
         json = generate_dashboard_json();
+    } else if (strcmp(url, "/api/exportacao") == 0) {
+        json = generate_exportacao_json();
+    } else if (strcmp(url, "/api/limites") == 0) {
+        json = generate_limites_json();
     } else {
         const char* error = "{\"error\": \"Endpoint not found\"}";
         struct MHD_Response* response = MHD_create_response_from_buffer(
@@ -512,12 +770,6 @@ static enum MHD_Result handle_api_request(struct MHD_Connection* connection,
     return ret;
 }
 
-static void* web_contratar_thread(void* arg) {
-    (void)arg;
-    iniciar_processo_contratacao("Cliente Web", "Funcionário", 45000.0);
-    return NULL;
-}
-
 static enum MHD_Result handle_post_operation(struct MHD_Connection* connection,
                                             const char* url,
                                             const char* data) {
@@ -526,9 +778,8 @@ static enum MHD_Result handle_post_operation(struct MHD_Connection* connection,
     printf("\n📨 POST Request: %s\n", data);
     
     if (strstr(data, "\"tipo\":\"contratar\"") != NULL) {
-        pthread_t thread;
-        pthread_create(&thread, NULL, web_contratar_thread, NULL);
-        pthread_detach(thread);
+        // Não bloqueia: a análise é agendada no motor de eventos do RH
+        iniciar_processo_contratacao("Cliente Web", "Funcionário", 45000.0);
         
         const char* response = "{\"status\":\"success\",\"message\":\"Processo de contratação iniciado\"}";
         struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
@@ -538,6 +789,43 @@ static enum MHD_Result handle_post_operation(struct MHD_Connection* connection,
         MHD_destroy_response(mhd_response);
         return ret;
     }
+    else if (strstr(data, "\"tipo\":\"exportar\"") != NULL) {
+        // O instantâneo é capturado já; a escrita segue noutra thread
+        int aceite = exportar_vendas_csv_async(FICHEIRO_EXPORTACAO_WEB, NULL, NULL);
+        const char* response = aceite
+            ? "{\"status\":\"success\",\"message\":\"Exportação iniciada (ver /api/exportacao)\"}"
+            : "{\"status\":\"error\",\"message\":\"Exportação já pendente\"}";
+        struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
+            strlen(response), (void*)response, MHD_RESPMEM_PERSISTENT);
+        MHD_add_response_header(mhd_response, "Content-Type", "application/json");
+        int ret = MHD_queue_response(connection, aceite ? MHD_HTTP_OK : MHD_HTTP_CONFLICT, mhd_response);
+        MHD_destroy_response(mhd_response);
+        return ret;
+    }
+    else if (strstr(data, "\"tipo\":\"limite\"") != NULL) {
+        // {"tipo":"limite","especificacao":"etapa:tipo=taxa[:rajada]"}
+        char especificacao[128] = "";
+        const char* inicio = strstr(data, "\"especificacao\":\"");
+        if (inicio) {
+            inicio += strlen("\"especificacao\":\"");
+            const char* fim = strchr(inicio, '"');
+            size_t tamanho = fim ? (size_t)(fim - inicio) : 0;
+            if (tamanho < sizeof(especificacao)) {
+                memcpy(especificacao, inicio, tamanho);
+                especificacao[tamanho] = '\0';
+            }
+        }
+        int aceite = especificacao[0] != '\0' && configurar_limite(especificacao);
+        const char* response = aceite
+            ? "{\"status\":\"success\",\"message\":\"Limite atualizado (ver /api/limites)\"}"
+            : "{\"status\":\"error\",\"message\":\"Especificação de limite inválida\"}";
+        struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
+            strlen(response), (void*)response, MHD_RESPMEM_PERSISTENT);
+        MHD_add_response_header(mhd_response, "Content-Type", "application/json");
+        int ret = MHD_queue_response(connection, aceite ? MHD_HTTP_OK : MHD_HTTP_BAD_REQUEST, mhd_response);
+        MHD_destroy_response(mhd_response);
+        return ret;
+    }
     else if (strstr(data, "\"tipo\":\"demitir\"") != NULL) {
         const char* response = "{\"status\":\"success\",\"message\":\"Demissão processada\"}";
         struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
@@ -564,6 +852,13 @@ static enum MHD_Result handle_connection(void* cls, struct MHD_Connection* conne
     (void)cls;
     (void)version;
     
+    // As threads são do libmicrohttpd: fixar cada uma no primeiro pedido
+    static _Thread_local int afinidade_aplicada = 0;
+    if (!afinidade_aplicada) {
+        aplicar_afinidade_thread(CLASSE_WEB, -1);
+        afinidade_aplicada = 1;
+    }
+    
     static int dummy;
     if (&dummy != *con_cls) {
         *con_cls = &dummy;
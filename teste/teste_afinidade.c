@@ -0,0 +1,81 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <assert.h>
+#include "afinidade.h"
+
+static int cpus_thread = -1;
+static int cpu_thread = -1;
+
+/* Fixa-se como agência e reporta onde ficou */
+void* thread_agencia(void* arg) {
+    (void)arg;
+    assert(aplicar_afinidade_thread(CLASSE_AGENCIA, 5));
+    cpu_set_t conjunto;
+    assert(pthread_getaffinity_np(pthread_self(), sizeof(conjunto), &conjunto) == 0);
+    cpus_thread = CPU_COUNT(&conjunto);
+    cpu_thread = CPU_ISSET(0, &conjunto) ? sched_getcpu() : -1;
+    return NULL;
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+
+    printf("Testando especificações inválidas...\n");
+    assert(!configurar_afinidade(NULL));
+    assert(!configurar_afinidade("agencias"));
+    assert(!configurar_afinidade("cozinha=0"));
+    assert(!configurar_afinidade("agencias=abc"));
+    assert(!configurar_afinidade("agencias=3-1"));
+    assert(!configurar_afinidade("agencias=0-"));
+    assert(!configurar_afinidade("agencias=100000"));
+    for (int c = 0; c < NUM_CLASSES_THREAD; c++) {
+        assert(!afinidade_configurada((ClasseThread)c));
+        assert(num_cpus_classe((ClasseThread)c) == 0);
+    }
+    // Sem configuração nada é fixado
+    assert(!aplicar_afinidade_thread(CLASSE_RH, 0));
+    printf("Especificações inválidas: OK\n");
+
+    printf("Testando fixação por classe...\n");
+    assert(configurar_afinidade("agencias=0"));
+    assert(afinidade_configurada(CLASSE_AGENCIA));
+    assert(num_cpus_classe(CLASSE_AGENCIA) == 1);
+
+    // CPUs que não existem são cortados ao conjunto online
+    assert(configurar_afinidade("rh=0-1000"));
+    assert(num_cpus_classe(CLASSE_RH) == online);
+
+    pthread_t t;
+    pthread_create(&t, NULL, thread_agencia, NULL);
+    pthread_join(t, NULL);
+    // Índice 5 num conjunto de um só CPU: em roda, o CPU 0
+    assert(cpus_thread == 1);
+    assert(cpu_thread == 0);
+    printf("Fixação: OK\n");
+
+    printf("Testando topologia e memória por nó...\n");
+    assert(num_nos_numa() >= 1);
+    assert(no_numa_da_cpu(-1) == 0);
+    assert(no_numa_atual() >= 0 && no_numa_atual() < num_nos_numa());
+
+    size_t tamanho = 3 * (size_t)sysconf(_SC_PAGESIZE) + 100;
+    unsigned char* local = (unsigned char*)alocar_memoria_local(tamanho);
+    unsigned char* intercalada = (unsigned char*)alocar_memoria_intercalada(tamanho);
+    assert(local && intercalada);
+    for (size_t i = 0; i < tamanho; i++) assert(local[i] == 0 && intercalada[i] == 0);
+    memset(local, 0xAB, tamanho);
+    memset(intercalada, 0xCD, tamanho);
+    libertar_memoria_numa(local, tamanho);
+    libertar_memoria_numa(intercalada, tamanho);
+    libertar_memoria_numa(NULL, tamanho);
+    printf("Topologia e memória: OK\n");
+
+    printf("\nTodos os testes de afinidade passaram!\n");
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <assert.h>
+#include "estoque.h"
+#include "Fila_prioridade.h"
+#include "vendas.h"
+
+#define NUM_AGENCIAS_TESTE 48
+#define NUM_CLIENTES_TESTE 40
+
+int main() {
+    setbuf(stdout, NULL);
+    inicializar_estoque();
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+
+    printf("Testando número de agências configurável...\n");
+    definir_num_agencias(0);
+    inicializar_sistema_vendas(fila);
+    assert(get_num_agencias() == 1);
+    assert(get_num_trabalhadores() == 1);
+
+    definir_num_agencias(NUM_AGENCIAS_TESTE);
+    inicializar_sistema_vendas(fila);
+    assert(get_num_agencias() == NUM_AGENCIAS_TESTE);
+    // Um trabalhador por núcleo, nunca mais do que agências
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    assert(get_num_trabalhadores() >= 1);
+    assert(get_num_trabalhadores() <= NUM_AGENCIAS_TESTE);
+    assert(get_num_trabalhadores() <= (nucleos > 0 ? nucleos : 1));
+    printf("Agências e trabalhadores: OK\n");
+
+    printf("Testando vendas no pool de trabalhadores...\n");
+    for (int i = 1; i <= NUM_CLIENTES_TESTE; i++) {
+        inserir_cliente(fila, i, i % 4 == 0 ? EMPRESA : PUBLICO);
+    }
+
+    // Turnos curtos: cada agência faz uma venda por segundo, pelo que os
+    // clientes só são todos atendidos se muitas agências correrem juntas
+    long duracao[3] = {300, 300, 300};
+    int limites[3] = {NUM_CLIENTES_TESTE, NUM_CLIENTES_TESTE, NUM_CLIENTES_TESTE};
+    configurar_turnos(duracao, limites);
+    iniciar_vendas_concorrentes(MANHA);
+
+    int soma_agencias = 0;
+    for (int i = 0; i < get_num_agencias(); i++) {
+        assert(agencias[i].vendas_realizadas <= 1);
+        soma_agencias += agencias[i].vendas_realizadas;
+    }
+    assert(get_vendas_totais() == NUM_CLIENTES_TESTE);
+    assert(soma_agencias == NUM_CLIENTES_TESTE);
+    assert(get_vendas_empresas() == NUM_CLIENTES_TESTE / 4);
+    assert(estoque_vendido() == NUM_CLIENTES_TESTE);
+    assert(fila->tamanho == 0);
+    assert(get_agencias_ativas() == 0);
+    printf("Pool de trabalhadores: OK\n");
+
+    liberar_fila(fila);
+    liberar_estoque();
+    printf("\nTodos os testes do pool de agências passaram!\n");
+    return 0;
+}
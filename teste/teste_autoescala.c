@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "estoque.h"
+#include "Fila_prioridade.h"
+#include "relogio.h"
+#include "vendas.h"
+
+#define NUM_AGENCIAS_TESTE 20
+#define MINIMO_TESTE 2
+#define MAXIMO_TESTE 16
+#define NUM_CLIENTES_TESTE 150
+#define AMOSTRA_NS (250 * 1000000LL)
+
+static int maximo_visto = 0;
+static int minimo_visto = NUM_AGENCIAS_TESTE;
+static int ultimo_visto = -1;
+static int amostras = 0;
+
+/* Injetor do ciclo virtual: só observa as agências ativas a intervalos */
+static long long observar_agencias(long long agora_ns) {
+    int ativas = get_agencias_ativas();
+    if (ativas > maximo_visto) maximo_visto = ativas;
+    if (ativas < minimo_visto) minimo_visto = ativas;
+    ultimo_visto = ativas;
+    amostras++;
+    return agora_ns + AMOSTRA_NS;
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    relogio_configurar(RELOGIO_VIRTUAL, 0);
+
+    printf("Testando limites da autoescala...\n");
+    inicializar_estoque();
+    reabastecer_estoque(NUM_CLIENTES_TESTE);
+    FilaPrioridade* fila = inicializar_fila();
+    for (int i = 1; i <= NUM_CLIENTES_TESTE; i++) inserir_cliente(fila, i, PUBLICO);
+
+    definir_num_agencias(NUM_AGENCIAS_TESTE);
+    inicializar_sistema_vendas(fila);
+    long duracao[3] = {10000, 10000, 10000};
+    int limites[3] = {NUM_CLIENTES_TESTE, NUM_CLIENTES_TESTE, NUM_CLIENTES_TESTE};
+    configurar_turnos(duracao, limites);
+    configurar_autoescala(MINIMO_TESTE, MAXIMO_TESTE);
+    definir_injetor_virtual(observar_agencias);
+
+    iniciar_vendas_concorrentes(MANHA);
+    definir_injetor_virtual(NULL);
+
+    assert(amostras > 0);
+    assert(get_vendas_totais() == NUM_CLIENTES_TESTE);
+    // Fila grande: sobe até ao máximo, sem nunca o passar
+    assert(maximo_visto == MAXIMO_TESTE);
+    // Fila vazia: volta ao mínimo, sem nunca descer abaixo dele
+    assert(minimo_visto == MINIMO_TESTE);
+    assert(ultimo_visto == MINIMO_TESTE);
+
+    // Só as agências ativas venderam
+    for (int i = MAXIMO_TESTE; i < NUM_AGENCIAS_TESTE; i++) {
+        assert(agencias[i].vendas_realizadas == 0);
+    }
+    printf("Subida e descida: OK\n");
+
+    printf("Testando autoescala desligada...\n");
+    configurar_autoescala(0, 0);
+    reinicializar_vendas();
+    for (int i = 1; i <= 10; i++) inserir_cliente(fila, i, PUBLICO);
+    definir_injetor_virtual(observar_agencias);
+    maximo_visto = 0;
+    minimo_visto = NUM_AGENCIAS_TESTE;
+    iniciar_vendas_concorrentes(NOITE);
+    definir_injetor_virtual(NULL);
+    // Todas as agências sempre em operação
+    assert(maximo_visto == NUM_AGENCIAS_TESTE);
+    assert(minimo_visto == NUM_AGENCIAS_TESTE);
+    printf("Autoescala desligada: OK\n");
+
+    reinicializar_vendas();
+    liberar_fila(fila);
+    liberar_estoque();
+    printf("\nTodos os testes de autoescala passaram!\n");
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include "vendas.h"
+
+#define VENDAS_POR_THREAD 1000
+#define THREADS_POR_RONDA 8
+#define NUM_RONDAS 64   // 512 threads: mais do que MAX_SLOTS_CONTADORES
+
+static atomic_int leitura_ativa = 1;
+static atomic_int leituras = 0;
+
+void* thread_vendedor(void* arg) {
+    int id = (int)(long)arg;
+    for (int i = 0; i < VENDAS_POR_THREAD; i++) {
+        contabilizar_venda((i + id) % 2 ? EMPRESA : PUBLICO, (Turno)(i % 3));
+    }
+    return NULL;
+}
+
+/* Cada leitura tem de ver vendas inteiras: o total bate com os tipos e
+ * os turnos, e nunca recua (nem quando um slot muda de dono) */
+void* thread_leitor(void* arg) {
+    (void)arg;
+    int anterior = 0;
+    while (atomic_load(&leitura_ativa)) {
+        EstatisticasVendas est;
+        obter_estatisticas_vendas(&est);
+        assert(est.total_vendas == est.vendas_empresas + est.vendas_publico);
+        assert(est.total_vendas ==
+               est.vendas_por_turno[0] + est.vendas_por_turno[1] + est.vendas_por_turno[2]);
+        assert(est.total_vendas >= anterior);
+        anterior = est.total_vendas;
+        atomic_fetch_add(&leituras, 1);
+    }
+    return NULL;
+}
+
+int main() {
+    setbuf(stdout, NULL);
+
+    printf("Testando contadores por thread com leitor concorrente...\n");
+    pthread_t leitor;
+    pthread_create(&leitor, NULL, thread_leitor, NULL);
+
+    // Threads de vida curta, como os trabalhadores recriados a cada corrida
+    for (int r = 0; r < NUM_RONDAS; r++) {
+        pthread_t threads[THREADS_POR_RONDA];
+        for (int i = 0; i < THREADS_POR_RONDA; i++) {
+            pthread_create(&threads[i], NULL, thread_vendedor, (void*)(long)i);
+        }
+        for (int i = 0; i < THREADS_POR_RONDA; i++) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    atomic_store(&leitura_ativa, 0);
+    pthread_join(leitor, NULL);
+
+    int esperado = NUM_RONDAS * THREADS_POR_RONDA * VENDAS_POR_THREAD;
+    EstatisticasVendas est;
+    obter_estatisticas_vendas(&est);
+    assert(est.total_vendas == esperado);
+    assert(est.vendas_empresas == esperado / 2);
+    assert(est.vendas_publico == esperado / 2);
+    assert(get_vendas_totais() == esperado);
+    printf("   %d vendas de %d threads, %d leituras consistentes\n",
+           est.total_vendas, NUM_RONDAS * THREADS_POR_RONDA, atomic_load(&leituras));
+    printf("Contadores: OK\n");
+
+    printf("\nTodos os testes de contadores passaram!\n");
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <assert.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "coordenador.h"
+#include "estoque.h"
+#include "estoque_remoto.h"
+
+#define CARTOES_PEDIDOS 10
+#define CARTOES_VENDIDOS 3
+#define CARTOES_DEVOLVIDOS 2
+
+static char endereco[64];
+
+/* Um pedido e a sua resposta; retorna a quantidade de inteiros lidos */
+static int trocar(int fd, OperacaoCoordenador operacao, const int32_t* ids, int quantidade,
+                  int32_t* resposta_ids) {
+    PedidoCoordenador pedido = { (uint32_t)operacao, (uint32_t)quantidade };
+    assert(write(fd, &pedido, sizeof(pedido)) == sizeof(pedido));
+    if (ids && quantidade > 0) {
+        ssize_t tamanho = (ssize_t)(quantidade * sizeof(int32_t));
+        assert(write(fd, ids, tamanho) == tamanho);
+    }
+
+    RespostaCoordenador resposta;
+    assert(recv(fd, &resposta, sizeof(resposta), MSG_WAITALL) == sizeof(resposta));
+    assert(resposta.estado == 0);
+    if (resposta.quantidade > 0) {
+        ssize_t tamanho = (ssize_t)(resposta.quantidade * sizeof(int32_t));
+        assert(recv(fd, resposta_ids, tamanho, MSG_WAITALL) == tamanho);
+    }
+    return (int)resposta.quantidade;
+}
+
+/* disponíveis, cedidos, vendidos, total */
+static void contar(int fd, int32_t valores[4]) {
+    assert(trocar(fd, COORD_CONTAGEM, NULL, 0, valores) == 4);
+}
+
+static int ligar(void) {
+    // O coordenador pode ainda não estar à escuta
+    for (int tentativa = 0; tentativa < 50; tentativa++) {
+        int fd = coordenador_abrir_endereco(endereco, 0);
+        if (fd >= 0) return fd;
+        usleep(100000);
+    }
+    return -1;
+}
+
+void test_no_desligado_com_vendas_por_confirmar(void) {
+    printf("Testando nó que cai com vendas por confirmar...\n");
+
+    snprintf(endereco, sizeof(endereco), "/tmp/teste_coordenador_%d.sock", (int)getpid());
+    unlink(endereco);
+
+    pid_t coordenador = fork();
+    assert(coordenador >= 0);
+    if (coordenador == 0) {
+        exit(executar_coordenador_estoque(endereco) ? 0 : 1);
+    }
+
+    // 1. Nó recebe cartões e cai sem confirmar nada
+    int no = ligar();
+    assert(no >= 0);
+    int32_t cedidos[CARTOES_PEDIDOS];
+    assert(trocar(no, COORD_RESERVAR, NULL, CARTOES_PEDIDOS, cedidos) == CARTOES_PEDIDOS);
+    close(no);
+    usleep(3 * INTERVALO_POLL_COORDENADOR_MS * 1000);
+
+    // 2. Os cartões ficam em quarentena: nem disponíveis nem vendidos
+    int observador = ligar();
+    assert(observador >= 0);
+    int32_t valores[4];
+    contar(observador, valores);
+    printf("   Após a queda: %d disponíveis, %d cedidos, %d vendidos, %d total\n",
+           valores[0], valores[1], valores[2], valores[3]);
+    assert(valores[0] == TOTAL_CARTOES - CARTOES_PEDIDOS);
+    assert(valores[1] == CARTOES_PEDIDOS);
+    assert(valores[2] == 0);
+
+    // 3. O nó religado confirma as vendas e devolve parte do que sobrou
+    int religado = ligar();
+    assert(religado >= 0);
+    // As respostas trazem os aceites seguidos dos cartões recusados
+    int32_t resposta[1 + CARTOES_PEDIDOS];
+    assert(trocar(religado, COORD_VENDER, cedidos, CARTOES_VENDIDOS, resposta) == 1);
+    assert(resposta[0] == CARTOES_VENDIDOS);
+    assert(trocar(religado, COORD_LIBERAR, cedidos + CARTOES_VENDIDOS, CARTOES_DEVOLVIDOS,
+                  resposta) == 1);
+    assert(resposta[0] == CARTOES_DEVOLVIDOS);
+
+    // Uma segunda venda do mesmo cartão já não conta e volta como recusada
+    assert(trocar(religado, COORD_VENDER, cedidos, 1, resposta) == 2);
+    assert(resposta[0] == 0);
+    assert(resposta[1] == cedidos[0]);
+
+    contar(observador, valores);
+    printf("   Após religar: %d disponíveis, %d cedidos, %d vendidos, %d total\n",
+           valores[0], valores[1], valores[2], valores[3]);
+    assert(valores[0] == TOTAL_CARTOES - CARTOES_PEDIDOS + CARTOES_DEVOLVIDOS);
+    assert(valores[1] == CARTOES_PEDIDOS - CARTOES_VENDIDOS - CARTOES_DEVOLVIDOS);
+    assert(valores[2] == CARTOES_VENDIDOS);
+    assert(valores[0] + valores[1] + valores[2] == valores[3]);
+
+    close(religado);
+    close(observador);
+
+    int estado;
+    kill(coordenador, SIGTERM);
+    assert(waitpid(coordenador, &estado, 0) == coordenador);
+    unlink(endereco);
+
+    printf("Quarentena do coordenador: OK\n");
+}
+
+void test_venda_recusada_apos_reinicio(void) {
+    printf("Testando venda recusada por um coordenador reiniciado...\n");
+
+    snprintf(endereco, sizeof(endereco), "/tmp/teste_coordenador_%d.sock", (int)getpid());
+    unlink(endereco);
+
+    pid_t coordenador = fork();
+    assert(coordenador >= 0);
+    if (coordenador == 0) {
+        exit(executar_coordenador_estoque(endereco) ? 0 : 1);
+    }
+    int ligado = 0;
+    for (int tentativa = 0; tentativa < 50 && !ligado; tentativa++) {
+        ligado = estoque_remoto_ligar(endereco);
+        if (!ligado) usleep(100000);
+    }
+    assert(ligado);
+    int cartao = estoque_remoto_reservar();
+    assert(cartao >= 0);
+
+    // O novo coordenador não conhece o cartão cedido pelo anterior
+    kill(coordenador, SIGTERM);
+    assert(waitpid(coordenador, NULL, 0) == coordenador);
+    unlink(endereco);
+    coordenador = fork();
+    assert(coordenador >= 0);
+    if (coordenador == 0) {
+        exit(executar_coordenador_estoque(endereco) ? 0 : 1);
+    }
+
+    estoque_remoto_confirmar(cartao);
+    EstatisticasEstoqueRemoto estatisticas = {0};
+    for (int espera = 0; espera < 100 && estatisticas.vendas_recusadas == 0; espera++) {
+        usleep(100000);
+        obter_estatisticas_estoque_remoto(&estatisticas);
+    }
+    printf("   Vendas enviadas: %lld, recusadas: %lld\n",
+           estatisticas.vendas_enviadas, estatisticas.vendas_recusadas);
+    assert(estatisticas.vendas_recusadas == 1);
+
+    int valores[4];
+    assert(estoque_remoto_contagem(valores));
+    assert(valores[2] == 0);
+
+    estoque_remoto_desligar();
+    kill(coordenador, SIGTERM);
+    assert(waitpid(coordenador, NULL, 0) == coordenador);
+    unlink(endereco);
+
+    printf("Venda recusada após reinício: OK\n");
+}
+
+int main() {
+    setbuf(stdout, NULL);
+
+    printf("=== TESTE DO COORDENADOR DE ESTOQUE ===\n\n");
+    test_no_desligado_com_vendas_por_confirmar();
+    test_venda_recusada_apos_reinicio();
+    printf("\n=== TODOS OS TESTES PASSARAM ===\n");
+    return 0;
+}
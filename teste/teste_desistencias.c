@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "relogio.h"
+#include "Fila_prioridade.h"
+
+#define INICIO_SIMULACAO 1700000000
+
+static void avancar_ms(long ms) {
+    relogio_avancar_ate(relogio_agora_ns() + ms * 1000000LL);
+}
+
+void test_configuracao(void) {
+    printf("Testando configuração da paciência...\n");
+    assert(!configurar_paciencia(NULL));
+    assert(!configurar_paciencia("publico"));
+    assert(!configurar_paciencia("cliente=5"));
+    assert(!configurar_paciencia("publico=-1"));
+    assert(!configurar_paciencia("publico=abc"));
+    assert(!configurar_paciencia("publico=90000"));
+    assert(configurar_paciencia("empresa=0"));
+    assert(configurar_paciencia("publico=2"));
+    printf("Configuração: OK\n");
+}
+
+void test_desistencias_por_tipo(void) {
+    printf("Testando desistências por tipo de cliente...\n");
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+    for (int i = 1; i <= 3; i++) inserir_cliente(fila, i, PUBLICO);
+    for (int i = 4; i <= 5; i++) inserir_cliente(fila, i, EMPRESA);
+
+    avancar_ms(1000);
+    assert(fila_expirar_desistencias(fila) == 0);
+    assert(fila->tamanho == 5);
+
+    // As empresas não têm limite; o público desiste aos 2 s
+    avancar_ms(1300);
+    assert(fila_expirar_desistencias(fila) == 3);
+    assert(fila->tamanho == 2);
+    assert(fila->frente->cliente.tipo == EMPRESA);
+
+    EstatisticasDesistencia estatisticas;
+    obter_estatisticas_desistencia(fila, &estatisticas);
+    assert(estatisticas.paciencia_s[PUBLICO] == 2.0);
+    assert(estatisticas.paciencia_s[EMPRESA] == 0.0);
+    assert(estatisticas.chegadas[PUBLICO] == 3 && estatisticas.chegadas[EMPRESA] == 2);
+    assert(estatisticas.desistencias[PUBLICO] == 3 && estatisticas.desistencias[EMPRESA] == 0);
+
+    // As vagas dos que desistiram voltam a estar livres
+    for (int i = 6; i < 6 + get_max_fila() - 2; i++) {
+        assert(tentar_inserir_cliente(fila, i, EMPRESA));
+    }
+    assert(!tentar_inserir_cliente(fila, 0, EMPRESA));
+    liberar_fila(fila);
+    printf("Desistências por tipo: OK\n");
+}
+
+void test_devolvido_mantem_chegada(void) {
+    printf("Testando cliente devolvido à fila...\n");
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+    inserir_cliente(fila, 1, PUBLICO);
+
+    avancar_ms(1500);
+    Cliente cliente;
+    assert(retirar_proximo_cliente(fila, &cliente));
+    assert(cliente.id_cliente == 1);
+    devolver_cliente(fila, &cliente);
+    assert(fila->tamanho == 1);
+
+    // O prazo conta desde a chegada original, não desde a devolução
+    avancar_ms(800);
+    assert(fila_expirar_desistencias(fila) == 1);
+    assert(fila->tamanho == 0);
+    liberar_fila(fila);
+    printf("Cliente devolvido: OK\n");
+}
+
+void test_prazo_alem_de_uma_volta(void) {
+    printf("Testando prazo além de uma volta da roda...\n");
+    // 1000 s é mais do que POSICOES_RODA * RESOLUCAO_RODA_MS
+    assert(1000 * 1000 > POSICOES_RODA * RESOLUCAO_RODA_MS);
+    assert(configurar_paciencia("publico=1000"));
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+    inserir_cliente(fila, 1, PUBLICO);
+
+    avancar_ms(500 * 1000);
+    assert(fila_expirar_desistencias(fila) == 0);
+    avancar_ms(400 * 1000);
+    assert(fila_expirar_desistencias(fila) == 0);
+    assert(fila->tamanho == 1);
+    avancar_ms(100 * 1000 + 300);
+    assert(fila_expirar_desistencias(fila) == 1);
+    assert(fila->tamanho == 0);
+    liberar_fila(fila);
+    printf("Prazo longo: OK\n");
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    relogio_configurar(RELOGIO_VIRTUAL, INICIO_SIMULACAO);
+
+    test_configuracao();
+    test_desistencias_por_tipo();
+    test_devolvido_mantem_chegada();
+    test_prazo_alem_de_uma_volta();
+
+    printf("\nTodos os testes de desistências passaram!\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <assert.h>
+#include <sys/stat.h>
+#include "diario.h"
+
+#define NUM_THREADS_TESTE 4
+#define VENDAS_POR_THREAD 5000   // Mais do que um buffer por thread
+#define TOTAL_VENDAS_TESTE (NUM_THREADS_TESTE * VENDAS_POR_THREAD)
+
+static char pasta[] = "/tmp/teste_diarioXXXXXX";
+
+/* Cartões distintos por thread: agencia_id * VENDAS_POR_THREAD + i */
+void* thread_vendas(void* arg) {
+    int agencia = (int)(long)arg;
+    for (int i = 0; i < VENDAS_POR_THREAD; i++) {
+        diario_registar_venda(i, i % 2 ? EMPRESA : PUBLICO, time(NULL),
+                              agencia * VENDAS_POR_THREAD + i, agencia, (Turno)(i % 3));
+    }
+    return NULL;
+}
+
+static long tamanho_ficheiro(const char* caminho) {
+    struct stat st;
+    if (stat(caminho, &st) != 0) return -1;
+    return (long)st.st_size;
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    assert(mkdtemp(pasta));
+    char diario[256], prefixo[256], caminho[512];
+    snprintf(diario, sizeof(diario), "%s/vendas.diario", pasta);
+    snprintf(prefixo, sizeof(prefixo), "%s/vendas", pasta);
+
+    printf("Testando diário fechado...\n");
+    assert(!diario_ativo());
+    diario_registar_venda(1, EMPRESA, time(NULL), 1, 1, MANHA);
+    assert(diario_total_registos() == 0);
+    printf("Diário fechado: OK\n");
+
+    printf("Testando registo concorrente...\n");
+    assert(diario_abrir(diario));
+    assert(diario_ativo());
+    pthread_t threads[NUM_THREADS_TESTE];
+    for (int i = 0; i < NUM_THREADS_TESTE; i++) {
+        pthread_create(&threads[i], NULL, thread_vendas, (void*)(long)i);
+    }
+    for (int i = 0; i < NUM_THREADS_TESTE; i++) pthread_join(threads[i], NULL);
+    diario_fechar();
+    assert(!diario_ativo());
+
+    assert(diario_total_registos() == TOTAL_VENDAS_TESTE);
+    assert(tamanho_ficheiro(diario) ==
+           (long)sizeof(CabecalhoDiario) + TOTAL_VENDAS_TESTE * (long)sizeof(RegistoVenda));
+    printf("Registo concorrente: OK\n");
+
+    printf("Testando exportação por colunas...\n");
+    assert(exportar_diario_colunar(diario, prefixo) == TOTAL_VENDAS_TESTE);
+
+    // Cada cartão aparece uma vez, e o cliente e o tipo correspondem-lhe
+    snprintf(caminho, sizeof(caminho), "%s.cartao_id.col", prefixo);
+    assert(tamanho_ficheiro(caminho) == TOTAL_VENDAS_TESTE * 4L);
+    FILE* cartoes = fopen(caminho, "rb");
+    snprintf(caminho, sizeof(caminho), "%s.cliente_id.col", prefixo);
+    FILE* clientes = fopen(caminho, "rb");
+    snprintf(caminho, sizeof(caminho), "%s.tipo.col", prefixo);
+    assert(tamanho_ficheiro(caminho) == TOTAL_VENDAS_TESTE);
+    FILE* tipos = fopen(caminho, "rb");
+    assert(cartoes && clientes && tipos);
+
+    char* visto = (char*)calloc(TOTAL_VENDAS_TESTE, 1);
+    for (int i = 0; i < TOTAL_VENDAS_TESTE; i++) {
+        int32_t cartao, cliente;
+        uint8_t tipo;
+        assert(fread(&cartao, sizeof(cartao), 1, cartoes) == 1);
+        assert(fread(&cliente, sizeof(cliente), 1, clientes) == 1);
+        assert(fread(&tipo, sizeof(tipo), 1, tipos) == 1);
+        assert(cartao >= 0 && cartao < TOTAL_VENDAS_TESTE && !visto[cartao]);
+        visto[cartao] = 1;
+        assert(cliente == cartao % VENDAS_POR_THREAD);
+        assert(tipo == (cliente % 2 ? EMPRESA : PUBLICO));
+    }
+    free(visto);
+    fclose(cartoes);
+    fclose(clientes);
+    fclose(tipos);
+
+    snprintf(caminho, sizeof(caminho), "%s.colunas.txt", prefixo);
+    FILE* manifesto = fopen(caminho, "r");
+    assert(manifesto);
+    long long registos = 0;
+    assert(fscanf(manifesto, "registos,%lld", &registos) == 1);
+    assert(registos == TOTAL_VENDAS_TESTE);
+    fclose(manifesto);
+    printf("Exportação: OK\n");
+
+    printf("Testando ficheiro inválido...\n");
+    snprintf(caminho, sizeof(caminho), "%s.colunas.txt", prefixo);
+    assert(exportar_diario_colunar(caminho, prefixo) == -1);
+    printf("Ficheiro inválido: OK\n");
+
+    char comando[300];
+    snprintf(comando, sizeof(comando), "rm -rf %s", pasta);
+    assert(system(comando) == 0);
+    printf("\nTodos os testes do diário passaram!\n");
+    return 0;
+}
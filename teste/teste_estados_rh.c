@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "contratacoes.h"
+
+#define NUM_CANCELADOS 10
+#define NUM_LEITORES 4
+
+static atomic_int leitura_ativa = 1;
+static atomic_int leituras_invalidas = 0;
+static atomic_long leituras = 0;
+
+static int somar_estados(void) {
+    int contagem[NUM_ESTADOS_PROCESSO];
+    obter_contagem_estados(contagem);
+    int soma = 0;
+    for (int e = 0; e < NUM_ESTADOS_PROCESSO; e++) soma += contagem[e];
+    return soma;
+}
+
+/* Leituras sem o mutex enquanto os processos mudam de estado */
+static void* ler_contagens(void* arg) {
+    int total = *(int*)arg;
+    while (atomic_load(&leitura_ativa)) {
+        int contagem[NUM_ESTADOS_PROCESSO];
+        obter_contagem_estados(contagem);
+        for (int e = 0; e < NUM_ESTADOS_PROCESSO; e++) {
+            if (contagem[e] < 0 || contagem[e] > total) atomic_fetch_add(&leituras_invalidas, 1);
+        }
+        int ativos = get_processos_ativos();
+        if (ativos < 0 || ativos > LIMITE_PROCESSOS_SIMULTANEOS) {
+            atomic_fetch_add(&leituras_invalidas, 1);
+        }
+        atomic_fetch_add(&leituras, 1);
+    }
+    return NULL;
+}
+
+void test_limite_simultaneos(void) {
+    printf("Testando limite de processos simultâneos...\n");
+    for (int i = 0; i < LIMITE_PROCESSOS_SIMULTANEOS; i++) {
+        iniciar_processo_contratacao("Candidato Teste", "Vendedor", 1000.0f);
+    }
+    assert(get_processos_ativos() == LIMITE_PROCESSOS_SIMULTANEOS);
+    iniciar_processo_contratacao("Candidato Extra", "Vendedor", 1000.0f);
+    assert(somar_estados() == LIMITE_PROCESSOS_SIMULTANEOS);
+
+    // Processos terminados libertam lugar; cancelar outra vez não conta
+    for (int id = 1; id <= NUM_CANCELADOS; id++) cancelar_processo(id);
+    cancelar_processo(1);
+    int contagem[NUM_ESTADOS_PROCESSO];
+    obter_contagem_estados(contagem);
+    assert(contagem[CANCELADO] == NUM_CANCELADOS);
+    assert(get_processos_ativos() == LIMITE_PROCESSOS_SIMULTANEOS - NUM_CANCELADOS);
+
+    for (int i = 0; i < NUM_CANCELADOS; i++) {
+        iniciar_processo_contratacao("Candidato Teste", "Vendedor", 1000.0f);
+    }
+    assert(get_processos_ativos() == LIMITE_PROCESSOS_SIMULTANEOS);
+    iniciar_processo_contratacao("Candidato Extra", "Vendedor", 1000.0f);
+    assert(somar_estados() == LIMITE_PROCESSOS_SIMULTANEOS + NUM_CANCELADOS);
+    printf("Limite de simultâneos: OK\n");
+}
+
+void test_leituras_concorrentes(void) {
+    printf("Testando leituras das contagens sem o mutex...\n");
+    int total = LIMITE_PROCESSOS_SIMULTANEOS + NUM_CANCELADOS;
+    pthread_t leitores[NUM_LEITORES];
+    for (int i = 0; i < NUM_LEITORES; i++) {
+        assert(pthread_create(&leitores[i], NULL, ler_contagens, &total) == 0);
+    }
+
+    while (atomic_load(&leituras) < 1000) sched_yield();
+
+    // Metade rejeitada, metade cancelada, entre as leituras
+    for (int id = NUM_CANCELADOS + 1; id <= total; id++) {
+        if (id % 2 == 0) rejeitar_processo(id);
+        else cancelar_processo(id);
+    }
+
+    atomic_store(&leitura_ativa, 0);
+    for (int i = 0; i < NUM_LEITORES; i++) pthread_join(leitores[i], NULL);
+    printf("   %ld leituras, %d inválidas\n", atomic_load(&leituras),
+           atomic_load(&leituras_invalidas));
+    assert(atomic_load(&leituras_invalidas) == 0);
+
+    int contagem[NUM_ESTADOS_PROCESSO];
+    obter_contagem_estados(contagem);
+    assert(get_processos_ativos() == 0);
+    assert(contagem[REJEITADO] == (total - NUM_CANCELADOS) / 2);
+    assert(contagem[CANCELADO] == total - contagem[REJEITADO]);
+    assert(somar_estados() == total);
+    printf("Leituras concorrentes: OK\n");
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    inicializar_sistema_rh();
+
+    test_limite_simultaneos();
+    test_leituras_concorrentes();
+
+    // Como em teste_indice_rh: o processo termina sem encerrar_sistema_rh
+    printf("\nTodos os testes das contagens por estado passaram!\n");
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include "estoque.h"
+
+#define NUM_FRAGMENTOS_TESTE 4
+#define NUM_VENDEDORES 4
+#define NUM_REPOSICOES 20
+#define LOTE_REPOSICAO_TESTE 25
+
+static atomic_int vendas_por_cartao[MAX_CARTOES];
+static atomic_int reposicao_terminada = 0;
+static atomic_int cartoes_repostos = 0;
+
+static void registar_venda(int id) {
+    assert(id >= 0 && id < estoque_total());
+    atomic_fetch_add(&vendas_por_cartao[id], 1);
+}
+
+/* Cada vendedor reserva do seu fragmento; com o fragmento vazio tenta
+ * o estoque todo, até a reposição acabar e não sobrar nada */
+void* thread_vendedor(void* arg) {
+    int fragmento = (int)(long)arg;
+    int vendidos = 0;
+
+    while (1) {
+        int id = reservar_cartao_fragmento(fragmento);
+        if (id == -1) id = reservar_proximo_cartao();
+        if (id != -1) {
+            registar_venda(id);
+            vendidos++;
+            continue;
+        }
+        if (atomic_load(&reposicao_terminada) && estoque_disponivel() == 0) break;
+        usleep(100);
+    }
+
+    printf(">>> THREAD: Vendedor do fragmento %d vendeu %d cartões\n", fragmento, vendidos);
+    return NULL;
+}
+
+/* Reserva sempre o último cartão publicado: cai em lotes acabados de
+ * publicar e ainda sem a fatia entregue à pilha do fragmento */
+void* thread_reserva_especifica(void* arg) {
+    (void)arg;
+    int vendidos = 0;
+
+    while (!atomic_load(&reposicao_terminada)) {
+        int id = estoque_total() - 1;
+        if (reservar_cartao_especifico(id)) {
+            registar_venda(id);
+            vendidos++;
+        }
+    }
+
+    printf(">>> THREAD: Reserva específica vendeu %d cartões\n", vendidos);
+    return NULL;
+}
+
+void* thread_reposicao(void* arg) {
+    (void)arg;
+
+    for (int i = 0; i < NUM_REPOSICOES; i++) {
+        atomic_fetch_add(&cartoes_repostos, reabastecer_estoque(LOTE_REPOSICAO_TESTE));
+        rebalancear_estoque();
+        usleep(1000);
+    }
+
+    atomic_store(&reposicao_terminada, 1);
+    return NULL;
+}
+
+void test_reserva_e_reposicao(void) {
+    printf("Testando reserva fragmentada com reposição concorrente...\n");
+
+    inicializar_estoque_fragmentado(NUM_FRAGMENTOS_TESTE);
+    assert(get_num_fragmentos_estoque() == NUM_FRAGMENTOS_TESTE);
+    assert(estoque_disponivel() == TOTAL_CARTOES);
+
+    pthread_t vendedores[NUM_VENDEDORES];
+    pthread_t especifica, reposicao;
+
+    for (int i = 0; i < NUM_VENDEDORES; i++) {
+        pthread_create(&vendedores[i], NULL, thread_vendedor, (void*)(long)i);
+    }
+    pthread_create(&especifica, NULL, thread_reserva_especifica, NULL);
+    pthread_create(&reposicao, NULL, thread_reposicao, NULL);
+
+    pthread_join(reposicao, NULL);
+    pthread_join(especifica, NULL);
+    for (int i = 0; i < NUM_VENDEDORES; i++) {
+        pthread_join(vendedores[i], NULL);
+    }
+
+    // Nenhum cartão se perdeu nem foi vendido duas vezes
+    int total = estoque_total();
+    assert(total == TOTAL_CARTOES + atomic_load(&cartoes_repostos));
+    for (int id = 0; id < total; id++) {
+        assert(atomic_load(&vendas_por_cartao[id]) == 1);
+    }
+    assert(estoque_vendido() == total);
+    assert(estoque_disponivel() == 0);
+    assert(estoque_retido() == 0);
+    assert(estoque_esgotado());
+
+    printf("   %d cartões (%d repostos) vendidos uma única vez\n",
+           total, atomic_load(&cartoes_repostos));
+    printf("Reserva e reposição: OK\n");
+
+    liberar_estoque();
+}
+
+int main() {
+    setbuf(stdout, NULL);
+
+    printf("=== TESTE DO ESTOQUE FRAGMENTADO ===\n\n");
+    test_reserva_e_reposicao();
+    printf("\n=== TODOS OS TESTES PASSARAM ===\n");
+    return 0;
+}
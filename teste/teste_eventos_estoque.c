@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "estoque.h"
+
+/* Lê todos os eventos a partir de 'seq' e confere tipo e cartão */
+static void conferir_eventos(unsigned long long* seq, TipoEventoEstoque tipo, int cartao_id) {
+    EventoEstoque eventos[4];
+    int n = estoque_eventos_desde(*seq, eventos, 4, seq);
+    assert(n == 1);
+    assert(eventos[0].tipo == tipo);
+    assert(eventos[0].cartao_id == cartao_id);
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    inicializar_estoque();
+
+    printf("Testando eventos de venda, retenção e liberação...\n");
+    unsigned long long seq = estoque_seq_atual();
+
+    int vendido = reservar_proximo_cartao();
+    assert(vendido != -1);
+    conferir_eventos(&seq, EVENTO_VENDA, vendido);
+
+    int retido = reter_proximo_cartao(TTL_RETENCAO_PADRAO);
+    assert(retido != -1);
+    conferir_eventos(&seq, EVENTO_RETENCAO, retido);
+
+    assert(cancelar_retencao(retido));
+    conferir_eventos(&seq, EVENTO_FIM_RETENCAO, retido);
+
+    assert(liberar_cartao(vendido));
+    conferir_eventos(&seq, EVENTO_LIBERACAO, vendido);
+
+    EventoEstoque eventos[4];
+    assert(estoque_eventos_desde(seq, eventos, 4, &seq) == 0);
+    printf("Eventos por operação: OK\n");
+
+    printf("Testando reposição em lote...\n");
+    assert(reabastecer_estoque(10) == 10);
+    EventoEstoque lote[16];
+    int n = estoque_eventos_desde(seq, lote, 16, &seq);
+    assert(n == 10);
+    for (int i = 0; i < n; i++) {
+        assert(lote[i].tipo == EVENTO_REPOSICAO);
+        assert(lote[i].seq == seq - n + i);
+    }
+    printf("Reposição: OK\n");
+
+    printf("Testando consumidor atrasado...\n");
+    unsigned long long antigo = seq;
+    for (int i = 0; i < CAPACIDADE_EVENTOS_ESTOQUE; i++) {
+        int id = reservar_proximo_cartao();
+        assert(id != -1);
+        assert(liberar_cartao(id));
+    }
+    // Os eventos de 'antigo' já foram sobrescritos: o consumidor reconstrói
+    assert(estoque_eventos_desde(antigo, lote, 16, NULL) == -1);
+    // Um seq no futuro também é rejeitado
+    assert(estoque_eventos_desde(estoque_seq_atual() + 1, lote, 16, NULL) == -1);
+    printf("Consumidor atrasado: OK\n");
+
+    liberar_estoque();
+    printf("\nTodos os testes de eventos passaram!\n");
+    return 0;
+}
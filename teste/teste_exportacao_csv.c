@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <semaphore.h>
+#include "estoque.h"
+#include "Fila_prioridade.h"
+#include "vendas.h"
+
+#define NUM_AGENCIAS_TESTE 1000
+
+static char pasta[] = "/tmp/teste_exportacaoXXXXXX";
+static sem_t callback_chamado;
+static sem_t libertar_callback;
+static int ultimo_sucesso = -1;
+static int ultimas_linhas = -1;
+
+/* O primeiro callback fica preso até o teste o libertar */
+static void callback_exportacao(const char* ficheiro, int sucesso, int linhas, void* arg) {
+    (void)ficheiro;
+    ultimo_sucesso = sucesso;
+    ultimas_linhas = linhas;
+    sem_post(&callback_chamado);
+    if (arg) sem_wait(&libertar_callback);
+}
+
+/* Total de vendas escrito nas estatísticas gerais do CSV */
+static int total_no_csv(const char* caminho) {
+    FILE* f = fopen(caminho, "r");
+    assert(f);
+    char linha[256];
+    int total = -1, agencias = 0;
+    while (fgets(linha, sizeof(linha), f)) {
+        if (sscanf(linha, "# Total Vendas,%d", &total) == 1) continue;
+        if (linha[0] >= '1' && linha[0] <= '9') agencias++;
+    }
+    fclose(f);
+    assert(agencias == NUM_AGENCIAS_TESTE);
+    return total;
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    assert(mkdtemp(pasta));
+    sem_init(&callback_chamado, 0, 0);
+    sem_init(&libertar_callback, 0, 0);
+    char primeiro[256], segundo[256], invalido[256];
+    snprintf(primeiro, sizeof(primeiro), "%s/primeiro.csv", pasta);
+    snprintf(segundo, sizeof(segundo), "%s/segundo.csv", pasta);
+    snprintf(invalido, sizeof(invalido), "%s/sem_pasta/vendas.csv", pasta);
+
+    inicializar_estoque();
+    FilaPrioridade* fila = inicializar_fila();
+    definir_num_agencias(NUM_AGENCIAS_TESTE);
+    inicializar_sistema_vendas(fila);
+    for (int i = 0; i < 10; i++) contabilizar_venda(EMPRESA, MANHA);
+
+    printf("Testando instantâneo em segundo plano...\n");
+    assert(exportar_vendas_csv_async(primeiro, callback_exportacao, (void*)1));
+    // Vendas depois do pedido não entram no instantâneo
+    for (int i = 0; i < 5; i++) contabilizar_venda(PUBLICO, MANHA);
+    sem_wait(&callback_chamado);
+    assert(ultimo_sucesso == 1);
+    assert(ultimas_linhas == NUM_AGENCIAS_TESTE);
+    assert(total_no_csv(primeiro) == 10);
+    printf("Instantâneo: OK\n");
+
+    printf("Testando pedidos com o exportador ocupado...\n");
+    // O exportador está no callback: este fica pendente e o seguinte é recusado
+    assert(exportar_vendas_csv_async(segundo, callback_exportacao, NULL));
+    assert(!exportar_vendas_csv_async(segundo, callback_exportacao, NULL));
+    EstadoExportacao estado;
+    obter_estado_exportacao(&estado);
+    assert(estado.em_curso);
+    sem_post(&libertar_callback);
+    sem_wait(&callback_chamado);
+    aguardar_exportacoes();
+    assert(total_no_csv(segundo) == 15);
+    printf("Exportador ocupado: OK\n");
+
+    printf("Testando falhas...\n");
+    char longo[400];
+    memset(longo, 'x', sizeof(longo) - 1);
+    longo[sizeof(longo) - 1] = '\0';
+    assert(!exportar_vendas_csv_async(longo, NULL, NULL));
+    assert(!exportar_vendas_csv_async(NULL, NULL, NULL));
+
+    assert(exportar_vendas_csv_async(invalido, callback_exportacao, NULL));
+    sem_wait(&callback_chamado);
+    aguardar_exportacoes();
+    assert(ultimo_sucesso == 0);
+
+    obter_estado_exportacao(&estado);
+    assert(!estado.em_curso);
+    assert(estado.concluidas == 2);
+    assert(estado.falhadas == 1);
+    assert(!estado.ultimo_sucesso);
+    printf("Falhas: OK\n");
+
+    parar_exportador_vendas();
+    liberar_fila(fila);
+    liberar_estoque();
+
+    char comando[300];
+    snprintf(comando, sizeof(comando), "rm -rf %s", pasta);
+    assert(system(comando) == 0);
+    printf("\nTodos os testes de exportação passaram!\n");
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include "fibras.h"
+#include "relogio.h"
+#include "estoque.h"
+#include "Fila_prioridade.h"
+#include "vendas.h"
+
+#define NUM_FIBRAS_TESTE 200
+#define NUM_AGENCIAS_TESTE 48
+#define NUM_CLIENTES_TESTE 40
+
+static FilaEsperaFibras fila_teste = FILA_ESPERA_FIBRAS_INICIALIZADOR;
+static atomic_int avisadas = 0;
+static atomic_int atrasadas = 0;
+static atomic_int cedencias = 0;
+
+static void fibra_a_espera(void* arg) {
+    (void)arg;
+    // Prazo longo: só o aviso as deve acordar
+    long long prazo = relogio_agora_ns() + 10LL * NS_POR_SEGUNDO;
+    if (fibra_esperar(&fila_teste, prazo)) atomic_fetch_add(&avisadas, 1);
+}
+
+static void fibra_adormecida(void* arg) {
+    long long instante = relogio_agora_ns() + (long long)(size_t)arg * 1000000LL;
+    fibra_dormir_ate(instante);
+    if (relogio_agora_ns() < instante) atomic_fetch_add(&atrasadas, 1);
+    for (int i = 0; i < 10; i++) {
+        fibra_ceder();
+        atomic_fetch_add(&cedencias, 1);
+    }
+}
+
+static void aguardar_fibras_terminadas(void) {
+    for (int espera = 0; espera < 500 && fibras_vivas() > 0; espera++) usleep(10000);
+    assert(fibras_vivas() == 0);
+}
+
+void test_primitivas(void) {
+    printf("Testando esperas e avisos entre fibras...\n");
+    assert(fibras_iniciar(2, PILHA_FIBRA_PADRAO) == 2);
+    assert(fibras_iniciar(2, PILHA_FIBRA_PADRAO) == 0);   // Já iniciadas
+
+    for (int i = 0; i < NUM_FIBRAS_TESTE; i++) assert(fibra_criar(fibra_a_espera, NULL));
+    for (int espera = 0; espera < 500 && atomic_load(&fila_teste.em_espera) < NUM_FIBRAS_TESTE; espera++) {
+        usleep(10000);
+    }
+    assert(atomic_load(&fila_teste.em_espera) == NUM_FIBRAS_TESTE);
+    assert(fibras_vivas() == NUM_FIBRAS_TESTE);
+
+    assert(fibras_acordar_uma(&fila_teste) == 1);
+    fibras_acordar_todas(&fila_teste);
+    assert(fibras_acordar_uma(&fila_teste) == 0);
+    aguardar_fibras_terminadas();
+    assert(atomic_load(&avisadas) == NUM_FIBRAS_TESTE);
+    printf("Avisos: OK\n");
+
+    printf("Testando prazos e cedências...\n");
+    for (size_t i = 0; i < NUM_FIBRAS_TESTE; i++) {
+        assert(fibra_criar(fibra_adormecida, (void*)(i % 50)));
+    }
+    aguardar_fibras_terminadas();
+    assert(atomic_load(&atrasadas) == 0);
+    assert(atomic_load(&cedencias) == NUM_FIBRAS_TESTE * 10);
+    fibras_aguardar();
+    assert(!fibra_criar(fibra_adormecida, NULL));   // Portadoras já juntas
+    printf("Prazos e cedências: OK\n");
+}
+
+void test_agencias_em_fibras(void) {
+    printf("Testando vendas com agências em fibras...\n");
+    inicializar_estoque();
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+
+    definir_agencias_fibras(1);
+    definir_num_agencias(NUM_AGENCIAS_TESTE);
+    inicializar_sistema_vendas(fila);
+    for (int i = 1; i <= NUM_CLIENTES_TESTE; i++) {
+        inserir_cliente(fila, i, i % 4 == 0 ? EMPRESA : PUBLICO);
+    }
+
+    // Como no pool: só muitas agências a correr juntas atendem todos a tempo
+    long duracao[3] = {300, 300, 300};
+    int limites[3] = {NUM_CLIENTES_TESTE, NUM_CLIENTES_TESTE, NUM_CLIENTES_TESTE};
+    configurar_turnos(duracao, limites);
+    iniciar_vendas_concorrentes(MANHA);
+
+    int soma_agencias = 0;
+    for (int i = 0; i < get_num_agencias(); i++) {
+        assert(agencias[i].vendas_realizadas <= 1);
+        soma_agencias += agencias[i].vendas_realizadas;
+    }
+    assert(get_vendas_totais() == NUM_CLIENTES_TESTE);
+    assert(soma_agencias == NUM_CLIENTES_TESTE);
+    assert(estoque_vendido() == NUM_CLIENTES_TESTE);
+    assert(fila->tamanho == 0);
+    assert(get_agencias_ativas() == 0);
+    assert(fibras_vivas() == 0);
+    definir_agencias_fibras(0);
+
+    liberar_fila(fila);
+    liberar_estoque();
+    printf("Agências em fibras: OK\n");
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    test_primitivas();
+    test_agencias_em_fibras();
+    printf("\nTodos os testes das fibras passaram!\n");
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <assert.h>
+#include "Fila_prioridade.h"
+#include "gerador.h"
+#include "relogio.h"
+
+#define TAXA_PUBLICO 20000.0
+#define TAXA_EMPRESA 2000.0
+#define DURACAO_TESTE_MS 500
+
+int main() {
+    setbuf(stdout, NULL);
+
+    printf("Testando especificações inválidas...\n");
+    assert(!configurar_gerador(NULL));
+    assert(!configurar_gerador("publico"));
+    assert(!configurar_gerador("publico=poisson"));
+    assert(!configurar_gerador("turistas=poisson:10"));
+    assert(!configurar_gerador("publico=uniforme:10"));
+    assert(!configurar_gerador("publico=poisson:0"));
+    assert(!configurar_gerador("publico=poisson:10x"));
+    assert(!configurar_gerador("publico=poisson:10:0"));
+    assert(!configurar_gerador("publico=poisson:10:99"));
+    assert(!gerador_configurado());
+    printf("Especificações inválidas: OK\n");
+
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+    assert(!iniciar_gerador(fila));   // Nada configurado
+
+    assert(configurar_gerador("publico=poisson:20000:2"));
+    assert(configurar_gerador("empresa=rajadas:2000"));
+    assert(gerador_configurado());
+
+    printf("Testando recusa no modo virtual...\n");
+    relogio_configurar(RELOGIO_VIRTUAL, 0);
+    assert(!iniciar_gerador(fila));
+    relogio_configurar(RELOGIO_REAL, 0);
+    printf("Modo virtual: OK\n");
+
+    printf("Testando saturação da fila...\n");
+    assert(iniciar_gerador(fila));
+    assert(!iniciar_gerador(fila));   // Já em execução
+    usleep(DURACAO_TESTE_MS * 1000);
+    parar_gerador();
+
+    EstatisticasGerador est;
+    obter_estatisticas_gerador(&est);
+    long long oferecidas = 0, aceites = 0;
+    for (int t = 0; t < 2; t++) {
+        ContagemChegadas* c = &est.por_tipo[t];
+        assert(c->oferecidas == c->aceites + c->recusadas);
+        oferecidas += c->oferecidas;
+        aceites += c->aceites;
+    }
+    // Ninguém vende: entram MAX_FILA clientes e as restantes chegadas são recusadas
+    assert(aceites == MAX_FILA);
+    assert(fila->tamanho == MAX_FILA);
+    assert(est.duracao_s >= DURACAO_TESTE_MS / 1000.0);
+
+    // O público chega à taxa pedida (margem larga para máquinas lentas)
+    double esperado = TAXA_PUBLICO * est.duracao_s;
+    assert(est.por_tipo[PUBLICO].oferecidas > esperado / 2);
+    assert(est.por_tipo[PUBLICO].oferecidas < esperado * 2);
+    assert(est.por_tipo[EMPRESA].oferecidas > 0);
+    printf("   %lld chegadas em %.2fs, %lld aceites\n", oferecidas, est.duracao_s, aceites);
+    printf("Saturação: OK\n");
+
+    parar_gerador();   // Segunda paragem não faz nada
+    liberar_fila(fila);
+    printf("\nTodos os testes do gerador passaram!\n");
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "contratacoes.h"
+
+#define NUM_CONTRATADOS 200   // Acima de CAPACIDADE_INICIAL_INDICE_RH: o índice cresce
+
+void test_contratacoes_e_demissoes(void) {
+    printf("Testando índice de contratados...\n");
+
+    // Sem processos em curso nenhuma thread do RH mexe nos contratados
+    for (int id = 1; id <= NUM_CONTRATADOS; id++) {
+        assert(adicionar_contratado(id, "Funcionario Teste", "Vendedor", 50000.0f) == 1);
+    }
+    assert(get_total_contratacoes() == NUM_CONTRATADOS);
+    assert(get_funcionarios_ativos() == NUM_CONTRATADOS);
+
+    // Demitir os ímpares, do último para o primeiro (fora da ordem da lista)
+    for (int id = NUM_CONTRATADOS - 1; id >= 1; id -= 2) {
+        demitir_funcionario(id);
+    }
+    assert(get_total_demissoes() == NUM_CONTRATADOS / 2);
+    assert(get_funcionarios_ativos() == NUM_CONTRATADOS / 2);
+
+    // Já demitido ou inexistente: nada muda
+    demitir_funcionario(1);
+    demitir_funcionario(NUM_CONTRATADOS + 1);
+    assert(get_total_demissoes() == NUM_CONTRATADOS / 2);
+
+    // Os pares continuam a ser encontrados pelo índice
+    for (int id = 2; id <= NUM_CONTRATADOS; id += 2) {
+        demitir_funcionario(id);
+    }
+    assert(get_total_demissoes() == NUM_CONTRATADOS);
+    assert(get_funcionarios_ativos() == 0);
+
+    printf("Contratados: OK\n");
+}
+
+void test_processos(void) {
+    printf("Testando índice de processos...\n");
+
+    int estados[NUM_ESTADOS_PROCESSO];
+    iniciar_processo_contratacao("Candidato A", "Vendedor", 40000.0f);
+    iniciar_processo_contratacao("Candidato B", "Técnico", 45000.0f);
+    iniciar_processo_contratacao("Candidato C", "Gerente", 60000.0f);
+
+    obter_contagem_estados(estados);
+    assert(estados[PENDENTE] == 3);
+
+    cancelar_processo(2);
+    rejeitar_processo(3);
+    rejeitar_processo(99);     // Inexistente
+    concluir_contratacao(1);   // Ainda não aprovado
+
+    obter_contagem_estados(estados);
+    assert(estados[PENDENTE] == 1);
+    assert(estados[CANCELADO] == 1);
+    assert(estados[REJEITADO] == 1);
+    assert(estados[CONTRATADO] == 0);
+    assert(get_processos_ativos() == 1);
+
+    printf("Processos: OK\n");
+}
+
+int main() {
+    setbuf(stdout, NULL);
+
+    printf("=== TESTE DOS ÍNDICES DO RH ===\n\n");
+    inicializar_sistema_rh();
+
+    test_contratacoes_e_demissoes();
+    test_processos();
+
+    // Sem encerrar_sistema_rh: o timer de exibição só pára ao fim do
+    // intervalo (INTERVALO_EXIBICAO); a saída do processo liberta tudo
+    printf("\n=== TODOS OS TESTES PASSARAM ===\n");
+    return 0;
+}
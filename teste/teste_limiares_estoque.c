@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <assert.h>
+#include "estoque.h"
+
+#define NUM_LIMIARES_TESTE 12
+
+static int descidas[NUM_LIMIARES_TESTE];
+static int subidas[NUM_LIMIARES_TESTE];
+
+static void contar_cruzamento(int limiar, int disponiveis, int descendo, void* arg) {
+    int i = (int)(long)arg;
+    assert(descendo ? disponiveis <= limiar : disponiveis > limiar);
+    if (descendo) descidas[i]++;
+    else subidas[i]++;
+}
+
+/* Vende tudo o que houver, devagar, para acordar quem espera pelo zero */
+void* thread_esgotar(void* arg) {
+    (void)arg;
+    usleep(50000);
+    while (reservar_proximo_cartao() != -1) {}
+    return NULL;
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    inicializar_estoque();
+
+    printf("Testando callbacks de limiar...\n");
+    int ids[NUM_LIMIARES_TESTE];
+    for (int i = 0; i < NUM_LIMIARES_TESTE; i++) {
+        // 110, 120, ... acima dos TOTAL_CARTOES iniciais
+        ids[i] = estoque_registrar_limiar(TOTAL_CARTOES + 10 * (i + 1), contar_cruzamento, (void*)(long)i);
+        assert(ids[i] >= 0);
+    }
+
+    // Uma só reposição cruza todos os limiares a subir
+    assert(reabastecer_estoque(10 * NUM_LIMIARES_TESTE + 5) == 10 * NUM_LIMIARES_TESTE + 5);
+    for (int i = 0; i < NUM_LIMIARES_TESTE; i++) {
+        assert(subidas[i] == 1);
+        assert(descidas[i] == 0);
+    }
+
+    // Descer um cartão de cada vez: cada limiar cruzado uma vez a descer
+    int total = estoque_disponivel();
+    for (int i = 0; i < total - TOTAL_CARTOES; i++) {
+        assert(reservar_proximo_cartao() != -1);
+    }
+    for (int i = 0; i < NUM_LIMIARES_TESTE; i++) {
+        assert(subidas[i] == 1);
+        assert(descidas[i] == 1);
+    }
+    printf("Callbacks: OK\n");
+
+    printf("Testando remoção de limiares...\n");
+    for (int i = 0; i < NUM_LIMIARES_TESTE; i++) estoque_remover_limiar(ids[i]);
+    assert(reabastecer_estoque(10 * NUM_LIMIARES_TESTE + 5) > 0);
+    for (int i = 0; i < NUM_LIMIARES_TESTE; i++) assert(subidas[i] == 1);
+    printf("Remoção: OK\n");
+
+    printf("Testando espera por limiar...\n");
+    // Já satisfeito: retorna logo
+    assert(estoque_aguardar_limiar(0, 1, 0) == 1);
+    // Não vai acontecer: timeout
+    assert(estoque_aguardar_limiar(1000000, 1, 50) == 0);
+
+    pthread_t t;
+    pthread_create(&t, NULL, thread_esgotar, NULL);
+    assert(estoque_aguardar_limiar(0, 0, 5000) == 1);
+    pthread_join(t, NULL);
+    assert(estoque_esgotado());
+
+    // Sem slots livres, a espera é recusada sem bloquear
+    for (int i = 0; i < MAX_LIMIARES_ESTOQUE; i++) {
+        assert(estoque_registrar_limiar(i, NULL, NULL) >= 0);
+    }
+    assert(estoque_registrar_limiar(0, NULL, NULL) == -1);
+    assert(estoque_aguardar_limiar(5, 1, -1) == -1);
+    printf("Espera: OK\n");
+
+    liberar_estoque();
+    printf("\nTodos os testes de limiares passaram!\n");
+    return 0;
+}
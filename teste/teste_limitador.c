@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "relogio.h"
+#include "limitador.h"
+#include "Fila_prioridade.h"
+
+#define INICIO_SIMULACAO 1700000000
+#define NUM_THREADS_TESTE 8
+#define PEDIDOS_POR_THREAD 1000
+#define RAJADA_CONCORRENTE 50
+
+static void avancar_ms(long ms) {
+    relogio_avancar_ate(relogio_agora_ns() + ms * 1000000LL);
+}
+
+void test_configuracao(void) {
+    printf("Testando configuração dos limites...\n");
+    assert(!configurar_limite(NULL));
+    assert(!configurar_limite("entrada"));
+    assert(!configurar_limite("saida:publico=1"));
+    assert(!configurar_limite("entrada:cliente=1"));
+    assert(!configurar_limite("entrada:publico=-1"));
+    assert(!configurar_limite("entrada:publico=5:0"));
+    assert(!configurar_limite("entrada:publico=5x"));
+    assert(!limite_ativo(LIMITE_ENTRADA, PUBLICO));
+
+    assert(configurar_limite("entrada:publico=10:3"));
+    assert(limite_ativo(LIMITE_ENTRADA, PUBLICO));
+    assert(!limite_ativo(LIMITE_ENTRADA, EMPRESA));
+    assert(!limite_ativo(LIMITE_ATENDIMENTO, PUBLICO));
+
+    EstatisticasLimites estatisticas;
+    obter_estatisticas_limites(&estatisticas);
+    assert(estatisticas.etapa[LIMITE_ENTRADA][PUBLICO].taxa == 10.0);
+    assert(estatisticas.etapa[LIMITE_ENTRADA][PUBLICO].rajada == 3);
+    printf("Configuração: OK\n");
+}
+
+void test_balde(void) {
+    printf("Testando rajada e reposição de fichas...\n");
+    // Continua o limite de 10/s com rajada 3 configurado acima
+    for (int i = 0; i < 3; i++) assert(limite_permitir(LIMITE_ENTRADA, PUBLICO));
+    assert(!limite_permitir(LIMITE_ENTRADA, PUBLICO));
+    assert(limite_permitir(LIMITE_ENTRADA, EMPRESA));   // Sem limite
+
+    avancar_ms(100);
+    assert(limite_permitir(LIMITE_ENTRADA, PUBLICO));
+    assert(!limite_permitir(LIMITE_ENTRADA, PUBLICO));
+
+    // Uma pausa longa não acumula mais do que a rajada
+    avancar_ms(5000);
+    for (int i = 0; i < 3; i++) assert(limite_permitir(LIMITE_ENTRADA, PUBLICO));
+    assert(!limite_permitir(LIMITE_ENTRADA, PUBLICO));
+
+    EstatisticasLimites estatisticas;
+    obter_estatisticas_limites(&estatisticas);
+    assert(estatisticas.etapa[LIMITE_ENTRADA][PUBLICO].aceites == 7);
+    assert(estatisticas.etapa[LIMITE_ENTRADA][PUBLICO].recusados == 3);
+    assert(estatisticas.etapa[LIMITE_ENTRADA][EMPRESA].aceites == 0);
+    printf("Balde de fichas: OK\n");
+
+    printf("Testando devolução de fichas...\n");
+    limite_devolver(LIMITE_ENTRADA, PUBLICO);
+    assert(limite_permitir(LIMITE_ENTRADA, PUBLICO));
+    assert(!limite_permitir(LIMITE_ENTRADA, PUBLICO));
+
+    // Com o balde cheio não há nada a devolver
+    avancar_ms(5000);
+    limite_devolver(LIMITE_ENTRADA, PUBLICO);
+    obter_estatisticas_limites(&estatisticas);
+    assert(estatisticas.etapa[LIMITE_ENTRADA][PUBLICO].aceites == 7);
+    for (int i = 0; i < 3; i++) assert(limite_permitir(LIMITE_ENTRADA, PUBLICO));
+    assert(!limite_permitir(LIMITE_ENTRADA, PUBLICO));
+
+    assert(configurar_limite("entrada:publico=0"));
+    assert(!limite_ativo(LIMITE_ENTRADA, PUBLICO));
+    assert(limite_permitir(LIMITE_ENTRADA, PUBLICO));
+    printf("Devolução: OK\n");
+}
+
+static void* pedir_fichas(void* arg) {
+    long aceites = 0;
+    (void)arg;
+    for (int i = 0; i < PEDIDOS_POR_THREAD; i++) {
+        aceites += limite_permitir(LIMITE_ATENDIMENTO, EMPRESA);
+    }
+    return (void*)aceites;
+}
+
+void test_concorrente(void) {
+    printf("Testando pedidos concorrentes...\n");
+    // Relógio parado: só a rajada pode ser aceite, por muitas threads que peçam
+    definir_limite(LIMITE_ATENDIMENTO, EMPRESA, 1, RAJADA_CONCORRENTE);
+    pthread_t threads[NUM_THREADS_TESTE];
+    for (int i = 0; i < NUM_THREADS_TESTE; i++) {
+        assert(pthread_create(&threads[i], NULL, pedir_fichas, NULL) == 0);
+    }
+    long total = 0;
+    for (int i = 0; i < NUM_THREADS_TESTE; i++) {
+        void* aceites;
+        pthread_join(threads[i], &aceites);
+        total += (long)aceites;
+    }
+    printf("   %ld aceites em %d pedidos\n", total, NUM_THREADS_TESTE * PEDIDOS_POR_THREAD);
+    assert(total == RAJADA_CONCORRENTE);
+
+    EstatisticasLimites estatisticas;
+    obter_estatisticas_limites(&estatisticas);
+    assert(estatisticas.etapa[LIMITE_ATENDIMENTO][EMPRESA].aceites == RAJADA_CONCORRENTE);
+    assert(estatisticas.etapa[LIMITE_ATENDIMENTO][EMPRESA].recusados ==
+           NUM_THREADS_TESTE * PEDIDOS_POR_THREAD - RAJADA_CONCORRENTE);
+    definir_limite(LIMITE_ATENDIMENTO, EMPRESA, 0, 1);
+    printf("Pedidos concorrentes: OK\n");
+}
+
+void test_fila(void) {
+    printf("Testando limites na fila...\n");
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+
+    // Entrada: o público além da rajada não entra
+    definir_limite(LIMITE_ENTRADA, PUBLICO, 1, 1);
+    assert(tentar_inserir_cliente(fila, 1, PUBLICO));
+    assert(!tentar_inserir_cliente(fila, 2, PUBLICO));
+    assert(fila->tamanho == 1);
+    definir_limite(LIMITE_ENTRADA, PUBLICO, 0, 1);
+
+    // Atendimento: empresas adiadas deixam passar o público
+    definir_limite(LIMITE_ATENDIMENTO, EMPRESA, 1, 1);
+    assert(tentar_inserir_cliente(fila, 3, EMPRESA));
+    assert(tentar_inserir_cliente(fila, 4, EMPRESA));
+    Cliente cliente;
+    assert(retirar_proximo_cliente(fila, &cliente));
+    assert(cliente.tipo == EMPRESA);
+    assert(retirar_proximo_cliente(fila, &cliente));
+    assert(cliente.tipo == PUBLICO && cliente.id_cliente == 1);
+    assert(!retirar_proximo_cliente(fila, &cliente));
+    assert(fila->tamanho == 1);
+
+    // Um cliente devolvido repõe a ficha do seu tipo
+    avancar_ms(1000);
+    assert(retirar_proximo_cliente(fila, &cliente));
+    assert(cliente.id_cliente == 4);
+    devolver_cliente(fila, &cliente);
+    assert(retirar_proximo_cliente(fila, &cliente));
+    assert(cliente.id_cliente == 4);
+    assert(fila->tamanho == 0);
+    definir_limite(LIMITE_ATENDIMENTO, EMPRESA, 0, 1);
+
+    liberar_fila(fila);
+    printf("Limites na fila: OK\n");
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    relogio_configurar(RELOGIO_VIRTUAL, INICIO_SIMULACAO);
+
+    test_configuracao();
+    test_balde();
+    test_concorrente();
+    test_fila();
+
+    printf("\nTodos os testes do limitador passaram!\n");
+    return 0;
+}
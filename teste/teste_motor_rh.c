@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <assert.h>
+#include "contratacoes.h"
+
+#define NUM_PROCESSOS_TESTE LIMITE_PROCESSOS_SIMULTANEOS
+
+static int contar_threads(void) {
+    int threads = 0;
+    DIR* tarefas = opendir("/proc/self/task");
+    assert(tarefas);
+    struct dirent* entrada;
+    while ((entrada = readdir(tarefas)) != NULL) {
+        if (entrada->d_name[0] != '.') threads++;
+    }
+    closedir(tarefas);
+    return threads;
+}
+
+/* Espera até 'segundos' que o estado chegue a 'quantidade' */
+static int esperar_estado(EstadoProcesso estado, int quantidade, int segundos) {
+    int contagem[NUM_ESTADOS_PROCESSO];
+    for (int espera = 0; espera < segundos * 10; espera++) {
+        obter_contagem_estados(contagem);
+        if (contagem[estado] == quantidade) return 1;
+        usleep(100000);
+    }
+    return 0;
+}
+
+void test_motor_de_eventos(void) {
+    printf("Testando processos de contratação no motor de eventos...\n");
+    inicializar_sistema_rh();
+    int threads_iniciais = contar_threads();
+
+    for (int i = 0; i < NUM_PROCESSOS_TESTE; i++) {
+        iniciar_processo_contratacao("Candidato Teste", "Vendedor", 1000.0f + i);
+    }
+    // Acima do limite de processos simultâneos o pedido é recusado
+    iniciar_processo_contratacao("Candidato Extra", "Vendedor", 1000.0f);
+    assert(get_processos_ativos() == NUM_PROCESSOS_TESTE);
+
+    // Os prazos são eventos: nenhuma thread nova por processo
+    assert(contar_threads() == threads_iniciais);
+
+    cancelar_processo(3);
+    rejeitar_processo(4);
+
+    int contagem[NUM_ESTADOS_PROCESSO];
+    obter_contagem_estados(contagem);
+    assert(contagem[PENDENTE] == NUM_PROCESSOS_TESTE - 2);
+    assert(contagem[CANCELADO] == 1 && contagem[REJEITADO] == 1);
+    printf("Processos criados: OK\n");
+
+    // Nada entra em análise antes do atraso
+    usleep((ATRASO_INICIO_ANALISE_MS - 500) * 1000);
+    obter_contagem_estados(contagem);
+    assert(contagem[EM_ANALISE] == 0);
+
+    assert(esperar_estado(EM_ANALISE, NUM_PROCESSOS_TESTE - 2, 3));
+    assert(contar_threads() == threads_iniciais);
+    printf("Entrada em análise: OK\n");
+
+    // Nenhuma análise acaba antes do tempo mínimo
+    usleep((TEMPO_CONTRATACAO_MIN - 1) * 1000000);
+    assert(get_total_contratacoes() == 0);
+
+    assert(esperar_estado(CONTRATADO, NUM_PROCESSOS_TESTE - 2,
+                          TEMPO_CONTRATACAO_MAX - TEMPO_CONTRATACAO_MIN + 3));
+    obter_contagem_estados(contagem);
+    assert(contagem[PENDENTE] == 0 && contagem[EM_ANALISE] == 0 && contagem[APROVADO] == 0);
+    assert(contagem[CANCELADO] == 1 && contagem[REJEITADO] == 1);
+    assert(get_total_contratacoes() == NUM_PROCESSOS_TESTE - 2);
+    assert(get_processos_ativos() == 0);
+    assert(contar_threads() == threads_iniciais);
+    printf("Conclusão das análises: OK\n");
+
+    // encerrar_sistema_rh esperaria pelo fim da pausa de INTERVALO_EXIBICAO
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    test_motor_de_eventos();
+    printf("\nTodos os testes do motor de eventos do RH passaram!\n");
+    return 0;
+}
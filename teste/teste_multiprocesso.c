@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "estoque.h"
+#include "Fila_prioridade.h"
+#include "multiprocesso.h"
+#include "relogio.h"
+#include "vendas.h"
+
+#define NUM_AGENCIAS_TESTE 8
+#define NUM_CLIENTES_TESTE 20
+
+int main() {
+    setbuf(stdout, NULL);
+    inicializar_estoque_fragmentado(2);
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+    definir_num_agencias(NUM_AGENCIAS_TESTE);
+    inicializar_sistema_vendas(fila);
+
+    printf("Testando recusa no modo virtual...\n");
+    relogio_configurar(RELOGIO_VIRTUAL, 0);
+    assert(executar_agencias_processos(fila, MANHA, NUM_AGENCIAS_TESTE) == -1);
+    relogio_configurar(RELOGIO_REAL, 0);
+    printf("Modo virtual: OK\n");
+
+    printf("Testando agências em processos...\n");
+    for (int i = 1; i <= NUM_CLIENTES_TESTE; i++) {
+        inserir_cliente(fila, i, i <= 5 ? EMPRESA : PUBLICO);
+    }
+    // Dia de 0,9 s e uma venda por segundo: cada processo vende uma vez
+    long duracao[3] = {300, 300, 300};
+    int limites[3] = {NUM_CLIENTES_TESTE, NUM_CLIENTES_TESTE, NUM_CLIENTES_TESTE};
+    configurar_turnos(duracao, limites);
+    definir_agencias_processos(1);
+    iniciar_vendas_concorrentes(MANHA);
+
+    // As vendas dos processos voltam ao estoque e às estatísticas do principal
+    assert(get_vendas_totais() == NUM_AGENCIAS_TESTE);
+    assert(get_vendas_empresas() == 5);
+    assert(estoque_vendido() == NUM_AGENCIAS_TESTE);
+    int soma_agencias = 0;
+    for (int i = 0; i < NUM_AGENCIAS_TESTE; i++) {
+        assert(agencias[i].vendas_realizadas == 1);
+        soma_agencias += agencias[i].vendas_realizadas;
+    }
+    assert(soma_agencias == NUM_AGENCIAS_TESTE);
+
+    // Cartões emprestados e não vendidos saem da retenção; clientes
+    // despachados e não atendidos voltam à fila
+    assert(estoque_retido() == 0);
+    assert(estoque_disponivel() == TOTAL_CARTOES - NUM_AGENCIAS_TESTE);
+    assert(fila->tamanho == NUM_CLIENTES_TESTE - NUM_AGENCIAS_TESTE);
+    printf("Processos: OK\n");
+
+    definir_agencias_processos(0);
+    liberar_fila(fila);
+    liberar_estoque();
+    printf("\nTodos os testes de multiprocesso passaram!\n");
+    return 0;
+}
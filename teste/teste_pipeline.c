@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "estoque.h"
+#include "Fila_prioridade.h"
+#include "pipeline.h"
+#include "utils.h"
+#include "vendas.h"
+
+#define NUM_EMPRESAS_TESTE 20
+#define NUM_PUBLICO_TESTE 130
+
+int main() {
+    setbuf(stdout, NULL);
+    definir_modo_saida_vendas(SAIDA_DESCARTAR);
+    inicializar_estoque();
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+
+    printf("Testando pipeline com fila vazia...\n");
+    assert(executar_pipeline_vendas(fila, MANHA, 0) == 0);
+    assert(estoque_disponivel() == TOTAL_CARTOES);
+    printf("Fila vazia: OK\n");
+
+    for (int i = 1; i <= NUM_EMPRESAS_TESTE; i++) inserir_cliente(fila, i, EMPRESA);
+    for (int i = 1; i <= NUM_PUBLICO_TESTE; i++) inserir_cliente(fila, 1000 + i, PUBLICO);
+
+    printf("Testando limite de vendas...\n");
+    assert(executar_pipeline_vendas(fila, MANHA, 30) == 30);
+    assert(fila->tamanho == NUM_EMPRESAS_TESTE + NUM_PUBLICO_TESTE - 30);
+    assert(estoque_vendido() == 30);
+
+    // O despacho respeita a prioridade e o último estágio conta cada venda
+    EstatisticasVendas est;
+    obter_estatisticas_vendas(&est);
+    assert(est.total_vendas == 30);
+    assert(est.vendas_empresas == NUM_EMPRESAS_TESTE);
+    assert(est.vendas_por_turno[MANHA] == 30);
+    printf("Limite: OK\n");
+
+    printf("Testando estoque esgotado a meio do pipeline...\n");
+    int vendas = executar_pipeline_vendas(fila, TARDE, 0);
+    assert(vendas == TOTAL_CARTOES - 30);
+    assert(estoque_esgotado());
+    // Os clientes já despachados sem cartão voltam à fila
+    assert(fila->tamanho == NUM_EMPRESAS_TESTE + NUM_PUBLICO_TESTE - TOTAL_CARTOES);
+    obter_estatisticas_vendas(&est);
+    assert(est.total_vendas == TOTAL_CARTOES);
+    assert(est.vendas_por_turno[TARDE] == TOTAL_CARTOES - 30);
+    printf("Estoque esgotado: OK\n");
+
+    liberar_fila(fila);
+    liberar_estoque();
+    printf("\nTodos os testes do pipeline passaram!\n");
+    return 0;
+}
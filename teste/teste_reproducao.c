@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <assert.h>
+#include "estoque.h"
+#include "Fila_prioridade.h"
+#include "relogio.h"
+#include "reproducao.h"
+#include "traco.h"
+#include "vendas.h"
+
+#define NUM_AGENCIAS_TESTE 4
+#define SEMENTE_TESTE 1234u
+#define CHEGADAS_POR_LOTE 5
+#define INTERVALO_CHEGADAS_NS (2 * NS_POR_SEGUNDO)
+
+static char caminho_traco[] = "/tmp/teste_reproducaoXXXXXX";
+static FilaPrioridade* fila_gravacao = NULL;
+static int proximo_cliente = 5000;
+
+/* Durante a gravação chegam clientes a meio do dia, como eventos virtuais */
+static long long chegadas_gravacao(long long agora_ns) {
+    for (int i = 0; i < CHEGADAS_POR_LOTE; i++) {
+        tentar_inserir_cliente(fila_gravacao, proximo_cliente++, i == 0 ? EMPRESA : PUBLICO);
+    }
+    return agora_ns + INTERVALO_CHEGADAS_NS;
+}
+
+static FilaPrioridade* preparar_dia(int num_agencias) {
+    inicializar_estoque_fragmentado(num_agencias);
+    iniciar_recolhedor_retencoes();
+    iniciar_rebalanceador_estoque();
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+    definir_num_agencias(num_agencias);
+    inicializar_sistema_vendas(fila);
+    return fila;
+}
+
+static void terminar_dia(FilaPrioridade* fila) {
+    reinicializar_vendas();
+    liberar_fila(fila);
+    liberar_estoque();
+}
+
+/* Reproduz o traço no modo rápido e confere as vendas com as gravadas */
+static void reproduzir(long long vendas_gravadas) {
+    CabecalhoTraco cabecalho;
+    assert(reproducao_preparar(caminho_traco, REPRODUCAO_RAPIDA, &cabecalho));
+    assert(cabecalho.num_agencias == NUM_AGENCIAS_TESTE);
+    assert(cabecalho.semente == SEMENTE_TESTE);
+
+    FilaPrioridade* fila = preparar_dia(cabecalho.num_agencias);
+    assert(reproducao_iniciar(fila));
+    iniciar_vendas_concorrentes(MANHA);
+    reproducao_concluir();
+    reproducao_parar();
+
+    EstatisticasReproducao est;
+    obter_estatisticas_reproducao(&est);
+    assert(est.vendas_gravadas == vendas_gravadas);
+    assert(est.vendas_reproduzidas == vendas_gravadas);
+    assert(est.vendas_coincidentes == vendas_gravadas);
+    assert(est.primeira_divergencia == -1);
+    assert(est.recusadas == 0);
+    terminar_dia(fila);
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    int fd = mkstemp(caminho_traco);
+    assert(fd >= 0);
+    close(fd);
+
+    printf("Testando gravação de um dia...\n");
+    relogio_configurar(RELOGIO_VIRTUAL, 0);
+    srand(SEMENTE_TESTE);
+    fila_gravacao = preparar_dia(NUM_AGENCIAS_TESTE);
+    long duracoes[3];
+    int limites[3];
+    obter_configuracao_turnos(duracoes, limites);
+    assert(traco_gravar(caminho_traco, SEMENTE_TESTE, NUM_AGENCIAS_TESTE, duracoes, limites));
+
+    for (int i = 1; i <= 30; i++) inserir_cliente(fila_gravacao, 1000 + i, EMPRESA);
+    for (int i = 1; i <= 40; i++) inserir_cliente(fila_gravacao, 2000 + i, PUBLICO);
+    definir_injetor_virtual(chegadas_gravacao);
+    iniciar_vendas_concorrentes(MANHA);
+    definir_injetor_virtual(NULL);
+    traco_parar_gravacao();
+    int vendas = get_vendas_totais();
+    terminar_dia(fila_gravacao);
+
+    // O traço tem as chegadas iniciais, as do meio do dia e cada venda
+    LeitorTraco leitor;
+    assert(traco_abrir_leitura(&leitor, caminho_traco));
+    RegistoTraco registo;
+    long long chegadas = 0, vendas_traco = 0, instante_anterior = 0;
+    int r;
+    while ((r = traco_ler_evento(&leitor, &registo)) == 1) {
+        assert(registo.instante_ns >= instante_anterior);
+        instante_anterior = registo.instante_ns;
+        if (registo.evento == TRACO_CHEGADA) chegadas++;
+        if (registo.evento == TRACO_VENDA) vendas_traco++;
+    }
+    assert(r == 0);
+    traco_fechar_leitura(&leitor);
+    assert(chegadas > 70);
+    assert(vendas > 0);
+    assert(vendas_traco == vendas);
+    printf("   %lld chegadas e %lld vendas gravadas\n", chegadas, vendas_traco);
+    printf("Gravação: OK\n");
+
+    printf("Testando reproduções determinísticas...\n");
+    for (int i = 0; i < 3; i++) reproduzir(vendas_traco);
+    printf("Reproduções: OK\n");
+
+    printf("Testando traço inválido...\n");
+    assert(!reproducao_preparar("/tmp/nao_existe_traco.bin", REPRODUCAO_RAPIDA, NULL));
+    printf("Traço inválido: OK\n");
+
+    unlink(caminho_traco);
+    printf("\nTodos os testes de reprodução passaram!\n");
+    return 0;
+}
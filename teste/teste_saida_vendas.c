@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <assert.h>
+#include "utils.h"
+
+#define NUM_THREADS_TESTE 4
+#define LINHAS_POR_THREAD 20000   // Vários buffers cheios por thread
+
+static char ficheiro_saida[] = "/tmp/teste_saida_vendasXXXXXX";
+static int fd_stdout = -1;
+
+/* Passa o stdout para um ficheiro temporário, para contar o que sai */
+static void capturar_stdout(void) {
+    fflush(stdout);
+    int fd = mkstemp(ficheiro_saida);
+    assert(fd >= 0);
+    fd_stdout = dup(STDOUT_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+}
+
+static void restaurar_stdout(void) {
+    fflush(stdout);
+    dup2(fd_stdout, STDOUT_FILENO);
+    close(fd_stdout);
+}
+
+static long tamanho_saida(void) {
+    fflush(stdout);
+    return lseek(STDOUT_FILENO, 0, SEEK_END);
+}
+
+void* thread_vendas(void* arg) {
+    int id = (int)(long)arg;
+    for (int i = 0; i < LINHAS_POR_THREAD; i++) {
+        saida_venda("[AGÊNCIA %d] Venda realizada: Cartão %05d\n", id, i);
+    }
+    return NULL;
+}
+
+static void executar_threads(void) {
+    pthread_t threads[NUM_THREADS_TESTE];
+    for (int i = 0; i < NUM_THREADS_TESTE; i++) {
+        pthread_create(&threads[i], NULL, thread_vendas, (void*)(long)i);
+    }
+    for (int i = 0; i < NUM_THREADS_TESTE; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+int main() {
+    printf("Testando modos DESCARTAR e BUFFER...\n");
+    capturar_stdout();
+    definir_modo_saida_vendas(SAIDA_DESCARTAR);
+    assert(saida_vendas_headless());
+    executar_threads();
+    saida_vendas_descarregar();
+    long descartado = tamanho_saida();
+
+    definir_modo_saida_vendas(SAIDA_BUFFER);
+    saida_venda("[AGÊNCIA 9] Venda realizada: Cartão 00000\n");
+    long antes = tamanho_saida();   // Ainda no buffer da thread
+    executar_threads();
+    saida_vendas_descarregar();
+    restaurar_stdout();
+
+    assert(descartado == 0);
+    assert(antes == 0);
+
+    // Cada linha chega inteira e, por agência, pela ordem em que foi escrita
+    FILE* f = fopen(ficheiro_saida, "r");
+    assert(f);
+    int proxima[NUM_THREADS_TESTE + 10];
+    memset(proxima, 0, sizeof(proxima));
+    int linhas = 0;
+    char linha[128];
+    while (fgets(linha, sizeof(linha), f)) {
+        int id, cartao;
+        assert(sscanf(linha, "[AGÊNCIA %d] Venda realizada: Cartão %d", &id, &cartao) == 2);
+        assert(linha[strlen(linha) - 1] == '\n');
+        if (id == 9) {
+            assert(cartao == 0);
+        } else {
+            assert(id >= 0 && id < NUM_THREADS_TESTE);
+            assert(cartao == proxima[id]);
+            proxima[id]++;
+        }
+        linhas++;
+    }
+    fclose(f);
+    unlink(ficheiro_saida);
+
+    assert(linhas == NUM_THREADS_TESTE * LINHAS_POR_THREAD + 1);
+    for (int i = 0; i < NUM_THREADS_TESTE; i++) assert(proxima[i] == LINHAS_POR_THREAD);
+    printf("Descartar e buffer: OK\n");
+
+    definir_modo_saida_vendas(SAIDA_TERMINAL);
+    assert(!saida_vendas_headless());
+    printf("\nTodos os testes de saída passaram!\n");
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "estoque.h"
+#include "Fila_prioridade.h"
+#include "relogio.h"
+#include "vendas.h"
+
+#define NUM_AGENCIAS_TESTE 3
+#define NUM_CLIENTES_TESTE 150
+#define INICIO_SIMULACAO ((time_t)1700000000)
+
+static EventoEstoque eventos[2][CAPACIDADE_EVENTOS_ESTOQUE];
+
+/* Um dia inteiro de vendas concorrentes no relógio virtual; retorna os
+ * eventos de estoque da corrida */
+static int executar_dia(EventoEstoque* destino) {
+    relogio_configurar(RELOGIO_VIRTUAL, INICIO_SIMULACAO);
+    inicializar_estoque_fragmentado(NUM_AGENCIAS_TESTE);
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+    for (int i = 1; i <= NUM_CLIENTES_TESTE; i++) {
+        inserir_cliente(fila, i, i % 3 == 0 ? EMPRESA : PUBLICO);
+    }
+
+    definir_num_agencias(NUM_AGENCIAS_TESTE);
+    inicializar_sistema_vendas(fila);
+
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    iniciar_vendas_concorrentes(MANHA);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    // Três turnos de 10 s simulados, sem dormir
+    long duracao[3];
+    obter_configuracao_turnos(duracao, NULL);
+    long long esperado = (long long)(duracao[0] + duracao[1] + duracao[2]) * 1000000LL;
+    assert(relogio_agora_ns() - (long long)INICIO_SIMULACAO * NS_POR_SEGUNDO == esperado);
+    assert(fim.tv_sec - inicio.tv_sec < 5);
+
+    // Uma venda por agência e segundo simulado, e nada além das quotas
+    EstatisticasVendas est;
+    obter_estatisticas_vendas(&est);
+    assert(est.total_vendas > 0);
+    assert(est.total_vendas <= NUM_AGENCIAS_TESTE * (int)(esperado / NS_POR_SEGUNDO));
+    assert(est.vendas_por_turno[MANHA] <= LIMITE_VENDAS_MANHA);
+    assert(est.vendas_por_turno[TARDE] <= LIMITE_VENDAS_TARDE);
+    assert(est.vendas_por_turno[NOITE] <= LIMITE_VENDAS_NOITE);
+    assert(est.total_vendas == estoque_vendido());
+
+    unsigned long long seq = 0;
+    int n = estoque_eventos_desde(0, destino, CAPACIDADE_EVENTOS_ESTOQUE, &seq);
+    assert(n > 0);
+
+    reinicializar_vendas();
+    liberar_fila(fila);
+    return n;
+}
+
+int main() {
+    setbuf(stdout, NULL);
+
+    printf("Testando um dia de vendas em tempo virtual...\n");
+    int n1 = executar_dia(eventos[0]);
+    printf("Dia virtual: OK\n");
+
+    printf("Testando repetição determinística...\n");
+    int n2 = executar_dia(eventos[1]);
+    assert(n1 == n2);
+    for (int i = 0; i < n1; i++) {
+        assert(eventos[0][i].tipo == eventos[1][i].tipo);
+        assert(eventos[0][i].cartao_id == eventos[1][i].cartao_id);
+        assert(eventos[0][i].instante == eventos[1][i].instante);
+    }
+    printf("Repetição (%d eventos iguais): OK\n", n1);
+
+    liberar_estoque();
+    printf("\nTodos os testes de tempo virtual passaram!\n");
+    return 0;
+}
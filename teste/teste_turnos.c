@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "estoque.h"
+#include "Fila_prioridade.h"
+#include "relogio.h"
+#include "vendas.h"
+
+#define NUM_CLIENTES_TESTE 60
+
+static FilaPrioridade* preparar_dia(void) {
+    inicializar_estoque();
+    FilaPrioridade* fila = inicializar_fila();
+    assert(fila);
+    for (int i = 1; i <= NUM_CLIENTES_TESTE; i++) inserir_cliente(fila, i, PUBLICO);
+    definir_num_agencias(4);
+    inicializar_sistema_vendas(fila);
+    return fila;
+}
+
+int main() {
+    setbuf(stdout, NULL);
+    relogio_configurar(RELOGIO_VIRTUAL, 0);
+
+    printf("Testando configuração dos turnos...\n");
+    long duracao[3] = {2000, 3000, 4000};
+    int limites[3] = {5, 3, 2};
+    configurar_turnos(duracao, limites);
+
+    // Valores não positivos (duração) ou negativos (quota) mantêm o atual
+    long sem_duracao[3] = {0, -1, 0};
+    int sem_limite[3] = {-1, -1, -1};
+    configurar_turnos(sem_duracao, sem_limite);
+    configurar_turnos(NULL, NULL);
+
+    long lidas[3];
+    int quotas[3];
+    obter_configuracao_turnos(lidas, quotas);
+    for (int t = 0; t < 3; t++) {
+        assert(lidas[t] == duracao[t]);
+        assert(quotas[t] == limites[t]);
+    }
+    printf("Configuração: OK\n");
+
+    printf("Testando quotas e mudança de turno...\n");
+    FilaPrioridade* fila = preparar_dia();
+    long long inicio = relogio_agora_ns();
+    iniciar_vendas_concorrentes(MANHA);
+
+    // Clientes de sobra: cada turno vende exatamente a sua quota
+    EstatisticasVendas est;
+    obter_estatisticas_vendas(&est);
+    assert(est.vendas_por_turno[MANHA] == 5);
+    assert(est.vendas_por_turno[TARDE] == 3);
+    assert(est.vendas_por_turno[NOITE] == 2);
+    assert(est.total_vendas == 10);
+    assert(fila->tamanho == NUM_CLIENTES_TESTE - 10);
+    assert(get_turno_atual() == NOITE);
+    assert(get_vendas_turno_atual() == 2);
+    assert(relogio_agora_ns() - inicio == 9000 * 1000000LL);
+    printf("Quotas por turno: OK\n");
+
+    printf("Testando arranque a meio do dia...\n");
+    reinicializar_vendas();
+    liberar_fila(fila);
+    fila = preparar_dia();
+    inicio = relogio_agora_ns();
+    iniciar_vendas_concorrentes(TARDE);
+
+    obter_estatisticas_vendas(&est);
+    assert(est.vendas_por_turno[MANHA] == 0);
+    assert(est.vendas_por_turno[TARDE] == 3);
+    assert(est.vendas_por_turno[NOITE] == 2);
+    assert(relogio_agora_ns() - inicio == 7000 * 1000000LL);
+    printf("Arranque na TARDE: OK\n");
+
+    reinicializar_vendas();
+    liberar_fila(fila);
+    liberar_estoque();
+    printf("\nTodos os testes de turnos passaram!\n");
+    return 0;
+}